@@ -35,6 +35,14 @@
 #include <kdl/overload.h>
 
 #include <vecmath/bbox.h>
+#include <vecmath/ray.h>
+#include <vecmath/vec.h>
+
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
 
 #include "BenchmarkUtils.h"
 #include "../../test/src/Catch2.h"
@@ -43,8 +51,8 @@ namespace TrenchBroom {
     using AABB = AABBTree<double, 3, Model::Node*>;
     using BOX = AABB::Box;
 
-    TEST_CASE("AABBTreeBenchmark.benchBuildTree", "[AABBTreeBenchmark]") {
-        const auto mapPath = IO::Disk::getCurrentWorkingDir() + IO::Path("fixture/benchmark/AABBTree/ne_ruins.map");
+    static std::unique_ptr<Model::WorldNode> loadMap(const std::string& mapName) {
+        const auto mapPath = IO::Disk::getCurrentWorkingDir() + IO::Path("fixture/benchmark/AABBTree") + IO::Path(mapName);
         const auto file = IO::Disk::openFile(mapPath);
         auto fileReader = file->reader().buffer();
 
@@ -52,20 +60,105 @@ namespace TrenchBroom {
         IO::WorldReader worldReader(fileReader.stringView(), Model::MapFormat::Standard);
 
         const vm::bbox3 worldBounds(8192.0);
-        auto world = worldReader.read(worldBounds, status);
+        return worldReader.read(worldBounds, status);
+    }
+
+    static std::vector<Model::Node*> collectNodes(Model::WorldNode& world) {
+        std::vector<Model::Node*> result;
+        world.accept(kdl::overload(
+            [] (auto&& thisLambda, Model::WorldNode* world_)  { world_->visitChildren(thisLambda); },
+            [] (auto&& thisLambda, Model::LayerNode* layer)   { layer->visitChildren(thisLambda); },
+            [] (auto&& thisLambda, Model::GroupNode* group)   { group->visitChildren(thisLambda); },
+            [&](auto&& thisLambda, Model::EntityNode* entity) { entity->visitChildren(thisLambda); result.push_back(entity); },
+            [&](Model::BrushNode* brush)                      { result.push_back(brush); },
+            [&](Model::PatchNode* patch)                      { result.push_back(patch); }
+        ));
+        return result;
+    }
+
+    static BOX getBounds(const Model::Node* node) {
+        return node->physicalBounds();
+    }
+
+    TEST_CASE("AABBTreeBenchmark.benchBuildTree", "[AABBTreeBenchmark]") {
+        auto world = loadMap("ne_ruins.map");
+        const auto nodes = collectNodes(*world);
 
         std::vector<AABB> trees(100);
-        timeLambda([&world, &trees]() {
+        timeLambda([&nodes, &trees]() {
             for (auto& tree : trees) {
-                world->accept(kdl::overload(
-                    [] (auto&& thisLambda, Model::WorldNode* world_)  { world_->visitChildren(thisLambda); },
-                    [] (auto&& thisLambda, Model::LayerNode* layer)   { layer->visitChildren(thisLambda); },
-                    [] (auto&& thisLambda, Model::GroupNode* group)   { group->visitChildren(thisLambda); },
-                    [&](auto&& thisLambda, Model::EntityNode* entity) { entity->visitChildren(thisLambda); tree.insert(entity->physicalBounds(), entity); },
-                    [&](Model::BrushNode* brush)                      { tree.insert(brush->physicalBounds(), brush); },
-                    [&](Model::PatchNode* patch)                      { tree.insert(patch->physicalBounds(), patch); }
-                ));
+                for (auto* node : nodes) {
+                    tree.insert(getBounds(node), node);
+                }
             }
         }, "Add objects to AABB tree");
+
+        std::vector<AABB> bulkTrees(100);
+        timeLambda([&nodes, &bulkTrees]() {
+            for (auto& tree : bulkTrees) {
+                tree.clearAndBuild(nodes, getBounds);
+            }
+        }, "Bulk build AABB tree");
+
+        printf("Incremental tree: height %zu, SAH cost %f\n", trees.front().height(), trees.front().sahCost());
+        printf("Bulk built tree: height %zu, SAH cost %f\n", bulkTrees.front().height(), bulkTrees.front().sahCost());
+    }
+
+    static void benchQueries(const AABB& tree, const std::vector<vm::ray3>& rays, const std::vector<vm::vec3>& points, const std::string& treeName) {
+        size_t hits = 0;
+        std::vector<Model::Node*> result;
+        timeLambda([&]() {
+            for (const auto& ray : rays) {
+                result.clear();
+                tree.findIntersectors(ray, std::back_inserter(result));
+                hits += result.size();
+            }
+        }, std::to_string(rays.size()) + " ray queries on " + treeName);
+        CHECK(hits > 0u);
+
+        hits = 0;
+        timeLambda([&]() {
+            for (const auto& point : points) {
+                result.clear();
+                tree.findContainers(point, std::back_inserter(result));
+                hits += result.size();
+            }
+        }, std::to_string(points.size()) + " point queries on " + treeName);
+        CHECK(hits > 0u);
+    }
+
+    TEST_CASE("AABBTreeBenchmark.benchQueries", "[AABBTreeBenchmark]") {
+        constexpr size_t NumQueries = 100'000;
+
+        auto world = loadMap("ne_ruins.map");
+        const auto nodes = collectNodes(*world);
+
+        AABB tree;
+        for (auto* node : nodes) {
+            tree.insert(getBounds(node), node);
+        }
+
+        AABB bulkTree;
+        bulkTree.clearAndBuild(nodes, getBounds);
+
+        // generate queries that are distributed over the bounds of the map
+        const auto& bounds = tree.bounds();
+        auto rng = std::mt19937(0);
+        auto xDist = std::uniform_real_distribution<double>(bounds.min.x(), bounds.max.x());
+        auto yDist = std::uniform_real_distribution<double>(bounds.min.y(), bounds.max.y());
+        auto zDist = std::uniform_real_distribution<double>(bounds.min.z(), bounds.max.z());
+        auto dirDist = std::uniform_real_distribution<double>(-1.0, 1.0);
+
+        std::vector<vm::vec3> points;
+        std::vector<vm::ray3> rays;
+        points.reserve(NumQueries);
+        rays.reserve(NumQueries);
+        for (size_t i = 0; i < NumQueries; ++i) {
+            points.emplace_back(xDist(rng), yDist(rng), zDist(rng));
+            rays.emplace_back(points.back(), vm::normalize(vm::vec3(dirDist(rng), dirDist(rng), dirDist(rng))));
+        }
+
+        benchQueries(tree, rays, points, "incremental tree");
+        benchQueries(bulkTree, rays, points, "bulk built tree");
     }
 }
@@ -0,0 +1,213 @@
+/*
+ Copyright (C) 2021 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Color.h"
+#include "Assets/TextureBuffer.h"
+
+#include <vecmath/vec.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "BenchmarkUtils.h"
+#include "../../test/src/Catch2.h"
+
+namespace TrenchBroom {
+    namespace Assets {
+        constexpr auto TextureSize = size_t(256);
+        constexpr auto TextureCount = size_t(256);
+        constexpr auto PixelCount = TextureSize * TextureSize;
+
+        /**
+         * The previous implementation of Palette::indexedToRgba, which copies and sums every pixel separately.
+         */
+        static Color scalarIndexedToRgba(const unsigned char* indexedImage, const size_t pixelCount, const unsigned char* paletteData, unsigned char* rgbaData) {
+            for (size_t i = 0; i < pixelCount; ++i) {
+                const int index = static_cast<int>(indexedImage[i]);
+                std::memcpy(rgbaData + (i * 4), &paletteData[index * 4], 4);
+            }
+
+            std::uint32_t colorSum[3] = {0, 0, 0};
+            for (size_t i = 0; i < pixelCount; ++i) {
+                colorSum[0] += static_cast<std::uint32_t>(rgbaData[(i * 4) + 0]);
+                colorSum[1] += static_cast<std::uint32_t>(rgbaData[(i * 4) + 1]);
+                colorSum[2] += static_cast<std::uint32_t>(rgbaData[(i * 4) + 2]);
+            }
+            return Color(static_cast<float>(colorSum[0]) / (255.0f * static_cast<float>(pixelCount)),
+                         static_cast<float>(colorSum[1]) / (255.0f * static_cast<float>(pixelCount)),
+                         static_cast<float>(colorSum[2]) / (255.0f * static_cast<float>(pixelCount)),
+                         1.0f);
+        }
+
+        /**
+         * The previous implementation of the average color of images loaded by FreeImageTextureReader.
+         */
+        static Color scalarAverageColor(const TextureBuffer& buffer) {
+            const unsigned char* const data = buffer.data();
+            const std::size_t bufferSize = buffer.size();
+
+            Color average;
+            for (std::size_t i = 0; i < bufferSize; i += 4) {
+                average = average + Color(data[i], data[i+1], data[i+2], data[i+3]);
+            }
+            const std::size_t numPixels = bufferSize / 4;
+            average = average / static_cast<float>(numPixels);
+
+            return average;
+        }
+
+        /**
+         * A straightforward box filter that computes one channel of one pixel at a time.
+         */
+        static void scalarGenerateMips(TextureBufferList& buffers, const size_t width, const size_t height) {
+            const auto mipLevels = mipLevelCount(width, height);
+            buffers.resize(mipLevels);
+
+            for (size_t level = 1; level < mipLevels; ++level) {
+                const auto srcSize = sizeAtMipLevel(width, height, level - 1);
+                const auto dstSize = sizeAtMipLevel(width, height, level);
+                buffers[level] = TextureBuffer(4 * dstSize.x() * dstSize.y());
+
+                const auto* src = buffers[level - 1].data();
+                auto* dst = buffers[level].data();
+                for (size_t y = 0; y < dstSize.y(); ++y) {
+                    for (size_t x = 0; x < dstSize.x(); ++x) {
+                        const auto x0 = std::min(2 * x, srcSize.x() - 1);
+                        const auto x1 = std::min(2 * x + 1, srcSize.x() - 1);
+                        const auto y0 = std::min(2 * y, srcSize.y() - 1);
+                        const auto y1 = std::min(2 * y + 1, srcSize.y() - 1);
+                        for (size_t c = 0; c < 4; ++c) {
+                            const auto sum = static_cast<unsigned int>(src[4 * (y0 * srcSize.x() + x0) + c])
+                                + src[4 * (y0 * srcSize.x() + x1) + c]
+                                + src[4 * (y1 * srcSize.x() + x0) + c]
+                                + src[4 * (y1 * srcSize.x() + x1) + c];
+                            dst[4 * (y * dstSize.x() + x) + c] = static_cast<unsigned char>((sum + 2) / 4);
+                        }
+                    }
+                }
+            }
+        }
+
+        static std::string describeTextures(const size_t pixelCount) {
+            return std::to_string(TextureCount) + " textures of " + std::to_string(pixelCount) + " pixels";
+        }
+
+        TEST_CASE("TextureBufferBenchmark.applyPalette", "[TextureBufferBenchmark]") {
+            auto rng = std::mt19937{42u};
+            auto byte = std::uniform_int_distribution<unsigned int>{0u, 255u};
+
+            auto palette = std::vector<unsigned char>(1024);
+            std::generate(std::begin(palette), std::end(palette), [&]() { return static_cast<unsigned char>(byte(rng)); });
+
+            auto indices = std::vector<unsigned char>(PixelCount);
+            std::generate(std::begin(indices), std::end(indices), [&]() { return static_cast<unsigned char>(byte(rng)); });
+
+            auto scalarImage = TextureBuffer(4 * PixelCount);
+            auto scalarColor = Color();
+            timeLambda([&]() {
+                for (size_t i = 0; i < TextureCount; ++i) {
+                    scalarColor = scalarIndexedToRgba(indices.data(), PixelCount, palette.data(), scalarImage.data());
+                }
+            }, "scalar palette expansion and average color of " + describeTextures(PixelCount));
+
+            auto image = TextureBuffer(4 * PixelCount);
+            auto color = Color();
+            timeLambda([&]() {
+                for (size_t i = 0; i < TextureCount; ++i) {
+                    applyPalette(indices.data(), PixelCount, palette.data(), image.data());
+                    color = Color(averageColor(image, GL_RGBA), 1.0f);
+                }
+            }, "vectorized palette expansion and average color of " + describeTextures(PixelCount));
+
+            CHECK(std::memcmp(image.data(), scalarImage.data(), image.size()) == 0);
+            CHECK(color.r() == Approx(scalarColor.r()));
+            CHECK(color.g() == Approx(scalarColor.g()));
+            CHECK(color.b() == Approx(scalarColor.b()));
+        }
+
+        TEST_CASE("TextureBufferBenchmark.averageColor", "[TextureBufferBenchmark]") {
+            auto rng = std::mt19937{42u};
+            auto byte = std::uniform_int_distribution<unsigned int>{0u, 255u};
+
+            auto image = TextureBuffer(4 * PixelCount);
+            std::generate(image.data(), image.data() + image.size(), [&]() { return static_cast<unsigned char>(byte(rng)); });
+
+            auto scalarColor = Color();
+            timeLambda([&]() {
+                for (size_t i = 0; i < TextureCount; ++i) {
+                    scalarColor = scalarAverageColor(image);
+                }
+            }, "scalar average color of " + describeTextures(PixelCount));
+
+            auto color = Color();
+            timeLambda([&]() {
+                for (size_t i = 0; i < TextureCount; ++i) {
+                    color = averageColor(image, GL_RGBA);
+                }
+            }, "vectorized average color of " + describeTextures(PixelCount));
+
+            // the scalar implementation loses precision when summing many floats
+            CHECK(color.r() == Approx(scalarColor.r()).epsilon(0.01));
+            CHECK(color.g() == Approx(scalarColor.g()).epsilon(0.01));
+            CHECK(color.b() == Approx(scalarColor.b()).epsilon(0.01));
+            CHECK(color.a() == Approx(scalarColor.a()).epsilon(0.01));
+        }
+
+        TEST_CASE("TextureBufferBenchmark.generateMips", "[TextureBufferBenchmark]") {
+            auto rng = std::mt19937{42u};
+            auto byte = std::uniform_int_distribution<unsigned int>{0u, 255u};
+
+            auto image = TextureBuffer(4 * PixelCount);
+            std::generate(image.data(), image.data() + image.size(), [&]() { return static_cast<unsigned char>(byte(rng)); });
+
+            const auto makeBuffers = [&]() {
+                auto result = TextureBufferList(1);
+                result[0] = TextureBuffer(image.size());
+                std::memcpy(result[0].data(), image.data(), image.size());
+                return result;
+            };
+
+            auto scalarBuffers = TextureBufferList{};
+            timeLambda([&]() {
+                for (size_t i = 0; i < TextureCount; ++i) {
+                    scalarBuffers = makeBuffers();
+                    scalarGenerateMips(scalarBuffers, TextureSize, TextureSize);
+                }
+            }, "scalar mip generation for " + describeTextures(PixelCount));
+
+            auto buffers = TextureBufferList{};
+            timeLambda([&]() {
+                for (size_t i = 0; i < TextureCount; ++i) {
+                    buffers = makeBuffers();
+                    generateMips(buffers, TextureSize, TextureSize, GL_RGBA);
+                }
+            }, "vectorized mip generation for " + describeTextures(PixelCount));
+
+            REQUIRE(buffers.size() == scalarBuffers.size());
+            for (size_t level = 0; level < buffers.size(); ++level) {
+                REQUIRE(buffers[level].size() == scalarBuffers[level].size());
+                CHECK(std::memcmp(buffers[level].data(), scalarBuffers[level].data(), buffers[level].size()) == 0);
+            }
+        }
+    }
+}
@@ -0,0 +1,92 @@
+/*
+ Copyright (C) 2021 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FloatType.h"
+#include "IO/NodeWriter.h"
+#include "Model/Brush.h"
+#include "Model/BrushBuilder.h"
+#include "Model/BrushNode.h"
+#include "Model/Entity.h"
+#include "Model/LayerNode.h"
+#include "Model/MapFormat.h"
+#include "Model/WorldNode.h"
+
+#include <kdl/result.h>
+
+#include <vecmath/bbox.h>
+#include <vecmath/mat.h>
+#include <vecmath/mat_ext.h>
+#include <vecmath/vec.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "BenchmarkUtils.h"
+#include "../../test/src/Catch2.h"
+
+namespace TrenchBroom {
+    namespace IO {
+        /**
+         * Saves a map with 100k brushes without any cached serializations, then saves it again after changing 0.1% of
+         * its brushes so that only those have to be serialized again.
+         */
+        TEST_CASE("NodeWriterBenchmark.saveAfterSmallChange", "[NodeWriterBenchmark]") {
+            const auto worldBounds = vm::bbox3(8192.0);
+            const auto mapFormat = Model::MapFormat::Valve;
+            const auto builder = Model::BrushBuilder(mapFormat, worldBounds);
+
+            auto world = Model::WorldNode(Model::Entity(), mapFormat);
+            auto brushNodes = std::vector<Model::BrushNode*>{};
+            brushNodes.reserve(100'000);
+            for (size_t i = 0; i < 100'000; ++i) {
+                const auto min = vm::vec3(static_cast<FloatType>(i % 256) * 32.0, static_cast<FloatType>(i / 256) * 16.0, 0.0);
+                brushNodes.push_back(new Model::BrushNode(builder.createCuboid(vm::bbox3(min, min + vm::vec3(32.0, 16.0, 64.0)), "texture").value()));
+            }
+
+            world.beginNodeTreeBatch();
+            world.defaultLayer()->addChildren(std::vector<Model::Node*>(std::begin(brushNodes), std::end(brushNodes)));
+            world.endNodeTreeBatch();
+
+            const auto save = [&]() {
+                auto str = std::stringstream{};
+                auto writer = NodeWriter(world, str);
+                writer.writeMap();
+                return str.str();
+            };
+
+            auto first = std::string{};
+            timeLambda([&]() { first = save(); }, "save without cached serializations");
+
+            auto second = std::string{};
+            timeLambda([&]() { second = save(); }, "save without changes");
+            CHECK(second == first);
+
+            for (size_t i = 0; i < brushNodes.size(); i += 1000) {
+                auto brush = brushNodes[i]->brush();
+                REQUIRE(brush.transform(worldBounds, vm::translation_matrix(vm::vec3(0.0, 0.0, 16.0)), false).is_success());
+                brushNodes[i]->setBrush(std::move(brush));
+            }
+
+            auto third = std::string{};
+            timeLambda([&]() { third = save(); }, "save after changing 0.1% of brushes");
+            CHECK(third != first);
+        }
+    }
+}
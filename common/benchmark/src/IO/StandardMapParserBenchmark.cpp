@@ -0,0 +1,135 @@
+/*
+ Copyright (C) 2021 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "IO/StandardMapParser.h"
+
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+#include "../../test/src/Catch2.h"
+
+namespace TrenchBroom {
+    namespace IO {
+        static const size_t BrushCount = 20000u;
+
+        static std::string makeStandardMap() {
+            std::stringstream str;
+            str << "// entity 0\n{\n\"classname\" \"worldspawn\"\n\"wad\" \"/quake/gfx.wad\"\n";
+            for (size_t i = 0u; i < BrushCount; ++i) {
+                const auto x = static_cast<int>(i % 256u) * 16;
+                str << "// brush " << i << "\n{\n"
+                    << "( " << x << " -64 -16 ) ( " << x << " -63 -16 ) ( " << x << " -64 -15 ) rock1_2 -0 -0 -0 1 1\n"
+                    << "( -64 -64 -16 ) ( -64 -64 -15 ) ( -63 -64 -16 ) rock1_2 -12.5 0 90 0.5 1.25\n"
+                    << "( -64 -64 -16 ) ( -63 -64 -16 ) ( -64 -63 -16 ) rock1_2 0 -0 -0 1 1\n"
+                    << "( 64 64 16 ) ( 64 65 16 ) ( 65 64 16 ) rock1_2 0 0 0 1 1\n"
+                    << "( 64 64 16 ) ( 65 64 16 ) ( 64 64 17 ) rock1_2 0 0 0 1 1\n"
+                    << "( 64 64 16 ) ( 64 64 17 ) ( 64 65 16 ) rock1_2 0 0 0 1 1\n"
+                    << "}\n";
+            }
+            str << "}\n";
+            return str.str();
+        }
+
+        static std::string makeValveMap() {
+            std::stringstream str;
+            str << "// entity 0\n{\n\"mapversion\" \"220\"\n\"classname\" \"worldspawn\"\n";
+            for (size_t i = 0u; i < BrushCount; ++i) {
+                const auto x = static_cast<int>(i % 256u) * 16;
+                str << "// brush " << i << "\n{\n"
+                    << "( " << x << " -64 -16 ) ( " << x << " -63 -16 ) ( " << x << " -64 -15 ) __TB_empty [ 0 -1 0 -0 ] [ 0 0 -1 -0 ] -0 1 1\n"
+                    << "( -64 -64 -16 ) ( -64 -64 -15 ) ( -63 -64 -16 ) __TB_empty [ 1 0 0 -0 ] [ 0 0 -1 -0 ] -0 1 1\n"
+                    << "( -64 -64 -16 ) ( -63 -64 -16 ) ( -64 -63 -16 ) __TB_empty [ -1 0 0 -0 ] [ 0 -1 0 -0 ] -0 1 1\n"
+                    << "( 64 64 16 ) ( 64 65 16 ) ( 65 64 16 ) __TB_empty [ 1 0 0 -0 ] [ 0 -1 0 -0 ] -0 1 1\n"
+                    << "( 64 64 16 ) ( 65 64 16 ) ( 64 64 17 ) __TB_empty [ -1 0 0 -0 ] [ 0 0 -1 -0 ] -0 1 1\n"
+                    << "( 64 64 16 ) ( 64 64 17 ) ( 64 65 16 ) __TB_empty [ 0 1 0 -0 ] [ 0 0 -1 -0 ] -0 1 1\n"
+                    << "}\n";
+            }
+            str << "}\n";
+            return str.str();
+        }
+
+        static std::string makeQuake3Map() {
+            std::stringstream str;
+            str << "// entity 0\n{\n\"classname\" \"worldspawn\"\n";
+            for (size_t i = 0u; i < BrushCount; ++i) {
+                const auto x = static_cast<int>(i % 256u) * 16;
+                if (i % 8u == 0u) {
+                    str << "// brush " << i << "\n{\npatchDef2\n{\ncommon/caulk\n( 3 3 0 0 0 )\n(\n"
+                        << "( ( " << x << " -64 0 0 0 ) ( " << x << " 0 0 0.5 0 ) ( " << x << " 64 0 1 0 ) )\n"
+                        << "( ( 0 -64 0 0 0.5 ) ( 0 0 32 0.5 0.5 ) ( 0 64 0 1 0.5 ) )\n"
+                        << "( ( 64 -64 0 0 1 ) ( 64 0 0 0.5 1 ) ( 64 64 0 1 1 ) )\n"
+                        << ")\n}\n}\n";
+                } else {
+                    str << "// brush " << i << "\n{\nbrushDef\n{\n"
+                        << "( " << x << " -64 -16 ) ( " << x << " -63 -16 ) ( " << x << " -64 -15 ) ( ( 0.03125 0 0 ) ( 0 0.03125 0 ) ) common/caulk 0 0 0\n"
+                        << "( -64 -64 -16 ) ( -64 -64 -15 ) ( -63 -64 -16 ) ( ( 0.03125 0 0 ) ( 0 0.03125 0 ) ) common/caulk 0 0 0\n"
+                        << "( -64 -64 -16 ) ( -63 -64 -16 ) ( -64 -63 -16 ) ( ( 0.03125 0 0 ) ( 0 0.03125 0 ) ) common/caulk 0 0 0\n"
+                        << "( 64 64 16 ) ( 64 65 16 ) ( 65 64 16 ) ( ( 0.03125 0 0 ) ( 0 0.03125 0 ) ) common/caulk 0 0 0\n"
+                        << "( 64 64 16 ) ( 65 64 16 ) ( 64 64 17 ) ( ( 0.03125 0 0 ) ( 0 0.03125 0 ) ) common/caulk 0 0 0\n"
+                        << "( 64 64 16 ) ( 64 64 17 ) ( 64 65 16 ) ( ( 0.03125 0 0 ) ( 0 0.03125 0 ) ) common/caulk 0 0 0\n"
+                        << "}\n}\n";
+                }
+            }
+            str << "}\n";
+            return str.str();
+        }
+
+        /**
+         * Runs the tokenizer over the given map and converts every number token like the parser would, then reports
+         * the throughput in MB/s.
+         */
+        static void tokenizeMap(const std::string& map, const std::string& name) {
+            size_t tokenCount = 0u;
+            double sum = 0.0;
+
+            const auto start = std::chrono::high_resolution_clock::now();
+            QuakeMapTokenizer tokenizer(map);
+            auto token = tokenizer.nextToken();
+            while (!token.hasType(QuakeMapToken::Eof)) {
+                if (token.hasType(QuakeMapToken::Number)) {
+                    sum += token.toFloat<double>();
+                }
+                ++tokenCount;
+                token = tokenizer.nextToken();
+            }
+            const auto end = std::chrono::high_resolution_clock::now();
+
+            const auto seconds = std::chrono::duration<double>(end - start).count();
+            const auto megabytes = static_cast<double>(map.size()) / (1024.0 * 1024.0);
+            std::printf("Tokenized %s map (%.1f MB, %zu tokens, checksum %g) in %fms: %.1f MB/s\n",
+                name.c_str(), megabytes, tokenCount, sum, seconds * 1000.0, megabytes / seconds);
+
+            CHECK(tokenCount > BrushCount);
+        }
+
+        TEST_CASE("StandardMapParserBenchmark.tokenizeStandardMap", "[StandardMapParserBenchmark]") {
+            tokenizeMap(makeStandardMap(), "Standard");
+        }
+
+        TEST_CASE("StandardMapParserBenchmark.tokenizeValveMap", "[StandardMapParserBenchmark]") {
+            tokenizeMap(makeValveMap(), "Valve");
+        }
+
+        TEST_CASE("StandardMapParserBenchmark.tokenizeQuake3Map", "[StandardMapParserBenchmark]") {
+            tokenizeMap(makeQuake3Map(), "Quake3");
+        }
+    }
+}
@@ -0,0 +1,137 @@
+/*
+ Copyright (C) 2021 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Logger.h"
+#include "Assets/Palette.h"
+#include "Assets/TextureCollection.h"
+#include "IO/DiskFileSystem.h"
+#include "IO/DiskIO.h"
+#include "IO/FileMatcher.h"
+#include "IO/IdMipTextureReader.h"
+#include "IO/IOUtils.h"
+#include "IO/Path.h"
+#include "IO/TextureCollectionLoader.h"
+#include "IO/TextureReader.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "BenchmarkUtils.h"
+#include "../../test/src/Catch2.h"
+
+namespace TrenchBroom {
+    namespace IO {
+        template <typename T>
+        static void writeInt(std::ostream& stream, const T value) {
+            stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        /**
+         * Writes a WAD2 file with the given number of textures with 4 mip levels each.
+         */
+        static void writeWad(const Path& path, const size_t textureCount, const size_t size) {
+            auto stream = openPathAsOutputStream(path, std::ios::out | std::ios::binary | std::ios::trunc);
+
+            const auto mipDataSize = size * size + (size / 2) * (size / 2) + (size / 4) * (size / 4) + (size / 8) * (size / 8);
+            const auto textureSize = 16 + 2 * 4 + 4 * 4 + mipDataSize;
+
+            stream.write("WAD2", 4);
+            writeInt(stream, static_cast<std::int32_t>(textureCount));
+            writeInt(stream, static_cast<std::int32_t>(12 + textureCount * textureSize));
+
+            auto pixels = std::vector<char>(mipDataSize);
+            for (size_t i = 0; i < textureCount; ++i) {
+                char name[16] = {};
+                std::snprintf(name, sizeof(name), "texture%zu", i);
+                stream.write(name, sizeof(name));
+                writeInt(stream, static_cast<std::int32_t>(size));
+                writeInt(stream, static_cast<std::int32_t>(size));
+
+                auto offset = std::int32_t(16 + 2 * 4 + 4 * 4);
+                for (size_t mip = 0; mip < 4; ++mip) {
+                    writeInt(stream, offset);
+                    offset += static_cast<std::int32_t>((size >> mip) * (size >> mip));
+                }
+
+                for (size_t j = 0; j < pixels.size(); ++j) {
+                    pixels[j] = static_cast<char>((i + j) % 255);
+                }
+                stream.write(pixels.data(), static_cast<std::streamsize>(pixels.size()));
+            }
+
+            for (size_t i = 0; i < textureCount; ++i) {
+                writeInt(stream, static_cast<std::int32_t>(12 + i * textureSize));
+                writeInt(stream, static_cast<std::int32_t>(textureSize));
+                writeInt(stream, static_cast<std::int32_t>(textureSize));
+                stream.put('D');
+                stream.put(0);
+                stream.put(0);
+                stream.put(0);
+
+                char name[16] = {};
+                std::snprintf(name, sizeof(name), "texture%zu", i);
+                stream.write(name, sizeof(name));
+            }
+        }
+
+        TEST_CASE("TextureLoaderBenchmark.loadCachedTextures", "[TextureLoaderBenchmark]") {
+            constexpr auto TextureCount = size_t(512);
+            constexpr auto TextureSize = size_t(256);
+
+            const auto dir = Disk::getCurrentWorkingDir() + Path("TextureLoaderBenchmark");
+            const auto cacheDir = dir + Path("cache");
+            Disk::ensureDirectoryExists(dir);
+            Disk::deleteFilesRecursively(dir, FileTypeMatcher(true, false));
+
+            writeWad(dir + Path("textures.wad"), TextureCount, TextureSize);
+
+            auto paletteData = std::vector<unsigned char>(768);
+            for (size_t i = 0; i < paletteData.size(); ++i) {
+                paletteData[i] = static_cast<unsigned char>(i / 3);
+            }
+            const auto palette = Assets::Palette(paletteData);
+
+            auto logger = NullLogger();
+            const auto fs = DiskFileSystem(dir);
+            const auto textureReader = IdMipTextureReader(TextureReader::TextureNameStrategy(), fs, logger, palette);
+
+            const auto load = [&](const Path& cacheDirectory) {
+                auto loader = FileTextureCollectionLoader(logger, {dir}, {}, cacheDirectory, "benchmark");
+                return loader.loadTextureCollection(Path("textures.wad"), {"D"}, textureReader);
+            };
+
+            timeLambda([&]() {
+                CHECK(load(Path()).textureCount() == TextureCount);
+            }, "load " + std::to_string(TextureCount) + " textures without cache");
+
+            timeLambda([&]() {
+                CHECK(load(cacheDir).textureCount() == TextureCount);
+            }, "load " + std::to_string(TextureCount) + " textures and populate cache (cold)");
+
+            timeLambda([&]() {
+                CHECK(load(cacheDir).textureCount() == TextureCount);
+            }, "load " + std::to_string(TextureCount) + " textures from cache (warm)");
+
+            Disk::deleteFilesRecursively(dir, FileTypeMatcher(true, false));
+        }
+    }
+}
@@ -0,0 +1,94 @@
+/*
+ Copyright (C) 2021 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "IO/DiskIO.h"
+#include "IO/File.h"
+#include "IO/Path.h"
+#include "IO/Reader.h"
+#include "IO/TestParserStatus.h"
+#include "IO/WorldReader.h"
+#include "Model/MapFormat.h"
+#include "Model/WorldNode.h"
+
+#include <vecmath/bbox.h>
+
+#include <cstdio>
+#include <memory>
+#include <optional>
+#include <string>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include "BenchmarkUtils.h"
+#include "../../test/src/Catch2.h"
+
+namespace TrenchBroom {
+    namespace IO {
+        /**
+         * Returns the largest amount of physical memory that this process has used so far, in bytes, or an empty
+         * optional if it cannot be determined on this platform.
+         */
+        static std::optional<size_t> peakResidentSetSize() {
+#ifdef _WIN32
+            return std::nullopt;
+#else
+            struct rusage usage;
+            if (getrusage(RUSAGE_SELF, &usage) != 0) {
+                return std::nullopt;
+            }
+#ifdef __APPLE__
+            return static_cast<size_t>(usage.ru_maxrss);
+#else
+            return static_cast<size_t>(usage.ru_maxrss) * 1024u;
+#endif
+#endif
+        }
+
+        static std::unique_ptr<Model::WorldNode> loadMap(const File& file) {
+            auto fileReader = file.reader().buffer();
+
+            TestParserStatus status;
+            WorldReader worldReader(fileReader.stringView(), Model::MapFormat::Standard);
+
+            const vm::bbox3 worldBounds(8192.0);
+            return worldReader.read(worldBounds, status);
+        }
+
+        /**
+         * Loads a large map from a memory mapped file and reports the load time and the peak memory used by the
+         * benchmark process.
+         */
+        TEST_CASE("WorldReaderBenchmark.loadLargeMap", "[WorldReaderBenchmark]") {
+            const auto mapPath = Disk::getCurrentWorkingDir() + Path("fixture/benchmark/AABBTree/ne_ruins.map");
+
+            std::unique_ptr<Model::WorldNode> world;
+            timeLambda([&]() {
+                const auto file = Disk::openMappedFile(mapPath);
+                world = loadMap(*file);
+            }, "Load " + mapPath.lastComponent().asString());
+
+            REQUIRE(world != nullptr);
+            if (const auto peakRss = peakResidentSetSize()) {
+                std::printf("Peak resident set size: %.1f MiB\n", static_cast<double>(*peakRss) / (1024.0 * 1024.0));
+            }
+        }
+    }
+}
@@ -0,0 +1,132 @@
+/*
+ Copyright (C) 2021 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FloatType.h"
+#include "Model/Brush.h"
+#include "Model/BrushBuilder.h"
+#include "Model/MapFormat.h"
+
+#include <kdl/interned_string.h>
+#include <kdl/result.h>
+
+#include <vecmath/bbox.h>
+#include <vecmath/vec.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "BenchmarkUtils.h"
+#include "../../test/src/Catch2.h"
+
+namespace TrenchBroom {
+    namespace Model {
+        /**
+         * Copies 100k brushes like undo and linked group updates do, then builds the geometry of the copies on demand and
+         * releases it again. Prints the memory used by the geometry of all brushes after each step.
+         */
+        TEST_CASE("BrushBenchmark.copyAndReleaseGeometry", "[BrushBenchmark]") {
+            const auto worldBounds = vm::bbox3(8192.0);
+            const BrushBuilder builder(MapFormat::Standard, worldBounds);
+
+            const auto printGeometryMemorySize = [](const std::string& message) {
+                printf("Brush geometry memory %s: %.1f MB\n", message.c_str(), static_cast<double>(Brush::geometryMemorySize()) / (1024.0 * 1024.0));
+            };
+
+            auto brushes = std::vector<Brush>{};
+            brushes.reserve(100'000);
+            timeLambda([&]() {
+                for (size_t i = 0; i < 100'000; ++i) {
+                    const auto min = vm::vec3(static_cast<FloatType>(i % 256) * 32.0, static_cast<FloatType>(i / 256) * 16.0, 0.0);
+                    brushes.push_back(builder.createCuboid(vm::bbox3(min, min + vm::vec3(32.0, 16.0, 64.0)), "texture").value());
+                }
+            }, "create 100k brushes");
+            printGeometryMemorySize("after creating brushes");
+
+            auto copies = std::vector<Brush>{};
+            timeLambda([&]() { copies = brushes; }, "copy 100k brushes");
+            printGeometryMemorySize("after copying brushes");
+
+            auto vertexCount = size_t(0);
+            timeLambda([&]() {
+                for (const auto& copy : copies) {
+                    vertexCount += copy.vertexCount();
+                }
+            }, "build geometry of 100k copies");
+            printGeometryMemorySize("after building geometry of copies");
+            CHECK(vertexCount == 800'000u);
+
+            timeLambda([&]() {
+                for (auto& brush : brushes) {
+                    brush.releaseGeometry();
+                }
+            }, "release geometry of 100k brushes");
+            printGeometryMemorySize("after releasing geometry");
+        }
+
+        /**
+         * Copies 100k brushes with six faces each, whose texture names are taken from a few hundred Quake 3 style names,
+         * and compares this to copying the texture names as strings. Prints the memory that the texture names of all
+         * faces would use if every face stored its own string.
+         */
+        TEST_CASE("BrushBenchmark.copyInternedTextureNames", "[BrushBenchmark]") {
+            const auto worldBounds = vm::bbox3(8192.0);
+            const BrushBuilder builder(MapFormat::Quake3, worldBounds);
+
+            auto textureNames = std::vector<std::string>{};
+            for (size_t i = 0; i < 300; ++i) {
+                textureNames.push_back("textures/base_wall/concrete_dark_" + std::to_string(i));
+            }
+
+            auto brushes = std::vector<Brush>{};
+            brushes.reserve(100'000);
+            for (size_t i = 0; i < 100'000; ++i) {
+                const auto min = vm::vec3(static_cast<FloatType>(i % 256) * 32.0, static_cast<FloatType>(i / 256) * 16.0, 0.0);
+                brushes.push_back(builder.createCuboid(vm::bbox3(min, min + vm::vec3(32.0, 16.0, 64.0)), textureNames[i % textureNames.size()]).value());
+            }
+
+            auto faceTextureNames = std::vector<std::string>{};
+            auto stringBytes = size_t(0);
+            for (const auto& brush : brushes) {
+                for (const auto& face : brush.faces()) {
+                    const auto& textureName = face.attributes().textureName();
+                    faceTextureNames.push_back(textureName);
+                    // strings longer than the small string buffer allocate their contents on the heap
+                    stringBytes += sizeof(std::string) + (textureName.size() > 15u ? textureName.size() + 1u : 0u);
+                }
+            }
+
+            const auto internedBytes = faceTextureNames.size() * sizeof(kdl::interned_string);
+            printf("Texture names of %zu faces: %.1f MB as strings, %.1f MB interned (%zu strings in pool)\n",
+                faceTextureNames.size(),
+                static_cast<double>(stringBytes) / (1024.0 * 1024.0),
+                static_cast<double>(internedBytes) / (1024.0 * 1024.0),
+                kdl::interned_string::pool_size());
+
+            auto copies = std::vector<Brush>{};
+            timeLambda([&]() { copies = brushes; }, "copy 100k brushes with interned texture names");
+
+            auto textureNameCopies = std::vector<std::string>{};
+            timeLambda([&]() { textureNameCopies = faceTextureNames; }, "copy texture names of 100k brushes as strings");
+
+            CHECK(copies.size() == brushes.size());
+            CHECK(textureNameCopies.size() == 600'000u);
+        }
+    }
+}
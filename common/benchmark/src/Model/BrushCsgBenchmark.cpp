@@ -0,0 +1,92 @@
+/*
+ Copyright (C) 2021 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Model/Brush.h"
+#include "Model/BrushBuilder.h"
+#include "Model/BrushError.h"
+#include "Model/MapFormat.h"
+
+#include <kdl/parallel.h>
+#include <kdl/result.h>
+#include <kdl/result_for_each.h>
+
+#include <vecmath/bbox.h>
+#include <vecmath/vec.h>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "BenchmarkUtils.h"
+#include "../../test/src/Catch2.h"
+
+namespace TrenchBroom {
+    namespace Model {
+        static const auto WorldBounds = vm::bbox3(8192.0);
+
+        /**
+         * Returns a square layer of `count` 64 unit cubes that touch each other.
+         */
+        static std::vector<Brush> makeTouchingBrushes(const BrushBuilder& builder, const size_t count) {
+            const auto perRow = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+
+            auto result = std::vector<Brush>{};
+            result.reserve(count);
+            for (size_t i = 0; i < count; ++i) {
+                const auto min = vm::vec3(static_cast<FloatType>(i % perRow) * 64.0, static_cast<FloatType>(i / perRow) * 64.0, 0.0);
+                result.push_back(builder.createCuboid(vm::bbox3(min, min + vm::vec3(64.0, 64.0, 64.0)), "minuend").value());
+            }
+            return result;
+        }
+
+        /**
+         * Subtracts a carve brush that cuts through the middle of every minuend, like a trench dug through dense terrain. The
+         * subtraction is computed per minuend like MapDocument::csgSubtract does, once sequentially and once in parallel.
+         */
+        TEST_CASE("BrushCsgBenchmark.subtractTouching", "[BrushCsgBenchmark]") {
+            const BrushBuilder builder(MapFormat::Standard, WorldBounds);
+
+            for (const size_t count : { size_t(1'000), size_t(10'000) }) {
+                const auto minuends = makeTouchingBrushes(builder, count);
+                const auto subtrahend = builder.createCuboid(vm::bbox3(vm::vec3(-16.0, -16.0, 16.0), vm::vec3(8192.0, 8192.0, 48.0)), "carve").value();
+                const auto subtrahends = std::vector<const Brush*>{&subtrahend};
+
+                const auto subtract = [&](const Brush& minuend) {
+                    return kdl::collect_values(minuend.subtract(MapFormat::Standard, WorldBounds, "carve", subtrahends), [](const BrushError&) {});
+                };
+
+                auto sequentialFragments = std::vector<std::vector<Brush>>(minuends.size());
+                timeLambda([&]() {
+                    for (size_t i = 0; i < minuends.size(); ++i) {
+                        sequentialFragments[i] = subtract(minuends[i]);
+                    }
+                }, "subtract from " + std::to_string(count) + " touching brushes sequentially");
+
+                auto parallelFragments = std::vector<std::vector<Brush>>(minuends.size());
+                timeLambda([&]() {
+                    kdl::parallel_for(minuends.size(), [&](const size_t i) {
+                        parallelFragments[i] = subtract(minuends[i]);
+                    });
+                }, "subtract from " + std::to_string(count) + " touching brushes in parallel");
+
+                CHECK(parallelFragments == sequentialFragments);
+            }
+        }
+    }
+}
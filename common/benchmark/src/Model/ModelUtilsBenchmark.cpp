@@ -0,0 +1,95 @@
+/*
+ Copyright (C) 2021 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FloatType.h"
+#include "Model/BrushBuilder.h"
+#include "Model/BrushNode.h"
+#include "Model/Entity.h"
+#include "Model/LayerNode.h"
+#include "Model/MapFormat.h"
+#include "Model/ModelUtils.h"
+#include "Model/WorldNode.h"
+
+#include <kdl/result.h>
+#include <kdl/vector_utils.h>
+
+#include <vecmath/bbox.h>
+#include <vecmath/vec.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BenchmarkUtils.h"
+#include "../../test/src/Catch2.h"
+
+namespace TrenchBroom {
+    namespace Model {
+        /**
+         * Compares collecting the nodes touched by or contained in the selected brushes by testing every node in a
+         * world with 100k brushes against collecting them using the world's spatial index.
+         */
+        TEST_CASE("ModelUtilsBenchmark.collectTouchingAndContainedNodes", "[ModelUtilsBenchmark]") {
+            const auto worldBounds = vm::bbox3(8192.0);
+            const auto mapFormat = MapFormat::Standard;
+            const BrushBuilder builder(mapFormat, worldBounds);
+
+            const auto createBrushNode = [&](const vm::vec3& min, const vm::vec3& size) {
+                return new BrushNode(builder.createCuboid(vm::bbox3(min, min + size), "texture").value());
+            };
+
+            auto world = WorldNode(Entity(), mapFormat);
+            auto brushNodes = std::vector<Node*>{};
+            brushNodes.reserve(100'000);
+            for (size_t i = 0; i < 100'000; ++i) {
+                const auto min = vm::vec3(static_cast<FloatType>(i % 256) * 32.0, static_cast<FloatType>(i / 256) * 16.0, 0.0);
+                brushNodes.push_back(createBrushNode(min, vm::vec3(32.0, 16.0, 64.0)));
+            }
+
+            world.beginNodeTreeBatch();
+            world.defaultLayer()->addChildren(brushNodes);
+            world.endNodeTreeBatch();
+
+            const auto createSelection = [&](const size_t count) {
+                auto result = std::vector<std::unique_ptr<BrushNode>>{};
+                for (size_t i = 0; i < count; ++i) {
+                    const auto min = vm::vec3(static_cast<FloatType>(i % 64) * 128.0, static_cast<FloatType>(i / 64) * 64.0, 0.0);
+                    result.emplace_back(createBrushNode(min, vm::vec3(40.0, 24.0, 64.0)));
+                }
+                return result;
+            };
+
+            for (const size_t selectionSize : {1u, 100u, 1000u}) {
+                const auto selection = createSelection(selectionSize);
+                const auto brushes = kdl::vec_transform(selection, [](const auto& brushNode) { return brushNode.get(); });
+                const auto suffix = std::to_string(selectionSize) + " selected brushes";
+
+                auto walked = std::vector<Node*>{};
+                auto indexed = std::vector<Node*>{};
+                timeLambda([&]() { walked = collectTouchingNodes(std::vector<Node*>{&world}, brushes); }, "walk touching, " + suffix);
+                timeLambda([&]() { indexed = collectTouchingNodes(world, brushes); }, "index touching, " + suffix);
+                CHECK_THAT(indexed, Catch::Matchers::UnorderedEquals(walked));
+
+                timeLambda([&]() { walked = collectContainedNodes(std::vector<Node*>{&world}, brushes); }, "walk contained, " + suffix);
+                timeLambda([&]() { indexed = collectContainedNodes(world, brushes); }, "index contained, " + suffix);
+                CHECK_THAT(indexed, Catch::Matchers::UnorderedEquals(walked));
+            }
+        }
+    }
+}
@@ -0,0 +1,208 @@
+/*
+ Copyright (C) 2021 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Model/BezierPatch.h"
+#include "Model/Hit.h"
+#include "Model/PatchNode.h"
+#include "Model/PickResult.h"
+
+#include <vecmath/constants.h>
+#include <vecmath/intersection.h>
+#include <vecmath/ray.h>
+#include <vecmath/scalar.h>
+#include <vecmath/vec.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "BenchmarkUtils.h"
+#include "../../test/src/Catch2.h"
+
+namespace TrenchBroom {
+    namespace Model {
+        /**
+         * Creates a rolling terrain patch with the given number of control points per row and column.
+         */
+        static BezierPatch makeTerrainPatch(const size_t pointCount) {
+            auto controlPoints = std::vector<BezierPatch::Point>{};
+            controlPoints.reserve(pointCount * pointCount);
+            for (size_t row = 0u; row < pointCount; ++row) {
+                for (size_t col = 0u; col < pointCount; ++col) {
+                    const auto x = static_cast<FloatType>(col) * 64.0;
+                    const auto y = static_cast<FloatType>(row) * 64.0;
+                    const auto z = 128.0 * std::sin(x / 256.0) * std::cos(y / 384.0);
+                    controlPoints.push_back(BezierPatch::Point{x, y, z, 0.0, 0.0});
+                }
+            }
+            return BezierPatch{pointCount, pointCount, std::move(controlPoints), "texture"};
+        }
+
+        /**
+         * Tests every triangle of the given grid, which is what picking used to do.
+         */
+        static FloatType pickAllTriangles(const PatchGrid& grid, const vm::ray3& ray) {
+            auto closest = vm::nan<FloatType>();
+            for (size_t row = 0u; row < grid.quadRowCount(); ++row) {
+                for (size_t col = 0u; col < grid.quadColumnCount(); ++col) {
+                    const auto& v0 = grid.point(row, col).position;
+                    const auto& v1 = grid.point(row, col + 1u).position;
+                    const auto& v2 = grid.point(row + 1u, col + 1u).position;
+                    const auto& v3 = grid.point(row + 1u, col).position;
+                    closest = vm::safe_min(closest, vm::intersect_ray_triangle(ray, v0, v1, v2));
+                    closest = vm::safe_min(closest, vm::intersect_ray_triangle(ray, v2, v3, v0));
+                }
+            }
+            return closest;
+        }
+
+        TEST_CASE("PatchNodeBenchmark.pickLargePatch", "[PatchNodeBenchmark]") {
+            auto patchNode = PatchNode{makeTerrainPatch(65u)};
+            const auto& grid = patchNode.grid();
+            std::printf("Patch grid has %zu triangles\n", grid.quadRowCount() * grid.quadColumnCount() * 2u);
+
+            const auto extent = static_cast<FloatType>(64u * 64u);
+            auto rng = std::mt19937{42u};
+            auto coord = std::uniform_real_distribution<FloatType>{0.0, extent};
+
+            auto rays = std::vector<vm::ray3>{};
+            for (size_t i = 0u; i < 1000u; ++i) {
+                const auto origin = vm::vec3{coord(rng), coord(rng), 1024.0};
+                const auto target = vm::vec3{coord(rng), coord(rng), 0.0};
+                rays.emplace_back(origin, vm::normalize(target - origin));
+            }
+
+            timeLambda([&]() {
+                auto pickResult = PickResult{};
+                patchNode.pick(rays.front(), pickResult);
+            }, "Build picking tree and pick once");
+
+            auto distances = std::vector<FloatType>{};
+            timeLambda([&]() {
+                for (const auto& ray : rays) {
+                    auto pickResult = PickResult{};
+                    patchNode.pick(ray, pickResult);
+                    distances.push_back(pickResult.empty() ? vm::nan<FloatType>() : pickResult.all().front().distance());
+                }
+            }, "Pick large patch " + std::to_string(rays.size()) + " times");
+
+            auto expectedDistances = std::vector<FloatType>{};
+            timeLambda([&]() {
+                for (const auto& ray : rays) {
+                    expectedDistances.push_back(pickAllTriangles(grid, ray));
+                }
+            }, "Test every triangle of large patch " + std::to_string(rays.size()) + " times");
+
+            for (size_t i = 0u; i < rays.size(); ++i) {
+                CHECK(vm::is_nan(distances[i]) == vm::is_nan(expectedDistances[i]));
+                if (!vm::is_nan(distances[i])) {
+                    CHECK(distances[i] == Approx(expectedDistances[i]));
+                }
+            }
+        }
+
+        /**
+         * Creates a patch with the given number of control points per row and column that forms a quarter cylinder, like
+         * the arches and pipes found in Quake 3 maps.
+         */
+        static BezierPatch makeArchPatch(const size_t pointCount, const FloatType radius) {
+            auto controlPoints = std::vector<BezierPatch::Point>{};
+            controlPoints.reserve(pointCount * 3u);
+            for (size_t row = 0u; row < pointCount; ++row) {
+                for (size_t col = 0u; col < 3u; ++col) {
+                    // the middle control point is where the tangents meet, the others are on the circle
+                    const auto angle = vm::C::pi() * static_cast<FloatType>(col) / 4.0;
+                    const auto scale = col == 1u ? std::sqrt(2.0) : 1.0;
+                    const auto x = radius * scale * std::cos(angle);
+                    const auto z = radius * scale * std::sin(angle);
+                    const auto y = static_cast<FloatType>(row) * 32.0;
+                    controlPoints.push_back(BezierPatch::Point{x, y, z, 0.0, 0.0});
+                }
+            }
+            return BezierPatch{pointCount, 3u, std::move(controlPoints), "texture"};
+        }
+
+        /**
+         * Creates a flat patch with the given number of control points per row and column.
+         */
+        static BezierPatch makeFlatPatch(const size_t pointCount) {
+            auto controlPoints = std::vector<BezierPatch::Point>{};
+            controlPoints.reserve(pointCount * pointCount);
+            for (size_t row = 0u; row < pointCount; ++row) {
+                for (size_t col = 0u; col < pointCount; ++col) {
+                    const auto u = static_cast<FloatType>(col) / static_cast<FloatType>(pointCount - 1u);
+                    const auto v = static_cast<FloatType>(row) / static_cast<FloatType>(pointCount - 1u);
+                    controlPoints.push_back(BezierPatch::Point{u * 256.0, v * 256.0, 0.0, u, v});
+                }
+            }
+            return BezierPatch{pointCount, pointCount, std::move(controlPoints), "texture"};
+        }
+
+        TEST_CASE("PatchNodeBenchmark.adaptiveSubdivisions", "[PatchNodeBenchmark]") {
+            // a mix of patches as found in Quake 3 maps with heavy patch use
+            auto patchNodes = std::vector<std::unique_ptr<PatchNode>>{};
+            for (size_t i = 0u; i < 500u; ++i) {
+                patchNodes.push_back(std::make_unique<PatchNode>(makeFlatPatch(3u + 2u * (i % 4u))));
+                patchNodes.push_back(std::make_unique<PatchNode>(makeArchPatch(3u + 2u * (i % 3u), 32.0 + static_cast<FloatType>(i % 8u) * 32.0)));
+                if (i % 10u == 0u) {
+                    patchNodes.push_back(std::make_unique<PatchNode>(makeTerrainPatch(9u)));
+                }
+            }
+
+            // a GPU vertex consists of a position, a normal and texture coordinates, all stored as floats
+            constexpr auto GpuVertexSize = (3u + 3u + 2u) * sizeof(float);
+
+            size_t fullVertexCount = 0u;
+            size_t adaptiveVertexCount = 0u;
+            timeLambda([&]() {
+                for (const auto& patchNode : patchNodes) {
+                    const auto& fullGrid = patchNode->grid();
+                    const auto& adaptiveGrid = patchNode->grid(patchNode->subdivisionsPerSurface());
+                    fullVertexCount += fullGrid.points.size();
+                    adaptiveVertexCount += adaptiveGrid.points.size();
+                }
+            }, "Create adaptive grids for " + std::to_string(patchNodes.size()) + " patches");
+
+            std::printf("Full grids:     %zu vertices, %zu KB grid memory, %zu KB vertex buffer\n",
+                fullVertexCount, fullVertexCount * sizeof(PatchGrid::Point) / 1024u, fullVertexCount * GpuVertexSize / 1024u);
+            std::printf("Adaptive grids: %zu vertices, %zu KB grid memory, %zu KB vertex buffer\n",
+                adaptiveVertexCount, adaptiveVertexCount * sizeof(PatchGrid::Point) / 1024u, adaptiveVertexCount * GpuVertexSize / 1024u);
+            std::printf("Saved %zu KB of vertex buffer memory (%.1f%%)\n",
+                (fullVertexCount - adaptiveVertexCount) * GpuVertexSize / 1024u,
+                100.0 * static_cast<double>(fullVertexCount - adaptiveVertexCount) / static_cast<double>(fullVertexCount));
+
+            // every level of detail halves the number of quads per surface side of the adaptive grid
+            for (size_t levelOfDetail = 0u; levelOfDetail <= 3u; ++levelOfDetail) {
+                size_t triangleCount = 0u;
+                for (const auto& patchNode : patchNodes) {
+                    const auto& grid = patchNode->grid(patchNode->subdivisionsPerSurface());
+                    const auto stride = size_t(1) << std::min(levelOfDetail, patchNode->subdivisionsPerSurface());
+                    triangleCount += 2u * (grid.quadRowCount() / stride) * (grid.quadColumnCount() / stride);
+                }
+                std::printf("Level of detail %zu: %zu triangles\n", levelOfDetail, triangleCount);
+            }
+
+            CHECK(adaptiveVertexCount < fullVertexCount);
+        }
+    }
+}
@@ -0,0 +1,108 @@
+/*
+ Copyright (C) 2021 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FloatType.h"
+#include "Model/Polyhedron.h"
+#include "Model/Polyhedron3.h"
+#include "Model/Polyhedron_Instantiation.h"
+
+#include <vecmath/bbox.h>
+#include <vecmath/plane.h>
+#include <vecmath/vec.h>
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "BenchmarkUtils.h"
+#include "../../test/src/Catch2.h"
+
+namespace TrenchBroom {
+    namespace Model {
+        static void printPoolMemorySize() {
+            const auto bytes = Polyhedron_Pool<Polyhedron3::Vertex>::allocated_bytes()
+                + Polyhedron_Pool<Polyhedron3::Edge>::allocated_bytes()
+                + Polyhedron_Pool<Polyhedron3::HalfEdge>::allocated_bytes()
+                + Polyhedron_Pool<Polyhedron3::Face>::allocated_bytes();
+            printf("Polyhedron pool memory: %.1f MB\n", static_cast<double>(bytes) / (1024.0 * 1024.0));
+        }
+
+        TEST_CASE("PolyhedronBenchmark.convexHull", "[PolyhedronBenchmark]") {
+            auto random = std::mt19937(0u);
+            auto coordinate = std::uniform_real_distribution<FloatType>(-256.0, 256.0);
+
+            auto pointSets = std::vector<std::vector<vm::vec3>>(10'000);
+            for (auto& points : pointSets) {
+                for (size_t i = 0u; i < 16u; ++i) {
+                    points.emplace_back(coordinate(random), coordinate(random), coordinate(random));
+                }
+            }
+
+            auto polyhedra = std::vector<Polyhedron3>{};
+            polyhedra.reserve(pointSets.size());
+            timeLambda([&]() {
+                for (const auto& points : pointSets) {
+                    polyhedra.emplace_back(points);
+                }
+            }, "build 10k convex hulls of 16 points");
+
+            timeLambda([&]() { polyhedra.clear(); }, "destroy 10k convex hulls");
+            printPoolMemorySize();
+        }
+
+        TEST_CASE("PolyhedronBenchmark.clipAndCopy", "[PolyhedronBenchmark]") {
+            // clip a cube into a rough sphere, which is how brush geometry is built from the brush faces
+            auto planes = std::vector<vm::plane3>{};
+            for (size_t i = 0u; i < 8u; ++i) {
+                for (size_t j = 0u; j < 8u; ++j) {
+                    const auto phi = static_cast<FloatType>(i) / 8.0 * 2.0 * vm::C::pi();
+                    const auto theta = (static_cast<FloatType>(j) + 0.5) / 8.0 * vm::C::pi();
+                    const auto normal = vm::vec3(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta));
+                    planes.emplace_back(64.0, normal);
+                }
+            }
+
+            auto polyhedra = std::vector<Polyhedron3>{};
+            polyhedra.reserve(10'000);
+            timeLambda([&]() {
+                for (size_t i = 0u; i < 10'000u; ++i) {
+                    auto& polyhedron = polyhedra.emplace_back(vm::bbox3(128.0));
+                    for (const auto& plane : planes) {
+                        polyhedron.clip(plane);
+                    }
+                }
+            }, "clip 10k cubes with 64 planes");
+
+            auto copies = std::vector<Polyhedron3>{};
+            timeLambda([&]() { copies = polyhedra; }, "copy 10k clipped polyhedra");
+
+            CHECK(copies == polyhedra);
+
+            timeLambda([&]() {
+                copies.clear();
+                polyhedra.clear();
+            }, "destroy 20k clipped polyhedra");
+            printPoolMemorySize();
+
+            timeLambda([&]() { Polyhedron3::releaseUnusedMemory(); }, "release unused pool memory");
+            printPoolMemorySize();
+        }
+    }
+}
@@ -0,0 +1,111 @@
+/*
+ Copyright (C) 2020 Eric Wasylishen
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <kdl/parallel.h>
+
+#include <atomic>
+#include <cmath>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BenchmarkUtils.h"
+#include "../../test/src/Catch2.h"
+
+namespace TrenchBroom {
+    /**
+     * The previous implementation of kdl::parallel_for, which spawns new threads using std::async on every call.
+     */
+    template<class L>
+    static void asyncParallelFor(const size_t count, L&& lambda) {
+        size_t numThreads = static_cast<size_t>(std::thread::hardware_concurrency());
+        if (numThreads == 0) {
+            numThreads = 1;
+        }
+
+        std::atomic<size_t> nextIndex(0);
+
+        std::vector<std::future<void>> threads;
+        threads.resize(numThreads);
+
+        for (size_t i = 0; i < numThreads; ++i) {
+            threads[i] = std::async(std::launch::async, [&]() {
+                while (true) {
+                    const size_t ourIndex = std::atomic_fetch_add(&nextIndex, static_cast<size_t>(1));
+                    if (ourIndex >= count) {
+                        break;
+                    }
+                    lambda(ourIndex);
+                }
+            });
+        }
+
+        for (size_t i = 0; i < numThreads; ++i) {
+            threads[i].wait();
+        }
+    }
+
+    static void benchParallelFor(const size_t count, const size_t repetitions) {
+        std::vector<double> values(count);
+        const auto work = [&](const size_t i) {
+            values[i] = std::sqrt(static_cast<double>(i)) * std::sin(static_cast<double>(i));
+        };
+
+        // make sure the global pool's threads are running before we start timing
+        kdl::global_thread_pool();
+
+        const auto description = std::to_string(repetitions) + " x " + std::to_string(count) + " elements";
+        timeLambda([&]() {
+            for (size_t i = 0; i < repetitions; ++i) {
+                asyncParallelFor(count, work);
+            }
+        }, "std::async parallel_for, " + description);
+        timeLambda([&]() {
+            for (size_t i = 0; i < repetitions; ++i) {
+                kdl::parallel_for(count, work);
+            }
+        }, "thread pool parallel_for, " + description);
+    }
+
+    TEST_CASE("ParallelBenchmark.smallInputs", "[ParallelBenchmark]") {
+        benchParallelFor(16, 10'000);
+        benchParallelFor(1'000, 1'000);
+    }
+
+    TEST_CASE("ParallelBenchmark.largeInputs", "[ParallelBenchmark]") {
+        benchParallelFor(100'000, 100);
+        benchParallelFor(10'000'000, 5);
+    }
+
+    TEST_CASE("ParallelBenchmark.nestedInputs", "[ParallelBenchmark]") {
+        constexpr size_t OuterCount = 64;
+        constexpr size_t InnerCount = 10'000;
+
+        std::vector<double> values(OuterCount * InnerCount);
+        timeLambda([&]() {
+            kdl::parallel_for(OuterCount, [&](const size_t i) {
+                kdl::parallel_for(InnerCount, [&](const size_t j) {
+                    const auto index = i * InnerCount + j;
+                    values[index] = std::sqrt(static_cast<double>(index));
+                });
+            });
+        }, "thread pool nested parallel_for, " + std::to_string(OuterCount) + " x " + std::to_string(InnerCount) + " elements");
+    }
+}
@@ -34,6 +34,7 @@
 #include <string>
 #include <tuple>
 #include <algorithm>
+#include <cmath>
 
 #include "BenchmarkUtils.h"
 #include "../../test/src/Catch2.h"
@@ -129,6 +130,65 @@ namespace TrenchBroom {
             kdl::vec_clear_and_delete(brushes);
             kdl::vec_clear_and_delete(textures);
         }
+
+        /**
+         * Both returned vectors need to be freed with kdl::vec_clear_and_delete
+         */
+        static std::pair<std::vector<Model::BrushNode*>, std::vector<Assets::Texture*>> makeSpreadBrushes(const size_t count) {
+            std::vector<Assets::Texture*> textures;
+            for (size_t i = 0; i < NumTextures; ++i) {
+                const auto textureName = "texture " + std::to_string(i);
+                textures.push_back(new Assets::Texture(textureName, 64, 64));
+            }
+
+            // place the brushes on a regular grid so that they are distributed over many chunks
+            const size_t perAxis = static_cast<size_t>(std::ceil(std::cbrt(static_cast<double>(count))));
+            const FloatType spacing = 128.0;
+            const FloatType offset = -static_cast<FloatType>(perAxis) * spacing / 2.0;
+            const vm::bbox3 worldBounds(8192.0);
+
+            Model::BrushBuilder builder(Model::MapFormat::Standard, worldBounds);
+
+            std::vector<Model::BrushNode*> result;
+            size_t currentTextureIndex = 0;
+            for (size_t i = 0; i < count; ++i) {
+                const auto min = vm::vec3(
+                    offset + static_cast<FloatType>(i % perAxis) * spacing,
+                    offset + static_cast<FloatType>((i / perAxis) % perAxis) * spacing,
+                    offset + static_cast<FloatType>(i / (perAxis * perAxis)) * spacing);
+                Model::Brush brush = builder.createCuboid(vm::bbox3(min, min + vm::vec3(64.0, 64.0, 64.0)), "").value();
+                for (Model::BrushFace& face : brush.faces()) {
+                    face.setTexture(textures.at((currentTextureIndex++) % NumTextures));
+                }
+                result.push_back(new Model::BrushNode(std::move(brush)));
+            }
+
+            return {result, textures};
+        }
+
+        TEST_CASE("BrushRendererBenchmark.benchEditInLargeMap", "[BrushRendererBenchmark]") {
+            auto [brushes, textures] = makeSpreadBrushes(100'000);
+
+            BrushRenderer r;
+            r.addBrushes(brushes);
+            timeLambda([&](){ r.validate(); }, "validate after adding " + std::to_string(brushes.size()) + " brushes in " + std::to_string(r.chunkCount()) + " chunks");
+
+            // changing a brush only rebuilds the vertex and index arrays of the chunk that contains it
+            for (const size_t editCount : { size_t(1), size_t(100), size_t(10'000) }) {
+                std::vector<Model::BrushNode*> editedBrushes;
+                for (size_t i = 0; i < editCount; ++i) {
+                    editedBrushes.push_back(brushes.at(i * (brushes.size() / editCount)));
+                }
+
+                timeLambda([&](){
+                    r.invalidateBrushes(editedBrushes);
+                    r.validate();
+                }, "invalidate and validate " + std::to_string(editCount) + " of " + std::to_string(brushes.size()) + " brushes");
+            }
+
+            kdl::vec_clear_and_delete(brushes);
+            kdl::vec_clear_and_delete(textures);
+        }
     }
 }
 
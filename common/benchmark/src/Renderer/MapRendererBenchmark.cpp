@@ -0,0 +1,94 @@
+/*
+ Copyright (C) 2021 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Model/BrushBuilder.h"
+#include "Model/BrushNode.h"
+#include "Model/MapFormat.h"
+#include "Model/WorldNode.h"
+#include "Renderer/MapRenderer.h"
+#include "View/MapDocument.h"
+#include "View/MapDocumentCommandFacade.h"
+
+#include <kdl/result.h>
+
+#include <vecmath/bbox.h>
+#include <vecmath/vec.h>
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BenchmarkUtils.h"
+#include "../../test/src/Model/TestGame.h"
+#include "../../test/src/Catch2.h"
+
+namespace TrenchBroom {
+    namespace Renderer {
+        /**
+         * Returns a cube of `count` 32 unit cubes that are spaced 64 units apart.
+         */
+        static std::vector<Model::Node*> makeBrushNodes(const Model::BrushBuilder& builder, const size_t count) {
+            const auto perAxis = static_cast<size_t>(std::ceil(std::cbrt(static_cast<double>(count))));
+
+            auto result = std::vector<Model::Node*>{};
+            result.reserve(count);
+            for (size_t i = 0; i < count; ++i) {
+                const auto x = static_cast<FloatType>(i % perAxis);
+                const auto y = static_cast<FloatType>((i / perAxis) % perAxis);
+                const auto z = static_cast<FloatType>(i / (perAxis * perAxis));
+                const auto min = vm::vec3(x, y, z) * 64.0 - vm::vec3(4096.0, 4096.0, 4096.0);
+                result.push_back(new Model::BrushNode(builder.createCuboid(vm::bbox3(min, min + vm::vec3(32.0, 32.0, 32.0)), "texture").value()));
+            }
+            return result;
+        }
+
+        /**
+         * Selects and deselects a single brush like a click in a map view does, and lets the map renderer update its
+         * renderers in response. The time per click should not depend on the number of brushes in the map.
+         */
+        TEST_CASE("MapRendererBenchmark.selectBrush", "[MapRendererBenchmark]") {
+            constexpr auto ClickCount = size_t(100);
+
+            for (const size_t count : { size_t(10'000), size_t(100'000) }) {
+                auto document = View::MapDocumentCommandFacade::newMapDocument();
+                document->newDocument(Model::MapFormat::Standard, vm::bbox3(8192.0), std::make_shared<Model::TestGame>());
+
+                MapRenderer mapRenderer(document);
+
+                const auto builder = Model::BrushBuilder(document->world()->mapFormat(), document->worldBounds());
+                const auto brushNodes = makeBrushNodes(builder, count);
+                timeLambda([&]() {
+                    document->addNodes({{document->parentForNodes(), brushNodes}});
+                }, "add " + std::to_string(count) + " brushes");
+
+                auto* brushNode = brushNodes[count / 2u];
+                timeLambda([&]() {
+                    for (size_t i = 0; i < ClickCount; ++i) {
+                        document->select(brushNode);
+                        document->deselectAll();
+                    }
+                }, "select and deselect one of " + std::to_string(count) + " brushes " + std::to_string(ClickCount) + " times");
+
+                document->select(brushNode);
+                CHECK(brushNode->selected());
+            }
+        }
+    }
+}
@@ -21,21 +21,36 @@
 
 #include "Exceptions.h"
 
+#include <kdl/thread_pool.h>
+
 #include <vecmath/scalar.h>
 #include <vecmath/bbox.h>
 #include <vecmath/bbox_io.h>
+#include <vecmath/plane.h>
 #include <vecmath/ray.h>
 #include <vecmath/intersection.h>
 
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <iosfwd>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace TrenchBroom {
 /**
  * An axis aligned bounding box tree that allows for quick ray intersection queries.
  *
+ * The nodes of the tree are stored in a single array and refer to each other by index. Queries traverse the tree using
+ * an explicit stack, so that no recursion or virtual dispatch is required. The slots of removed nodes are kept in a
+ * free list and reused by subsequent insertions.
+ *
  * @tparam T the floating point type
  * @tparam S the number of dimensions for vector types
  * @tparam U the node data to store in the leafs
@@ -49,523 +64,618 @@ namespace TrenchBroom {
         using FloatType = T;
         static constexpr size_t Components = S;
     private:
-        class InnerNode;
-        class LeafNode;
+        using Index = std::uint32_t;
+        static constexpr Index NoIndex = std::numeric_limits<Index>::max();
 
-        class Visitor {
-        public:
-            virtual ~Visitor() = default;
+        /**
+         * The number of bins per axis that the bulk builder uses to evaluate split candidates.
+         */
+        static constexpr size_t SplitBinCount = 16u;
+
+        /**
+         * Subtrees with at least this many objects are built in parallel by the bulk builder.
+         */
+        static constexpr size_t ParallelBuildMinimum = 4096u;
 
-            virtual bool visit(const InnerNode* innerNode) = 0;
-            virtual void visit(const LeafNode* leaf) = 0;
+        /**
+         * insertAll rebuilds the tree only for at least this many objects.
+         */
+        static constexpr size_t BulkInsertMinimum = 1024u;
+
+        struct BuildItem {
+            Box bounds;
+            vm::vec<T,S> center;
+            U data;
         };
 
-        template <typename I_V, typename L_V>
-        class LambdaVisitor : public Visitor {
-        private:
-            I_V m_innerNodeVisitor;
-            L_V m_leafNodeVisitor;
-        public:
-            LambdaVisitor(I_V innerNodeVisitor, L_V leafNodeVisitor) :
-                m_innerNodeVisitor(std::move(innerNodeVisitor)),
-                m_leafNodeVisitor(std::move(leafNodeVisitor)) {}
-
-            bool visit(const InnerNode* innerNode) override { return m_innerNodeVisitor(innerNode); }
-            void visit(const LeafNode* leafNode)   override { m_leafNodeVisitor(leafNode); }
+        /**
+         * A node of the tree. A leaf node has no children and carries data, while an inner node has exactly two
+         * children. The bounds of an inner node is the smallest bounding box that contains the bounds of its children.
+         */
+        struct Node {
+            Box bounds;
+            Index parent;
+            Index left;
+            Index right;
+            /**
+             * A leaf always has a height of 1, and an inner node has a height equal to the maximum of the heights of its
+             * children plus one.
+             */
+            Index height;
+            U data;
+
+            bool isLeaf() const {
+                return left == NoIndex;
+            }
         };
 
-#if !defined __GNUC__ || defined __clang__
+        std::vector<Node> m_nodes;
+        std::vector<Index> m_freeNodes;
+        Index m_root;
+        std::unordered_map<U, Index> m_leafForData;
+    public:
+        AABBTree() : m_root(NoIndex) {}
+
         /**
-         * Deduction guide.
+         * Indicates whether a node with the given data exists in this tree.
          *
-         * Note that as of GCC 9.2, there appears to be a bug in GCC that disallows deduction guides in non-namespace scope.
-         * Luckily, GCC does not need a guide to deduce the template parameters of LambdaVisitor, but clang does!
+         * @param data the data to find
+         * @return true if a node with the given data exists and false otherwise
          */
-        template <typename I_V, typename L_V>
-        LambdaVisitor(I_V innerNodeVisitor, L_V outerNodeVisitor) -> LambdaVisitor<I_V, L_V>;
-#endif
-
-        class Node {
-        public:
-            Box m_bounds;
-            InnerNode* m_parent;
-        protected:
-            explicit Node(const Box& bounds) :
-                m_bounds(bounds),
-                m_parent(nullptr) {}
-        public:
-            virtual ~Node() = default;
+        bool contains(const U& data) const {
+            auto it = m_leafForData.find(data);
+            return it != m_leafForData.end();
+        }
 
-            /**
-             * Return the bounds of this node.
-             *
-             * @return the bounds
-             */
-            const Box& bounds() const {
-                return m_bounds;
+        /**
+         * Clears this tree and rebuilds it from the given objects.
+         *
+         * The tree is built top down by recursively splitting the objects into two halves using a binned surface area
+         * heuristic. Large subtrees are built in parallel. The resulting tree does not depend on the order in which the
+         * objects are given.
+         *
+         * @param objects the objects to insert, a list of DataType
+         * @param getBounds a function from DataType -> Box to compute the bounds of each object
+         *
+         * @throws NodeTreeException if any data occurs more than once, or any bounds contains NaN; the tree is empty
+         * afterwards
+         */
+        template <typename DataList, typename GetBounds>
+        void clearAndBuild(const DataList& objects, GetBounds&& getBounds) {
+            clear();
+
+            std::vector<BuildItem> items;
+            items.reserve(objects.size());
+            for (const U& object : objects) {
+                const Box bounds = getBounds(object);
+                check(bounds);
+                items.push_back(BuildItem{bounds, bounds.center(), object});
             }
 
-            /**
-             * Return the height of this node. A leaf always has a height of 1, and an inner node has a height equal to the
-             * maximum of the heights of its children plus one.
-             *
-             * @return the height
-             */
-            virtual size_t height() const = 0;
+            build(std::move(items));
+        }
 
-            /**
-             * Inserts a new node into the subtree rooted at `this`.
-             *
-             * @param bounds the bounds of the data to be inserted
-             * @param data the data to be inserted
-             * @return a pair containing the new subtree root (may be `this`, or a new node), and the newly inserted LeafNode
-             */
-            virtual std::pair<Node*, LeafNode*> insert(const Box& bounds, const U& data) = 0;
+        /**
+         * Inserts the given objects into this tree.
+         *
+         * If the number of objects is large compared to the number of objects already in the tree, the tree is rebuilt
+         * from all objects as in `clearAndBuild`, since that is faster and yields a better tree than inserting the
+         * objects one by one. Otherwise, the objects are inserted one by one. Consequently, the shape of the resulting
+         * tree depends on the order and the batches in which objects were inserted.
+         *
+         * All objects are validated before the tree is modified, so the tree is left unchanged if this throws.
+         *
+         * @param objects the objects to insert, a list of DataType
+         * @param getBounds a function from DataType -> Box to compute the bounds of each object
+         *
+         * @throws NodeTreeException if any data is already in this tree or occurs more than once in the given objects,
+         * if any bounds contains NaN, or if the tree cannot hold all objects
+         */
+        template <typename DataList, typename GetBounds>
+        void insertAll(const DataList& objects, GetBounds&& getBounds) {
+            const size_t count = static_cast<size_t>(std::distance(std::begin(objects), std::end(objects)));
 
-            /**
-             * Accepts the given visitor.
-             *
-             * @param visitor the visitor to accept
-             */
-            virtual void accept(Visitor& visitor) const = 0;
-        public:
-            /**
-             * Appends a textual representation of this node to the given output stream.
-             *
-             * @param str the stream to append to
-             */
-            void appendTo(std::ostream& str) const {
-                appendTo(str, "  ", 0);
+            std::vector<BuildItem> newItems;
+            newItems.reserve(count);
+            std::unordered_set<U> newData;
+            newData.reserve(count);
+            for (const U& object : objects) {
+                if (contains(object) || !newData.insert(object).second) {
+                    throw NodeTreeException("Data already in tree");
+                }
+                const Box bounds = getBounds(object);
+                check(bounds);
+                newItems.push_back(BuildItem{bounds, bounds.center(), object});
             }
 
-            /**
-             * Appends a textual representation of this node to the given output stream using the given indent string and
-             * the given level of indentation.
-             *
-             * @param str the stream to append to
-             * @param indent the indent string
-             * @param level the level of indentation
-             */
-            virtual void appendTo(std::ostream& str, const std::string& indent, size_t level) const = 0;
+            if (count == 0u) {
+                return;
+            }
 
-            virtual void checkParentPointers(const Node* expectedParent) const = 0;
-        protected:
-            /**
-             * Updates the bounds of this node.
-             *
-             * @param bounds the new bounds
-             */
-            void setBounds(const Box& bounds) {
-                m_bounds = bounds;
+            // a tree with n leafs consists of 2n-1 nodes regardless of how it is built
+            const size_t totalCount = m_leafForData.size() + count;
+            if (2u * totalCount - 1u >= static_cast<size_t>(NoIndex)) {
+                throw NodeTreeException("AABB tree is full");
             }
 
-            /**
-             * Appends a textual representation of this node's bounds to the given output stream.
-             *
-             * @param str the stream to append to
-             */
-            void appendBounds(std::ostream& str) const {
-                str << "[ ( " << m_bounds.min << " ) ( " << m_bounds.max  << " ) ]";
+            if (count < BulkInsertMinimum || count < m_leafForData.size() / 4u) {
+                for (const auto& item : newItems) {
+                    insert(item.bounds, item.data);
+                }
+                return;
             }
-        };
+
+            std::vector<BuildItem> items;
+            items.reserve(totalCount);
+            for (const auto& [data, leaf] : m_leafForData) {
+                const auto& bounds = m_nodes[leaf].bounds;
+                items.push_back(BuildItem{bounds, bounds.center(), data});
+            }
+            std::move(std::begin(newItems), std::end(newItems), std::back_inserter(items));
+
+            clear();
+            build(std::move(items));
+        }
 
         /**
-         * An inner node of an AABB tree does not carry data. It's only purpose is to structure the tree. Its bounds is
-         * the smallest bounding box that contains the bounds of its children.
+         * Insert a node with the given bounds and data into this tree.
+         *
+         * @param bounds the bounds to insert
+         * @param data the data to insert
+         *
+         * @throws NodeTreeException if a node with the given data already exists in this tree, or the bounds contains NaN
          */
-        class InnerNode : public Node {
-        private:
-            Node* m_left;
-            Node* m_right;
-            size_t m_height;
-        public:
-            InnerNode(Node* left, Node* right) :
-                Node(merge(left->bounds(), right->bounds())),
-                m_left(left),
-                m_right(right),
-                m_height(0) {
-                assert(m_left != nullptr);
-                assert(m_right != nullptr);
+        void insert(const Box& bounds, const U& data) {
+            check(bounds);
 
-                m_left->m_parent = this;
-                m_right->m_parent = this;
+            // Check that the data isn't already inserted
+            if (m_leafForData.find(data) != m_leafForData.end()) {
+                throw NodeTreeException("Data already in tree");
+            }
 
-                updateHeight();
+            if (empty()) {
+                m_root = createLeaf(bounds, data);
+                m_leafForData[data] = m_root;
+                return;
             }
 
-        private: // node removal private
-            /**
-             * Children (or grandchildren etc.) changed. Update the height and bounds.
-             * Recurses up the tree along the m_parent chain until it reaches the root.
-             *
-             * @return the new root of the tree
-             */
-            Node* updateAndReturnRoot() {
-                updateHeight();
-                updateBounds();
+            // Descend into the subtree which is increased the least by inserting a node with the given bounds until we
+            // reach a leaf.
+            Index sibling = m_root;
+            while (!m_nodes[sibling].isLeaf()) {
+                sibling = selectLeastIncreaser(m_nodes[sibling].left, m_nodes[sibling].right, bounds);
+            }
 
-                if (this->m_parent == nullptr) {
-                    return this;
-                }
+            // Replace the leaf with a new inner node that has the leaf as its left child and the new leaf as its right
+            // child.
+            const Index newLeaf = createLeaf(bounds, data);
+            const Index oldParent = m_nodes[sibling].parent;
+            const Index newParent = createInner(sibling, newLeaf);
 
-                return this->m_parent->updateAndReturnRoot();
+            m_nodes[newParent].parent = oldParent;
+            if (oldParent == NoIndex) {
+                m_root = newParent;
+            } else {
+                replaceChild(oldParent, sibling, newParent);
+                updateAncestors(oldParent);
             }
 
-            /**
-             * One of our direct children is being swapped for a new node.
-             *
-             * @return the new root of the tree
-             */
-            Node* replaceChild(Node* child, Node* replacement) {
-                replacement->m_parent = this;
+            m_leafForData[data] = newLeaf;
+        }
 
-                if (child == m_left) {
-                    m_left = replacement;
+        /**
+         * Removes the node with the given data from this tree.
+         *
+         * @param data the data to remove
+         * @return true if a node with the given data was removed, and false otherwise
+         */
+        bool remove(const U& data) {
+            auto it = m_leafForData.find(data);
+            if (it == m_leafForData.end()) {
+                return false;
+            }
+
+            const Index leaf = it->second;
+            assert(m_nodes[leaf].data == data);
+            m_leafForData.erase(it);
+
+            const Index parent = m_nodes[leaf].parent;
+            freeNode(leaf);
+
+            if (parent == NoIndex) {
+                m_root = NoIndex;
+            } else {
+                // The parent is replaced by the leaf's sibling.
+                const Index sibling = m_nodes[parent].left == leaf ? m_nodes[parent].right : m_nodes[parent].left;
+                const Index grandParent = m_nodes[parent].parent;
+                freeNode(parent);
+
+                m_nodes[sibling].parent = grandParent;
+                if (grandParent == NoIndex) {
+                    m_root = sibling;
                 } else {
-                    assert(child == m_right);
-                    m_right = replacement;
+                    replaceChild(grandParent, parent, sibling);
+                    updateAncestors(grandParent);
                 }
+            }
 
-                return updateAndReturnRoot();
+            if (empty()) {
+                // release the storage once the tree becomes empty
+                m_nodes.clear();
+                m_freeNodes.clear();
             }
-        public: // Node removal public
-            /**
-             * One of our direct children is being deleted. `this` will turn into a LeafNode.
-             *
-             * @param child either m_left or m_right, which is being deleted
-             * @return the new root of the tree
-             */
-            Node* handleChildDeletion(LeafNode* child) {
-                Node* replacementForThis;
-                if (child == m_left) {
-                    replacementForThis = m_right;
-                } else {
-                    assert(child == m_right);
-                    replacementForThis = m_left;
-                }
 
-                // Clear m_left/m_right so our destructor doesn't delete our children.
-                // The caller is going to delete one of them (`child`),
-                // and we will reuse the other one as the replacement for `this`.
-                m_left = nullptr;
-                m_right = nullptr;
-
-                // Special case when `this` is already the tree root
-                if (this->m_parent == nullptr) {
-                    Node* newTreeRoot = replacementForThis;
-                    newTreeRoot->m_parent = nullptr;
-                    delete this;
-                    return newTreeRoot;
-                }
+            return true;
+        }
 
-                Node* newTreeRoot = this->m_parent->replaceChild(this, replacementForThis);
-                delete this;
-                return newTreeRoot;
-            }
+        /**
+         * Updates the node with the given data with the given new bounds.
+         *
+         * @param newBounds the new bounds of the node
+         * @param data the node data of the node to update
+         *
+         * @throws NodeTreeException if no node with the given data can be found in this tree
+         */
+        void update(const Box& newBounds, const U& data) {
+            check(newBounds);
 
-        public: // Node overrides
-            ~InnerNode() override {
-                delete m_left;
-                delete m_right;
+            if (!remove(data)) {
+                throw NodeTreeException("AABB node not found");
+            }
+            insert(newBounds, data);
+        }
+    private:
+        void check(const Box& bounds) const {
+            if (vm::is_nan(bounds.min) || vm::is_nan(bounds.max)) {
+                throw NodeTreeException("Cannot add node to AABB tree with invalid bounds");
             }
+        }
 
-            size_t height() const override {
-                return m_height;
+        Index allocateNode() {
+            if (!m_freeNodes.empty()) {
+                const Index index = m_freeNodes.back();
+                m_freeNodes.pop_back();
+                return index;
             }
 
-            std::pair<Node*, LeafNode*> insert(const Box& bounds, const U& data) override {
-                // Select the subtree which is increased the least by inserting a node with the given bounds.
-                // Then insert the node into that subtree and update our reference to it.
-                auto*& subtree = selectLeastIncreaser(m_left, m_right, bounds);
+            if (m_nodes.size() >= static_cast<size_t>(NoIndex)) {
+                throw NodeTreeException("AABB tree is full");
+            }
 
-                Node* newSubtree;
-                LeafNode* insertedLeafNode;
-                std::tie(newSubtree, insertedLeafNode) = subtree->insert(bounds, data);
+            m_nodes.emplace_back();
+            return static_cast<Index>(m_nodes.size() - 1u);
+        }
 
-                // Update the parent pointer
-                newSubtree->m_parent = this;
+        void freeNode(const Index index) {
+            m_nodes[index].data = U{};
+            m_freeNodes.push_back(index);
+        }
 
-                // Subtree is either a reference to m_left or m_right
-                if (subtree == m_left) {
-                    m_left = newSubtree;
-                } else {
-                    assert(subtree == m_right);
-                    m_right = newSubtree;
-                }
+        Index createLeaf(const Box& bounds, const U& data) {
+            const Index index = allocateNode();
+            m_nodes[index] = Node{bounds, NoIndex, NoIndex, NoIndex, 1u, data};
+            return index;
+        }
 
-                // Update our data.
-                updateBounds();
-                updateHeight();
+        Index createInner(const Index left, const Index right) {
+            const Index index = allocateNode();
+            m_nodes[index] = Node{
+                merge(m_nodes[left].bounds, m_nodes[right].bounds),
+                NoIndex,
+                left,
+                right,
+                static_cast<Index>(std::max(m_nodes[left].height, m_nodes[right].height) + 1u),
+                U{}
+            };
+
+            m_nodes[left].parent = index;
+            m_nodes[right].parent = index;
+            return index;
+        }
 
-                return std::make_pair(this, insertedLeafNode);
+        void replaceChild(const Index parent, const Index child, const Index replacement) {
+            auto& parentNode = m_nodes[parent];
+            if (parentNode.left == child) {
+                parentNode.left = replacement;
+            } else {
+                assert(parentNode.right == child);
+                parentNode.right = replacement;
             }
+            m_nodes[replacement].parent = parent;
+        }
 
-        private:
-            /**
-             * Selects one of the two given nodes such that it increases the given bounds the least.
-             *
-             * @tparam TT the type of the nodes
-             * @param node1 the first node to test
-             * @param node2 the second node to test
-             * @param bounds the bounds to test against
-             * @return node1 if it increases the given bounds volume by a smaller or equal amount than node2 would, and
-             *     node2 otherwise
-             */
-            template <typename TT>
-            static TT*& selectLeastIncreaser(TT*& node1, TT*& node2, const Box& bounds) {
-                const auto node1Contains = node1->bounds().contains(bounds);
-                const auto node2Contains = node2->bounds().contains(bounds);
+        /**
+         * Children (or grandchildren etc.) of the given node changed. Updates the height and bounds of the given node
+         * and all of its ancestors.
+         */
+        void updateAncestors(Index index) {
+            while (index != NoIndex) {
+                auto& node = m_nodes[index];
+                const auto& left = m_nodes[node.left];
+                const auto& right = m_nodes[node.right];
+
+                node.bounds = merge(left.bounds, right.bounds);
+                node.height = static_cast<Index>(std::max(left.height, right.height) + 1u);
+                index = node.parent;
+            }
+        }
 
-                if (node1Contains && !node2Contains) {
+        /**
+         * Selects one of the two given nodes such that it increases the given bounds the least.
+         *
+         * @param node1 the first node to test
+         * @param node2 the second node to test
+         * @param bounds the bounds to test against
+         * @return node1 if it increases the given bounds volume by a smaller or equal amount than node2 would, and
+         *     node2 otherwise
+         */
+        Index selectLeastIncreaser(const Index node1, const Index node2, const Box& bounds) const {
+            const auto& box1 = m_nodes[node1].bounds;
+            const auto& box2 = m_nodes[node2].bounds;
+            const auto node1Contains = box1.contains(bounds);
+            const auto node2Contains = box2.contains(bounds);
+
+            if (node1Contains && !node2Contains) {
+                return node1;
+            } else if (!node1Contains && node2Contains) {
+                return node2;
+            } else if (!node1Contains && !node2Contains) {
+                const auto diff1 = vm::merge(box1, bounds).volume() - box1.volume();
+                const auto diff2 = vm::merge(box2, bounds).volume() - box2.volume();
+
+                if (diff1 < diff2) {
                     return node1;
-                } else if (!node1Contains && node2Contains) {
+                } else if (diff2 < diff1) {
                     return node2;
-                } else if (!node1Contains && !node2Contains) {
-                    const auto new1 = vm::merge(node1->bounds(), bounds);
-                    const auto new2 = vm::merge(node2->bounds(), bounds);
-                    const auto vol1 = node1->bounds().volume();
-                    const auto vol2 = node2->bounds().volume();
-                    const auto diff1 = new1.volume() - vol1;
-                    const auto diff2 = new2.volume() - vol2;
-
-                    if (diff1 < diff2) {
-                        return node1;
-                    } else if (diff2 < diff1) {
-                        return node2;
-                    }
                 }
+            }
 
-                static auto choice = 0u;
+            static auto choice = 0u;
 
-                if (node1->height() < node2->height()) {
+            const auto height1 = m_nodes[node1].height;
+            const auto height2 = m_nodes[node2].height;
+            if (height1 < height2) {
+                return node1;
+            } else if (height2 < height1) {
+                return node2;
+            } else {
+                if (choice++ % 2 == 0) {
                     return node1;
-                } else if (node2->height() < node1->height()) {
-                    return node2;
                 } else {
-                    if (choice++ % 2 == 0) {
-                        return node1;
-                    } else {
-                        return node2;
-                    }
+                    return node2;
                 }
             }
+        }
 
-            void updateBounds() {
-                this->setBounds(merge(m_left->bounds(), m_right->bounds()));
+        /**
+         * Builds this tree from the given items, which must not contain duplicate data.
+         *
+         * Precondition: this tree is empty
+         */
+        void build(std::vector<BuildItem> items) {
+            assert(empty());
+            if (items.empty()) {
+                return;
             }
 
-            void updateHeight() {
-                m_height = std::max(m_left->height(), m_right->height()) + 1;
-                assert(m_height > 0);
+            if (2u * items.size() - 1u >= static_cast<size_t>(NoIndex)) {
+                throw NodeTreeException("AABB tree is full");
             }
 
-            void accept(Visitor& visitor) const override {
-                if (visitor.visit(this)) {
-                    m_left->accept(visitor);
-                    m_right->accept(visitor);
+            m_leafForData.reserve(items.size());
+            for (const auto& item : items) {
+                if (!m_leafForData.emplace(item.data, NoIndex).second) {
+                    clear();
+                    throw NodeTreeException("Data already in tree");
                 }
             }
-        public:
-            void appendTo(std::ostream& str, const std::string& indent, const size_t level) const override {
-                for (size_t i = 0; i < level; ++i)
-                    str << indent;
 
-                str << "O ";
-                this->appendBounds(str);
-                str << std::endl;
+            // A subtree with n leafs consists of exactly 2n-1 nodes, so we can assign each subtree a fixed range of
+            // node indices in advance and build the subtrees independently.
+            m_nodes.resize(2u * items.size() - 1u);
+            buildSubtree(items, 0u, items.size(), 0u, NoIndex);
+            m_root = 0u;
 
-                m_left->appendTo(str, indent, level + 1);
-                m_right->appendTo(str, indent, level + 1);
-            }
-
-            void checkParentPointers([[maybe_unused]] const Node* expectedParent) const override {
-                assert(this->m_parent == expectedParent);
-                m_left->checkParentPointers(this);
-                m_left->checkParentPointers(this);
+            for (Index i = 0u; i < static_cast<Index>(m_nodes.size()); ++i) {
+                if (m_nodes[i].isLeaf()) {
+                    m_leafForData[m_nodes[i].data] = i;
+                }
             }
-        };
+        }
 
         /**
-         * A leaf node represents actual data. It does not have any children. Its bounds equals the bounds supplied when
-         * the node was inserted into the tree. A leaf has a height of 1 and a balance of 0.
+         * Builds the subtree for the items in the range [first, last) and stores its root at the given node index. The
+         * descendants of the root are stored at the following 2 * (last - first) - 2 indices.
          */
-        class LeafNode : public Node {
-        private:
-            U m_data;
-        public:
-            LeafNode(const Box& bounds, const U& data) : Node(bounds), m_data(data) {}
+        void buildSubtree(std::vector<BuildItem>& items, const size_t first, const size_t last, const Index index, const Index parent) {
+            if (last - first == 1u) {
+                const auto& item = items[first];
+                m_nodes[index] = Node{item.bounds, parent, NoIndex, NoIndex, 1u, item.data};
+                return;
+            }
 
-            /**
-             * Deletes this. Returns the new root of the tree.
-             */
-            Node* deleteThis() {
-                Node* newRoot = (this->m_parent != nullptr)
-                                ? this->m_parent->handleChildDeletion(this)
-                                : nullptr;
-                delete this;
-                return newRoot;
+            const size_t mid = partitionItems(items, first, last);
+            const Index left = index + 1u;
+            const Index right = index + static_cast<Index>(2u * (mid - first));
+
+            if (last - first >= ParallelBuildMinimum) {
+                kdl::global_thread_pool().parallel_invoke(
+                    [&]() { buildSubtree(items, first, mid, left, index); },
+                    [&]() { buildSubtree(items, mid, last, right, index); }
+                );
+            } else {
+                buildSubtree(items, first, mid, left, index);
+                buildSubtree(items, mid, last, right, index);
             }
 
-            /**
-             * Returns the data associated with this node.
-             *
-             * @return the data associated with this node
-             */
-            U& data() {
-                return m_data;
+            const auto& leftNode = m_nodes[left];
+            const auto& rightNode = m_nodes[right];
+            m_nodes[index] = Node{
+                merge(leftNode.bounds, rightNode.bounds),
+                parent,
+                left,
+                right,
+                static_cast<Index>(std::max(leftNode.height, rightNode.height) + 1u),
+                U{}
+            };
+        }
+
+        /**
+         * Partitions the items in the range [first, last) into two non empty halves and returns the index of the first
+         * item of the second half.
+         *
+         * The items are sorted into bins according to their centers along the axis in which the centers are spread the
+         * most. The split position between two bins that minimizes the surface area heuristic, that is, the sum of the
+         * surface areas of the bounds of both halves weighted by the number of items in each half, is chosen. If all
+         * centers coincide, the items are split into two halves of equal size.
+         */
+        size_t partitionItems(std::vector<BuildItem>& items, const size_t first, const size_t last) const {
+            auto centerMin = items[first].center;
+            auto centerMax = items[first].center;
+            for (size_t i = first + 1u; i < last; ++i) {
+                centerMin = vm::min(centerMin, items[i].center);
+                centerMax = vm::max(centerMax, items[i].center);
             }
 
-            /**
-             * Returns the data associated with this node.
-             *
-             * @return the data associated with this node
-             */
-            const U& data() const {
-                return m_data;
+            const auto centerSize = centerMax - centerMin;
+            if (last - first <= SplitBinCount) {
+                return partitionItemsAtMedian(items, first, last, centerSize);
             }
 
-        public: // Node overrides
-            size_t height() const override {
-                return 1;
+            // only consider the axis in which the centers are spread the most
+            size_t axis = 0u;
+            for (size_t i = 1u; i < S; ++i) {
+                if (centerSize[i] > centerSize[axis]) {
+                    axis = i;
+                }
             }
 
-            /**
-             * Returns a new inner node that has this leaf as its left child and a new leaf representing the given bounds
-             * and data as its right child.
-             *
-             * @param bounds the bounds to insert
-             * @param data the data to insert
-             * @return a pair containing the new inner node that is the root of this subtree, and the newly inserted LeafNode
-             */
-            std::pair<Node*, LeafNode*> insert(const Box& bounds, const U& data) override {
-                auto* newLeaf = new LeafNode(bounds, data);
-                auto* newParent = new InnerNode(this, newLeaf);
+            if (!(centerSize[axis] > T(0))) {
+                return first + (last - first) / 2u;
+            }
 
-                return std::make_pair(newParent, newLeaf);
+            const auto binScale = static_cast<T>(SplitBinCount) / centerSize[axis];
+            const auto binOf = [&](const BuildItem& item) {
+                const auto bin = static_cast<size_t>((item.center[axis] - centerMin[axis]) * binScale);
+                return std::min(bin, SplitBinCount - 1u);
+            };
+
+            Box binBounds[SplitBinCount];
+            size_t binCounts[SplitBinCount] = {};
+            for (size_t i = first; i < last; ++i) {
+                const auto& item = items[i];
+                const auto bin = binOf(item);
+                auto& bounds = binBounds[bin];
+                if (binCounts[bin]++ == 0u) {
+                    bounds = item.bounds;
+                } else {
+                    bounds.min = vm::min(bounds.min, item.bounds.min);
+                    bounds.max = vm::max(bounds.max, item.bounds.max);
+                }
             }
 
-            void accept(Visitor& visitor) const override {
-                visitor.visit(this);
+            // sweep from the right to compute the cost of the right halves, then from the left
+            T rightCosts[SplitBinCount] = {};
+            auto rightBounds = Box();
+            auto rightCount = size_t(0);
+            for (size_t bin = SplitBinCount - 1u; bin > 0u; --bin) {
+                if (binCounts[bin] > 0u) {
+                    rightBounds = rightCount == 0u ? binBounds[bin] : merge(rightBounds, binBounds[bin]);
+                    rightCount += binCounts[bin];
+                }
+                rightCosts[bin - 1u] = rightCount == 0u ? T(0) : surfaceArea(rightBounds) * static_cast<T>(rightCount);
             }
 
-            void appendTo(std::ostream& str, const std::string& indent, const size_t level) const override {
-                for (size_t i = 0; i < level; ++i)
-                    str << indent;
+            auto bestCost = std::numeric_limits<T>::max();
+            auto bestBin = SplitBinCount;
 
-                str << "L ";
-                this->appendBounds(str);
-                str << ": " << m_data << std::endl;
-            }
+            auto leftBounds = Box();
+            auto leftCount = size_t(0);
+            for (size_t bin = 0u; bin < SplitBinCount - 1u; ++bin) {
+                if (binCounts[bin] > 0u) {
+                    leftBounds = leftCount == 0u ? binBounds[bin] : merge(leftBounds, binBounds[bin]);
+                    leftCount += binCounts[bin];
+                }
 
-            virtual void checkParentPointers([[maybe_unused]] const Node* expectedParent) const override {
-                assert(this->m_parent == expectedParent);
+                if (leftCount > 0u && leftCount < last - first) {
+                    const auto cost = surfaceArea(leftBounds) * static_cast<T>(leftCount) + rightCosts[bin];
+                    if (cost < bestCost) {
+                        bestCost = cost;
+                        bestBin = bin;
+                    }
+                }
             }
-        };
-    private:
-        Node* m_root;
-        std::unordered_map<U, LeafNode*> m_leafForData;
-    public:
-        AABBTree() : m_root(nullptr) {}
 
-        ~AABBTree() {
-            clear();
-        }
+            if (bestBin == SplitBinCount) {
+                return first + (last - first) / 2u;
+            }
 
-        /**
-         * Indicates whether a node with the given data exists in this tree.
-         *
-         * @param data the data to find
-         * @return true if a node with the given data exists and false otherwise
-         */
-        bool contains(const U& data) const {
-            auto it = m_leafForData.find(data);
-            return it != m_leafForData.end();
+            const auto midIt = std::partition(
+                std::next(std::begin(items), static_cast<std::ptrdiff_t>(first)),
+                std::next(std::begin(items), static_cast<std::ptrdiff_t>(last)),
+                [&](const BuildItem& item) { return binOf(item) <= bestBin; });
+            return static_cast<size_t>(std::distance(std::begin(items), midIt));
         }
 
         /**
-         * Clears this tree and rebuilds it by inserting given objects.
-         *
-         * @param objects the objects to insert, a list of DataType
-         * @param getBounds a function from DataType -> Box to compute the bounds of each object
+         * Partitions the items in the range [first, last) into two halves of equal size along the axis in which the
+         * given size of the item centers is largest. Used for small ranges where binning does not pay off.
          */
-        template <typename DataList, typename GetBounds>
-        void clearAndBuild(const DataList& objects, GetBounds&& getBounds) {
-            clear();
-            for (const U& object : objects) {
-                insert(getBounds(object), object);
+        size_t partitionItemsAtMedian(std::vector<BuildItem>& items, const size_t first, const size_t last, const vm::vec<T,S>& centerSize) const {
+            size_t axis = 0u;
+            for (size_t i = 1u; i < S; ++i) {
+                if (centerSize[i] > centerSize[axis]) {
+                    axis = i;
+                }
             }
+
+            const size_t mid = first + (last - first) / 2u;
+            std::nth_element(
+                std::next(std::begin(items), static_cast<std::ptrdiff_t>(first)),
+                std::next(std::begin(items), static_cast<std::ptrdiff_t>(mid)),
+                std::next(std::begin(items), static_cast<std::ptrdiff_t>(last)),
+                [&](const BuildItem& lhs, const BuildItem& rhs) { return lhs.center[axis] < rhs.center[axis]; });
+            return mid;
         }
 
         /**
-         * Insert a node with the given bounds and data into this tree.
-         *
-         * @param bounds the bounds to insert
-         * @param data the data to insert
-         *
-         * @throws NodeTreeException if a node with the given data already exists in this tree, or the bounds contains NaN
+         * Returns half of the surface area of the given box.
          */
-        void insert(const Box& bounds, const U& data) {
-            check(bounds);
-
-            // Check that the data isn't already inserted
-            if (m_leafForData.find(data) != m_leafForData.end()) {
-                throw NodeTreeException("Data already in tree");
-            }
-
-            if (empty()) {
-                auto* insertedLeafNode = new LeafNode(bounds, data);
-
-                m_root = insertedLeafNode;
-                m_leafForData[data] = insertedLeafNode;
-            } else {
-                LeafNode* insertedLeafNode;
-                std::tie(m_root, insertedLeafNode) = m_root->insert(bounds, data);
-
-                m_leafForData[data] = insertedLeafNode;
+        static T surfaceArea(const Box& box) {
+            const auto size = box.size();
+            auto result = T(0);
+            for (size_t i = 0u; i < S; ++i) {
+                for (size_t j = i + 1u; j < S; ++j) {
+                    result += size[i] * size[j];
+                }
             }
+            return result;
         }
 
         /**
-         * Removes the node with the given data from this tree.
-         *
-         * @param data the data to remove
-         * @return true if a node with the given data was removed, and false otherwise
+         * Visits the nodes of this tree in depth first order. Inner nodes are passed to `visitInner`, and their
+         * children are only visited if it returns true. Leafs are passed to `visitLeaf`.
          */
-        bool remove(const U& data) {
-            auto it = m_leafForData.find(data);
-            if (it == m_leafForData.end()) {
-                return false;
+        template <typename I_V, typename L_V>
+        void traverse(const I_V& visitInner, const L_V& visitLeaf) const {
+            if (empty()) {
+                return;
             }
 
-            LeafNode* leaf = it->second;
-            assert(leaf->data() == data);
-            m_leafForData.erase(it);
+            std::vector<Index> stack;
+            stack.reserve(height());
+            stack.push_back(m_root);
 
-            m_root = leaf->deleteThis();
+            while (!stack.empty()) {
+                const auto& node = m_nodes[stack.back()];
+                stack.pop_back();
 
-            return true;
-        }
-
-        /**
-         * Updates the node with the given data with the given new bounds.
-         *
-         * @param newBounds the new bounds of the node
-         * @param data the node data of the node to update
-         *
-         * @throws NodeTreeException if no node with the given data can be found in this tree
-         */
-        void update(const Box& newBounds, const U& data) {
-            check(newBounds);
-
-            if (!remove(data)) {
-                throw NodeTreeException("AABB node not found");
-            }
-            insert(newBounds, data);
-        }
-    private:
-        void check(const Box& bounds) const {
-            if (vm::is_nan(bounds.min) || vm::is_nan(bounds.max)) {
-                throw NodeTreeException("Cannot add node to AABB tree with invalid bounds");
+                if (node.isLeaf()) {
+                    visitLeaf(node);
+                } else if (visitInner(node)) {
+                    stack.push_back(node.right);
+                    stack.push_back(node.left);
+                }
             }
         }
     public:
@@ -573,11 +683,10 @@ namespace TrenchBroom {
          * Clears this node tree.
          */
         void clear() {
-            if (!empty()) {
-                m_leafForData.clear();
-                delete m_root;
-                m_root = nullptr;
-            }
+            m_nodes.clear();
+            m_freeNodes.clear();
+            m_leafForData.clear();
+            m_root = NoIndex;
         }
 
         /**
@@ -586,7 +695,7 @@ namespace TrenchBroom {
          * @return true if this tree is empty and false otherwise
          */
         bool empty() const {
-            return m_root == nullptr;
+            return m_root == NoIndex;
         }
 
         /**
@@ -601,17 +710,51 @@ namespace TrenchBroom {
             if (empty()) {
                 return EmptyBox;
             } else {
-                return m_root->bounds();
+                return m_nodes[m_root].bounds;
             }
         }
 
+        /**
+         * Returns the number of data items in this tree.
+         *
+         * @return the number of data items in this tree
+         */
+        size_t size() const {
+            return m_leafForData.size();
+        }
+
         /**
          * Returns the height of this tree.
          *
          * @return the height of this tree
          */
         size_t height() const {
-            return empty() ? 0 : m_root->height();
+            return empty() ? 0 : static_cast<size_t>(m_nodes[m_root].height);
+        }
+
+        /**
+         * Returns the expected cost of a ray query according to the surface area heuristic. The cost is the sum of the
+         * surface areas of all nodes relative to the surface area of the root, i.e., the expected number of nodes that
+         * a random ray hitting the root bounds must be tested against. Lower values indicate a better tree.
+         *
+         * @return the cost of this tree, or 0 if this tree is empty
+         */
+        T sahCost() const {
+            if (empty()) {
+                return T(0);
+            }
+
+            const auto rootArea = surfaceArea(m_nodes[m_root].bounds);
+            if (!(rootArea > T(0))) {
+                return T(0);
+            }
+
+            auto result = T(0);
+            traverse(
+                [&](const Node& node) { result += surfaceArea(node.bounds); return true; },
+                [&](const Node& node) { result += surfaceArea(node.bounds); }
+            );
+            return result / rootArea;
         }
 
         /**
@@ -636,21 +779,124 @@ namespace TrenchBroom {
          */
         template <typename O>
         void findIntersectors(const vm::ray<T,S>& ray, O out) const {
-            if (!empty()) {
-                LambdaVisitor visitor(
-                    [&](const InnerNode* innerNode) {
-                        return innerNode->bounds().contains(ray.origin) || !vm::is_nan(
-                            vm::intersect_ray_bbox(ray, innerNode->bounds()));
-                    },
-                    [&](const LeafNode* leaf) {
-                        if (leaf->bounds().contains(ray.origin) || !vm::is_nan(vm::intersect_ray_bbox(ray, leaf->bounds()))) {
-                            out = leaf->data();
-                            ++out;
+            const auto intersects = [&](const Node& node) {
+                return node.bounds.contains(ray.origin) || !vm::is_nan(vm::intersect_ray_bbox(ray, node.bounds));
+            };
+
+            traverse(
+                intersects,
+                [&](const Node& leaf) {
+                    if (intersects(leaf)) {
+                        out = leaf.data;
+                        ++out;
+                    }
+                }
+            );
+        }
+
+        /**
+         * Finds the data item in this tree that the given ray hits first.
+         *
+         * The given function computes the distance at which the ray hits a data item, or NaN if the ray misses it. The
+         * tree is traversed front to back, and subtrees whose bounds are farther away than the closest hit found so far
+         * are skipped, so that only the data items near the ray's first hit are tested.
+         *
+         * @tparam I the type of the intersection function, must be of type `T(const U&)`
+         * @param ray the ray to test
+         * @param intersect the function that computes the distance at which the ray hits a data item
+         * @return the distance to the closest hit and the data item that was hit, or an empty optional if the ray misses
+         * every data item
+         */
+        template <typename I>
+        std::optional<std::pair<T, U>> findClosestIntersection(const vm::ray<T,S>& ray, const I& intersect) const {
+            if (empty()) {
+                return std::nullopt;
+            }
+
+            const auto entryDistance = [&](const Node& node) {
+                return node.bounds.contains(ray.origin) ? T(0) : vm::intersect_ray_bbox(ray, node.bounds);
+            };
+
+            auto result = std::optional<std::pair<T, U>>{};
+
+            std::vector<std::pair<Index, T>> stack;
+            stack.reserve(2u * height());
+            if (const auto rootDistance = entryDistance(m_nodes[m_root]); !vm::is_nan(rootDistance)) {
+                stack.emplace_back(m_root, rootDistance);
+            }
+
+            while (!stack.empty()) {
+                const auto [index, distance] = stack.back();
+                stack.pop_back();
+
+                if (result && distance > result->first) {
+                    continue;
+                }
+
+                const auto& node = m_nodes[index];
+                if (node.isLeaf()) {
+                    if (const auto hitDistance = intersect(node.data); !vm::is_nan(hitDistance) && (!result || hitDistance < result->first)) {
+                        result = std::make_pair(hitDistance, node.data);
+                    }
+                } else {
+                    const auto leftDistance = entryDistance(m_nodes[node.left]);
+                    const auto rightDistance = entryDistance(m_nodes[node.right]);
+
+                    // push the farther child first so that the nearer one is visited first
+                    const auto push = [&](const Index child, const T childDistance) {
+                        if (!vm::is_nan(childDistance)) {
+                            stack.emplace_back(child, childDistance);
                         }
+                    };
+                    if (leftDistance < rightDistance) {
+                        push(node.right, rightDistance);
+                        push(node.left, leftDistance);
+                    } else {
+                        push(node.left, leftDistance);
+                        push(node.right, rightDistance);
                     }
-                );
-                m_root->accept(visitor);
+                }
             }
+
+            return result;
+        }
+
+        /**
+         * Finds every data item in this tree whose bounding box intersects with the given box and returns a list of those
+         * items. Boxes that only touch the given box count as intersecting.
+         *
+         * @param box the box to test
+         * @return a list containing all found data items
+         */
+        List findIntersectors(const Box& box) const {
+            List result;
+            findIntersectors(box, std::back_inserter(result));
+            return result;
+        }
+
+        /**
+         * Finds every data item in this tree whose bounding box intersects with the given box and appends it to the given
+         * output iterator. Boxes that only touch the given box count as intersecting.
+         *
+         * @tparam O the output iterator type
+         * @param box the box to test
+         * @param out the output iterator to append to
+         */
+        template <typename O>
+        void findIntersectors(const Box& box, O out) const {
+            const auto intersects = [&](const Node& node) {
+                return node.bounds.intersects(box);
+            };
+
+            traverse(
+                intersects,
+                [&](const Node& leaf) {
+                    if (intersects(leaf)) {
+                        out = leaf.data;
+                        ++out;
+                    }
+                }
+            );
         }
 
         /**
@@ -675,19 +921,99 @@ namespace TrenchBroom {
          */
         template <typename O>
         void findContainers(const vm::vec<T,S>& point, O out) const {
-            if (!empty()) {
-                LambdaVisitor visitor(
-                    [&](const InnerNode* innerNode) {
-                        return innerNode->bounds().contains(point);
-                    },
-                    [&](const LeafNode* leaf) {
-                        if (leaf->bounds().contains(point)) {
-                            out = leaf->data();
-                            ++out;
+            const auto containsPoint = [&](const Node& node) {
+                return node.bounds.contains(point);
+            };
+
+            traverse(
+                containsPoint,
+                [&](const Node& leaf) {
+                    if (containsPoint(leaf)) {
+                        out = leaf.data;
+                        ++out;
+                    }
+                }
+            );
+        }
+
+        /**
+         * Finds every data item in this tree whose bounding box is not entirely in front of any of the given planes and
+         * returns a list of those items. If the planes bound a view frustum and their normals point out of it, the
+         * result contains every item that may be visible in the frustum.
+         *
+         * @param planes the planes to test, at most 32
+         * @return a list containing all found data items
+         */
+        List findInFrustum(const std::vector<vm::plane<T,S>>& planes) const {
+            List result;
+            findInFrustum(planes, std::back_inserter(result));
+            return result;
+        }
+
+        /**
+         * Finds every data item in this tree whose bounding box is not entirely in front of any of the given planes and
+         * appends it to the given output iterator.
+         *
+         * A subtree whose bounds are entirely behind a plane is not tested against that plane again, and a subtree whose
+         * bounds are entirely behind all planes is appended without any further tests.
+         *
+         * @tparam O the output iterator type
+         * @param planes the planes to test, at most 32
+         * @param out the output iterator to append to
+         */
+        template <typename O>
+        void findInFrustum(const std::vector<vm::plane<T,S>>& planes, O out) const {
+            using PlaneMask = std::uint32_t;
+            assert(planes.size() <= 32u);
+
+            if (empty()) {
+                return;
+            }
+
+            // each entry holds the planes that the node's bounds still straddle
+            std::vector<std::pair<Index, PlaneMask>> stack;
+            stack.reserve(height());
+            stack.emplace_back(m_root, planes.size() < 32u ? (PlaneMask(1) << planes.size()) - 1u : ~PlaneMask(0));
+
+            while (!stack.empty()) {
+                const auto [index, parentMask] = stack.back();
+                stack.pop_back();
+
+                const auto& node = m_nodes[index];
+                auto mask = parentMask;
+                if (mask != 0u) {
+                    const auto center = node.bounds.center();
+                    const auto halfSize = node.bounds.size() / T(2);
+
+                    bool outside = false;
+                    for (size_t i = 0u; i < planes.size() && !outside; ++i) {
+                        const auto bit = PlaneMask(1) << i;
+                        if ((mask & bit) != 0u) {
+                            const auto& plane = planes[i];
+                            const auto distance = plane.point_distance(center);
+                            const auto radius = dot(vm::abs(plane.normal), halfSize);
+                            if (distance - radius > T(0)) {
+                                // entirely in front of this plane
+                                outside = true;
+                            } else if (distance + radius <= T(0)) {
+                                // entirely behind this plane, so the children need not be tested against it
+                                mask &= ~bit;
+                            }
                         }
                     }
-                );
-                m_root->accept(visitor);
+
+                    if (outside) {
+                        continue;
+                    }
+                }
+
+                if (node.isLeaf()) {
+                    out = node.data;
+                    ++out;
+                } else {
+                    stack.emplace_back(node.right, mask);
+                    stack.emplace_back(node.left, mask);
+                }
             }
         }
 
@@ -698,9 +1024,37 @@ namespace TrenchBroom {
          */
         void print(std::ostream& str) const {
             if (!empty()) {
-                m_root->appendTo(str);
+                appendTo(str, m_root, "  ", 0);
+            }
+        }
+    private:
+        /**
+         * Appends a textual representation of the subtree rooted at the given node to the given output stream using the
+         * given indent string and the given level of indentation.
+         */
+        void appendTo(std::ostream& str, const Index index, const std::string& indent, const size_t level) const {
+            const auto& node = m_nodes[index];
+
+            for (size_t i = 0; i < level; ++i) {
+                str << indent;
+            }
+
+            if (node.isLeaf()) {
+                str << "L ";
+                appendBounds(str, node.bounds);
+                str << ": " << node.data << std::endl;
+            } else {
+                str << "O ";
+                appendBounds(str, node.bounds);
+                str << std::endl;
+
+                appendTo(str, node.left, indent, level + 1);
+                appendTo(str, node.right, indent, level + 1);
             }
         }
+
+        static void appendBounds(std::ostream& str, const Box& bounds) {
+            str << "[ ( " << bounds.min << " ) ( " << bounds.max  << " ) ]";
+        }
     };
 }
-
@@ -137,36 +137,13 @@ namespace TrenchBroom {
             const unsigned char* indexedImage = reinterpret_cast<const unsigned char*>(reader.begin() + reader.position());
             reader.seekForward(pixelCount); // throws ReaderException if there aren't pixelCount bytes available
 
-            // Write rgba pixels
-            unsigned char* const rgbaData = rgbaImage.data();
-            for (size_t i = 0; i < pixelCount; ++i) {
-                const int index = static_cast<int>(indexedImage[i]);
+            applyPalette(indexedImage, pixelCount, paletteData, rgbaImage.data());
+            averageColor = Color(Assets::averageColor(rgbaImage, GL_RGBA), 1.0f);
 
-                std::memcpy(rgbaData + (i * 4), &paletteData[index * 4], 4);
-            }
-
-            // Check average color
-            uint32_t colorSum[3] = {0, 0, 0};
-            for (size_t i = 0; i < pixelCount; ++i) {
-                colorSum[0] += static_cast<uint32_t>(rgbaData[(i * 4) + 0]);
-                colorSum[1] += static_cast<uint32_t>(rgbaData[(i * 4) + 1]);
-                colorSum[2] += static_cast<uint32_t>(rgbaData[(i * 4) + 2]);
-            }
-            averageColor = Color(static_cast<float>(colorSum[0]) / (255.0f * static_cast<float>(pixelCount)),
-                                 static_cast<float>(colorSum[1]) / (255.0f * static_cast<float>(pixelCount)),
-                                 static_cast<float>(colorSum[2]) / (255.0f * static_cast<float>(pixelCount)),
-                                 1.0f);
-
-            // Check for transparency
-            bool hasTransparency = false;
-            if (transparency == PaletteTransparency::Index255Transparent) {
-                // Take the bitwise AND of the alpha channel of all pixels
-                unsigned char andAlpha = 0xff;
-                for (size_t i = 0; i < pixelCount; ++i) {
-                    andAlpha &= rgbaData[(i * 4) + 3];
-                }
-                hasTransparency = (andAlpha != 0xff);
-            }
+            // Only index 255 can be transparent, and searching the indices is cheaper than checking every pixel's alpha
+            const bool hasTransparency =
+                transparency == PaletteTransparency::Index255Transparent
+                && std::memchr(indexedImage, 255, pixelCount) != nullptr;
 
             return hasTransparency;
         }
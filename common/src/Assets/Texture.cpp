@@ -23,6 +23,7 @@
 #include "Renderer/GL.h"
 
 #include <algorithm> // for std::max
+#include <utility>
 #include <cassert>
 
 namespace TrenchBroom {
@@ -83,6 +84,42 @@ namespace TrenchBroom {
         m_blendFunc{TextureBlendFunc::Enable::UseDefault, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA},
         m_textureId(0) {}
 
+        Texture::Texture(Texture&& other) :
+        m_name(std::move(other.m_name)),
+        m_absolutePath(std::move(other.m_absolutePath)),
+        m_relativePath(std::move(other.m_relativePath)),
+        m_width(other.m_width),
+        m_height(other.m_height),
+        m_averageColor(other.m_averageColor),
+        m_usageCount(other.m_usageCount.load()),
+        m_overridden(other.m_overridden),
+        m_format(other.m_format),
+        m_type(other.m_type),
+        m_surfaceParms(std::move(other.m_surfaceParms)),
+        m_culling(other.m_culling),
+        m_blendFunc(other.m_blendFunc),
+        m_textureId(other.m_textureId),
+        m_buffers(std::move(other.m_buffers)) {}
+
+        Texture& Texture::operator=(Texture&& other) {
+            m_name = std::move(other.m_name);
+            m_absolutePath = std::move(other.m_absolutePath);
+            m_relativePath = std::move(other.m_relativePath);
+            m_width = other.m_width;
+            m_height = other.m_height;
+            m_averageColor = other.m_averageColor;
+            m_usageCount = other.m_usageCount.load();
+            m_overridden = other.m_overridden;
+            m_format = other.m_format;
+            m_type = other.m_type;
+            m_surfaceParms = std::move(other.m_surfaceParms);
+            m_culling = other.m_culling;
+            m_blendFunc = other.m_blendFunc;
+            m_textureId = other.m_textureId;
+            m_buffers = std::move(other.m_buffers);
+            return *this;
+        }
+
         Texture::~Texture() = default;
 
         TextureType Texture::selectTextureType(const bool masked) {
@@ -149,6 +186,10 @@ namespace TrenchBroom {
             m_culling = culling;
         }
 
+        const TextureBlendFunc& Texture::blendFunc() const {
+            return m_blendFunc;
+        }
+
         void Texture::setBlendFunc(GLenum srcFactor, GLenum destFactor) {
             m_blendFunc.enable = TextureBlendFunc::Enable::UseFactors;
             m_blendFunc.srcFactor = srcFactor;
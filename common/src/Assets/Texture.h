@@ -26,6 +26,7 @@
 
 #include <vecmath/forward.h>
 
+#include <atomic>
 #include <set>
 #include <string>
 #include <vector>
@@ -84,7 +85,8 @@ namespace TrenchBroom {
             size_t m_height;
             Color m_averageColor;
 
-            size_t m_usageCount;
+            // brushes are copied and modified on worker threads, which adds and removes texture references concurrently
+            std::atomic<size_t> m_usageCount;
             bool m_overridden;
 
             GLenum m_format;
@@ -109,8 +111,8 @@ namespace TrenchBroom {
             Texture(const Texture&) = delete;
             Texture& operator=(const Texture&) = delete;
             
-            Texture(Texture&& other) = default;
-            Texture& operator=(Texture&& other) = default;
+            Texture(Texture&& other);
+            Texture& operator=(Texture&& other);
 
             ~Texture();
 
@@ -147,6 +149,7 @@ namespace TrenchBroom {
             TextureCulling culling() const;
             void setCulling(TextureCulling culling);
 
+            const TextureBlendFunc& blendFunc() const;
             void setBlendFunc(GLenum srcFactor, GLenum destFactor);
             void disableBlend();
 
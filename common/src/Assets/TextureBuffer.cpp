@@ -19,6 +19,7 @@
 
 #include "TextureBuffer.h"
 
+#include "Color.h"
 #include "Ensure.h"
 
 #include <vecmath/vec.h>
@@ -26,6 +27,14 @@
 #include <FreeImage.h>
 
 #include <algorithm> // for std::max
+#include <cstdint>
+#include <cstring>
+
+// SSE2 is part of every x86-64 CPU, other platforms use the scalar code paths
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TB_TEXTURE_BUFFER_SSE2
+#include <emmintrin.h>
+#endif
 
 namespace TrenchBroom {
     namespace Assets {
@@ -111,5 +120,150 @@ namespace TrenchBroom {
                 FreeImage_Unload(newBitmap);
             }
         }
+
+        size_t mipLevelCount(const size_t width, const size_t height) {
+            assert(width > 0);
+            assert(height > 0);
+
+            size_t result = 1u;
+            for (auto size = std::max(width, height); size > 1u; size >>= 1u) {
+                ++result;
+            }
+            return result;
+        }
+
+        void applyPalette(const unsigned char* indices, const size_t pixelCount, const unsigned char* rgbaPalette, unsigned char* rgbaImage) {
+            // SSE2 cannot gather, so every pixel is copied with a single 32 bit load and store instead
+            std::uint32_t palette[256];
+            std::memcpy(palette, rgbaPalette, sizeof(palette));
+
+            size_t i = 0u;
+            for (; i + 4u <= pixelCount; i += 4u) {
+                const std::uint32_t pixels[4] = {
+                    palette[indices[i + 0u]],
+                    palette[indices[i + 1u]],
+                    palette[indices[i + 2u]],
+                    palette[indices[i + 3u]]
+                };
+                std::memcpy(rgbaImage + 4u * i, pixels, sizeof(pixels));
+            }
+            for (; i < pixelCount; ++i) {
+                std::memcpy(rgbaImage + 4u * i, &palette[indices[i]], 4u);
+            }
+        }
+
+        /**
+         * Adds the sums of each of the 4 channels of the given pixels to the given sums.
+         */
+        static void sumChannels(const unsigned char* data, const size_t pixelCount, std::uint64_t (&sums)[4]) {
+            size_t i = 0u;
+#ifdef TB_TEXTURE_BUFFER_SSE2
+            const auto zero = _mm_setzero_si128();
+            while (i + 4u <= pixelCount) {
+                // every iteration adds at most 2 * 255 to a 16 bit lane, so 128 iterations cannot overflow it
+                const auto iterations = std::min((pixelCount - i) / 4u, size_t(128));
+
+                // the lanes hold the channels of two pixels
+                auto blockSums = _mm_setzero_si128();
+                for (size_t j = 0u; j < iterations; ++j, i += 4u) {
+                    const auto pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 4u * i));
+                    blockSums = _mm_add_epi16(blockSums, _mm_add_epi16(_mm_unpacklo_epi8(pixels, zero), _mm_unpackhi_epi8(pixels, zero)));
+                }
+
+                alignas(16) std::uint32_t channelSums[4];
+                _mm_store_si128(reinterpret_cast<__m128i*>(channelSums), _mm_add_epi32(_mm_unpacklo_epi16(blockSums, zero), _mm_unpackhi_epi16(blockSums, zero)));
+                for (size_t c = 0u; c < 4u; ++c) {
+                    sums[c] += channelSums[c];
+                }
+            }
+#endif
+            for (; i < pixelCount; ++i) {
+                for (size_t c = 0u; c < 4u; ++c) {
+                    sums[c] += data[4u * i + c];
+                }
+            }
+        }
+
+        Color averageColor(const TextureBuffer& buffer, const GLenum format) {
+            ensure(format == GL_RGBA || format == GL_BGRA, "expected RGBA or BGRA");
+
+            const auto pixelCount = buffer.size() / 4u;
+            if (pixelCount == 0u) {
+                return Color();
+            }
+
+            std::uint64_t sums[4] = { 0u, 0u, 0u, 0u };
+            sumChannels(buffer.data(), pixelCount, sums);
+
+            const auto average = [&](const size_t c) {
+                return static_cast<float>(static_cast<double>(sums[c]) / (255.0 * static_cast<double>(pixelCount)));
+            };
+
+            return format == GL_RGBA
+                ? Color(average(0u), average(1u), average(2u), average(3u))
+                : Color(average(2u), average(1u), average(0u), average(3u));
+        }
+
+        /**
+         * Computes every pixel of the destination as the rounded average of the corresponding 2x2 source pixels. If
+         * the source is only one pixel wide or high, its last column or row is used twice.
+         */
+        static void boxFilter(const unsigned char* src, const size_t srcWidth, const size_t srcHeight, unsigned char* dst, const size_t dstWidth, const size_t dstHeight) {
+#ifdef TB_TEXTURE_BUFFER_SSE2
+            const auto zero = _mm_setzero_si128();
+            const auto two = _mm_set1_epi16(2);
+#endif
+
+            for (size_t y = 0u; y < dstHeight; ++y) {
+                const auto* row0 = src + 4u * srcWidth * std::min(2u * y, srcHeight - 1u);
+                const auto* row1 = src + 4u * srcWidth * std::min(2u * y + 1u, srcHeight - 1u);
+                auto* dstRow = dst + 4u * dstWidth * y;
+
+                size_t x = 0u;
+#ifdef TB_TEXTURE_BUFFER_SSE2
+                // two destination pixels from four source pixels of both rows per iteration
+                for (; x + 2u <= dstWidth; x += 2u) {
+                    const auto top = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 8u * x));
+                    const auto bottom = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 8u * x));
+
+                    // the vertical sums of the first two and the last two source pixels
+                    const auto left = _mm_add_epi16(_mm_unpacklo_epi8(top, zero), _mm_unpacklo_epi8(bottom, zero));
+                    const auto right = _mm_add_epi16(_mm_unpackhi_epi8(top, zero), _mm_unpackhi_epi8(bottom, zero));
+
+                    // add the horizontal neighbours, which are in the upper and lower halves
+                    const auto sums = _mm_unpacklo_epi64(
+                        _mm_add_epi16(left, _mm_srli_si128(left, 8)),
+                        _mm_add_epi16(right, _mm_srli_si128(right, 8)));
+
+                    const auto averages = _mm_srli_epi16(_mm_add_epi16(sums, two), 2);
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(dstRow + 4u * x), _mm_packus_epi16(averages, averages));
+                }
+#endif
+                for (; x < dstWidth; ++x) {
+                    const auto x0 = 4u * std::min(2u * x, srcWidth - 1u);
+                    const auto x1 = 4u * std::min(2u * x + 1u, srcWidth - 1u);
+                    for (size_t c = 0u; c < 4u; ++c) {
+                        const auto sum = static_cast<unsigned int>(row0[x0 + c]) + row0[x1 + c] + row1[x0 + c] + row1[x1 + c];
+                        dstRow[4u * x + c] = static_cast<unsigned char>((sum + 2u) / 4u);
+                    }
+                }
+            }
+        }
+
+        void generateMips(TextureBufferList& buffers, const size_t width, const size_t height, const GLenum format) {
+            ensure(format == GL_RGBA || format == GL_BGRA, "expected RGBA or BGRA");
+            ensure(!buffers.empty() && buffers[0].size() == 4u * width * height, "incorrect first mip level size");
+
+            const auto mipLevels = mipLevelCount(width, height);
+            buffers.resize(mipLevels);
+
+            for (size_t level = 1u; level < mipLevels; ++level) {
+                const auto srcSize = sizeAtMipLevel(width, height, level - 1u);
+                const auto dstSize = sizeAtMipLevel(width, height, level);
+
+                buffers[level] = TextureBuffer(4u * dstSize.x() * dstSize.y());
+                boxFilter(buffers[level - 1u].data(), srcSize.x(), srcSize.y(), buffers[level].data(), dstSize.x(), dstSize.y());
+            }
+        }
     }
 }
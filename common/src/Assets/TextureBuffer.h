@@ -27,6 +27,8 @@
 #include <vector>
 
 namespace TrenchBroom {
+    class Color;
+
     namespace Assets {
         class TextureBuffer {
         private:
@@ -48,6 +50,36 @@ namespace TrenchBroom {
         void setMipBufferSize(TextureBufferList& buffers, size_t mipLevels, size_t width, size_t height, GLenum format);
 
         void resizeMips(TextureBufferList& buffers, const vm::vec2s& oldSize, const vm::vec2s& newSize);
+
+        /**
+         * Returns the number of mip levels of a texture with the given size, down to and including the 1x1 level.
+         */
+        size_t mipLevelCount(size_t width, size_t height);
+
+        /**
+         * Replaces every palette index with the corresponding color of the given palette.
+         *
+         * @param indices the palette indices, `pixelCount` bytes
+         * @param pixelCount the number of pixels to convert
+         * @param rgbaPalette 256 colors, 4 bytes each
+         * @param rgbaImage the destination, `pixelCount` * 4 bytes
+         */
+        void applyPalette(const unsigned char* indices, size_t pixelCount, const unsigned char* rgbaPalette, unsigned char* rgbaImage);
+
+        /**
+         * Returns the average of all pixels in the given buffer, which must contain 4 bytes per pixel in the given
+         * format.
+         */
+        Color averageColor(const TextureBuffer& buffer, GLenum format);
+
+        /**
+         * Computes all mip levels of a texture with the given size from its first level using a box filter. Every
+         * pixel of a mip level is the average of the corresponding 2x2 pixels of the previous level. The buffers are
+         * resized to the full number of mip levels.
+         *
+         * The first buffer must contain 4 bytes per pixel in the given format.
+         */
+        void generateMips(TextureBufferList& buffers, size_t width, size_t height, GLenum format);
     }
 }
 
@@ -29,20 +29,24 @@
 namespace TrenchBroom {
     namespace Assets {
         TextureCollection::TextureCollection() :
-        m_loaded(false) {}
+        m_loaded(false),
+        m_preparedTextureCount(0u) {}
 
         TextureCollection::TextureCollection(std::vector<Texture> textures) :
         m_loaded(false),
-        m_textures(std::move(textures)) {}
+        m_textures(std::move(textures)),
+        m_preparedTextureCount(0u) {}
 
         TextureCollection::TextureCollection(const IO::Path& path) :
         m_loaded(false),
-        m_path(path) {}
+        m_path(path),
+        m_preparedTextureCount(0u) {}
 
         TextureCollection::TextureCollection(const IO::Path& path, std::vector<Texture> textures) :
         m_loaded(true),
         m_path(path),
-        m_textures(std::move(textures)) {}
+        m_textures(std::move(textures)),
+        m_preparedTextureCount(0u) {}
 
         TextureCollection::~TextureCollection() {
             if (!m_textureIds.empty()) {
@@ -104,22 +108,28 @@ namespace TrenchBroom {
         }
 
         bool TextureCollection::prepared() const {
-            return !m_textureIds.empty();
+            return m_preparedTextureCount == textureCount();
         }
 
-        void TextureCollection::prepare(const int minFilter, const int magFilter) {
+        size_t TextureCollection::prepare(const int minFilter, const int magFilter, const size_t maxBytes) {
             assert(!prepared());
 
-            m_textureIds.resize(textureCount());
-            if (textureCount() != 0u) {
+            if (m_textureIds.empty()) {
+                m_textureIds.resize(textureCount());
                 glAssert(glGenTextures(static_cast<GLsizei>(textureCount()),
                                        static_cast<GLuint*>(&m_textureIds.front())));
+            }
 
-                for (size_t i = 0; i < textureCount(); ++i) {
-                    Texture& texture = m_textures[i];
-                    texture.prepare(m_textureIds[i], minFilter, magFilter);
+            size_t bytes = 0u;
+            while (m_preparedTextureCount < textureCount() && (bytes == 0u || bytes < maxBytes)) {
+                Texture& texture = m_textures[m_preparedTextureCount];
+                for (const auto& buffer : texture.buffersIfUnprepared()) {
+                    bytes += buffer.size();
                 }
+                texture.prepare(m_textureIds[m_preparedTextureCount], minFilter, magFilter);
+                ++m_preparedTextureCount;
             }
+            return bytes;
         }
 
         void TextureCollection::setTextureMode(const int minFilter, const int magFilter) {
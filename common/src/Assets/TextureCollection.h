@@ -37,6 +37,7 @@ namespace TrenchBroom {
             std::vector<Texture> m_textures;
 
             TextureIdList m_textureIds;
+            size_t m_preparedTextureCount;
 
             friend class Texture;
         public:
@@ -68,7 +69,13 @@ namespace TrenchBroom {
             Texture* textureByName(const std::string& name);
 
             bool prepared() const;
-            void prepare(int minFilter, int magFilter);
+
+            /**
+             * Uploads the textures of this collection that have not been uploaded yet, in order, until the given number
+             * of bytes has been reached or every texture has been uploaded. At least one texture is uploaded per call so
+             * that preparation always makes progress. Returns the number of bytes uploaded.
+             */
+            size_t prepare(int minFilter, int magFilter, size_t maxBytes);
             void setTextureMode(int minFilter, int magFilter);
         };
     }
@@ -56,6 +56,12 @@ namespace TrenchBroom {
             }
         };
 
+        /**
+         * The number of bytes of texture data to upload per call to commitChanges. Uploading this much takes a few
+         * milliseconds on common hardware.
+         */
+        static constexpr size_t MaxUploadBytesPerCommit = 16u * 1024u * 1024u;
+
         TextureManager::TextureManager(int magFilter, int minFilter, Logger& logger) :
         m_logger(logger),
         m_minFilter(minFilter),
@@ -137,6 +143,10 @@ namespace TrenchBroom {
             m_toRemove.clear();
         }
 
+        bool TextureManager::hasPendingChanges() const {
+            return !m_toPrepare.empty();
+        }
+
         const Texture* TextureManager::texture(const std::string& name) const {
             auto it = m_texturesByName.find(kdl::str_to_lower(name));
             if (it == std::end(m_texturesByName)) {
@@ -168,11 +178,16 @@ namespace TrenchBroom {
         }
 
         void TextureManager::prepare() {
-            for (const size_t index : m_toPrepare) {
-                auto& collection = m_collections[index];
-                collection.prepare(m_minFilter, m_magFilter);
+            size_t bytes = 0u;
+            auto it = std::begin(m_toPrepare);
+            while (it != std::end(m_toPrepare) && bytes < MaxUploadBytesPerCommit) {
+                auto& collection = m_collections[*it];
+                bytes += collection.prepare(m_minFilter, m_magFilter, MaxUploadBytesPerCommit - bytes);
+                if (collection.prepared()) {
+                    ++it;
+                }
             }
-            m_toPrepare.clear();
+            m_toPrepare.erase(std::begin(m_toPrepare), it);
         }
 
         void TextureManager::updateTextures() {
@@ -66,8 +66,19 @@ namespace TrenchBroom {
             void clear();
 
             void setTextureMode(int minFilter, int magFilter);
+
+            /**
+             * Applies pending texture mode changes and uploads the next batch of textures. Textures are uploaded in
+             * batches of limited size so that a frame is not stalled until every texture is uploaded. Views must call
+             * this once per frame and schedule another frame while hasPendingChanges() returns true.
+             */
             void commitChanges();
 
+            /**
+             * Indicates whether there are textures that still need to be uploaded.
+             */
+            bool hasPendingChanges() const;
+
             const Texture* texture(const std::string& name) const;
             Texture* texture(const std::string& name);
             
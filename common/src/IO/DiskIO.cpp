@@ -27,9 +27,11 @@
 
 #include <kdl/string_compare.h>
 
+#include <cstdint>
 #include <fstream>
 #include <string>
 
+#include <QDateTime>
 #include <QDir>
 #include <QFileInfo>
 
@@ -117,6 +119,15 @@ namespace TrenchBroom {
                 return fileInfo.exists() && fileInfo.isFile();
             }
 
+            std::int64_t fileModificationTime(const Path& path) {
+                const Path fixedPath = fixPath(path);
+                QFileInfo fileInfo = QFileInfo(pathAsQString(fixedPath));
+                if (!fileInfo.exists() || !fileInfo.isFile()) {
+                    throw FileNotFoundException(fixedPath.asString());
+                }
+                return static_cast<std::int64_t>(fileInfo.lastModified().toMSecsSinceEpoch());
+            }
+
             std::vector<Path> getDirectoryContents(const Path& path) {
                 const Path fixedPath = fixPath(path);
                 QDir dir(pathAsQString(fixedPath));
@@ -142,6 +153,15 @@ namespace TrenchBroom {
                 return std::make_shared<CFile>(fixedPath);
             }
 
+            std::shared_ptr<File> openMappedFile(const Path& path) {
+                const Path fixedPath = fixPath(path);
+                if (!fileExists(fixedPath)) {
+                    throw FileNotFoundException(fixedPath.asString());
+                }
+
+                return std::make_shared<MappedFile>(fixedPath);
+            }
+
             std::string readTextFile(const Path& path) {
                 const Path fixedPath = fixPath(path);
 
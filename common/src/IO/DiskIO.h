@@ -21,6 +21,7 @@
 
 #include "IO/Path.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -36,8 +37,20 @@ namespace TrenchBroom {
             bool directoryExists(const Path& path);
             bool fileExists(const Path& path);
 
+            /**
+             * Returns the time at which the file at the given path was last modified, in milliseconds since the epoch.
+             *
+             * @throw FileNotFoundException if the file does not exist
+             */
+            std::int64_t fileModificationTime(const Path& path);
+
             std::vector<Path> getDirectoryContents(const Path& path);
             std::shared_ptr<File> openFile(const Path& path);
+            /**
+             * Opens the file at the given path and maps it into memory. Prefer this to openFile for large files that
+             * are read in their entirety.
+             */
+            std::shared_ptr<File> openMappedFile(const Path& path);
             std::string readTextFile(const Path& path);
             Path getCurrentWorkingDir();
 
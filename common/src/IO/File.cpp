@@ -21,6 +21,9 @@
 
 #include "Exceptions.h"
 #include "IO/IOUtils.h"
+#include "IO/PathQt.h"
+
+#include <QFile>
 
 namespace TrenchBroom {
     namespace IO {
@@ -79,7 +82,7 @@ namespace TrenchBroom {
         }
 
         Reader CFile::reader() const {
-            return Reader::from(m_file);
+            return Reader::from(m_file, m_fileMutex);
         }
 
         size_t CFile::size() const {
@@ -90,6 +93,37 @@ namespace TrenchBroom {
             return m_file;
         }
 
+        MappedFile::MappedFile(const Path& path) :
+        File(path),
+        m_file(std::make_unique<QFile>(pathAsQString(path))),
+        m_begin(nullptr),
+        m_size(0u) {
+            if (!m_file->open(QIODevice::ReadOnly)) {
+                throw FileSystemException("Cannot open file " + path.asString());
+            }
+
+            m_size = static_cast<size_t>(m_file->size());
+            if (m_size > 0u) {
+                // mapping an empty file fails, but there is nothing to map in that case
+                const auto* begin = m_file->map(0, m_file->size());
+                if (begin == nullptr) {
+                    throw FileSystemException("Cannot map file " + path.asString() + ": " + m_file->errorString().toStdString());
+                }
+                m_begin = reinterpret_cast<const char*>(begin);
+            }
+        }
+
+        // the file is unmapped when it is closed
+        MappedFile::~MappedFile() = default;
+
+        Reader MappedFile::reader() const {
+            return Reader::from(m_begin, m_begin + m_size);
+        }
+
+        size_t MappedFile::size() const {
+            return m_size;
+        }
+
         FileView::FileView(const Path& path, std::shared_ptr<File> file, const size_t offset, const size_t length) :
         File(path),
         m_file(std::move(file)),
@@ -24,6 +24,9 @@
 
 #include <cstdio>
 #include <memory>
+#include <mutex>
+
+class QFile;
 
 namespace TrenchBroom {
     namespace IO {
@@ -113,6 +116,11 @@ namespace TrenchBroom {
         private:
             std::FILE* m_file;
             size_t m_size;
+            /**
+             * Guards the file position of m_file, which is shared by all readers of this file, e.g. when the entries of
+             * an archive are read on multiple threads. Readers of different files don't block each other.
+             */
+            mutable std::mutex m_fileMutex;
         public:
             /**
              * Creates a new file with the given path and opens the file for reading.
@@ -133,6 +141,33 @@ namespace TrenchBroom {
             std::FILE* file() const;
         };
 
+        /**
+         * A file that is backed by a physical file on the disk which is mapped into memory. The file is opened and
+         * mapped in the constructor and unmapped and closed in the destructor.
+         *
+         * Unlike CFile, reading the contents of this file into a buffer does not copy them. The operating system pages
+         * the contents in as they are accessed, and it can evict them again without writing them to swap.
+         */
+        class MappedFile : public File {
+        private:
+            std::unique_ptr<QFile> m_file;
+            const char* m_begin;
+            size_t m_size;
+        public:
+            /**
+             * Creates a new file with the given path, opens the file for reading and maps it into memory.
+             *
+             * @param path the path of the file
+             *
+             * @throw FileSystemException if the file cannot be opened or mapped
+             */
+            explicit MappedFile(const Path& path);
+            ~MappedFile() override;
+
+            Reader reader() const override;
+            size_t size() const override;
+        };
+
         /**
          * A file that is backed by a portion of a physical file.
          */
@@ -39,6 +39,7 @@
 
 #include <fmt/format.h>
 
+#include <atomic>
 #include <iterator> // for std::ostreambuf_iterator
 #include <memory>
 #include <sstream>
@@ -50,8 +51,8 @@ namespace TrenchBroom {
     namespace IO {
         class QuakeFileSerializer : public MapFileSerializer {
         public:
-            explicit QuakeFileSerializer(std::ostream& stream) :
-            MapFileSerializer(stream) {}
+            QuakeFileSerializer(const Model::MapFormat mapFormat, std::ostream& stream) :
+            MapFileSerializer(mapFormat, stream) {}
         private:
             void doWriteBrushFace(std::ostream& stream, const Model::BrushFace& face) const override {
                 writeFacePoints(stream, face);
@@ -120,8 +121,8 @@ namespace TrenchBroom {
 
         class Quake2FileSerializer : public QuakeFileSerializer {
         public:
-            explicit Quake2FileSerializer(std::ostream& stream) :
-            QuakeFileSerializer(stream) {}
+            Quake2FileSerializer(const Model::MapFormat mapFormat, std::ostream& stream) :
+            QuakeFileSerializer(mapFormat, stream) {}
         private:
             void doWriteBrushFace(std::ostream& stream, const Model::BrushFace& face) const override {
                 writeFacePoints(stream, face);
@@ -144,8 +145,8 @@ namespace TrenchBroom {
 
         class Quake2ValveFileSerializer : public Quake2FileSerializer {
         public:
-            explicit Quake2ValveFileSerializer(std::ostream& stream) :
-            Quake2FileSerializer(stream) {}
+            Quake2ValveFileSerializer(const Model::MapFormat mapFormat, std::ostream& stream) :
+            Quake2FileSerializer(mapFormat, stream) {}
         private:
             void doWriteBrushFace(std::ostream& stream, const Model::BrushFace& face) const override {
                 writeFacePoints(stream, face);
@@ -160,8 +161,8 @@ namespace TrenchBroom {
         private:
             std::string SurfaceColorFormat;
         public:
-            explicit DaikatanaFileSerializer(std::ostream& stream) :
-            Quake2FileSerializer(stream),
+            DaikatanaFileSerializer(const Model::MapFormat mapFormat, std::ostream& stream) :
+            Quake2FileSerializer(mapFormat, stream),
             SurfaceColorFormat(" %d %d %d") {}
         private:
             void doWriteBrushFace(std::ostream& stream, const Model::BrushFace& face) const override {
@@ -188,8 +189,8 @@ namespace TrenchBroom {
 
         class Hexen2FileSerializer : public QuakeFileSerializer {
         public:
-            explicit Hexen2FileSerializer(std::ostream& stream):
-            QuakeFileSerializer(stream) {}
+            Hexen2FileSerializer(const Model::MapFormat mapFormat, std::ostream& stream) :
+            QuakeFileSerializer(mapFormat, stream) {}
         private:
             void doWriteBrushFace(std::ostream& stream, const Model::BrushFace& face) const override {
                 writeFacePoints(stream, face);
@@ -200,8 +201,8 @@ namespace TrenchBroom {
 
         class ValveFileSerializer : public QuakeFileSerializer {
         public:
-            explicit ValveFileSerializer(std::ostream& stream) :
-            QuakeFileSerializer(stream) {}
+            ValveFileSerializer(const Model::MapFormat mapFormat, std::ostream& stream) :
+            QuakeFileSerializer(mapFormat, stream) {}
         private:
             void doWriteBrushFace(std::ostream& stream, const Model::BrushFace& face) const override {
                 writeFacePoints(stream, face);
@@ -213,30 +214,31 @@ namespace TrenchBroom {
         std::unique_ptr<NodeSerializer> MapFileSerializer::create(const Model::MapFormat format, std::ostream& stream) {
             switch (format) {
                 case Model::MapFormat::Standard:
-                    return std::make_unique<QuakeFileSerializer>(stream);
+                    return std::make_unique<QuakeFileSerializer>(format, stream);
                 case Model::MapFormat::Quake2:
                     // TODO 2427: Implement Quake3 serializers and use them
                 case Model::MapFormat::Quake3:
                 case Model::MapFormat::Quake3_Legacy:
-                    return std::make_unique<Quake2FileSerializer>(stream);
+                    return std::make_unique<Quake2FileSerializer>(format, stream);
                 case Model::MapFormat::Quake2_Valve:
                 case Model::MapFormat::Quake3_Valve:
-                    return std::make_unique<Quake2ValveFileSerializer>(stream);
+                    return std::make_unique<Quake2ValveFileSerializer>(format, stream);
                 case Model::MapFormat::Daikatana:
-                    return std::make_unique<DaikatanaFileSerializer>(stream);
+                    return std::make_unique<DaikatanaFileSerializer>(format, stream);
                 case Model::MapFormat::Valve:
-                    return std::make_unique<ValveFileSerializer>(stream);
+                    return std::make_unique<ValveFileSerializer>(format, stream);
                 case Model::MapFormat::Hexen2:
-                    return std::make_unique<Hexen2FileSerializer>(stream);
+                    return std::make_unique<Hexen2FileSerializer>(format, stream);
                 case Model::MapFormat::Unknown:
                     throw FileFormatException("Unknown map file format");
                 switchDefault()
             }
         }
 
-        MapFileSerializer::MapFileSerializer(std::ostream& stream) :
+        MapFileSerializer::MapFileSerializer(const Model::MapFormat mapFormat, std::ostream& stream) :
         m_line(1),
-        m_stream(stream) {}
+        m_stream(stream),
+        m_mapFormat(mapFormat) {}
 
         void MapFileSerializer::doBeginFile(const std::vector<const Model::Node*>& rootNodes) {
             ensure(m_nodeToPrecomputedString.empty(), "MapFileSerializer may not be reused");
@@ -258,16 +260,29 @@ namespace TrenchBroom {
                 }
             ));
 
-            // serialize brushes to strings in parallel
+            // serialize brushes to strings in parallel, reusing the strings cached in the nodes if they haven't changed
+            // since they were last serialized
+            auto reusedSerializationCount = std::atomic<size_t>(0);
+            const auto serialize = [&](const Model::Node* node, const auto& write) {
+                if (auto cachedSerialization = node->cachedSerialization(m_mapFormat)) {
+                    ++reusedSerializationCount;
+                    return cachedSerialization;
+                }
+
+                auto serialization = std::make_shared<const Model::NodeSerialization>(write());
+                node->setCachedSerialization(serialization);
+                return serialization;
+            };
+
             using Entry = std::pair<const Model::Node*, PrecomputedString>;
             std::vector<Entry> result = kdl::vec_parallel_transform(std::move(nodesToSerialize),
                 [&](const auto& node) {
                     return std::visit(kdl::overload(
                         [&](const Model::BrushNode* brushNode) {
-                            return Entry{brushNode, writeBrushFaces(brushNode->brush())};
+                            return Entry{brushNode, serialize(brushNode, [&]() { return writeBrushFaces(brushNode->brush()); })};
                         },
                         [&](const Model::PatchNode* patchNode) {
-                            return Entry{patchNode, writePatch(patchNode->patch())};
+                            return Entry{patchNode, serialize(patchNode, [&]() { return writePatch(patchNode->patch()); })};
                         }
                     ), node);
                 });
@@ -276,6 +291,7 @@ namespace TrenchBroom {
             for (auto& entry: result) {
                 m_nodeToPrecomputedString.insert(std::move(entry));
             }
+            setReusedSerializationCount(reusedSerializationCount);
         }
 
         void MapFileSerializer::doEndFile() {}
@@ -311,7 +327,7 @@ namespace TrenchBroom {
             // write pre-serialized brush faces
             auto it = m_nodeToPrecomputedString.find(brush);
             ensure(it != std::end(m_nodeToPrecomputedString), "attempted to serialize a brush which was not passed to doBeginFile");
-            const PrecomputedString& precomputedString = it->second;
+            const Model::NodeSerialization& precomputedString = *it->second;
             m_stream << precomputedString.string;
             m_line += precomputedString.lineCount;
 
@@ -335,7 +351,7 @@ namespace TrenchBroom {
             // write pre-serialized patch
             auto it = m_nodeToPrecomputedString.find(patchNode);
             ensure(it != std::end(m_nodeToPrecomputedString), "attempted to serialize a patch which was not passed to doBeginFile");
-            const PrecomputedString& precomputedString = it->second;
+            const Model::NodeSerialization& precomputedString = *it->second;
             m_stream << precomputedString.string;
             m_line += precomputedString.lineCount;
 
@@ -357,15 +373,15 @@ namespace TrenchBroom {
         /**
          * Threadsafe
          */
-        MapFileSerializer::PrecomputedString MapFileSerializer::writeBrushFaces(const Model::Brush& brush) const {
+        Model::NodeSerialization MapFileSerializer::writeBrushFaces(const Model::Brush& brush) const {
             std::stringstream stream;
             for (const Model::BrushFace& face : brush.faces()) {
                 doWriteBrushFace(stream, face);
             }
-            return PrecomputedString{stream.str(), brush.faces().size()};
+            return Model::NodeSerialization{m_mapFormat, stream.str(), brush.faces().size()};
         }
 
-        MapFileSerializer::PrecomputedString MapFileSerializer::writePatch(const Model::BezierPatch& patch) const {
+        Model::NodeSerialization MapFileSerializer::writePatch(const Model::BezierPatch& patch) const {
             size_t lineCount = 0u;
             std::stringstream stream;
             
@@ -389,7 +405,7 @@ namespace TrenchBroom {
             fmt::format_to(std::ostreambuf_iterator<char>(stream), "}}\n"); ++lineCount;
             fmt::format_to(std::ostreambuf_iterator<char>(stream), "}}\n"); ++lineCount;
 
-            return PrecomputedString{stream.str(), lineCount};
+            return Model::NodeSerialization{m_mapFormat, stream.str(), lineCount};
         }
     }
 }
@@ -34,6 +34,7 @@ namespace TrenchBroom {
         class BrushFace;
         class EntityProperty;
         class Node;
+        struct NodeSerialization;
         class PatchNode;
     }
 
@@ -45,15 +46,14 @@ namespace TrenchBroom {
             size_t m_line;
             std::ostream& m_stream;
 
-            struct PrecomputedString {
-                std::string string;
-                size_t lineCount;
-            };
+            Model::MapFormat m_mapFormat;
+
+            using PrecomputedString = std::shared_ptr<const Model::NodeSerialization>;
             std::unordered_map<const Model::Node*, PrecomputedString> m_nodeToPrecomputedString;
         public:
             static std::unique_ptr<NodeSerializer> create(Model::MapFormat format, std::ostream& stream);
         protected:
-            explicit MapFileSerializer(std::ostream& stream);
+            MapFileSerializer(Model::MapFormat mapFormat, std::ostream& stream);
         private:
             void doBeginFile(const std::vector<const Model::Node*>& rootNodes) override;
             void doEndFile() override;
@@ -70,8 +70,8 @@ namespace TrenchBroom {
             size_t startLine();
         private: // threadsafe
             virtual void doWriteBrushFace(std::ostream& stream, const Model::BrushFace& face) const = 0;
-            PrecomputedString writeBrushFaces(const Model::Brush& brush) const;
-            PrecomputedString writePatch(const Model::BezierPatch& patch) const;
+            Model::NodeSerialization writeBrushFaces(const Model::Brush& brush) const;
+            Model::NodeSerialization writePatch(const Model::BezierPatch& patch) const;
         };
     }
 }
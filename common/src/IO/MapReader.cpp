@@ -45,16 +45,25 @@
 #include <kdl/vector_utils.h>
 
 #include <cassert>
+#include <memory>
 #include <optional>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace TrenchBroom {
     namespace IO {
+        /**
+         * The number of recorded object infos at which they are handed to the thread pool for node creation.
+         */
+        static constexpr size_t NodeCreationBatchSize = 256u;
+
         MapReader::MapReader(std::string_view str, const Model::MapFormat sourceMapFormat, const Model::MapFormat targetMapFormat) :
-        StandardMapParser(std::move(str), sourceMapFormat, targetMapFormat) {}
+        StandardMapParser(std::move(str), sourceMapFormat, targetMapFormat),
+        m_objectInfoCount(0u),
+        m_finishedNodeCreationBatchCount(0u) {}
 
         void MapReader::readEntities(const vm::bbox3& worldBounds, ParserStatus& status) {
             m_worldBounds = worldBounds;
@@ -76,31 +85,35 @@ namespace TrenchBroom {
         // implement MapParser interface
 
         void MapReader::onBeginEntity(const size_t /* line */, std::vector<Model::EntityProperty> properties, ParserStatus& /* status */) {
-            m_currentEntityInfo = m_objectInfos.size();
-            m_objectInfos.push_back(EntityInfo{std::move(properties), 0, 0});
+            m_currentEntityInfo = std::make_pair(m_objectInfoCount++, EntityInfo{std::move(properties), 0, 0});
         }
 
         void MapReader::onEndEntity(const size_t startLine, const size_t lineCount, ParserStatus& /* status */) {
             assert(m_currentEntityInfo != std::nullopt);
-            assert(std::holds_alternative<EntityInfo>(m_objectInfos[*m_currentEntityInfo]));
 
-            EntityInfo& entity = std::get<EntityInfo>(m_objectInfos[*m_currentEntityInfo]);
+            auto& [index, entity] = *m_currentEntityInfo;
             entity.startLine = startLine;
             entity.lineCount = lineCount;
+            m_objectInfos.emplace_back(index, std::move(entity));
             
             m_currentEntityInfo = std::nullopt;
         }
 
         void MapReader::onBeginBrush(const size_t /* line */, ParserStatus& /* status */) {
-            m_objectInfos.push_back(BrushInfo{{}, 0, 0, m_currentEntityInfo});
+            const auto parentIndex = m_currentEntityInfo ? std::optional<size_t>{m_currentEntityInfo->first} : std::nullopt;
+            m_objectInfos.emplace_back(m_objectInfoCount++, BrushInfo{{}, 0, 0, parentIndex});
         }
 
         void MapReader::onEndBrush(const size_t startLine, const size_t lineCount, ParserStatus& /* status */) {
-            assert(std::holds_alternative<BrushInfo>(m_objectInfos.back()));
+            assert(std::holds_alternative<BrushInfo>(m_objectInfos.back().second));
 
-            BrushInfo& brush = std::get<BrushInfo>(m_objectInfos.back());
+            BrushInfo& brush = std::get<BrushInfo>(m_objectInfos.back().second);
             brush.startLine = startLine;
             brush.lineCount = lineCount;
+
+            if (m_objectInfos.size() >= NodeCreationBatchSize) {
+                dispatchObjectInfos();
+            }
         }
 
         void MapReader::onStandardBrushFace(const size_t line, const Model::MapFormat targetMapFormat, const vm::vec3& point1, const vm::vec3& point2, const vm::vec3& point3, const Model::BrushFaceAttributes& attribs, ParserStatus& status) {
@@ -124,7 +137,12 @@ namespace TrenchBroom {
         }
 
         void MapReader::onPatch(const size_t startLine, const size_t lineCount, Model::MapFormat, const size_t rowCount, const size_t columnCount, std::vector<vm::vec<FloatType, 5>> controlPoints, std::string textureName, ParserStatus&) {
-            m_objectInfos.push_back(PatchInfo{rowCount, columnCount, std::move(controlPoints), std::move(textureName), startLine, lineCount, m_currentEntityInfo});
+            const auto parentIndex = m_currentEntityInfo ? std::optional<size_t>{m_currentEntityInfo->first} : std::nullopt;
+            m_objectInfos.emplace_back(m_objectInfoCount++, PatchInfo{rowCount, columnCount, std::move(controlPoints), std::move(textureName), startLine, lineCount, parentIndex});
+
+            if (m_objectInfos.size() >= NodeCreationBatchSize) {
+                dispatchObjectInfos();
+            }
         }
 
         // helper methods
@@ -413,7 +431,8 @@ namespace TrenchBroom {
          * Creates a brush node from the given brush info. Returns an error if the brush could not be created.
          */
         static CreateNodeResult createBrushNode(MapReader::BrushInfo brushInfo, const vm::bbox3& worldBounds) {
-            return Model::Brush::create(worldBounds, std::move(brushInfo.faces))
+            // the geometry is built when it is first needed, e.g. when the brush is rendered
+            return Model::Brush::createDeferred(worldBounds, std::move(brushInfo.faces))
                 .and_then([&](Model::Brush&& brush) {
                     auto brushNode = std::make_unique<Model::BrushNode>(std::move(brush));
                     brushNode->setFilePosition(brushInfo.startLine, brushInfo.lineCount);
@@ -446,27 +465,83 @@ namespace TrenchBroom {
         }
 
         /**
-        * Transforms the given object infos into a vector of node infos. The returned vector is sparse, that is,
-        * it contains empty optionals in place of nodes that we failed to create. We need the indices to remain
-        * correct because we use them to refer to parent nodes later.
-        */
-        static std::vector<std::optional<NodeInfo>> createNodesFromObjectInfos(std::vector<MapReader::ObjectInfo> objectInfos, const vm::bbox3& worldBounds, const Model::MapFormat mapFormat, ParserStatus& status) {
-            // create nodes in parallel, moving data out of objectInfos
-            // we store optionals in the result vector to make the elements default constructible, which is a requirement for parallel transform
-            std::vector<std::optional<CreateNodeResult>> createNodeResults = kdl::vec_parallel_transform(std::move(objectInfos), [&](auto&& objectInfo) -> std::optional<CreateNodeResult> {
-                return std::visit(kdl::overload(
-                    [&](MapReader::EntityInfo&& entityInfo) {
-                        return createNodeFromEntityInfo(std::move(entityInfo), mapFormat);
-                    },
-                    [&](MapReader::BrushInfo&& brushInfo) {
-                        return createBrushNode(std::move(brushInfo), worldBounds);
-                    },
-                    [&](MapReader::PatchInfo&& patchInfo) {
-                        return createPatchNode(std::move(patchInfo));
-                    }
-                ), std::move(objectInfo));
+         * Creates a node from the given object info.
+         */
+        static CreateNodeResult createNodeFromObjectInfo(MapReader::ObjectInfo objectInfo, const vm::bbox3& worldBounds, const Model::MapFormat mapFormat) {
+            return std::visit(kdl::overload(
+                [&](MapReader::EntityInfo&& entityInfo) {
+                    return createNodeFromEntityInfo(std::move(entityInfo), mapFormat);
+                },
+                [&](MapReader::BrushInfo&& brushInfo) {
+                    return createBrushNode(std::move(brushInfo), worldBounds);
+                },
+                [&](MapReader::PatchInfo&& patchInfo) {
+                    return createPatchNode(std::move(patchInfo));
+                }
+            ), std::move(objectInfo));
+        }
+
+        /**
+         * A batch of object infos whose nodes are created by a task on the thread pool while parsing continues.
+         */
+        struct MapReader::NodeCreationBatch {
+            std::vector<std::pair<size_t, ObjectInfo>> objectInfos;
+            // we store optionals in the results to make them default constructible, which is a requirement for parallel transform
+            std::vector<std::pair<size_t, std::optional<CreateNodeResult>>> createNodeResults;
+            // declared last so that it waits for the task before the data it refers to is destroyed
+            kdl::task_group task;
+
+            explicit NodeCreationBatch(std::vector<std::pair<size_t, ObjectInfo>> i_objectInfos) :
+            objectInfos(std::move(i_objectInfos)),
+            task(kdl::global_thread_pool()) {}
+        };
+
+        MapReader::~MapReader() = default;
+
+        /**
+         * Hands the recorded object infos to a task on the thread pool which creates their nodes while parsing continues.
+         *
+         * To keep the memory used by object infos bounded, waits for the oldest batch to finish if more batches are in
+         * flight than there are threads to process them.
+         */
+        void MapReader::dispatchObjectInfos() {
+            if (m_objectInfos.empty()) {
+                return;
+            }
+
+            auto* batch = m_nodeCreationBatches.emplace_back(std::make_unique<NodeCreationBatch>(std::move(m_objectInfos))).get();
+            m_objectInfos.clear();
+
+            batch->task.run([batch, worldBounds = m_worldBounds, mapFormat = m_targetMapFormat]() {
+                batch->createNodeResults = kdl::vec_parallel_transform(std::move(batch->objectInfos), [&](auto&& indexedObjectInfo) {
+                    auto& [index, objectInfo] = indexedObjectInfo;
+                    return std::make_pair(index, std::optional<CreateNodeResult>{createNodeFromObjectInfo(std::move(objectInfo), worldBounds, mapFormat)});
+                });
+                batch->objectInfos.clear();
             });
 
+            const auto maxPendingBatchCount = 2u * kdl::global_thread_pool().thread_count() + 1u;
+            if (m_nodeCreationBatches.size() - m_finishedNodeCreationBatchCount > maxPendingBatchCount) {
+                m_nodeCreationBatches[m_finishedNodeCreationBatchCount++]->task.wait();
+            }
+        }
+
+        /**
+        * Waits for the given node creation batches and transforms their results into a vector of node infos, ordered by the
+        * index of the object info that each node was created from. The returned vector is sparse, that is, it contains empty
+        * optionals in place of nodes that we failed to create. We need the indices to remain correct because we use them to
+        * refer to parent nodes later.
+        */
+        static std::vector<std::optional<NodeInfo>> collectNodeInfos(std::vector<std::unique_ptr<MapReader::NodeCreationBatch>> batches, const size_t objectInfoCount, ParserStatus& status) {
+            auto createNodeResults = std::vector<std::optional<CreateNodeResult>>(objectInfoCount);
+            for (auto& batch : batches) {
+                batch->task.wait();
+                for (auto& [index, createNodeResult] : batch->createNodeResults) {
+                    createNodeResults[index] = std::move(createNodeResult);
+                }
+            }
+            batches.clear();
+
             return kdl::vec_transform(std::move(createNodeResults), [&](std::optional<CreateNodeResult>&& createNodeResult) -> std::optional<NodeInfo> {
                 assert(createNodeResult.has_value());
 
@@ -628,8 +703,12 @@ namespace TrenchBroom {
          * from the `onWorldNode` callback.
          */
         void MapReader::createNodes(ParserStatus& status) {
-            // create nodes from the recorded object infos
-            auto nodeInfos = createNodesFromObjectInfos(std::move(m_objectInfos), m_worldBounds, m_targetMapFormat, status);
+            // create nodes from the remaining object infos and wait for all nodes to be created
+            dispatchObjectInfos();
+            auto nodeInfos = collectNodeInfos(std::move(m_nodeCreationBatches), m_objectInfoCount, status);
+            m_nodeCreationBatches.clear();
+            m_finishedNodeCreationBatchCount = 0u;
+            m_objectInfoCount = 0u;
 
             // call onWorldNode for the first world node, remember the default parent and clear out all other world nodes
             // the brushes belonging to redundant world nodes will be added to the default parent
@@ -688,9 +767,9 @@ namespace TrenchBroom {
          * Overridden in BrushFaceReader (which doesn't use m_brushInfos) to collect the faces directly
          */
         void MapReader::onBrushFace(Model::BrushFace face, ParserStatus& /* status */) {
-            assert(std::holds_alternative<BrushInfo>(m_objectInfos.back()));
+            assert(std::holds_alternative<BrushInfo>(m_objectInfos.back().second));
 
-            BrushInfo& brush = std::get<BrushInfo>(m_objectInfos.back());
+            BrushInfo& brush = std::get<BrushInfo>(m_objectInfos.back().second);
             brush.faces.push_back(std::move(face));
         }
     }
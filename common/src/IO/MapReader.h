@@ -31,8 +31,10 @@
 #include <vecmath/forward.h>
 #include <vecmath/bbox.h>
 
+#include <memory>
 #include <optional>
 #include <string_view>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -61,9 +63,11 @@ namespace TrenchBroom {
          *
          * The flow of control is:
          *
-         * 1. MapParser callbacks get called with the raw data, which we just store (m_objectInfos).
-         * 2. Convert the raw data to nodes in parallel (createNodes) and record any additional information
-         *    necessary to restore the parent / child relationships.
+         * 1. MapParser callbacks get called with the raw data, which we store (m_objectInfos). Whenever enough raw
+         *    data has been recorded, it is handed to the thread pool, which converts it to nodes while parsing
+         *    continues (dispatchObjectInfos). We also record any additional information necessary to restore the
+         *    parent / child relationships.
+         * 2. Wait until all nodes have been created (createNodes).
          * 3. Validate the created nodes.
          * 4. Post process the nodes to find the correct parent nodes (createNodes).
          * 5. Call the appropriate callbacks (onWorldspawn, onLayer, ...).
@@ -94,11 +98,21 @@ namespace TrenchBroom {
             };
 
             using ObjectInfo = std::variant<EntityInfo, BrushInfo, PatchInfo>;
+
+            struct NodeCreationBatch;
         private:
             vm::bbox3 m_worldBounds;
         private: // data populated in response to MapParser callbacks
-            std::vector<ObjectInfo> m_objectInfos;
-            std::optional<size_t> m_currentEntityInfo;
+            /**
+             * Object infos that have not yet been handed to the thread pool, each with its index in the order in which
+             * the objects were parsed. An entity info is only recorded here once the entity has been parsed completely.
+             */
+            std::vector<std::pair<size_t, ObjectInfo>> m_objectInfos;
+            size_t m_objectInfoCount;
+            std::optional<std::pair<size_t, EntityInfo>> m_currentEntityInfo;
+
+            std::vector<std::unique_ptr<NodeCreationBatch>> m_nodeCreationBatches;
+            size_t m_finishedNodeCreationBatchCount;
         protected:
             /**
              * Creates a new reader where the given string is expected to be formatted in the given source map format,
@@ -109,7 +123,9 @@ namespace TrenchBroom {
              * @param targetMapFormat the format to convert the created objects to
              */
             MapReader(std::string_view str, Model::MapFormat sourceMapFormat, Model::MapFormat targetMapFormat);
-
+        public:
+            ~MapReader() override;
+        protected:
             /**
              * Attempts to parse as one or more entities.
              *
@@ -137,6 +153,7 @@ namespace TrenchBroom {
             void onValveBrushFace(size_t line, Model::MapFormat targetMapFormat, const vm::vec3& point1, const vm::vec3& point2, const vm::vec3& point3, const Model::BrushFaceAttributes& attribs, const vm::vec3& texAxisX, const vm::vec3& texAxisY, ParserStatus& status) override;
             void onPatch(size_t startLine, size_t lineCount, Model::MapFormat targetMapFormat, size_t rowCount, size_t columnCount, std::vector<vm::vec<FloatType, 5>> controlPoints, std::string textureName, ParserStatus& status) override;
         private: // helper methods
+            void dispatchObjectInfos();
             void createNodes(ParserStatus& status);
         private: // subclassing interface - these will be called in the order that nodes should be inserted
             /**
@@ -43,7 +43,8 @@ namespace TrenchBroom {
         NodeSerializer::NodeSerializer() :
         m_entityNo(0),
         m_brushNo(0),
-        m_exporting(false) {}
+        m_exporting(false),
+        m_reusedSerializationCount(0) {}
 
         NodeSerializer::~NodeSerializer() = default;
 
@@ -63,6 +64,14 @@ namespace TrenchBroom {
             m_exporting = exporting;
         }
 
+        size_t NodeSerializer::reusedSerializationCount() const {
+            return m_reusedSerializationCount;
+        }
+
+        void NodeSerializer::setReusedSerializationCount(const size_t reusedSerializationCount) {
+            m_reusedSerializationCount = reusedSerializationCount;
+        }
+
         void NodeSerializer::beginFile(const std::vector<const Model::Node*>& rootNodes) {
             m_entityNo = 0;
             m_brushNo = 0;
@@ -61,6 +61,7 @@ namespace TrenchBroom {
             ObjectNo m_brushNo;
 
             bool m_exporting;
+            size_t m_reusedSerializationCount;
         public:
             NodeSerializer();
             virtual ~NodeSerializer();
@@ -70,6 +71,13 @@ namespace TrenchBroom {
         public:
             bool exporting() const;
             void setExporting(bool exporting);
+
+            /**
+             * Returns the number of brushes and patches whose cached serialization was reused when the file was written.
+             */
+            size_t reusedSerializationCount() const;
+        protected:
+            void setReusedSerializationCount(size_t reusedSerializationCount);
         public:
             /**
              * Prepares to serialize the given nodes and all of their children.
@@ -86,11 +86,12 @@ namespace TrenchBroom {
             m_serializer->setExporting(exporting);
         }
 
-        void NodeWriter::writeMap() {
+        size_t NodeWriter::writeMap() {
             m_serializer->beginFile({&m_world});
             writeDefaultLayer();
             writeCustomLayers();
             m_serializer->endFile();
+            return m_serializer->reusedSerializationCount();
         }
 
         void NodeWriter::writeDefaultLayer() {
@@ -49,7 +49,11 @@ namespace TrenchBroom {
             ~NodeWriter();
 
             void setExporting(bool exporting);
-            void writeMap();
+
+            /**
+             * Writes the map and returns the number of brushes and patches whose cached serialization was reused.
+             */
+            size_t writeMap();
         private:
             void writeDefaultLayer();
             void writeCustomLayers();
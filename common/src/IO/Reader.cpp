@@ -26,6 +26,7 @@
 #include <cerrno>
 #include <cstring>
 #include <functional>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -70,12 +71,14 @@ namespace TrenchBroom {
             return doBuffer();
         }
 
-        Reader::FileSource::FileSource(std::FILE* file, const size_t offset, const size_t length) :
+        Reader::FileSource::FileSource(std::FILE* file, std::mutex& fileMutex, const size_t offset, const size_t length) :
         m_file(file),
+        m_fileMutex(fileMutex),
         m_offset(offset),
         m_length(length),
         m_position(0) {
             assert(m_file != nullptr);
+            const auto lock = std::lock_guard<std::mutex>{m_fileMutex};
             std::rewind(m_file);
         }
 
@@ -89,9 +92,8 @@ namespace TrenchBroom {
         }
 
         void Reader::FileSource::doRead(char* val, const size_t size) {
-            // We might consider removing this check under the assumption that the file position is set in the constructor
-            // of this reader and that no other reader will access the file while this reader is in use. This may be a
-            // reasonable assumption, since we usually read files one by one.
+            // Other readers may have accessed the file since this reader was last used, so we must check the position.
+            const auto lock = std::lock_guard<std::mutex>{m_fileMutex};
 
             const auto pos = std::ftell(m_file);
             if (pos < 0) {
@@ -113,10 +115,11 @@ namespace TrenchBroom {
         }
 
         std::unique_ptr<Reader::Source> Reader::FileSource::doGetSubSource(const size_t position, const size_t length) const {
-            return std::make_unique<FileSource>(m_file, m_offset + position, length);
+            return std::make_unique<FileSource>(m_file, m_fileMutex, m_offset + position, length);
         }
 
         std::tuple<const char*, const char*, std::unique_ptr<char[]>> Reader::FileSource::doBuffer() const {
+            const auto lock = std::lock_guard<std::mutex>{m_fileMutex};
             std::fseek(m_file, static_cast<long>(m_offset), SEEK_SET);
 
             auto buffer = std::make_unique<char[]>(m_length);
@@ -189,8 +192,8 @@ namespace TrenchBroom {
 
         Reader::~Reader() = default;
 
-        Reader Reader::from(std::FILE* file) {
-            return Reader(std::make_unique<FileSource>(file, 0, fileSize(file)));
+        Reader Reader::from(std::FILE* file, std::mutex& fileMutex) {
+            return Reader(std::make_unique<FileSource>(file, fileMutex, 0, fileSize(file)));
         }
 
         Reader Reader::from(const char* begin, const char* end) {
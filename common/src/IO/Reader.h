@@ -23,6 +23,7 @@
 
 #include <cstdio>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <string_view>
 
@@ -123,11 +124,14 @@ namespace TrenchBroom {
             /**
              * A reader source that reads directly from a file. Note that the seek position of the underlying C file
              * is kept in sync with this file source's position automatically, that is, two readers can read from the
-             * same underlying file without causing problems.
+             * same underlying file without causing problems. Every file position change and the subsequent read are
+             * done while holding the given mutex, so readers of the same file can be used on multiple threads if they
+             * share the mutex.
              */
             class FileSource : public Source {
             private:
                 std::FILE* m_file;
+                std::mutex& m_fileMutex;
                 size_t m_offset;
                 size_t m_length;
                 size_t m_position;
@@ -136,10 +140,11 @@ namespace TrenchBroom {
                  * Creates a new reader source for the given underlying file at the given offset and length.
                  *
                  * @param file the file
+                 * @param fileMutex the mutex that guards the file position of the given file
                  * @param offset the offset into the file at which this reader source should begin
                  * @param length the length of this reader source
                  */
-                FileSource(std::FILE* file, size_t offset, size_t length);
+                FileSource(std::FILE* file, std::mutex& fileMutex, size_t offset, size_t length);
             private:
                 size_t doGetSize() const override;
                 size_t doGetPosition() const override;
@@ -203,14 +208,16 @@ namespace TrenchBroom {
             virtual ~Reader();
         public:
             /**
-             * Creates a new reader that reads from the given file.
+             * Creates a new reader that reads from the given file. All readers of the same file must be given the same
+             * mutex, and the mutex must outlive the reader.
              *
              * @param file the file to read from
+             * @param fileMutex the mutex that guards the file position of the given file
              * @return the reader
              *
              * @throw ReaderException if the reader cannot be created
              */
-            static Reader from(std::FILE* file);
+            static Reader from(std::FILE* file, std::mutex& fileMutex);
             /**
              * Creates a new reader that reads from the given memory region.
              *
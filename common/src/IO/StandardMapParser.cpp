@@ -34,11 +34,6 @@
 
 namespace TrenchBroom {
     namespace IO {
-        const std::string& QuakeMapTokenizer::NumberDelim() {
-            static const std::string numberDelim(Whitespace() + ")");
-            return numberDelim;
-        }
-
         QuakeMapTokenizer::QuakeMapTokenizer(std::string_view str) :
         Tokenizer(std::move(str), "\"", '\\'),
         m_skipEol(true) {}
@@ -109,24 +104,23 @@ namespace TrenchBroom {
                         switchFallthrough();
                     case ' ':
                     case '\t':
-                        discardWhile(Whitespace());
+                        discardWhitespace();
                         break;
-                    default: { // whitespace, integer, decimal or word
-                        const auto* e = readInteger(NumberDelim());
-                        if (e != nullptr) {
+                    default: { // integer, decimal or word
+                        // find the end of the token first and classify it afterwards, so that every character is only
+                        // looked at once or twice
+                        const auto* e = findNumberEnd(c);
+                        if (isInteger(c, e)) {
+                            advanceInLine(static_cast<size_t>(e - c));
                             return Token(QuakeMapToken::Integer, c, e, offset(c), startLine, startColumn);
                         }
-
-                        e = readDecimal(NumberDelim());
-                        if (e != nullptr) {
+                        if (isDecimal(c, e)) {
+                            advanceInLine(static_cast<size_t>(e - c));
                             return Token(QuakeMapToken::Decimal, c, e, offset(c), startLine, startColumn);
                         }
 
-                        e = readUntil(Whitespace());
-                        if (e == nullptr) {
-                            throw ParserException(startLine, startColumn, "Unexpected character: " + std::string(c, 1));
-                        }
-
+                        e = findWordEnd(e);
+                        advanceInLine(static_cast<size_t>(e - c));
                         return Token(QuakeMapToken::String, c, e, offset(c), startLine, startColumn);
                     }
                 }
@@ -134,6 +128,75 @@ namespace TrenchBroom {
             return Token(QuakeMapToken::Eof, nullptr, nullptr, length(), line(), column());
         }
 
+        static bool isWhitespaceChar(const char c) {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+        }
+
+        /**
+         * Returns the position of the next whitespace or closing parenthesis, either of which ends a number.
+         */
+        const char* QuakeMapTokenizer::findNumberEnd(const char* c) const {
+            while (c < m_end && !isWhitespaceChar(*c) && *c != ')') {
+                ++c;
+            }
+            return c;
+        }
+
+        const char* QuakeMapTokenizer::findWordEnd(const char* c) const {
+            while (c < m_end && !isWhitespaceChar(*c)) {
+                ++c;
+            }
+            return c;
+        }
+
+        /**
+         * Accepts the same tokens as Tokenizer::readInteger: an optional sign followed by any number of digits.
+         */
+        bool QuakeMapTokenizer::isInteger(const char* c, const char* e) const {
+            if (c == e || (*c != '+' && *c != '-' && !isDigit(*c))) {
+                return false;
+            }
+
+            ++c;
+            while (c < e && isDigit(*c)) {
+                ++c;
+            }
+            return c == e;
+        }
+
+        /**
+         * Accepts the same tokens as Tokenizer::readDecimal: an optional sign or leading digit, an optional fractional
+         * part and an optional exponent, each of which may have no digits.
+         */
+        bool QuakeMapTokenizer::isDecimal(const char* c, const char* e) const {
+            if (c == e || (*c != '+' && *c != '-' && *c != '.' && !isDigit(*c))) {
+                return false;
+            }
+
+            const auto skipDigits = [&]() {
+                while (c < e && isDigit(*c)) {
+                    ++c;
+                }
+            };
+
+            if (*c != '.') {
+                ++c;
+                skipDigits();
+            }
+            if (c < e && *c == '.') {
+                ++c;
+                skipDigits();
+            }
+            if (c < e && *c == 'e') {
+                ++c;
+                if (c < e && (*c == '+' || *c == '-' || isDigit(*c))) {
+                    ++c;
+                    skipDigits();
+                }
+            }
+            return c == e;
+        }
+
         const std::string StandardMapParser::BrushPrimitiveId = "brushDef";
         const std::string StandardMapParser::PatchId = "patchDef2";
 
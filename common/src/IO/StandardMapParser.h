@@ -56,7 +56,6 @@ namespace TrenchBroom {
 
         class QuakeMapTokenizer : public Tokenizer<QuakeMapToken::Type> {
         private:
-            static const std::string& NumberDelim();
             bool m_skipEol;
         public:
             explicit QuakeMapTokenizer(std::string_view str);
@@ -64,6 +63,11 @@ namespace TrenchBroom {
             void setSkipEol(bool skipEol);
         private:
             Token emitToken() override;
+
+            const char* findNumberEnd(const char* c) const;
+            const char* findWordEnd(const char* c) const;
+            bool isInteger(const char* c, const char* e) const;
+            bool isDecimal(const char* c, const char* e) const;
         };
 
         class StandardMapParser : public MapParser, public Parser<QuakeMapToken::Type> {
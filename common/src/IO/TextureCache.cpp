@@ -0,0 +1,367 @@
+/*
+ Copyright (C) 2021 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TextureCache.h"
+
+#include "Color.h"
+#include "Exceptions.h"
+#include "Assets/Texture.h"
+#include "Assets/TextureBuffer.h"
+#include "IO/DiskIO.h"
+#include "IO/File.h"
+#include "IO/IOUtils.h"
+#include "IO/Reader.h"
+#include "IO/ReaderException.h"
+
+#include <kdl/parallel.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace IO {
+        namespace TextureCacheLayout {
+            static const std::string Magic = "TBTC";
+            // increment when the layout changes or when a texture reader decodes textures differently
+            static const std::uint32_t Version = 2;
+            static const std::string FileExtension = "texcache";
+
+            // upper bounds for the values read from a cache file, which may be corrupt or truncated
+            static const size_t MaxStringLength = 4096u;
+            static const size_t MaxTextureSize = 16384u;
+            static const size_t MaxBufferCount = 32u;
+            static const size_t MaxBytesPerPixel = 4u;
+        }
+
+        /**
+         * Returns the FNV-1a hash of the given string, which, unlike std::hash, is the same on every platform.
+         */
+        static std::uint64_t stableHash(const std::string& str) {
+            auto result = std::uint64_t(14695981039346656037u);
+            for (const auto c : str) {
+                result ^= static_cast<std::uint64_t>(static_cast<unsigned char>(c));
+                result *= std::uint64_t(1099511628211u);
+            }
+            return result;
+        }
+
+        static Path cacheFilePath(const Path& cacheDirectory, const std::string& collectionKey) {
+            return cacheDirectory + Path(TextureCache::fingerprint(collectionKey)).addExtension(TextureCacheLayout::FileExtension);
+        }
+
+        static std::string indexKey(const Path& sourcePath, const Path& entryPath, const std::int64_t modificationTime) {
+            return sourcePath.asString() + "\n" + entryPath.asString() + "\n" + std::to_string(modificationTime);
+        }
+
+        /**
+         * Reads a count of elements that occupy at least the given number of bytes each and checks it against the
+         * given maximum and the number of bytes that remain in the given reader.
+         *
+         * @throw ReaderException if the count is out of bounds
+         */
+        template <typename T>
+        static size_t readCount(Reader& reader, const size_t minElementSize, const size_t maxCount) {
+            const auto count = reader.readSize<T>();
+            if (count > maxCount || !reader.canRead(count * minElementSize)) {
+                throw ReaderException("Invalid count " + std::to_string(count) + " in texture cache file");
+            }
+            return count;
+        }
+
+        static std::string readString(Reader& reader) {
+            const auto size = readCount<std::uint32_t>(reader, 1u, TextureCacheLayout::MaxStringLength);
+            return reader.readString(size);
+        }
+
+        template <typename T>
+        static void write(std::ostream& stream, const T value) {
+            stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        static void writeString(std::ostream& stream, const std::string& str) {
+            write(stream, static_cast<std::uint32_t>(str.size()));
+            stream.write(str.data(), static_cast<std::streamsize>(str.size()));
+        }
+
+        static Assets::Texture readTexture(Reader& reader) {
+            const auto name = readString(reader);
+            const auto absolutePath = Path(readString(reader));
+            const auto relativePath = Path(readString(reader));
+            const auto width = reader.readSize<std::uint32_t>();
+            const auto height = reader.readSize<std::uint32_t>();
+            if (width > TextureCacheLayout::MaxTextureSize || height > TextureCacheLayout::MaxTextureSize) {
+                throw ReaderException("Invalid texture size " + std::to_string(width) + "x" + std::to_string(height) + " in texture cache file");
+            }
+
+            const auto r = reader.readFloat<float>();
+            const auto g = reader.readFloat<float>();
+            const auto b = reader.readFloat<float>();
+            const auto a = reader.readFloat<float>();
+            const auto format = static_cast<GLenum>(reader.readUnsignedInt<std::uint32_t>());
+            const auto type = static_cast<Assets::TextureType>(reader.readUnsignedInt<std::uint32_t>());
+            const auto culling = static_cast<Assets::TextureCulling>(reader.readUnsignedInt<std::uint32_t>());
+            const auto blendEnable = static_cast<Assets::TextureBlendFunc::Enable>(reader.readUnsignedInt<std::uint32_t>());
+            const auto srcFactor = static_cast<GLenum>(reader.readUnsignedInt<std::uint32_t>());
+            const auto destFactor = static_cast<GLenum>(reader.readUnsignedInt<std::uint32_t>());
+
+            auto surfaceParms = std::set<std::string>{};
+            const auto surfaceParmCount = readCount<std::uint32_t>(reader, sizeof(std::uint32_t), reader.size());
+            for (size_t i = 0; i < surfaceParmCount; ++i) {
+                surfaceParms.insert(readString(reader));
+            }
+
+            auto buffers = Assets::TextureBufferList{};
+            const auto bufferCount = readCount<std::uint32_t>(reader, sizeof(std::uint64_t), TextureCacheLayout::MaxBufferCount);
+            for (size_t i = 0; i < bufferCount; ++i) {
+                const auto size = readCount<std::uint64_t>(reader, 1u, width * height * TextureCacheLayout::MaxBytesPerPixel);
+                auto& buffer = buffers.emplace_back(size);
+                reader.read(buffer.data(), size);
+            }
+
+            auto texture = buffers.empty()
+                ? Assets::Texture(name, width, height, format, type)
+                : Assets::Texture(name, width, height, Color(r, g, b, a), std::move(buffers), format, type);
+            texture.setAbsolutePath(absolutePath);
+            texture.setRelativePath(relativePath);
+            texture.setSurfaceParms(surfaceParms);
+            texture.setCulling(culling);
+            switch (blendEnable) {
+                case Assets::TextureBlendFunc::Enable::UseFactors:
+                    texture.setBlendFunc(srcFactor, destFactor);
+                    break;
+                case Assets::TextureBlendFunc::Enable::DisableBlend:
+                    texture.disableBlend();
+                    break;
+                case Assets::TextureBlendFunc::Enable::UseDefault:
+                    break;
+            }
+            return texture;
+        }
+
+        static void writeTexture(std::ostream& stream, const Assets::Texture& texture) {
+            writeString(stream, texture.name());
+            writeString(stream, texture.absolutePath().asString());
+            writeString(stream, texture.relativePath().asString());
+            write(stream, static_cast<std::uint32_t>(texture.width()));
+            write(stream, static_cast<std::uint32_t>(texture.height()));
+            write(stream, texture.averageColor().r());
+            write(stream, texture.averageColor().g());
+            write(stream, texture.averageColor().b());
+            write(stream, texture.averageColor().a());
+            write(stream, static_cast<std::uint32_t>(texture.format()));
+            write(stream, static_cast<std::uint32_t>(texture.type()));
+            write(stream, static_cast<std::uint32_t>(texture.culling()));
+            write(stream, static_cast<std::uint32_t>(texture.blendFunc().enable));
+            write(stream, static_cast<std::uint32_t>(texture.blendFunc().srcFactor));
+            write(stream, static_cast<std::uint32_t>(texture.blendFunc().destFactor));
+
+            write(stream, static_cast<std::uint32_t>(texture.surfaceParms().size()));
+            for (const auto& surfaceParm : texture.surfaceParms()) {
+                writeString(stream, surfaceParm);
+            }
+
+            write(stream, static_cast<std::uint32_t>(texture.buffersIfUnprepared().size()));
+            for (const auto& buffer : texture.buffersIfUnprepared()) {
+                write(stream, static_cast<std::uint64_t>(buffer.size()));
+                stream.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+            }
+        }
+
+        namespace {
+            /**
+             * The cache files that are being written on background threads, by path. Destroying this at exit waits
+             * for the pending writes.
+             */
+            struct PendingStores {
+                std::mutex mutex;
+                std::unordered_map<std::string, std::shared_future<void>> stores;
+            };
+
+            PendingStores& pendingStores() {
+                static auto instance = PendingStores{};
+                return instance;
+            }
+
+            std::shared_future<void> pendingStore(const Path& cacheFilePath) {
+                auto& pending = pendingStores();
+                const auto lock = std::lock_guard<std::mutex>{pending.mutex};
+                const auto it = pending.stores.find(cacheFilePath.asString());
+                return it != std::end(pending.stores) ? it->second : std::shared_future<void>{};
+            }
+        }
+
+        TextureCache::TextureCache(const Path& cacheDirectory, std::string collectionKey) :
+        m_cacheFilePath(cacheFilePath(cacheDirectory, collectionKey)),
+        m_collectionKey(std::move(collectionKey)) {
+            if (const auto store = pendingStore(m_cacheFilePath); store.valid()) {
+                try {
+                    store.get();
+                } catch (const std::exception& e) {
+                    m_storeError = e.what();
+                }
+            }
+            readIndex();
+        }
+
+        std::string TextureCache::fingerprint(const std::string& data) {
+            char result[17];
+            std::snprintf(result, sizeof(result), "%016llx", static_cast<unsigned long long>(stableHash(data)));
+            return result;
+        }
+
+        std::optional<TextureCache::Key> TextureCache::makeKey(const Path& sourcePath, const Path& entryPath) {
+            try {
+                return Key{sourcePath, entryPath, Disk::fileModificationTime(sourcePath)};
+            } catch (const Exception&) {
+                return std::nullopt;
+            }
+        }
+
+        size_t TextureCache::size() const {
+            return m_entries.size();
+        }
+
+        const std::optional<std::string>& TextureCache::storeError() const {
+            return m_storeError;
+        }
+
+        std::optional<Assets::Texture> TextureCache::find(const Key& key) const {
+            const auto it = m_entries.find(indexKey(key.sourcePath, key.entryPath, key.modificationTime));
+            if (it == std::end(m_entries)) {
+                return std::nullopt;
+            }
+
+            try {
+                // the sub reader keeps a corrupt entry from reading into the next one
+                const auto& [offset, size] = it->second;
+                auto reader = m_file->reader().subReaderFromBegin(offset, size);
+                return readTexture(reader);
+            } catch (const std::exception&) {
+                // a corrupt cache file is replaced when the collection is stored again
+                return std::nullopt;
+            }
+        }
+
+        std::shared_future<void> TextureCache::store(const std::vector<std::pair<Key, const Assets::Texture*>>& textures) {
+            // the cache file cannot be replaced while it is mapped into memory on some platforms
+            m_file.reset();
+            m_entries.clear();
+
+            // the textures may be prepared once this function returns, so they are serialized right away
+            auto entries = std::vector<std::string>(textures.size());
+            kdl::parallel_for(textures.size(), [&](const size_t i) {
+                const auto& [key, texture] = textures[i];
+
+                // every texture is serialized separately so that its size can be stored in front of it
+                auto textureStream = std::ostringstream{std::ios::out | std::ios::binary};
+                writeTexture(textureStream, *texture);
+                const auto textureData = textureStream.str();
+
+                auto entryStream = std::ostringstream{std::ios::out | std::ios::binary};
+                writeString(entryStream, key.sourcePath.asString());
+                writeString(entryStream, key.entryPath.asString());
+                write(entryStream, static_cast<std::int64_t>(key.modificationTime));
+                write(entryStream, static_cast<std::uint64_t>(textureData.size()));
+                entryStream.write(textureData.data(), static_cast<std::streamsize>(textureData.size()));
+                entries[i] = entryStream.str();
+            });
+
+            auto& pending = pendingStores();
+            const auto lock = std::lock_guard<std::mutex>{pending.mutex};
+            auto& store = pending.stores[m_cacheFilePath.asString()];
+
+            // a previous store of the same cache file must finish first since both write the same temporary file
+            store = std::async(std::launch::async, [previousStore = store, cacheFilePath = m_cacheFilePath, collectionKey = m_collectionKey, entries = std::move(entries)]() mutable {
+                // the shared state of this task outlives it, so the entries are released when it finishes
+                const auto entriesToWrite = std::move(entries);
+                if (previousStore.valid()) {
+                    previousStore.wait();
+                }
+
+                Disk::ensureDirectoryExists(cacheFilePath.deleteLastComponent());
+
+                const auto tmpPath = cacheFilePath.addExtension("tmp");
+                {
+                    auto stream = openPathAsOutputStream(tmpPath, std::ios::out | std::ios::binary | std::ios::trunc);
+                    if (!stream.is_open()) {
+                        throw FileSystemException("Could not open texture cache file '" + tmpPath.asString() + "' for writing");
+                    }
+
+                    stream.write(TextureCacheLayout::Magic.data(), static_cast<std::streamsize>(TextureCacheLayout::Magic.size()));
+                    write(stream, TextureCacheLayout::Version);
+                    writeString(stream, collectionKey);
+                    write(stream, static_cast<std::uint32_t>(entriesToWrite.size()));
+                    for (const auto& entry : entriesToWrite) {
+                        stream.write(entry.data(), static_cast<std::streamsize>(entry.size()));
+                    }
+
+                    if (!stream) {
+                        throw FileSystemException("Could not write texture cache file '" + tmpPath.asString() + "'");
+                    }
+                }
+
+                Disk::moveFile(tmpPath, cacheFilePath, true);
+            }).share();
+
+            return store;
+        }
+
+        void TextureCache::readIndex() {
+            try {
+                if (!Disk::fileExists(m_cacheFilePath)) {
+                    return;
+                }
+
+                m_file = Disk::openMappedFile(m_cacheFilePath);
+
+                auto reader = m_file->reader();
+                if (reader.readString(TextureCacheLayout::Magic.size()) != TextureCacheLayout::Magic
+                    || reader.readUnsignedInt<std::uint32_t>() != TextureCacheLayout::Version
+                    || readString(reader) != m_collectionKey) {
+                    m_file.reset();
+                    return;
+                }
+
+                // every entry stores at least the lengths of its paths, its modification time and its size
+                const auto count = readCount<std::uint32_t>(reader, 2u * sizeof(std::uint32_t) + sizeof(std::int64_t) + sizeof(std::uint64_t), reader.size());
+                for (size_t i = 0; i < count; ++i) {
+                    const auto sourcePath = Path(readString(reader));
+                    const auto entryPath = Path(readString(reader));
+                    const auto modificationTime = reader.read<std::int64_t, std::int64_t>();
+                    const auto size = readCount<std::uint64_t>(reader, 1u, reader.size());
+
+                    m_entries.emplace(indexKey(sourcePath, entryPath, modificationTime), std::make_pair(reader.position(), size));
+                    reader.seekForward(size);
+                }
+            } catch (const std::exception&) {
+                // a corrupt cache file is replaced when the collection is stored again
+                m_file.reset();
+                m_entries.clear();
+            }
+        }
+    }
+}
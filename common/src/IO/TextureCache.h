@@ -0,0 +1,131 @@
+/*
+ Copyright (C) 2021 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "IO/Path.h"
+
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Assets {
+        class Texture;
+    }
+
+    namespace IO {
+        class File;
+
+        /**
+         * A persistent cache of decoded textures.
+         *
+         * The decoded textures of a texture collection are stored in a single cache file, which is mapped into memory
+         * when the collection is loaded again. A cached texture contains its mip buffers and all of its metadata, so
+         * reading it only copies its mip buffers out of the mapped file.
+         *
+         * Every cached texture is stored under the path of the file it was read from, its entry in that file and the
+         * modification time of that file. A texture whose file has changed is therefore no longer found and must be
+         * decoded again. Textures that were not read from a file on disk, e.g. from a pak archive in a directory
+         * collection, cannot be cached.
+         *
+         * Cache files are written on a background thread so that loading a collection doesn't wait for the disk.
+         */
+        class TextureCache {
+        public:
+            struct Key {
+                /**
+                 * The absolute path of the file on disk that contains the texture.
+                 */
+                Path sourcePath;
+                /**
+                 * The path of the texture in the source file if the source file is an archive, or an empty path.
+                 */
+                Path entryPath;
+                std::int64_t modificationTime;
+            };
+        private:
+            Path m_cacheFilePath;
+            std::string m_collectionKey;
+            std::shared_ptr<File> m_file;
+            /**
+             * Maps the index key of each cached texture to the offset and size of its data in the cache file.
+             */
+            std::unordered_map<std::string, std::pair<size_t, size_t>> m_entries;
+            std::optional<std::string> m_storeError;
+        public:
+            /**
+             * Opens the cache file for the collection with the given key in the given directory. The collection key
+             * must identify the collection and every setting that affects how its textures are decoded, e.g. the
+             * palette. If the cache file does not exist or cannot be read, the cache is empty.
+             *
+             * If the cache file is still being written by a previous call to `store`, this waits until it is written.
+             */
+            TextureCache(const Path& cacheDirectory, std::string collectionKey);
+
+            /**
+             * Returns a short string that identifies the given data, such as a palette, for use in collection keys.
+             * The result is the same on every platform.
+             */
+            static std::string fingerprint(const std::string& data);
+
+            /**
+             * Returns a key for the given source file and entry, or an empty optional if the source file does not
+             * exist on disk.
+             */
+            static std::optional<Key> makeKey(const Path& sourcePath, const Path& entryPath);
+
+            /**
+             * Returns the number of cached textures.
+             */
+            size_t size() const;
+
+            /**
+             * Returns the error that occurred when the cache file was last written by `store`, if any.
+             */
+            const std::optional<std::string>& storeError() const;
+
+            /**
+             * Returns a copy of the texture with the given key, or an empty optional if there is no such texture or if
+             * it cannot be read because the cache file is corrupt. This function can be called from multiple threads
+             * concurrently.
+             */
+            std::optional<Assets::Texture> find(const Key& key) const;
+
+            /**
+             * Replaces the contents of the cache file with the given textures, which must not have been prepared yet.
+             *
+             * The textures are serialized before this function returns, but written on a background thread. They are
+             * written to a temporary file first, which then replaces the cache file. This cache is empty afterwards
+             * since it releases the cache file before it is replaced.
+             *
+             * @return a future that becomes ready when the cache file is written and throws FileSystemException if it
+             * cannot be written
+             */
+            std::shared_future<void> store(const std::vector<std::pair<Key, const Assets::Texture*>>& textures);
+        private:
+            void readIndex();
+        };
+    }
+}
@@ -19,23 +19,111 @@
 
 #include "TextureCollectionLoader.h"
 
+#include "Exceptions.h"
 #include "Logger.h"
 #include "Assets/TextureCollection.h"
 #include "IO/DiskIO.h"
 #include "IO/File.h"
 #include "IO/FileMatcher.h"
 #include "IO/FileSystem.h"
+#include "IO/TextureCache.h"
 #include "IO/TextureReader.h"
 #include "IO/WadFileSystem.h"
 
+#include <kdl/parallel.h>
+#include <kdl/vector_utils.h>
+
+#include <atomic>
 #include <memory>
+#include <optional>
+#include <utility>
 #include <vector>
 
 namespace TrenchBroom {
     namespace IO {
-        TextureCollectionLoader::TextureCollectionLoader(Logger& logger, const std::vector<std::string>& exclusions) :
+        /**
+         * Calls the given lambda for every texture path in parallel and returns the textures it returned in path order.
+         *
+         * The lambda opens and decodes the texture at the given path. Since every task opens its own file, no more files
+         * are open at once than there are worker threads. The messages logged by the tasks and the errors they throw are
+         * logged in path order.
+         *
+         * If a cache is given, the textures for which the given key function returns a key are taken from the cache if
+         * possible. If any of these textures was decoded successfully, the cache is updated with all of them afterwards.
+         * The cache file is written in the background.
+         */
+        template <typename K, typename L>
+        static std::vector<Assets::Texture> readTexturesInParallel(Logger& logger, std::optional<TextureCache>& cache, const std::vector<Path>& texturePaths, K cacheKey, L readTexture) {
+            auto results = std::vector<std::optional<Assets::Texture>>(texturePaths.size());
+            auto cacheKeys = std::vector<std::optional<TextureCache::Key>>(texturePaths.size());
+            auto messages = std::vector<Logger::DeferredMessageList>(texturePaths.size());
+            auto cacheHits = std::atomic<size_t>{0u};
+            auto cacheableTexturesDecoded = std::atomic<size_t>{0u};
+
+            kdl::parallel_for(texturePaths.size(), [&](const size_t index) {
+                const Logger::DeferMessages deferMessages(messages[index]);
+                try {
+                    if (cache) {
+                        cacheKeys[index] = cacheKey(texturePaths[index]);
+                        if (cacheKeys[index]) {
+                            if (auto texture = cache->find(*cacheKeys[index])) {
+                                results[index] = std::move(texture);
+                                ++cacheHits;
+                                return;
+                            }
+                        }
+                    }
+                    results[index] = readTexture(texturePaths[index]);
+                    if (cacheKeys[index]) {
+                        ++cacheableTexturesDecoded;
+                    }
+                } catch (const std::exception& e) {
+                    logger.warn() << e.what();
+                }
+            });
+
+            for (const auto& messageList : messages) {
+                for (const auto& message : messageList) {
+                    logger.log(message.level, message.str);
+                }
+            }
+
+            if (cache) {
+                if (const auto& storeError = cache->storeError()) {
+                    logger.warn() << "Could not update texture cache: " << *storeError;
+                }
+
+                logger.info() << "Read " << cacheHits.load() << " of " << texturePaths.size() << " textures from texture cache";
+                if (cacheableTexturesDecoded > 0u) {
+                    auto texturesToCache = std::vector<std::pair<TextureCache::Key, const Assets::Texture*>>();
+                    for (size_t i = 0; i < texturePaths.size(); ++i) {
+                        if (cacheKeys[i] && results[i]) {
+                            texturesToCache.emplace_back(*cacheKeys[i], &*results[i]);
+                        }
+                    }
+
+                    // errors are reported when the collection is loaded again
+                    cache->store(texturesToCache);
+                }
+            }
+
+            auto textures = std::vector<Assets::Texture>();
+            textures.reserve(texturePaths.size());
+
+            for (auto& result : results) {
+                if (result) {
+                    textures.push_back(std::move(*result));
+                }
+            }
+
+            return textures;
+        }
+
+        TextureCollectionLoader::TextureCollectionLoader(Logger& logger, const std::vector<std::string>& exclusions, const Path& cacheDirectory, const std::string& cacheKey) :
         m_logger(logger),
-        m_textureExclusions(exclusions) {}
+        m_textureExclusions(exclusions),
+        m_cacheDirectory(cacheDirectory),
+        m_cacheKey(cacheKey) {}
 
         TextureCollectionLoader::~TextureCollectionLoader() = default;
 
@@ -48,68 +136,77 @@ namespace TrenchBroom {
             return false;
         }
 
-        FileTextureCollectionLoader::FileTextureCollectionLoader(Logger& logger, const std::vector<IO::Path>& searchPaths, const std::vector<std::string>& exclusions) :
-        TextureCollectionLoader(logger, exclusions),
+        std::vector<Path> TextureCollectionLoader::removeExcludedTextures(std::vector<Path> texturePaths) {
+            return kdl::vec_filter(std::move(texturePaths), [&](const Path& texturePath) {
+                return !shouldExclude(texturePath.lastComponent().deleteExtension().asString());
+            });
+        }
+
+        std::optional<TextureCache> TextureCollectionLoader::openCache(const Path& collectionPath) const {
+            if (m_cacheDirectory.isEmpty()) {
+                return std::nullopt;
+            }
+            return TextureCache(m_cacheDirectory, m_cacheKey + "\n" + collectionPath.asString());
+        }
+
+        FileTextureCollectionLoader::FileTextureCollectionLoader(Logger& logger, const std::vector<IO::Path>& searchPaths, const std::vector<std::string>& exclusions, const Path& cacheDirectory, const std::string& cacheKey) :
+        TextureCollectionLoader(logger, exclusions, cacheDirectory, cacheKey),
         m_searchPaths(searchPaths) {}
 
         Assets::TextureCollection FileTextureCollectionLoader::loadTextureCollection(const Path& path, const std::vector<std::string>& textureExtensions, const TextureReader& textureReader) {
             const auto wadPath = Disk::resolvePath(m_searchPaths, path);
             WadFileSystem wadFS(wadPath, m_logger);
 
-            const auto texturePaths = wadFS.findItems(Path(""), FileExtensionMatcher(textureExtensions));
-            auto textures = std::vector<Assets::Texture>();
-            textures.reserve(texturePaths.size());
-            
-            for (const auto& texturePath : texturePaths)  {
-                try {
-                    auto file = wadFS.openFile(texturePath);
-                    const auto name = file->path().lastComponent().deleteExtension().asString();
-                    if (shouldExclude(name)) {
-                        continue;
-                    }
-                    textures.push_back(textureReader.readTexture(file));
-                } catch (const std::exception& e) {
-                    m_logger.warn() << e.what();
+            const auto texturePaths = removeExcludedTextures(wadFS.findItems(Path(""), FileExtensionMatcher(textureExtensions)));
+
+            auto cache = openCache(wadPath);
+            const auto wadKey = cache ? TextureCache::makeKey(wadPath, Path()) : std::nullopt;
+
+            auto textures = readTexturesInParallel(m_logger, cache, texturePaths, [&](const Path& texturePath) -> std::optional<TextureCache::Key> {
+                if (!wadKey) {
+                    return std::nullopt;
                 }
-            }
+                return TextureCache::Key{wadKey->sourcePath, texturePath, wadKey->modificationTime};
+            }, [&](const Path& texturePath) {
+                return textureReader.readTexture(wadFS.openFile(texturePath));
+            });
 
             return Assets::TextureCollection(path, std::move(textures));
         }
 
-        DirectoryTextureCollectionLoader::DirectoryTextureCollectionLoader(Logger& logger, const FileSystem& gameFS, const std::vector<std::string>& exclusions) :
-        TextureCollectionLoader(logger, exclusions),
+        DirectoryTextureCollectionLoader::DirectoryTextureCollectionLoader(Logger& logger, const FileSystem& gameFS, const std::vector<std::string>& exclusions, const Path& cacheDirectory, const std::string& cacheKey) :
+        TextureCollectionLoader(logger, exclusions, cacheDirectory, cacheKey),
         m_gameFS(gameFS) {}
 
         Assets::TextureCollection DirectoryTextureCollectionLoader::loadTextureCollection(const Path& path, const std::vector<std::string>& textureExtensions, const TextureReader& textureReader) {
-            const auto texturePaths = m_gameFS.findItems(path, FileExtensionMatcher(textureExtensions));
-            auto textures = std::vector<Assets::Texture>();
-            textures.reserve(texturePaths.size());
+            const auto texturePaths = removeExcludedTextures(m_gameFS.findItems(path, FileExtensionMatcher(textureExtensions)));
 
-            for (const auto& texturePath : texturePaths) {
+            // Store the absolute path to the original file (may be used by .obj export)
+            const auto makeAbsolute = [&](const Path& texturePath) -> std::optional<Path> {
                 try {
-                    auto file = m_gameFS.openFile(texturePath);
-
-                    // Store the absolute path to the original file (may be used by .obj export)
-                    IO::Path absolutePath;
-                    try {
-                        absolutePath = m_gameFS.makeAbsolute(texturePath);
-                    } catch (const FileSystemException& e) {
-                        m_logger.debug() << e.what();
-                    }
+                    return m_gameFS.makeAbsolute(texturePath);
+                } catch (const FileSystemException& e) {
+                    m_logger.debug() << e.what();
+                    return std::nullopt;
+                }
+            };
 
-                    const auto name = file->path().lastComponent().deleteExtension().asString();
-                    if (shouldExclude(name)) {
-                        continue;
-                    }
-                    auto texture = textureReader.readTexture(file);
-                    texture.setAbsolutePath(absolutePath);
-                    texture.setRelativePath(texturePath);
-                    textures.push_back(std::move(texture));
-                } catch (const std::exception& e) {
-                    m_logger.warn() << e.what();
+            // the directory may exist in several places, so its path alone does not identify it
+            auto cache = openCache(makeAbsolute(path).value_or(path));
+
+            auto textures = readTexturesInParallel(m_logger, cache, texturePaths, [&](const Path& texturePath) -> std::optional<TextureCache::Key> {
+                // textures in archives cannot be cached, but the file system cannot make their paths absolute anyway
+                if (const auto absolutePath = makeAbsolute(texturePath)) {
+                    return TextureCache::makeKey(*absolutePath, Path());
                 }
-            }
-            
+                return std::nullopt;
+            }, [&](const Path& texturePath) {
+                auto texture = textureReader.readTexture(m_gameFS.openFile(texturePath));
+                texture.setAbsolutePath(makeAbsolute(texturePath).value_or(Path()));
+                texture.setRelativePath(texturePath);
+                return texture;
+            });
+
             return Assets::TextureCollection(path, std::move(textures));
         }
     }
@@ -19,10 +19,13 @@
 
 #pragma once
 
+#include "IO/Path.h"
+#include "IO/TextureCache.h"
+
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
-#include <string>
 
 namespace TrenchBroom {
     class Logger;
@@ -34,7 +37,6 @@ namespace TrenchBroom {
     namespace IO {
         class File;
         class FileSystem;
-        class Path;
         class TextureReader;
 
         class TextureCollectionLoader {
@@ -43,21 +45,31 @@ namespace TrenchBroom {
         protected:
             Logger& m_logger;
             const std::vector<std::string> m_textureExclusions;
+            /**
+             * The directory in which decoded textures are cached, or an empty path if textures should not be cached.
+             */
+            const Path m_cacheDirectory;
+            /**
+             * Identifies the settings that affect how textures are decoded, such as the texture format and palette.
+             */
+            const std::string m_cacheKey;
         protected:
-            explicit TextureCollectionLoader(Logger& logger, const std::vector<std::string>& exclusions);
+            TextureCollectionLoader(Logger& logger, const std::vector<std::string>& exclusions, const Path& cacheDirectory, const std::string& cacheKey);
         public:
             virtual ~TextureCollectionLoader();
         public:
             virtual Assets::TextureCollection loadTextureCollection(const Path& path, const std::vector<std::string>& textureExtensions, const TextureReader& textureReader) = 0;
         protected:
             bool shouldExclude(const std::string& textureName);
+            std::vector<Path> removeExcludedTextures(std::vector<Path> texturePaths);
+            std::optional<TextureCache> openCache(const Path& collectionPath) const;
         };
 
         class FileTextureCollectionLoader : public TextureCollectionLoader {
         private:
             const std::vector<Path> m_searchPaths;
         public:
-            FileTextureCollectionLoader(Logger& logger, const std::vector<Path>& searchPaths, const std::vector<std::string>& exclusions);
+            FileTextureCollectionLoader(Logger& logger, const std::vector<Path>& searchPaths, const std::vector<std::string>& exclusions, const Path& cacheDirectory, const std::string& cacheKey);
         private:
             Assets::TextureCollection loadTextureCollection(const Path& path, const std::vector<std::string>& textureExtensions, const TextureReader& textureReader);
         };
@@ -66,7 +78,7 @@ namespace TrenchBroom {
         private:
             const FileSystem& m_gameFS;
         public:
-            DirectoryTextureCollectionLoader(Logger& logger, const FileSystem& gameFS, const std::vector<std::string>& exclusions);
+            DirectoryTextureCollectionLoader(Logger& logger, const FileSystem& gameFS, const std::vector<std::string>& exclusions, const Path& cacheDirectory, const std::string& cacheKey);
         private:
             Assets::TextureCollection loadTextureCollection(const Path& path, const std::vector<std::string>& textureExtensions, const TextureReader& textureReader);
         };
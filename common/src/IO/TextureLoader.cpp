@@ -20,16 +20,20 @@
 #include "TextureLoader.h"
 
 #include "Ensure.h"
+#include "Exceptions.h"
 #include "Logger.h"
 #include "Assets/Palette.h"
 #include "Assets/TextureCollection.h"
 #include "Assets/TextureManager.h"
+#include "IO/File.h"
 #include "IO/FileSystem.h"
 #include "IO/FreeImageTextureReader.h"
 #include "IO/HlMipTextureReader.h"
 #include "IO/IdMipTextureReader.h"
 #include "IO/M8TextureReader.h"
 #include "IO/Quake3ShaderTextureReader.h"
+#include "IO/Reader.h"
+#include "IO/TextureCache.h"
 #include "IO/TextureCollectionLoader.h"
 #include "IO/WalTextureReader.h"
 #include "IO/Path.h"
@@ -40,10 +44,10 @@
 
 namespace TrenchBroom {
     namespace IO {
-        TextureLoader::TextureLoader(const FileSystem& gameFS, const std::vector<IO::Path>& fileSearchPaths, const Model::TextureConfig& textureConfig, Logger& logger) :
+        TextureLoader::TextureLoader(const FileSystem& gameFS, const std::vector<IO::Path>& fileSearchPaths, const Model::TextureConfig& textureConfig, const Path& cacheDirectory, Logger& logger) :
         m_textureExtensions(getTextureExtensions(textureConfig)),
         m_textureReader(createTextureReader(gameFS, textureConfig, logger)),
-        m_textureCollectionLoader(createTextureCollectionLoader(gameFS, fileSearchPaths, textureConfig, logger)) {
+        m_textureCollectionLoader(createTextureCollectionLoader(gameFS, fileSearchPaths, textureConfig, cacheDirectory, logger)) {
             ensure(m_textureReader != nullptr, "textureReader is null");
             ensure(m_textureCollectionLoader != nullptr, "textureCollectionLoader is null");
         }
@@ -90,13 +94,27 @@ namespace TrenchBroom {
             }
         }
 
-        std::unique_ptr<TextureCollectionLoader> TextureLoader::createTextureCollectionLoader(const FileSystem& gameFS, const std::vector<IO::Path>& fileSearchPaths, const Model::TextureConfig& textureConfig, Logger& logger) {
+        std::string TextureLoader::getCacheKey(const FileSystem& gameFS, const Model::TextureConfig& textureConfig) {
+            // the texture names depend on the root directory, and palette based textures depend on the palette
+            auto result = textureConfig.format.format + "\n" + textureConfig.package.rootDirectory.asString();
+            if (!textureConfig.palette.isEmpty()) {
+                try {
+                    const auto reader = gameFS.openFile(textureConfig.palette)->reader().buffer();
+                    result += "\n" + TextureCache::fingerprint(std::string(reader.stringView()));
+                } catch (const Exception&) {
+                    // the palette cannot be loaded, so textures are not decoded using it
+                }
+            }
+            return result;
+        }
+
+        std::unique_ptr<TextureCollectionLoader> TextureLoader::createTextureCollectionLoader(const FileSystem& gameFS, const std::vector<IO::Path>& fileSearchPaths, const Model::TextureConfig& textureConfig, const Path& cacheDirectory, Logger& logger) {
             using Model::GameConfig;
             switch (textureConfig.package.type) {
                 case Model::TexturePackageConfig::PT_File:
-                    return std::make_unique<FileTextureCollectionLoader>(logger, fileSearchPaths, textureConfig.excludes);
+                    return std::make_unique<FileTextureCollectionLoader>(logger, fileSearchPaths, textureConfig.excludes, cacheDirectory, getCacheKey(gameFS, textureConfig));
                 case Model::TexturePackageConfig::PT_Directory:
-                    return std::make_unique<DirectoryTextureCollectionLoader>(logger, gameFS, textureConfig.excludes);
+                    return std::make_unique<DirectoryTextureCollectionLoader>(logger, gameFS, textureConfig.excludes, cacheDirectory, getCacheKey(gameFS, textureConfig));
                 case Model::TexturePackageConfig::PT_Unset:
                     throw GameException("Texture package format is not set");
                 switchDefault()
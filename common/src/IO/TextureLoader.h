@@ -50,13 +50,18 @@ namespace TrenchBroom {
             std::unique_ptr<TextureReader> m_textureReader;
             std::unique_ptr<TextureCollectionLoader> m_textureCollectionLoader;
         public:
-            TextureLoader(const FileSystem& gameFS, const std::vector<Path>& fileSearchPaths, const Model::TextureConfig& textureConfig, Logger& logger);
+            /**
+             * Creates a texture loader for the given texture configuration. If the given cache directory is not empty,
+             * decoded textures are cached in it, see TextureCache.
+             */
+            TextureLoader(const FileSystem& gameFS, const std::vector<Path>& fileSearchPaths, const Model::TextureConfig& textureConfig, const Path& cacheDirectory, Logger& logger);
             ~TextureLoader();
         private:
             static std::vector<std::string> getTextureExtensions(const Model::TextureConfig& textureConfig);
             static std::unique_ptr<TextureReader> createTextureReader(const FileSystem& gameFS, const Model::TextureConfig& textureConfig, Logger& logger);
             static Assets::Palette loadPalette(const FileSystem& gameFS, const Model::TextureConfig& textureConfig, Logger& logger);
-            static std::unique_ptr<TextureCollectionLoader> createTextureCollectionLoader(const FileSystem& gameFS, const std::vector<Path>& fileSearchPaths, const Model::TextureConfig& textureConfig, Logger& logger);
+            static std::string getCacheKey(const FileSystem& gameFS, const Model::TextureConfig& textureConfig);
+            static std::unique_ptr<TextureCollectionLoader> createTextureCollectionLoader(const FileSystem& gameFS, const std::vector<Path>& fileSearchPaths, const Model::TextureConfig& textureConfig, const Path& cacheDirectory, Logger& logger);
         public:
             Assets::TextureCollection loadTextureCollection(const Path& path);
             void loadTextures(const std::vector<Path>& paths, Assets::TextureManager& textureManager);
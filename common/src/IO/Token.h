@@ -20,7 +20,9 @@
 #pragma once
 
 #include <cassert>
+#include <charconv>
 #include <string>
+#include <system_error>
 
 #include <kdl/string_utils.h>
 
@@ -92,12 +94,29 @@ namespace TrenchBroom {
 
             template <typename T>
             T toFloat() const {
+#if defined(__cpp_lib_to_chars)
+                // parse the number in place instead of copying it into a string first
+                auto value = 0.0;
+                const auto result = std::from_chars(skipPlusSign(), m_end, value);
+                return static_cast<T>(result.ec == std::errc() ? value : 0.0);
+#else
                 return static_cast<T>(kdl::str_to_double(std::string(m_begin, m_end)).value_or(0.0));
+#endif
             }
 
             template <typename T>
             T toInteger() const {
-                return static_cast<T>(kdl::str_to_long(std::string(m_begin, m_end)).value_or(0l));
+                // parse the number in place instead of copying it into a string first
+                auto value = 0l;
+                const auto result = std::from_chars(skipPlusSign(), m_end, value);
+                return static_cast<T>(result.ec == std::errc() ? value : 0l);
+            }
+        private:
+            /**
+             * Returns the beginning of this token, skipping a leading plus sign which std::from_chars does not accept.
+             */
+            const char* skipPlusSign() const {
+                return m_begin != m_end && *m_begin == '+' ? m_begin + 1 : m_begin;
             }
         };
     }
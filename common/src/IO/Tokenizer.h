@@ -27,6 +27,8 @@
 #include <kdl/string_format.h>
 
 #include <cassert>
+#include <cstdint>
+#include <cstring>
 #include <tuple>
 #include <string>
 #include <string_view>
@@ -148,6 +150,101 @@ namespace TrenchBroom {
                 ++m_state.cur;
             }
 
+            /**
+             * Advances by the given number of characters, none of which may be a line break. This is equivalent to
+             * calling advance() for each character, but updates the column once.
+             */
+            void advanceInLine(const size_t count) {
+                assert(count <= static_cast<size_t>(m_end - m_state.cur));
+
+                // only the trailing run of escape characters determines whether the next character is escaped
+                size_t trailingEscapeChars = 0u;
+                while (trailingEscapeChars < count && m_state.cur[count - trailingEscapeChars - 1u] == m_escapeChar) {
+                    ++trailingEscapeChars;
+                }
+                if (trailingEscapeChars == count) {
+                    m_state.escaped = m_state.escaped != (count % 2u == 1u);
+                } else {
+                    m_state.escaped = trailingEscapeChars % 2u == 1u;
+                }
+
+                m_state.cur += count;
+                m_state.column += count;
+            }
+
+            /**
+             * Discards whitespace like discardWhile(" \t\n\r"), but examines eight characters at a time while they
+             * are all whitespace and counts the line breaks among them at once.
+             */
+            const char* discardWhitespace() {
+                auto* cur = m_state.cur;
+                auto line = m_state.line;
+                auto column = m_state.column;
+
+                const auto discardChar = [&]() {
+                    switch (*cur) {
+                        case ' ':
+                        case '\t':
+                            ++column;
+                            break;
+                        case '\r':
+                            if (cur + 1 < m_end && *(cur + 1) == '\n') {
+                                ++column;
+                                break;
+                            }
+                            // handle carriage return without consecutive line feed
+                            // by falling through into the line feed case
+                            switchFallthrough();
+                        case '\n':
+                            ++line;
+                            column = 1;
+                            break;
+                        default:
+                            return false;
+                    }
+                    ++cur;
+                    return true;
+                };
+
+                while (cur < m_end) {
+                    if (m_end - cur >= 8) {
+                        std::uint64_t block;
+                        std::memcpy(&block, cur, 8u);
+
+                        const auto lineFeeds = matchBytes(block, '\n');
+                        const auto carriageReturns = matchBytes(block, '\r');
+                        const auto whitespace = matchBytes(block, ' ') | matchBytes(block, '\t') | lineFeeds | carriageReturns;
+                        if (whitespace == HighBits && carriageReturns == 0u) {
+                            if (lineFeeds == 0u) {
+                                column += 8u;
+                            } else {
+                                line += countMatches(lineFeeds);
+                                column = 1u;
+                                for (auto* c = cur + 7; *c != '\n'; --c) {
+                                    ++column;
+                                }
+                            }
+                            cur += 8;
+                            continue;
+                        }
+
+                        // carriage returns and the end of the whitespace are handled one character at a time
+                        const auto* blockEnd = cur + 8;
+                        while (cur < blockEnd && discardChar());
+                        if (cur < blockEnd) {
+                            break;
+                        }
+                    } else if (!discardChar()) {
+                        break;
+                    }
+                }
+
+                if (cur != m_state.cur) {
+                    m_state = TokenizerState{cur, line, column, false};
+                }
+                return cur;
+            }
+
             void errorIfEof() const {
                 if (eof()) {
                     throw ParserException("Unexpected end of file");
@@ -161,7 +258,27 @@ namespace TrenchBroom {
             void restore(const TokenizerState& snapshot) {
                 m_state = snapshot;
             }
+        private:
+            static constexpr std::uint64_t LowBits = 0x0101010101010101u;
+            static constexpr std::uint64_t HighBits = 0x8080808080808080u;
+
+            /**
+             * Returns a mask with the high bit of every byte of the given block set that is equal to the given
+             * character, and all other bits cleared.
+             */
+            static std::uint64_t matchBytes(const std::uint64_t block, const char c) {
+                const auto x = block ^ (LowBits * static_cast<unsigned char>(c));
+                // the high bit of a byte is set if the byte is non-zero
+                const auto nonZero = ((x & ~HighBits) + ~HighBits) | x;
+                return ~nonZero & HighBits;
+            }
 
+            /**
+             * Returns the number of bytes marked in the given mask returned by matchBytes.
+             */
+            static std::uint64_t countMatches(const std::uint64_t mask) {
+                return ((mask >> 7u) * LowBits) >> 56u;
+            }
         public:
             bool eof() const  {
                 return eof(m_state.cur);
@@ -23,6 +23,7 @@
 #include "IO/DiskFileSystem.h"
 
 #include <memory>
+#include <mutex>
 #include <string>
 
 namespace TrenchBroom {
@@ -34,6 +35,7 @@ namespace TrenchBroom {
         m_fileIndex(fileIndex) {}
 
         std::shared_ptr<File> ZipFileSystem::ZipCompressedFile::doOpen() const {
+            const auto lock = std::lock_guard<std::mutex>{m_owner->m_archiveMutex};
             const auto path = Path(m_owner->filename(m_fileIndex));
 
             mz_zip_archive_file_stat stat;
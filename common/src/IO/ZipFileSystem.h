@@ -22,6 +22,7 @@
 #include "IO/ImageFileSystem.h"
 
 #include <memory>
+#include <mutex>
 
 #include <miniz/miniz.h>
 
@@ -32,6 +33,10 @@ namespace TrenchBroom {
         class ZipFileSystem : public ImageFileSystem {
         private:
             mz_zip_archive m_archive;
+            /**
+             * Guards the archive because miniz does not support extracting files from the same archive concurrently.
+             */
+            std::mutex m_archiveMutex;
         private:
             class ZipCompressedFile : public FileEntry {
             private:
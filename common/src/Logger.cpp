@@ -32,6 +32,17 @@ namespace TrenchBroom {
         m_logger->log(m_logLevel, m_buf.str());
     }
 
+    thread_local Logger::DeferredMessageList* Logger::s_deferredMessages = nullptr;
+
+    Logger::DeferMessages::DeferMessages(DeferredMessageList& messages) :
+    m_previousMessages(s_deferredMessages) {
+        s_deferredMessages = &messages;
+    }
+
+    Logger::DeferMessages::~DeferMessages() {
+        s_deferredMessages = m_previousMessages;
+    }
+
     Logger::~Logger() {}
 
     Logger::stream Logger::debug() {
@@ -106,16 +117,28 @@ namespace TrenchBroom {
 
     void Logger::log(const LogLevel level, const std::string& message) {
 #ifdef NDEBUG
-        if (level != LogLevel::Debug)
+        if (level == LogLevel::Debug) {
+            return;
+        }
 #endif
-        doLog(level, message);
+        if (s_deferredMessages != nullptr) {
+            s_deferredMessages->push_back(DeferredMessage{level, message});
+        } else {
+            doLog(level, message);
+        }
     }
 
     void Logger::log(const LogLevel level, const QString& message) {
 #ifdef NDEBUG
-        if (level != LogLevel::Debug)
+        if (level == LogLevel::Debug) {
+            return;
+        }
 #endif
-        doLog(level, message);
+        if (s_deferredMessages != nullptr) {
+            s_deferredMessages->push_back(DeferredMessage{level, message.toStdString()});
+        } else {
+            doLog(level, message);
+        }
     }
 
     void NullLogger::doLog(const LogLevel /* level */, const std::string& /* message */) {}
@@ -19,8 +19,11 @@
 
 #pragma once
 
+#include "Macros.h"
+
 #include <sstream>
 #include <string>
+#include <vector>
 
 class QString;
 
@@ -49,6 +52,32 @@ namespace TrenchBroom {
                 return *this;
             }
         };
+
+        struct DeferredMessage {
+            LogLevel level;
+            std::string str;
+        };
+
+        using DeferredMessageList = std::vector<DeferredMessage>;
+
+        /**
+         * While an instance of this class exists, every message that is logged to any logger on the thread that
+         * created it is appended to the given list instead. Tasks that run in parallel use this to collect their
+         * messages so that the calling thread can log them in a deterministic order once all tasks have finished.
+         *
+         * Instances must be destroyed in the reverse order of their creation.
+         */
+        class DeferMessages {
+        private:
+            DeferredMessageList* m_previousMessages;
+        public:
+            explicit DeferMessages(DeferredMessageList& messages);
+            ~DeferMessages();
+
+            deleteCopyAndMove(DeferMessages)
+        };
+    private:
+        static thread_local DeferredMessageList* s_deferredMessages;
     public:
         virtual ~Logger();
 
@@ -43,7 +43,12 @@
 #include <vecmath/polygon.h>
 #include <vecmath/util.h>
 
+#include <algorithm>
+#include <atomic>
 #include <iterator>
+#include <mutex>
+#include <numeric>
+#include <optional>
 #include <set>
 #include <string>
 #include <vector>
@@ -51,6 +56,51 @@
 
 namespace TrenchBroom {
     namespace Model {
+        static std::atomic<size_t> s_geometryMemorySize(0u);
+        static std::atomic<size_t> s_geometryAccessClock(0u);
+
+        static size_t memorySize(const BrushGeometry& geometry) {
+            return geometry.vertexCount() * sizeof(BrushVertex)
+                + geometry.edgeCount() * (sizeof(BrushEdge) + 2u * sizeof(BrushHalfEdge))
+                + geometry.faceCount() * sizeof(BrushFaceGeometry);
+        }
+
+        static void replaceGeometry(std::unique_ptr<BrushGeometry>& geometry, std::unique_ptr<BrushGeometry> newGeometry) {
+            if (geometry) {
+                s_geometryMemorySize -= memorySize(*geometry);
+            }
+            if (newGeometry) {
+                s_geometryMemorySize += memorySize(*newGeometry);
+            }
+            geometry = std::move(newGeometry);
+        }
+
+        /**
+         * Clips the given geometry with the boundaries of the given faces in the given order and links each face that
+         * remains with its face geometry. The payload of each face geometry is set to the index of its face.
+         */
+        static kdl::result<void, BrushError> clipGeometry(BrushGeometry& geometry, const std::vector<BrushFace>& faces, const std::vector<size_t>& order) {
+            for (const size_t i : order) {
+                const BrushFace& face = faces[i];
+                const auto result = geometry.clip(face.boundary());
+                if (result.success()) {
+                    BrushFaceGeometry* faceGeometry = result.face();
+                    face.setGeometry(faceGeometry);
+                    faceGeometry->setPayload(i);
+                } else  if (result.empty()) {
+                    return BrushError::EmptyBrush;
+                }
+            }
+
+            // Correct vertex positions and heal short edges
+            geometry.correctVertexPositions();
+            if (!geometry.healEdges()) {
+                return BrushError::InvalidBrush;
+            }
+
+            return kdl::void_success;
+        }
+
         class Brush::CopyCallback : public BrushGeometry::CopyCallback {
         public:
             void faceWasCopied(const BrushFaceGeometry* original, BrushFaceGeometry* copy) const override {
@@ -58,24 +108,44 @@ namespace TrenchBroom {
             }
         };
 
-        Brush::Brush() {}
+        Brush::Brush() :
+        m_hasGeometry(false),
+        m_lastGeometryAccess(s_geometryAccessClock.load(std::memory_order_relaxed)),
+        m_canRebuildGeometry(false) {}
 
         Brush::Brush(const Brush& other) :
         m_faces(other.m_faces),
-        m_geometry(other.m_geometry ? std::make_unique<BrushGeometry>(*other.m_geometry, CopyCallback()) : nullptr) {
-            if (m_geometry) {
-                for (BrushFaceGeometry* faceGeometry : m_geometry->faces()) {
+        m_worldBounds(other.m_worldBounds),
+        m_bounds(other.m_bounds),
+        m_hasGeometry(false),
+        m_lastGeometryAccess(s_geometryAccessClock.load(std::memory_order_relaxed)),
+        m_canRebuildGeometry(other.m_canRebuildGeometry) {
+            // the copied faces must not refer to the geometry of the other brush
+            for (const BrushFace& face : m_faces) {
+                face.setGeometry(nullptr);
+            }
+
+            // a brush that cannot rebuild its geometry never releases it, so the geometry must be copied
+            if (!m_canRebuildGeometry && other.m_hasGeometry) {
+                auto geometry = std::make_unique<BrushGeometry>(*other.m_geometry, CopyCallback());
+                for (BrushFaceGeometry* faceGeometry : geometry->faces()) {
                     if (const auto faceIndex = faceGeometry->payload()) {
-                        BrushFace& face = m_faces[*faceIndex];
-                        face.setGeometry(faceGeometry);
+                        m_faces[*faceIndex].setGeometry(faceGeometry);
                     }
                 }
+                replaceGeometry(m_geometry, std::move(geometry));
+                m_hasGeometry = true;
             }
         }
 
         Brush::Brush(Brush&& other) noexcept :
         m_faces(std::move(other.m_faces)),
-        m_geometry(std::move(other.m_geometry)) {}
+        m_worldBounds(other.m_worldBounds),
+        m_bounds(other.m_bounds),
+        m_geometry(std::move(other.m_geometry)),
+        m_hasGeometry(other.m_hasGeometry.exchange(false)),
+        m_lastGeometryAccess(other.m_lastGeometryAccess.load(std::memory_order_relaxed)),
+        m_canRebuildGeometry(other.m_canRebuildGeometry) {}
 
         Brush& Brush::operator=(Brush other) noexcept {
             using std::swap;
@@ -86,13 +156,29 @@ namespace TrenchBroom {
         void swap(Brush& lhs, Brush& rhs) noexcept {
             using std::swap;
             swap(lhs.m_faces, rhs.m_faces);
+            swap(lhs.m_worldBounds, rhs.m_worldBounds);
+            swap(lhs.m_bounds, rhs.m_bounds);
             swap(lhs.m_geometry, rhs.m_geometry);
+            swap(lhs.m_canRebuildGeometry, rhs.m_canRebuildGeometry);
+
+            const bool lhsHasGeometry = lhs.m_hasGeometry;
+            lhs.m_hasGeometry = rhs.m_hasGeometry.load();
+            rhs.m_hasGeometry = lhsHasGeometry;
+
+            const size_t lhsLastGeometryAccess = lhs.m_lastGeometryAccess;
+            lhs.m_lastGeometryAccess = rhs.m_lastGeometryAccess.load();
+            rhs.m_lastGeometryAccess = lhsLastGeometryAccess;
         }
         
-        Brush::~Brush() = default;
+        Brush::~Brush() {
+            replaceGeometry(m_geometry, nullptr);
+        }
 
         Brush::Brush(std::vector<BrushFace> faces) :
-        m_faces(std::move(faces)) {}
+        m_faces(std::move(faces)),
+        m_hasGeometry(false),
+        m_lastGeometryAccess(s_geometryAccessClock.load(std::memory_order_relaxed)),
+        m_canRebuildGeometry(false) {}
 
         kdl::result<Brush, BrushError> Brush::create(const vm::bbox3& worldBounds, std::vector<BrushFace> faces) {
             Brush brush(std::move(faces));
@@ -100,54 +186,216 @@ namespace TrenchBroom {
                 .and_then([&]() { return std::move(brush); });
         }
 
+        /**
+         * Computes the bounds of a brush with the given faces from the face planes without building its geometry. The
+         * vertices are found by intersecting every triple of face planes and keeping the points that are not above any
+         * face plane.
+         *
+         * Returns std::nullopt unless the faces form a closed brush within the world bounds in which every face has a
+         * polygon, because only then is building the geometry later guaranteed to link every face with a face geometry.
+         * Brushes with vertices that are so close that they would be merged when building the geometry are rejected, too.
+         */
+        static std::optional<vm::bbox3> computeBoundsFromFacePlanes(const vm::bbox3& worldBounds, const std::vector<BrushFace>& faces) {
+            // the minimum edge length of the brush geometry
+            constexpr auto MinVertexDistance = static_cast<FloatType>(0.01);
+            const auto epsilon = vm::constants<FloatType>::point_status_epsilon();
+
+            if (faces.size() < 4u) {
+                return std::nullopt;
+            }
+
+            const auto isInside = [&](const vm::vec3& point) {
+                return std::none_of(std::begin(faces), std::end(faces), [&](const BrushFace& face) {
+                    return face.boundary().point_status(point, epsilon) == vm::plane_status::above;
+                });
+            };
+
+            auto vertices = std::vector<vm::vec3>{};
+            for (size_t i = 0u; i < faces.size(); ++i) {
+                for (size_t j = i + 1u; j < faces.size(); ++j) {
+                    for (size_t k = j + 1u; k < faces.size(); ++k) {
+                        const auto& p1 = faces[i].boundary();
+                        const auto& p2 = faces[j].boundary();
+                        const auto& p3 = faces[k].boundary();
+
+                        const auto n2xn3 = vm::cross(p2.normal, p3.normal);
+                        const auto denominator = vm::dot(p1.normal, n2xn3);
+                        if (vm::is_zero(denominator, vm::C::almost_zero())) {
+                            continue;
+                        }
+
+                        const auto point = (p1.distance * n2xn3 + p2.distance * vm::cross(p3.normal, p1.normal) + p3.distance * vm::cross(p1.normal, p2.normal)) / denominator;
+                        if (!isInside(point)) {
+                            continue;
+                        }
+
+                        const auto closeVertex = std::find_if(std::begin(vertices), std::end(vertices), [&](const vm::vec3& vertex) {
+                            return vm::squared_distance(vertex, point) < MinVertexDistance * MinVertexDistance;
+                        });
+                        if (closeVertex == std::end(vertices)) {
+                            vertices.push_back(point);
+                        } else if (vm::squared_distance(*closeVertex, point) > epsilon * epsilon) {
+                            return std::nullopt;
+                        }
+                    }
+                }
+            }
+
+            // every face must have a polygon, and the brush must be closed, i.e. its Euler characteristic must be 2
+            auto faceVertices = std::vector<std::vector<size_t>>(faces.size());
+            for (size_t v = 0u; v < vertices.size(); ++v) {
+                for (size_t f = 0u; f < faces.size(); ++f) {
+                    if (faces[f].boundary().point_status(vertices[v], epsilon) == vm::plane_status::inside) {
+                        faceVertices[f].push_back(v);
+                    }
+                }
+            }
+
+            if (std::any_of(std::begin(faceVertices), std::end(faceVertices), [](const auto& v) { return v.size() < 3u; })) {
+                return std::nullopt;
+            }
+
+            auto edgeCount = size_t(0u);
+            for (size_t i = 0u; i < faces.size(); ++i) {
+                for (size_t j = i + 1u; j < faces.size(); ++j) {
+                    const auto sharedVertexCount = std::count_if(std::begin(faceVertices[i]), std::end(faceVertices[i]), [&](const size_t v) {
+                        return kdl::vec_contains(faceVertices[j], v);
+                    });
+                    if (sharedVertexCount >= 2) {
+                        ++edgeCount;
+                    }
+                }
+            }
+
+            if (vertices.size() + faces.size() != edgeCount + 2u) {
+                return std::nullopt;
+            }
+
+            auto builder = vm::bbox3::builder{};
+            for (const auto& vertex : vertices) {
+                builder.add(vm::correct(vertex));
+            }
+
+            // a brush that touches the world bounds is clipped by them when its geometry is built
+            const auto bounds = builder.bounds();
+            const auto innerWorldBounds = vm::bbox3(worldBounds.min + vm::vec3::fill(epsilon), worldBounds.max - vm::vec3::fill(epsilon));
+            if (!innerWorldBounds.contains(bounds)) {
+                return std::nullopt;
+            }
+
+            return bounds;
+        }
+
+        kdl::result<Brush, BrushError> Brush::createDeferred(const vm::bbox3& worldBounds, std::vector<BrushFace> faces) {
+            BrushFace::sortFaces(faces);
+
+            const auto bounds = computeBoundsFromFacePlanes(worldBounds, faces);
+            if (!bounds) {
+                return create(worldBounds, std::move(faces));
+            }
+
+            // the faces are sorted, so clipping them in sorted order when the geometry is built yields a face geometry for every face
+            Brush brush(std::move(faces));
+            brush.m_worldBounds = worldBounds;
+            brush.m_bounds = *bounds;
+            brush.m_canRebuildGeometry = true;
+            return std::move(brush);
+        }
+
         kdl::result<void, BrushError> Brush::updateGeometryFromFaces(const vm::bbox3& worldBounds) {
             // First, add all faces to the brush geometry
             BrushFace::sortFaces(m_faces);
             
+            auto order = std::vector<size_t>(m_faces.size());
+            std::iota(std::begin(order), std::end(order), 0u);
+
             auto geometry = std::make_unique<BrushGeometry>(worldBounds);
-            
-            for (size_t i = 0u; i < m_faces.size(); ++i) {
-                BrushFace& face = m_faces[i];
-                const auto result = geometry->clip(face.boundary());
-                if (result.success()) {
-                    BrushFaceGeometry* faceGeometry = result.face();
-                    face.setGeometry(faceGeometry);
-                    faceGeometry->setPayload(i);
-                } else  if (result.empty()) {
-                    return BrushError::EmptyBrush;
+            return clipGeometry(*geometry, m_faces, order)
+                .and_then([&]() -> kdl::result<void, BrushError> {
+                    // Now collect all faces which still remain
+                    const auto faceCount = m_faces.size();
+                    std::vector<BrushFace> remainingFaces;
+                    remainingFaces.reserve(m_faces.size());
+                    
+                    for (BrushFaceGeometry* faceGeometry : geometry->faces()) {
+                        if (const auto faceIndex = faceGeometry->payload()) {
+                            remainingFaces.push_back(std::move(m_faces[*faceIndex]));
+                            faceGeometry->setPayload(remainingFaces.size() - 1u);
+                        } else {
+                            return BrushError::IncompleteBrush;
+                        }
+                    }
+
+                    m_faces = std::move(remainingFaces);
+                    m_worldBounds = worldBounds;
+                    m_bounds = geometry->bounds();
+                    m_canRebuildGeometry = m_faces.size() == faceCount;
+                    replaceGeometry(m_geometry, std::move(geometry));
+                    m_hasGeometry = true;
+                    
+                    assert(checkFaceLinks());
+
+                    return kdl::void_success;
+                });
+        }
+
+        const BrushGeometry& Brush::geometry() const {
+            m_lastGeometryAccess.store(s_geometryAccessClock.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            if (!m_hasGeometry) {
+                std::lock_guard<std::mutex> lock(m_geometryMutex);
+                if (!m_geometry) {
+                    // The geometry was only released because no face was dropped when it was built. Clipping the faces
+                    // in the same order repeats that computation, so it yields a face geometry for every face again.
+                    assert(m_canRebuildGeometry);
+                    auto geometry = std::make_unique<BrushGeometry>(m_worldBounds);
+                    const auto result = clipGeometry(*geometry, m_faces, BrushFace::sortedFaceIndices(m_faces));
+                    assert(result.is_success() && geometry->faceCount() == m_faces.size());
+                    unused(result);
+
+                    replaceGeometry(m_geometry, std::move(geometry));
+                    assert(checkFaceLinks());
+                    m_hasGeometry = true;
                 }
             }
+            return *m_geometry;
+        }
+        
+        const vm::bbox3& Brush::bounds() const {
+            return m_bounds;
+        }
 
-            // Correct vertex positions and heal short edges
-            geometry->correctVertexPositions();
-            if (!geometry->healEdges()) {
-                return BrushError::InvalidBrush;
+        bool Brush::hasGeometry() const {
+            return m_hasGeometry;
+        }
+
+        bool Brush::releaseGeometry() {
+            std::lock_guard<std::mutex> lock(m_geometryMutex);
+            if (!m_geometry || !m_canRebuildGeometry) {
+                return false;
             }
-            
-            // Now collect all faces which still remain
-            std::vector<BrushFace> remainingFaces;
-            remainingFaces.reserve(m_faces.size());
-            
-            for (BrushFaceGeometry* faceGeometry : geometry->faces()) {
-                if (const auto faceIndex = faceGeometry->payload()) {
-                    remainingFaces.push_back(std::move(m_faces[*faceIndex]));
-                    faceGeometry->setPayload(remainingFaces.size() - 1u);
-                } else {
-                    return BrushError::IncompleteBrush;
-                }
+
+            m_hasGeometry = false;
+            for (const BrushFace& face : m_faces) {
+                face.setGeometry(nullptr);
             }
+            replaceGeometry(m_geometry, nullptr);
+            return true;
+        }
 
-            m_faces = std::move(remainingFaces);
-            m_geometry = std::move(geometry);
-            
-            assert(checkFaceLinks());
+        size_t Brush::lastGeometryAccess() const {
+            return m_lastGeometryAccess.load(std::memory_order_relaxed);
+        }
 
-            return kdl::void_success;
+        void Brush::advanceGeometryAccessClock() {
+            ++s_geometryAccessClock;
         }
-        
-        const vm::bbox3& Brush::bounds() const {
-            ensure(m_geometry != nullptr, "geometry is null");
-            return m_geometry->bounds();
+
+        size_t Brush::geometryMemorySize() {
+            return s_geometryMemorySize;
+        }
+
+        size_t Brush::releaseUnusedGeometryMemory() {
+            return BrushGeometry::releaseUnusedMemory();
         }
 
         std::optional<size_t> Brush::findFace(const std::string& textureName) const {
@@ -163,6 +411,7 @@ namespace TrenchBroom {
         }
 
         std::optional<size_t> Brush::findFace(const vm::polygon3& vertices, const FloatType epsilon) const {
+            geometry();
             return kdl::vec_index_of(m_faces, [&](const BrushFace& face) { return face.hasVertices(vertices, epsilon); });
         }
 
@@ -177,35 +426,50 @@ namespace TrenchBroom {
 
         const BrushFace& Brush::face(const size_t index) const {
             assert(index < faceCount());
+            geometry();
             return m_faces[index];
         }
 
         BrushFace& Brush::face(const size_t index) {
             assert(index < faceCount());
+            geometry();
             return m_faces[index];
         }
 
+        const std::vector<BrushFace>& Brush::facesWithoutGeometry() const {
+            return m_faces;
+        }
+
+        std::vector<BrushFace>& Brush::facesWithoutGeometry() {
+            return m_faces;
+        }
+
         size_t Brush::faceCount() const {
             return m_faces.size();
         }
 
         const std::vector<BrushFace>& Brush::faces() const {
+            geometry();
             return m_faces;
         }
 
         std::vector<BrushFace>& Brush::faces() {
+            geometry();
             return m_faces;
         }
 
+        void Brush::unsetTextures() {
+            for (auto& face : m_faces) {
+                face.setTexture(nullptr);
+            }
+        }
+
         bool Brush::closed() const {
-            ensure(m_geometry != nullptr, "geometry is null");
-            return m_geometry->closed();
+            return geometry().closed();
         }
 
         bool Brush::fullySpecified() const {
-            ensure(m_geometry != nullptr, "geometry is null");
-
-            for (auto* current : m_geometry->faces()) {
+            for (auto* current : geometry().faces()) {
                 if (!current->payload().has_value()) {
                     return false;
                 }
@@ -299,6 +563,11 @@ namespace TrenchBroom {
         kdl::result<void, BrushError> Brush::moveBoundary(const vm::bbox3& worldBounds, const size_t faceIndex, const vm::vec3& delta, const bool lockTexture) {
             assert(faceIndex < faceCount());
 
+            if (lockTexture) {
+                // texture lock uses the face center, which requires the geometry
+                geometry();
+            }
+
             return m_faces[faceIndex].transform(vm::translation_matrix(delta), lockTexture)
                 .and_then([&]() {
                     return updateGeometryFromFaces(worldBounds);
@@ -306,6 +575,10 @@ namespace TrenchBroom {
         }
 
         kdl::result<void, BrushError> Brush::expand(const vm::bbox3& worldBounds, const FloatType delta, const bool lockTexture) {
+            if (lockTexture) {
+                geometry();
+            }
+
             for (auto& face : m_faces) {
                 const vm::vec3 moveAmount = face.boundary().normal * delta;
                 if (!face.transform(vm::translation_matrix(moveAmount), lockTexture)) {
@@ -317,38 +590,31 @@ namespace TrenchBroom {
         }
 
         size_t Brush::vertexCount() const {
-            ensure(m_geometry != nullptr, "geometry is null");
-            return m_geometry->vertexCount();
+            return geometry().vertexCount();
         }
 
         const Brush::VertexList& Brush::vertices() const {
-            ensure(m_geometry != nullptr, "geometry is null");
-            return m_geometry->vertices();
+            return geometry().vertices();
         }
 
         const std::vector<vm::vec3> Brush::vertexPositions() const {
-            ensure(m_geometry != nullptr, "geometry is null");
-            return m_geometry->vertexPositions();
+            return geometry().vertexPositions();
         }
 
         bool Brush::hasVertex(const vm::vec3& position, const FloatType epsilon) const {
-            ensure(m_geometry != nullptr, "geometry is null");
-            return m_geometry->findVertexByPosition(position, epsilon) != nullptr;
+            return geometry().findVertexByPosition(position, epsilon) != nullptr;
         }
 
         vm::vec3 Brush::findClosestVertexPosition(const vm::vec3& position) const {
-            ensure(m_geometry != nullptr, "geometry is null");
-            return m_geometry->findClosestVertex(position)->position();
+            return geometry().findClosestVertex(position)->position();
         }
 
         std::vector<vm::vec3> Brush::findClosestVertexPositions(const std::vector<vm::vec3>& positions) const {
-            ensure(m_geometry != nullptr, "geometry is null");
-            
             std::vector<vm::vec3> result;
             result.reserve(positions.size());
 
             for (const auto& position : positions) {
-                const auto* newVertex = m_geometry->findClosestVertex(position, CloseVertexEpsilon);
+                const auto* newVertex = geometry().findClosestVertex(position, CloseVertexEpsilon);
                 if (newVertex != nullptr) {
                     result.push_back(newVertex->position());
                 }
@@ -358,13 +624,11 @@ namespace TrenchBroom {
         }
 
         std::vector<vm::segment3> Brush::findClosestEdgePositions(const std::vector<vm::segment3>& positions) const {
-            ensure(m_geometry != nullptr, "geometry is null");
-            
             std::vector<vm::segment3> result;
             result.reserve(positions.size());
 
             for (const auto& edgePosition : positions) {
-                const auto* newEdge = m_geometry->findClosestEdge(edgePosition.start(), edgePosition.end(), CloseVertexEpsilon);
+                const auto* newEdge = geometry().findClosestEdge(edgePosition.start(), edgePosition.end(), CloseVertexEpsilon);
                 if (newEdge != nullptr) {
                     result.push_back(vm::segment3(newEdge->firstVertex()->position(), newEdge->secondVertex()->position()));
                 }
@@ -374,13 +638,11 @@ namespace TrenchBroom {
         }
 
         std::vector<vm::polygon3> Brush::findClosestFacePositions(const std::vector<vm::polygon3>& positions) const {
-            ensure(m_geometry != nullptr, "geometry is null");
-
             std::vector<vm::polygon3> result;
             result.reserve(positions.size());
 
             for (const auto& facePosition : positions) {
-                const auto* newFace = m_geometry->findClosestFace(facePosition.vertices(), CloseVertexEpsilon);
+                const auto* newFace = geometry().findClosestFace(facePosition.vertices(), CloseVertexEpsilon);
                 if (newFace != nullptr) {
                     result.push_back(vm::polygon3(newFace->vertexPositions()));
                 }
@@ -391,23 +653,19 @@ namespace TrenchBroom {
 
 
         bool Brush::hasEdge(const vm::segment3& edge, const FloatType epsilon) const {
-            ensure(m_geometry != nullptr, "geometry is null");
-            return m_geometry->findEdgeByPositions(edge.start(), edge.end(), epsilon) != nullptr;
+            return geometry().findEdgeByPositions(edge.start(), edge.end(), epsilon) != nullptr;
         }
 
         bool Brush::hasFace(const vm::polygon3& face, const FloatType epsilon) const {
-            ensure(m_geometry != nullptr, "geometry is null");
-            return m_geometry->hasFace(face.vertices(), epsilon);
+            return geometry().hasFace(face.vertices(), epsilon);
         }
 
         size_t Brush::edgeCount() const {
-            ensure(m_geometry != nullptr, "geometry is null");
-            return m_geometry->edgeCount();
+            return geometry().edgeCount();
         }
 
         const Brush::EdgeList& Brush::edges() const {
-            ensure(m_geometry != nullptr, "geometry is null");
-            return m_geometry->edges();
+            return geometry().edges();
         }
 
         bool Brush::containsPoint(const vm::vec3& point) const {
@@ -448,20 +706,19 @@ namespace TrenchBroom {
         }
 
         bool Brush::canAddVertex(const vm::bbox3& worldBounds, const vm::vec3& position) const {
-            ensure(m_geometry != nullptr, "geometry is null");
             if (!worldBounds.contains(position)) {
                 return false;
             }
             
-            BrushGeometry newGeometry(kdl::vec_concat(m_geometry->vertexPositions(), std::vector<vm::vec3>({position})));
+            BrushGeometry newGeometry(kdl::vec_concat(geometry().vertexPositions(), std::vector<vm::vec3>({position})));
             return newGeometry.hasVertex(position);
         }
         
         kdl::result<void, BrushError> Brush::addVertex(const vm::bbox3& worldBounds, const vm::vec3& position) {
             assert(canAddVertex(worldBounds, position));
         
-            BrushGeometry newGeometry(kdl::vec_concat(m_geometry->vertexPositions(), std::vector<vm::vec3>({position})));
-            const PolyhedronMatcher<BrushGeometry> matcher(*m_geometry, newGeometry);
+            BrushGeometry newGeometry(kdl::vec_concat(geometry().vertexPositions(), std::vector<vm::vec3>({position})));
+            const PolyhedronMatcher<BrushGeometry> matcher(geometry(), newGeometry);
             return updateFacesFromGeometry(worldBounds, matcher, newGeometry);
         }
 
@@ -480,19 +737,17 @@ namespace TrenchBroom {
         }
 
         bool Brush::canRemoveVertices(const vm::bbox3& /* worldBounds */, const std::vector<vm::vec3>& vertexPositions) const {
-            ensure(m_geometry != nullptr, "geometry is null");
             ensure(!vertexPositions.empty(), "no vertex positions");
 
-            return removeVerticesFromGeometry(*m_geometry, vertexPositions).polyhedron();
+            return removeVerticesFromGeometry(geometry(), vertexPositions).polyhedron();
         }
 
         kdl::result<void, BrushError> Brush::removeVertices(const vm::bbox3& worldBounds, const std::vector<vm::vec3>& vertexPositions) {
-            ensure(m_geometry != nullptr, "geometry is null");
             ensure(!vertexPositions.empty(), "no vertex positions");
             assert(canRemoveVertices(worldBounds, vertexPositions));
 
-            const BrushGeometry newGeometry = removeVerticesFromGeometry(*m_geometry, vertexPositions);
-            const PolyhedronMatcher<BrushGeometry> matcher(*m_geometry, newGeometry);
+            const BrushGeometry newGeometry = removeVerticesFromGeometry(geometry(), vertexPositions);
+            const PolyhedronMatcher<BrushGeometry> matcher(geometry(), newGeometry);
             return updateFacesFromGeometry(worldBounds, matcher, newGeometry);
         }
 
@@ -508,17 +763,14 @@ namespace TrenchBroom {
         }
         
         bool Brush::canSnapVertices(const vm::bbox3& /* worldBounds */, const FloatType snapToF) const {
-            ensure(m_geometry != nullptr, "geometry is null");
-            return snappedGeometry(*m_geometry, snapToF).polyhedron();
+            return snappedGeometry(geometry(), snapToF).polyhedron();
         }
 
         kdl::result<void, BrushError> Brush::snapVertices(const vm::bbox3& worldBounds, const FloatType snapToF, const bool uvLock) {
-            ensure(m_geometry != nullptr, "geometry is null");
-            
-            const BrushGeometry newGeometry = snappedGeometry(*m_geometry, snapToF);
+            const BrushGeometry newGeometry = snappedGeometry(geometry(), snapToF);
 
             std::map<vm::vec3,vm::vec3> vertexMapping;
-            for (const auto* vertex : m_geometry->vertices()) {
+            for (const auto* vertex : geometry().vertices()) {
                 const auto& origin = vertex->position();
                 const auto destination = snapToF * round(origin / snapToF);
                 if (newGeometry.hasVertex(destination)) {
@@ -526,12 +778,11 @@ namespace TrenchBroom {
                 }
             }
 
-            const PolyhedronMatcher<BrushGeometry> matcher(*m_geometry, newGeometry, vertexMapping);
+            const PolyhedronMatcher<BrushGeometry> matcher(geometry(), newGeometry, vertexMapping);
             return updateFacesFromGeometry(worldBounds, matcher, newGeometry, uvLock);
         }
 
         bool Brush::canMoveEdges(const vm::bbox3& worldBounds, const std::vector<vm::segment3>& edgePositions, const vm::vec3& delta) const {
-            ensure(m_geometry != nullptr, "geometry is null");
             ensure(!edgePositions.empty(), "no edge positions");
 
             std::vector<vm::vec3> vertexPositions;
@@ -563,7 +814,6 @@ namespace TrenchBroom {
         }
 
         bool Brush::canMoveFaces(const vm::bbox3& worldBounds, const std::vector<vm::polygon3>& facePositions, const vm::vec3& delta) const {
-            ensure(m_geometry != nullptr, "geometry is null");
             ensure(!facePositions.empty(), "no face positions");
 
             std::vector<vm::vec3> vertexPositions;
@@ -648,7 +898,7 @@ namespace TrenchBroom {
             std::vector<vm::vec3> resultPoints;
             resultPoints.reserve(vertexCount());
             
-            for (const auto* vertex : m_geometry->vertices()) {
+            for (const auto* vertex : geometry().vertices()) {
                 const auto& position = vertex->position();
                 if (!vertexSet.count(position)) {
                     // the vertex is not moving
@@ -724,14 +974,13 @@ namespace TrenchBroom {
         }
 
         kdl::result<void, BrushError> Brush::doMoveVertices(const vm::bbox3& worldBounds, const std::vector<vm::vec3>& vertexPositions, const vm::vec3& delta, const bool uvLock) {
-            ensure(m_geometry != nullptr, "geometry is null");
             ensure(!vertexPositions.empty(), "no vertex positions");
             assert(canMoveVertices(worldBounds, vertexPositions, delta));
 
             std::vector<vm::vec3> newVertices;
             newVertices.reserve(vertexCount());
             
-            for (const auto* vertex : m_geometry->vertices()) {
+            for (const auto* vertex : geometry().vertices()) {
                 const auto& position = vertex->position();
                 if (kdl::vec_contains(vertexPositions, position)) {
                     newVertices.push_back(position + delta);
@@ -744,7 +993,7 @@ namespace TrenchBroom {
 
             using VecMap = std::map<vm::vec3, vm::vec3>;
             VecMap vertexMapping;
-            for (auto* oldVertex : m_geometry->vertices()) {
+            for (auto* oldVertex : geometry().vertices()) {
                 const auto& oldPosition = oldVertex->position();
                 const auto moved = kdl::vec_contains(vertexPositions, oldPosition);
                 const auto newPosition = moved ? oldPosition + delta : oldPosition;
@@ -754,7 +1003,7 @@ namespace TrenchBroom {
                 }
             }
 
-            const PolyhedronMatcher<BrushGeometry> matcher(*m_geometry, newGeometry, vertexMapping);
+            const PolyhedronMatcher<BrushGeometry> matcher(geometry(), newGeometry, vertexMapping);
             return updateFacesFromGeometry(worldBounds, matcher, newGeometry, uvLock);
         }
 
@@ -866,13 +1115,13 @@ namespace TrenchBroom {
         }
 
         std::vector<kdl::result<Brush, BrushError>> Brush::subtract(const MapFormat mapFormat, const vm::bbox3& worldBounds, const std::string& defaultTextureName, const std::vector<const Brush*>& subtrahends) const {
-            auto result = std::vector<BrushGeometry>{*m_geometry};
+            auto result = std::vector<BrushGeometry>{geometry()};
 
             for (const auto* subtrahend : subtrahends) {
                 auto nextResults = std::vector<BrushGeometry>{};
 
                 for (const BrushGeometry& fragment : result) {
-                    auto subFragments = fragment.subtract(*subtrahend->m_geometry);
+                    auto subFragments = fragment.subtract(subtrahend->geometry());
                     nextResults = kdl::vec_concat(std::move(nextResults), std::move(subFragments));
                 }
 
@@ -894,6 +1143,10 @@ namespace TrenchBroom {
         }
 
         kdl::result<void, BrushError> Brush::transform(const vm::bbox3& worldBounds, const vm::mat4x4& transformation, const bool lockTextures) {
+            if (lockTextures) {
+                geometry();
+            }
+
             for (auto& face : m_faces) {
                 if (const auto transformResult = face.transform(transformation, lockTextures); !transformResult) {
                     return BrushError::InvalidFace;
@@ -918,7 +1171,7 @@ namespace TrenchBroom {
         }
 
         bool Brush::contains(const Brush& brush) const {
-            return m_geometry->contains(*brush.m_geometry);
+            return geometry().contains(brush.geometry());
         }
 
         bool Brush::intersects(const vm::bbox3& bounds) const {
@@ -926,7 +1179,7 @@ namespace TrenchBroom {
         }
 
         bool Brush::intersects(const Brush& brush) const {
-            return m_geometry->intersects(*brush.m_geometry);
+            return geometry().intersects(brush.geometry());
         }
 
         kdl::result<Brush, BrushError> Brush::createBrush(const MapFormat mapFormat, const vm::bbox3& worldBounds, const std::string& defaultTextureName, const BrushGeometry& geometry, const std::vector<const Brush*>& subtrahends) const {
@@ -1020,7 +1273,7 @@ namespace TrenchBroom {
         }
 
         bool operator==(const Brush& lhs, const Brush& rhs) {
-            return lhs.faces() == rhs.faces();
+            return lhs.m_faces == rhs.m_faces;
         }
 
         bool operator!=(const Brush& lhs, const Brush& rhs) {
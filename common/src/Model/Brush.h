@@ -26,8 +26,11 @@
 #include <kdl/result_forward.h>
 
 #include <vecmath/forward.h>
+#include <vecmath/bbox.h>
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <vector>
@@ -41,8 +44,6 @@ namespace TrenchBroom {
 
         class Brush {
         private:
-            class CopyCallback;
-            
             /**
              * Epsilon value to use when finding a vertex after applying a vertex operation
              */
@@ -52,7 +53,34 @@ namespace TrenchBroom {
             using EdgeList = BrushEdgeList;
         private:
             std::vector<BrushFace> m_faces;
-            std::unique_ptr<BrushGeometry> m_geometry;
+            vm::bbox3 m_worldBounds;
+            vm::bbox3 m_bounds;
+
+            /**
+             * The geometry is derived from the faces and is built on demand. Copies of a brush don't copy the
+             * geometry, and the geometry of an unused brush can be released with releaseGeometry().
+             *
+             * m_hasGeometry is set once m_geometry is built so that accessing built geometry doesn't need to lock
+             * m_geometryMutex. The mutex only serializes building and releasing the geometry.
+             */
+            mutable std::unique_ptr<BrushGeometry> m_geometry;
+            mutable std::atomic<bool> m_hasGeometry;
+            mutable std::mutex m_geometryMutex;
+
+            /**
+             * The value of the geometry access clock when the geometry was last accessed, so that the geometry of the
+             * least recently used brushes can be released first.
+             */
+            mutable std::atomic<size_t> m_lastGeometryAccess;
+
+            /**
+             * Indicates whether clipping the faces in sorted order is guaranteed to reproduce the geometry. This is
+             * only the case if no face was dropped when the geometry was built, because the dropped faces took part
+             * in clipping the original geometry. Brushes that cannot rebuild their geometry always keep it.
+             */
+            bool m_canRebuildGeometry;
+
+            class CopyCallback;
         public:
             Brush();
 
@@ -65,13 +93,70 @@ namespace TrenchBroom {
             ~Brush();
             
             static kdl::result<Brush, BrushError> create(const vm::bbox3& worldBounds, std::vector<BrushFace> faces);
+
+            /**
+             * Creates a brush like create(), but defers building the geometry until it is first accessed. The bounds are
+             * computed from the face planes instead. If the faces cannot be shown to form a closed brush in which every
+             * face has a polygon, the geometry is built immediately so that the same errors are reported as by create().
+             *
+             * Accessing the faces of the returned brush builds the geometry, except via facesWithoutGeometry().
+             */
+            static kdl::result<Brush, BrushError> createDeferred(const vm::bbox3& worldBounds, std::vector<BrushFace> faces);
         private:
             Brush(std::vector<BrushFace> faces);
 
             kdl::result<void, BrushError> updateGeometryFromFaces(const vm::bbox3& worldBounds);
+
+            /**
+             * Returns the geometry of this brush, building it from the faces if necessary. This function can be
+             * called concurrently from any thread. If the geometry is already built, it does not lock.
+             */
+            const BrushGeometry& geometry() const;
         public:
+            /**
+             * Returns the bounds of this brush. The bounds are kept when the geometry is released, so calling this
+             * function never builds the geometry.
+             */
             const vm::bbox3& bounds() const;
-        public: // face management:
+
+            /**
+             * Indicates whether the geometry of this brush is currently built. This function does not lock.
+             */
+            bool hasGeometry() const;
+
+            /**
+             * Releases the geometry of this brush if it can be rebuilt from the faces. The geometry is rebuilt when it
+             * is needed again, e.g. when the faces, vertices or edges of this brush are accessed.
+             *
+             * Only call this function from the main thread, and only if no other thread accesses this brush and no
+             * caller holds a reference to its geometry, vertices, edges or face geometries.
+             *
+             * @return true if the geometry was released and false otherwise
+             */
+            bool releaseGeometry();
+
+            /**
+             * Returns the value of the geometry access clock when the geometry of this brush was last accessed.
+             */
+            size_t lastGeometryAccess() const;
+
+            /**
+             * Advances the geometry access clock. Brushes whose geometry is accessed afterwards count as more recently
+             * used than brushes whose geometry was last accessed before.
+             */
+            static void advanceGeometryAccessClock();
+
+            /**
+             * Returns an estimate of the number of bytes used by the geometry of all brushes.
+             */
+            static size_t geometryMemorySize();
+
+            /**
+             * Returns the memory freed by releasing or destroying brush geometry to the system and returns the number of
+             * bytes released. Only call this function after releasing the geometry of many brushes.
+             */
+            static size_t releaseUnusedGeometryMemory();
+        public: // face management; accessing the faces builds the geometry because the faces refer to it:
             std::optional<size_t> findFace(const std::string& textureName) const;
             std::optional<size_t> findFace(const vm::vec3& normal) const;
             std::optional<size_t> findFace(const vm::plane3& boundary) const;
@@ -80,10 +165,23 @@ namespace TrenchBroom {
 
             const BrushFace& face(size_t index) const;
             BrushFace& face(size_t index);
+
+            /**
+             * Returns the faces without building the geometry. The returned faces may not be linked with their face
+             * geometries, so only their attributes, textures, tags and selection state may be used.
+             */
+            const std::vector<BrushFace>& facesWithoutGeometry() const;
+            std::vector<BrushFace>& facesWithoutGeometry();
             size_t faceCount() const;
             const std::vector<BrushFace>& faces() const;
             std::vector<BrushFace>& faces();
 
+            /**
+             * Removes the textures from all faces. Unlike setting the texture of each face, this does not build the
+             * geometry.
+             */
+            void unsetTextures();
+
             bool closed() const;
             bool fullySpecified() const;
         public: // clone face attributes from matching faces of other brushes
@@ -262,6 +360,8 @@ namespace TrenchBroom {
             Brush convertToParallel() const;
         private:
             bool checkFaceLinks() const;
+
+            friend bool operator==(const Brush& lhs, const Brush& rhs);
         };
 
         bool operator==(const Brush& lhs, const Brush& rhs);
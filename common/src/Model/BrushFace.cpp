@@ -46,6 +46,8 @@
 #include <vecmath/vec.h>
 #include <vecmath/vec_io.h>
 
+#include <algorithm>
+#include <numeric>
 #include <sstream>
 #include <string>
 
@@ -193,25 +195,36 @@ namespace TrenchBroom {
             return str;
         }
 
+        static bool compareFaceBoundaries(const BrushFace& lhs, const BrushFace& rhs) {
+            const auto& lhsBoundary = lhs.boundary();
+            const auto& rhsBoundary = rhs.boundary();
+
+            const auto cmp = vm::compare(lhsBoundary.normal, rhsBoundary.normal);
+            if (cmp < 0) {
+                return true;
+            } else if (cmp > 0) {
+                return false;
+            } else {
+                // normal vectors are identical -- this should never happen
+                return lhsBoundary.distance < rhsBoundary.distance;
+            }
+        }
+
         void BrushFace::sortFaces(std::vector<BrushFace>& faces) {
             // Originally, the idea to sort faces came from TxQBSP, but the sorting used there was not entirely clear to me.
             // But it is still desirable to have a deterministic order in which the faces are added to the brush, so I chose
             // to just sort the faces by their normals.
 
-            std::sort(std::begin(faces), std::end(faces), [](const auto& lhs, const auto& rhs) {
-                const auto& lhsBoundary = lhs.boundary();
-                const auto& rhsBoundary = rhs.boundary();
-
-                const auto cmp = vm::compare(lhsBoundary.normal, rhsBoundary.normal);
-                if (cmp < 0) {
-                    return true;
-                } else if (cmp > 0) {
-                    return false;
-                } else {
-                    // normal vectors are identical -- this should never happen
-                    return lhsBoundary.distance < rhsBoundary.distance;
-                }
+            std::sort(std::begin(faces), std::end(faces), compareFaceBoundaries);
+        }
+
+        std::vector<size_t> BrushFace::sortedFaceIndices(const std::vector<BrushFace>& faces) {
+            auto result = std::vector<size_t>(faces.size());
+            std::iota(std::begin(result), std::end(result), 0u);
+            std::stable_sort(std::begin(result), std::end(result), [&](const size_t lhs, const size_t rhs) {
+                return compareFaceBoundaries(faces[lhs], faces[rhs]);
             });
+            return result;
         }
 
         std::unique_ptr<TexCoordSystemSnapshot> BrushFace::takeTexCoordSystemSnapshot() const {
@@ -581,7 +594,7 @@ namespace TrenchBroom {
             return m_geometry;
         }
 
-        void BrushFace::setGeometry(BrushFaceGeometry* geometry) {
+        void BrushFace::setGeometry(BrushFaceGeometry* geometry) const {
             m_geometry = geometry;
         }
 
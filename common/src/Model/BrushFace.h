@@ -88,7 +88,8 @@ namespace TrenchBroom {
 
             Assets::AssetReference<Assets::Texture> m_textureReference;
             std::unique_ptr<TexCoordSystem> m_texCoordSystem;
-            BrushFaceGeometry* m_geometry;
+            // the owning brush sets this when it builds its geometry on demand
+            mutable BrushFaceGeometry* m_geometry;
 
             mutable size_t m_lineNumber;
             mutable size_t m_lineCount;
@@ -144,6 +145,11 @@ namespace TrenchBroom {
 
             static void sortFaces(std::vector<BrushFace>& faces);
 
+            /**
+             * Returns the indices of the given faces in the order in which sortFaces would sort them.
+             */
+            static std::vector<size_t> sortedFaceIndices(const std::vector<BrushFace>& faces);
+
             std::unique_ptr<TexCoordSystemSnapshot> takeTexCoordSystemSnapshot() const;
             void restoreTexCoordSystemSnapshot(const TexCoordSystemSnapshot& coordSystemSnapshot);
             void copyTexCoordSystemFromFace(const TexCoordSystemSnapshot& coordSystemSnapshot, const BrushFaceAttributes& attributes, const vm::plane3& sourceFacePlane, WrapStyle wrapStyle);
@@ -202,7 +208,7 @@ namespace TrenchBroom {
             vm::polygon3 polygon() const;
         public:
             BrushFaceGeometry* geometry() const;
-            void setGeometry(BrushFaceGeometry* geometry);
+            void setGeometry(BrushFaceGeometry* geometry) const;
 
             size_t lineNumber() const;
             void setFilePosition(size_t lineNumber, size_t lineCount) const;
@@ -110,31 +110,42 @@ namespace TrenchBroom {
             return brush;
         }
 
+        void BrushNode::releaseBrushGeometry() {
+            m_brush.releaseGeometry();
+        }
+
         bool BrushNode::hasSelectedFaces() const {
             return m_selectedFaceCount > 0u;
         }
 
         void BrushNode::selectFace(const size_t faceIndex) {
-            m_brush.face(faceIndex).select();
+            m_brush.facesWithoutGeometry()[faceIndex].select();
             ++m_selectedFaceCount;
         }
         
         void BrushNode::deselectFace(const size_t faceIndex) {
-            m_brush.face(faceIndex).deselect();
+            m_brush.facesWithoutGeometry()[faceIndex].deselect();
             --m_selectedFaceCount;
         }
 
         void BrushNode::updateFaceTags(const size_t faceIndex, TagManager& tagManager) {
-            m_brush.face(faceIndex).updateTags(tagManager);
+            m_brush.facesWithoutGeometry()[faceIndex].updateTags(tagManager);
         }
 
         void BrushNode::setFaceTexture(const size_t faceIndex, Assets::Texture* texture) {
-            m_brush.face(faceIndex).setTexture(texture);
+            m_brush.facesWithoutGeometry()[faceIndex].setTexture(texture);
             
             invalidateIssues();
             invalidateVertexCache();
         }
 
+        void BrushNode::unsetFaceTextures() {
+            m_brush.unsetTextures();
+
+            invalidateIssues();
+            invalidateVertexCache();
+        }
+
         static bool containsPatch(const Brush& brush, const PatchGrid& grid) {
             if (!brush.bounds().contains(grid.bounds)) {
                 return false;
@@ -220,7 +231,7 @@ namespace TrenchBroom {
         }
 
         void BrushNode::clearSelectedFaces() {
-            for (BrushFace& face : m_brush.faces()) {
+            for (BrushFace& face : m_brush.facesWithoutGeometry()) {
                 if (face.selected()) {
                     face.deselect();
                 }
@@ -230,7 +241,7 @@ namespace TrenchBroom {
 
         void BrushNode::updateSelectedFaceCount() {
             m_selectedFaceCount = 0u;
-            for (const BrushFace& face : m_brush.faces()) {
+            for (const BrushFace& face : m_brush.facesWithoutGeometry()) {
                 if (face.selected()) {
                     ++m_selectedFaceCount;
                 }
@@ -352,20 +363,20 @@ namespace TrenchBroom {
 
         void BrushNode::initializeTags(TagManager& tagManager) {
             Taggable::initializeTags(tagManager);
-            for (auto& face : m_brush.faces()) {
+            for (auto& face : m_brush.facesWithoutGeometry()) {
                 face.initializeTags(tagManager);
             }
         }
 
         void BrushNode::clearTags() {
-            for (auto& face : m_brush.faces()) {
+            for (auto& face : m_brush.facesWithoutGeometry()) {
                 face.clearTags();
             }
             Taggable::clearTags();
         }
 
         void BrushNode::updateTags(TagManager& tagManager) {
-            for (auto& face : m_brush.faces()) {
+            for (auto& face : m_brush.facesWithoutGeometry()) {
                 face.updateTags(tagManager);
             }
             Taggable::updateTags(tagManager);
@@ -375,14 +386,14 @@ namespace TrenchBroom {
             // Possible optimization: Store the shared face tag mask in the brush and updated it when a face changes.
 
             TagType::Type sharedFaceTags = TagType::AnyType; // set all bits to 1
-            for (const auto& face : m_brush.faces()) {
+            for (const auto& face : m_brush.facesWithoutGeometry()) {
                 sharedFaceTags &= face.tagMask();
             }
             return (sharedFaceTags & tagMask) != 0;
         }
 
         bool BrushNode::anyFaceHasAnyTag() const {
-            for (const auto& face : m_brush.faces()) {
+            for (const auto& face : m_brush.facesWithoutGeometry()) {
                 if (face.hasAnyTag()) {
                     return true;
                 }
@@ -393,7 +404,7 @@ namespace TrenchBroom {
         bool BrushNode::anyFacesHaveAnyTagInMask(TagType::Type tagMask) const {
             // Possible optimization: Store the shared face tag mask in the brush and updated it when a face changes.
 
-            for (const auto& face : m_brush.faces()) {
+            for (const auto& face : m_brush.facesWithoutGeometry()) {
                 if (face.hasTag(tagMask)) {
                     return true;
                 }
@@ -75,6 +75,12 @@ namespace TrenchBroom {
             const Brush& brush() const;
             Brush setBrush(Brush brush);
 
+            /**
+             * Releases the geometry of this node's brush to save memory if it can be rebuilt when it is needed again.
+             * See Brush::releaseGeometry for when this may be called.
+             */
+            void releaseBrushGeometry();
+
             bool hasSelectedFaces() const;
             void selectFace(size_t faceIndex);
             void deselectFace(size_t faceIndex);
@@ -82,6 +88,7 @@ namespace TrenchBroom {
             void updateFaceTags(size_t faceIndex, TagManager& tagManager);
             
             void setFaceTexture(size_t faceIndex, Assets::Texture* texture);
+            void unsetFaceTextures();
 
             bool contains(const Node* node) const;
             bool intersects(const Node* node) const;
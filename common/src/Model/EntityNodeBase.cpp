@@ -25,6 +25,8 @@
 #include <kdl/collection_utils.h>
 #include <kdl/vector_utils.h>
 
+#include <algorithm>
+#include <iterator>
 #include <string>
 #include <vector>
 
@@ -280,26 +282,34 @@ namespace TrenchBroom {
 
         std::vector<std::string> EntityNodeBase::findMissingLinkTargets() const {
             std::vector<std::string> result;
-            findMissingTargets(PropertyKeys::Target, result);
+            findMissingTargets(PropertyKeys::Target, m_linkTargets, result);
             return result;
         }
 
         std::vector<std::string> EntityNodeBase::findMissingKillTargets() const {
             std::vector<std::string> result;
-            findMissingTargets(PropertyKeys::Killtarget, result);
+            findMissingTargets(PropertyKeys::Killtarget, m_killTargets, result);
             return result;
         }
 
-        void EntityNodeBase::findMissingTargets(const std::string& prefix, std::vector<std::string>& result) const {
-            for (const EntityProperty& property : m_entity.numberedProperties(prefix)) {
+        /**
+         * The links are updated whenever a property of an entity changes, so a target is missing exactly if none of
+         * the given linked entities has the target's value as its targetname. Checking this does not require querying
+         * the entity node index.
+         */
+        void EntityNodeBase::findMissingTargets(const std::string& prefix, const std::vector<EntityNodeBase*>& targets, std::vector<std::string>& result) const {
+            for (const EntityProperty& property : m_entity.properties()) {
+                if (!property.hasNumberedPrefix(prefix)) {
+                    continue;
+                }
+
                 const std::string& targetname = property.value();
-                if (targetname.empty()) {
+                const auto hasTarget = !targetname.empty() && std::any_of(std::begin(targets), std::end(targets), [&](const EntityNodeBase* target) {
+                    const auto* targetTargetname = target->entity().property(PropertyKeys::Targetname);
+                    return targetTargetname && *targetTargetname == targetname;
+                });
+                if (!hasTarget) {
                     result.push_back(property.key());
-                } else {
-                    std::vector<EntityNodeBase*> linkTargets;
-                    findEntityNodesWithProperty(PropertyKeys::Targetname, targetname, linkTargets);
-                    if (linkTargets.empty())
-                        result.push_back(property.key());
                 }
             }
         }
@@ -427,6 +437,10 @@ namespace TrenchBroom {
         }
 
         void EntityNodeBase::addLinkTargets(const std::vector<EntityNodeBase*>& targets) {
+            if (targets.empty()) {
+                return;
+            }
+
             m_linkTargets.reserve(m_linkTargets.size() + targets.size());
             for (EntityNodeBase* target : targets) {
                 target->addLinkSource(this);
@@ -436,6 +450,10 @@ namespace TrenchBroom {
         }
 
         void EntityNodeBase::addKillTargets(const std::vector<EntityNodeBase*>& targets) {
+            if (targets.empty()) {
+                return;
+            }
+
             m_killTargets.reserve(m_killTargets.size() + targets.size());
             for (EntityNodeBase* target : targets) {
                 target->addKillSource(this);
@@ -445,6 +463,10 @@ namespace TrenchBroom {
         }
 
         void EntityNodeBase::addLinkSources(const std::vector<EntityNodeBase*>& sources) {
+            if (sources.empty()) {
+                return;
+            }
+
             m_linkSources.reserve(m_linkSources.size() + sources.size());
             for (EntityNodeBase* linkSource : sources) {
                 linkSource->addLinkTarget(this);
@@ -454,6 +476,10 @@ namespace TrenchBroom {
         }
 
         void EntityNodeBase::addKillSources(const std::vector<EntityNodeBase*>& sources) {
+            if (sources.empty()) {
+                return;
+            }
+
             m_killSources.reserve(m_killSources.size() + sources.size());
             for (EntityNodeBase* killSource : sources) {
                 killSource->addKillTarget(this);
@@ -463,6 +489,10 @@ namespace TrenchBroom {
         }
 
         void EntityNodeBase::removeAllLinkSources() {
+            if (m_linkSources.empty()) {
+                return;
+            }
+
             for (EntityNodeBase* linkSource : m_linkSources)
                 linkSource->removeLinkTarget(this);
             m_linkSources.clear();
@@ -470,6 +500,10 @@ namespace TrenchBroom {
         }
 
         void EntityNodeBase::removeAllLinkTargets() {
+            if (m_linkTargets.empty()) {
+                return;
+            }
+
             for (EntityNodeBase* linkTarget : m_linkTargets)
                 linkTarget->removeLinkSource(this);
             m_linkTargets.clear();
@@ -477,6 +511,10 @@ namespace TrenchBroom {
         }
 
         void EntityNodeBase::removeAllKillSources() {
+            if (m_killSources.empty()) {
+                return;
+            }
+
             for (EntityNodeBase* killSource : m_killSources)
                 killSource->removeKillTarget(this);
             m_killSources.clear();
@@ -484,6 +522,10 @@ namespace TrenchBroom {
         }
 
         void EntityNodeBase::removeAllKillTargets() {
+            if (m_killTargets.empty()) {
+                return;
+            }
+
             for (EntityNodeBase* killTarget : m_killTargets)
                 killTarget->removeKillSource(this);
             m_killTargets.clear();
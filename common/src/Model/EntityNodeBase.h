@@ -94,7 +94,7 @@ namespace TrenchBroom {
             std::vector<std::string> findMissingLinkTargets() const;
             std::vector<std::string> findMissingKillTargets() const;
         private: // link management internals
-            void findMissingTargets(const std::string& prefix, std::vector<std::string>& result) const;
+            void findMissingTargets(const std::string& prefix, const std::vector<EntityNodeBase*>& targets, std::vector<std::string>& result) const;
 
 
             void addLinks(const std::string& name, const std::string& value);
@@ -139,16 +139,7 @@ namespace TrenchBroom {
             result = kdl::vec_sort_and_remove_duplicates(std::move(result));
 
             // next, remove results from the result set that don't match `keyQuery`
-            auto it = std::begin(result);
-            while (it != std::end(result)) {
-                const EntityNodeBase* node = *it;
-                if (!keyQuery.execute(node, value))
-                    it = result.erase(it);
-                else
-                    ++it;
-            }
-
-            return result;
+            return kdl::vec_erase_if(std::move(result), [&](const EntityNodeBase* node) { return !keyQuery.execute(node, value); });
         }
 
         std::vector<std::string> EntityNodeIndex::allKeys() const {
@@ -91,14 +91,14 @@ namespace TrenchBroom {
         m_value(value) {}
 
         int EntityProperty::compare(const EntityProperty& rhs) const {
-            const int keyCmp = m_key.compare(rhs.m_key);
+            const int keyCmp = m_key == rhs.m_key ? 0 : m_key.str().compare(rhs.m_key.str());
             if (keyCmp != 0)
                 return keyCmp;
             return m_value.compare(rhs.m_value);
         }
 
         const std::string& EntityProperty::key() const {
-            return m_key;
+            return m_key.str();
         }
 
         const std::string& EntityProperty::value() const {
@@ -106,7 +106,7 @@ namespace TrenchBroom {
         }
 
         bool EntityProperty::hasKey(std::string_view key) const {
-            return kdl::cs::str_is_equal(m_key, key);
+            return kdl::cs::str_is_equal(m_key.str(), key);
         }
 
         bool EntityProperty::hasValue(const std::string_view value) const {
@@ -118,7 +118,7 @@ namespace TrenchBroom {
         }
 
         bool EntityProperty::hasPrefix(const std::string_view prefix) const {
-            return kdl::cs::str_is_prefix(m_key, prefix);
+            return kdl::cs::str_is_prefix(m_key.str(), prefix);
         }
 
         bool EntityProperty::hasPrefixAndValue(const std::string_view prefix, const std::string_view value) const {
@@ -126,7 +126,7 @@ namespace TrenchBroom {
         }
 
         bool EntityProperty::hasNumberedPrefix(const std::string_view prefix) const {
-            return isNumberedProperty(prefix, m_key);
+            return isNumberedProperty(prefix, m_key.str());
         }
 
         bool EntityProperty::hasNumberedPrefixAndValue(const std::string_view prefix, const std::string_view value) const {
@@ -134,7 +134,7 @@ namespace TrenchBroom {
         }
 
         void EntityProperty::setKey(const std::string& key) {
-            m_key = key;
+            m_key = kdl::interned_string{key};
         }
 
         void EntityProperty::setValue(const std::string& value) {
@@ -19,6 +19,8 @@
 
 #pragma once
 
+#include <kdl/interned_string.h>
+
 #include <iosfwd>
 #include <string>
 #include <vector>
@@ -77,7 +79,9 @@ namespace TrenchBroom {
 
         class EntityProperty {
         private:
-            std::string m_key;
+            // Keys come from a small vocabulary and are shared by many entities, so they are interned. Values are
+            // not, because many of them are unique, such as origins, and the pool never releases its strings.
+            kdl::interned_string m_key;
             std::string m_value;
         public:
             EntityProperty();
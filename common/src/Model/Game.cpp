@@ -82,8 +82,8 @@ namespace TrenchBroom {
             return doLoadMap(format, worldBounds, path, logger);
         }
 
-        void Game::writeMap(WorldNode& world, const IO::Path& path) const {
-            doWriteMap(world, path);
+        size_t Game::writeMap(WorldNode& world, const IO::Path& path) const {
+            return doWriteMap(world, path);
         }
 
         void Game::exportMap(WorldNode& world, const Model::ExportFormat format, const IO::Path& path) const {
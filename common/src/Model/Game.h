@@ -97,7 +97,11 @@ namespace TrenchBroom {
         public: // loading and writing map files
             std::unique_ptr<WorldNode> newMap(MapFormat format, const vm::bbox3& worldBounds, Logger& logger) const;
             std::unique_ptr<WorldNode> loadMap(MapFormat format, const vm::bbox3& worldBounds, const IO::Path& path, Logger& logger) const;
-            void writeMap(WorldNode& world, const IO::Path& path) const;
+            /**
+             * Writes the given world to the given path and returns the number of brushes and patches whose cached
+             * serialization was reused.
+             */
+            size_t writeMap(WorldNode& world, const IO::Path& path) const;
             void exportMap(WorldNode& world, Model::ExportFormat format, const IO::Path& path) const;
         public: // parsing and serializing objects
             std::vector<Node*> parseNodes(const std::string& str, MapFormat mapFormat, const vm::bbox3& worldBounds, Logger& logger) const;
@@ -146,7 +150,7 @@ namespace TrenchBroom {
 
             virtual std::unique_ptr<WorldNode> doNewMap(MapFormat format, const vm::bbox3& worldBounds, Logger& logger) const = 0;
             virtual std::unique_ptr<WorldNode> doLoadMap(MapFormat format, const vm::bbox3& worldBounds, const IO::Path& path, Logger& logger) const = 0;
-            virtual void doWriteMap(WorldNode& world, const IO::Path& path) const = 0;
+            virtual size_t doWriteMap(WorldNode& world, const IO::Path& path) const = 0;
             virtual void doExportMap(WorldNode& world, Model::ExportFormat format, const IO::Path& path) const = 0;
 
             virtual std::vector<Node*> doParseNodes(const std::string& str, MapFormat mapFormat, const vm::bbox3& worldBounds, Logger& logger) const = 0;
@@ -177,7 +177,7 @@ namespace TrenchBroom {
 
         std::unique_ptr<WorldNode> GameImpl::doLoadMap(const MapFormat format, const vm::bbox3& worldBounds, const IO::Path& path, Logger& logger) const {
             IO::SimpleParserStatus parserStatus(logger);
-            auto file = IO::Disk::openFile(IO::Disk::fixPath(path));
+            auto file = IO::Disk::openMappedFile(IO::Disk::fixPath(path));
             auto fileReader = file->reader().buffer();
             if (format == MapFormat::Unknown) {
                 // Try all formats listed in the game config
@@ -191,7 +191,7 @@ namespace TrenchBroom {
             }
         }
 
-        void GameImpl::doWriteMap(WorldNode& world, const IO::Path& path, const bool exporting) const {
+        size_t GameImpl::doWriteMap(WorldNode& world, const IO::Path& path, const bool exporting) const {
             const auto mapFormatName = formatName(world.mapFormat());
 
             std::ofstream file = openPathAsOutputStream(path);
@@ -202,11 +202,11 @@ namespace TrenchBroom {
 
             IO::NodeWriter writer(world, file);
             writer.setExporting(exporting);
-            writer.writeMap();
+            return writer.writeMap();
         }
 
-        void GameImpl::doWriteMap(WorldNode& world, const IO::Path& path) const {
-            doWriteMap(world, path, false);
+        size_t GameImpl::doWriteMap(WorldNode& world, const IO::Path& path) const {
+            return doWriteMap(world, path, false);
         }
 
         void GameImpl::doExportMap(WorldNode& world, const Model::ExportFormat format, const IO::Path& path) const {
@@ -272,7 +272,8 @@ namespace TrenchBroom {
             const auto paths = extractTextureCollections(entity);
 
             const auto fileSearchPaths = textureCollectionSearchPaths(documentPath);
-            IO::TextureLoader textureLoader(m_fs, fileSearchPaths, m_config.textureConfig(), logger);
+            const auto cacheDirectory = IO::SystemPaths::userDataDirectory() + IO::Path("TextureCache");
+            IO::TextureLoader textureLoader(m_fs, fileSearchPaths, m_config.textureConfig(), cacheDirectory, logger);
             textureLoader.loadTextures(paths, textureManager);
         }
 
@@ -33,8 +33,10 @@
 #include "Model/WorldNode.h"
 
 #include <kdl/overload.h>
+#include <kdl/parallel.h>
 #include <kdl/vector_utils.h>
 
+#include <unordered_set>
 #include <vector>
 
 namespace TrenchBroom {
@@ -281,6 +283,98 @@ namespace TrenchBroom {
             return result;
         }
 
+        /**
+         * Like the above, but the brushes are only tested against the nodes that the spatial index of the given world
+         * returns for their bounds.
+         *
+         * Closed groups are matched against their bounds, which may intersect a brush even if the bounds of none of
+         * their members do. Therefore, the closed groups are collected from the node hierarchy, which is cheap
+         * because only the layers and the opened groups must be visited. Entity nodes compute their bounds lazily and
+         * are therefore tested on the calling thread.
+         */
+        template <typename P>
+        static std::vector<Node*> collectMatchingNodes(WorldNode& world, const std::vector<BrushNode*>& brushes, const P& predicate) {
+            auto closedGroups = std::vector<GroupNode*>{};
+            world.accept(kdl::overload(
+                [] (auto&& thisLambda, Model::WorldNode* w) { w->visitChildren(thisLambda); },
+                [] (auto&& thisLambda, Model::LayerNode* layer) { layer->visitChildren(thisLambda); },
+                [&](auto&& thisLambda, Model::GroupNode* group) {
+                    if (group->opened()) {
+                        group->visitChildren(thisLambda);
+                    } else {
+                        closedGroups.push_back(group);
+                    }
+                },
+                [] (Model::EntityNode*) {},
+                [] (Model::BrushNode*)  {},
+                [] (Model::PatchNode*)  {}
+            ));
+
+            const auto queryBrushes = std::unordered_set<const Node*>{std::begin(brushes), std::end(brushes)};
+            auto matchingNodes = std::vector<std::vector<Node*>>(brushes.size());
+            auto entityCandidates = std::vector<std::vector<EntityNode*>>(brushes.size());
+
+            kdl::parallel_for(brushes.size(), [&](const size_t index) {
+                const auto* brush = brushes[index];
+                for (auto* node : world.findNodesIntersecting(brush->logicalBounds())) {
+                    if (findOutermostClosedGroup(node) != nullptr) {
+                        continue;
+                    }
+
+                    node->accept(kdl::overload(
+                        [] (Model::WorldNode*) {},
+                        [] (Model::LayerNode*) {},
+                        [] (Model::GroupNode*) {},
+                        [&](Model::EntityNode* entity) {
+                            // entities with children are matched by their children
+                            if (!entity->hasChildren()) {
+                                entityCandidates[index].push_back(entity);
+                            }
+                        },
+                        [&](Model::BrushNode* candidate) {
+                            // the query brushes themselves are never matched
+                            if (queryBrushes.count(candidate) == 0u && predicate(candidate, brush)) {
+                                matchingNodes[index].push_back(candidate);
+                            }
+                        },
+                        [&](Model::PatchNode* candidate) {
+                            if (predicate(candidate, brush)) {
+                                matchingNodes[index].push_back(candidate);
+                            }
+                        }
+                    ));
+                }
+            });
+
+            auto result = std::vector<Node*>{};
+            auto visited = std::unordered_set<Node*>{};
+            const auto collectIfMatching = [&](auto* node, const BrushNode* brush) {
+                if (visited.count(node) == 0u && predicate(node, brush)) {
+                    visited.insert(node);
+                    result.push_back(node);
+                }
+            };
+
+            for (auto* group : closedGroups) {
+                for (const auto* brush : brushes) {
+                    collectIfMatching(group, brush);
+                }
+            }
+
+            for (size_t i = 0u; i < brushes.size(); ++i) {
+                for (auto* entity : entityCandidates[i]) {
+                    collectIfMatching(entity, brushes[i]);
+                }
+                for (auto* node : matchingNodes[i]) {
+                    if (visited.insert(node).second) {
+                        result.push_back(node);
+                    }
+                }
+            }
+
+            return result;
+        }
+
         std::vector<Node*> collectTouchingNodes(const std::vector<Node*>& nodes, const std::vector<BrushNode*>& brushes) {
             return collectMatchingNodes(nodes, brushes, [](const auto* node, const auto* brush) {
                 return brush->intersects(node);
@@ -293,6 +387,18 @@ namespace TrenchBroom {
             });
         }
 
+        std::vector<Node*> collectTouchingNodes(WorldNode& world, const std::vector<BrushNode*>& brushes) {
+            return collectMatchingNodes(world, brushes, [](const auto* node, const auto* brush) {
+                return brush->intersects(node);
+            });
+        }
+
+        std::vector<Node*> collectContainedNodes(WorldNode& world, const std::vector<BrushNode*>& brushes) {
+            return collectMatchingNodes(world, brushes, [](const auto* node, const auto* brush) {
+                return brush->contains(node);
+            });
+        }
+
         std::vector<Node*> collectSelectedNodes(const std::vector<Node*>& nodes) {
             auto selectedNodes = std::vector<Model::Node*>{};
             
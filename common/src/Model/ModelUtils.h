@@ -70,6 +70,16 @@ namespace TrenchBroom {
         std::vector<Node*> collectTouchingNodes(const std::vector<Node*>& nodes, const std::vector<BrushNode*>& brushes);
         std::vector<Node*> collectContainedNodes(const std::vector<Node*>& nodes, const std::vector<BrushNode*>& brushes);
 
+        /**
+         * Returns the same nodes as collectTouchingNodes and collectContainedNodes would for the given world, but only
+         * tests the nodes that the world's spatial index returns for the bounds of each brush. The brushes are tested
+         * in parallel.
+         *
+         * The given brushes need not belong to the given world. The returned nodes are in no particular order.
+         */
+        std::vector<Node*> collectTouchingNodes(WorldNode& world, const std::vector<BrushNode*>& brushes);
+        std::vector<Node*> collectContainedNodes(WorldNode& world, const std::vector<BrushNode*>& brushes);
+
         std::vector<Node*> collectSelectedNodes(const std::vector<Node*>& nodes);
 
         std::vector<Node*> collectSelectableNodes(const std::vector<Node*>& nodes, const EditorContext& editorContext);
@@ -24,6 +24,7 @@
 #include "Model/Issue.h"
 #include "Model/IssueGenerator.h"
 #include "Model/LockState.h"
+#include "Model/MapFormat.h"
 #include "Model/VisibilityState.h"
 
 #include <kdl/vector_utils.h>
@@ -31,9 +32,11 @@
 #include <vecmath/bbox.h>
 
 #include <cassert>
+#include <chrono>
 #include <iterator>
 #include <ostream>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace TrenchBroom {
@@ -138,6 +141,7 @@ namespace TrenchBroom {
         void Node::cloneAttributes(Node* node) const {
             node->setVisibilityState(m_visibilityState);
             node->setLockState(m_lockState);
+            node->m_cachedSerialization = m_cachedSerialization;
         }
 
         std::vector<Node*> Node::clone(const vm::bbox3& worldBounds, const std::vector<Node*>& nodes) {
@@ -421,6 +425,7 @@ namespace TrenchBroom {
             if (m_parent != nullptr)
                 m_parent->childDidChange(this);
             invalidateIssues();
+            m_cachedSerialization = nullptr;
         }
 
         Node::NotifyNodeChange::NotifyNodeChange(Node* node) :
@@ -674,11 +679,49 @@ namespace TrenchBroom {
             return lineNumber >= m_lineNumber && lineNumber < m_lineNumber + m_lineCount;
         }
 
+        std::shared_ptr<const NodeSerialization> Node::cachedSerialization(const MapFormat mapFormat) const {
+            if (m_cachedSerialization != nullptr && m_cachedSerialization->mapFormat == mapFormat) {
+                return m_cachedSerialization;
+            }
+            return nullptr;
+        }
+
+        void Node::setCachedSerialization(std::shared_ptr<const NodeSerialization> serialization) const {
+            m_cachedSerialization = std::move(serialization);
+        }
+
         const std::vector<Issue*>& Node::issues(const std::vector<IssueGenerator*>& issueGenerators) {
             validateIssues(issueGenerators);
             return m_issues;
         }
 
+        bool Node::issuesValid() const {
+            return m_issuesValid;
+        }
+
+        void Node::validateIssues(const std::vector<Node*>& nodes, const std::vector<IssueGenerator*>& issueGenerators, std::vector<std::chrono::nanoseconds>& generatorTimes) {
+            assert(generatorTimes.size() == issueGenerators.size());
+
+            const auto invalidNodes = kdl::vec_filter(nodes, [](const auto* node) { return !node->m_issuesValid; });
+            if (invalidNodes.empty()) {
+                return;
+            }
+
+            for (size_t i = 0u; i < issueGenerators.size(); ++i) {
+                const auto* generator = issueGenerators[i];
+
+                const auto start = std::chrono::steady_clock::now();
+                for (auto* node : invalidNodes) {
+                    node->doGenerateIssues(generator, node->m_issues);
+                }
+                generatorTimes[i] += std::chrono::steady_clock::now() - start;
+            }
+
+            for (auto* node : invalidNodes) {
+                node->m_issuesValid = true;
+            }
+        }
+
         bool Node::issueHidden(const IssueType type) const {
             return (type & m_hiddenIssues) != 0;
         }
@@ -28,6 +28,7 @@
 #include <vecmath/bbox.h>
 #include <vecmath/util.h>
 
+#include <chrono>
 #include <iosfwd>
 #include <memory>
 #include <string>
@@ -40,6 +41,7 @@ namespace TrenchBroom {
         class Issue;
         class IssueGenerator;
         enum class LockState;
+        enum class MapFormat;
         class NodeVisitor;
         class PickResult;
         enum class VisibilityState;
@@ -52,6 +54,15 @@ namespace TrenchBroom {
         bool operator!=(const NodePath& lhs, const NodePath& rhs);
         std::ostream& operator<<(std::ostream& str, const NodePath& path);
 
+        /**
+         * The text that a node was serialized to in a map file of the given format.
+         */
+        struct NodeSerialization {
+            MapFormat mapFormat;
+            std::string string;
+            size_t lineCount;
+        };
+
         class Node : public Taggable {
         private:
             Node* m_parent;
@@ -67,6 +78,7 @@ namespace TrenchBroom {
 
             mutable size_t m_lineNumber;
             mutable size_t m_lineCount;
+            mutable std::shared_ptr<const NodeSerialization> m_cachedSerialization;
 
             mutable std::vector<Issue*> m_issues;
             mutable bool m_issuesValid;
@@ -325,8 +337,26 @@ namespace TrenchBroom {
             size_t lineNumber() const;
             void setFilePosition(size_t lineNumber, size_t lineCount) const;
             bool containsLine(size_t lineNumber) const;
+        public: // serialization cache
+            /**
+             * Returns the text that this node was last serialized to in the given map format, or nullptr if it was
+             * serialized in another format or if it has changed since. Clones share the cached serialization.
+             */
+            std::shared_ptr<const NodeSerialization> cachedSerialization(MapFormat mapFormat) const;
+            void setCachedSerialization(std::shared_ptr<const NodeSerialization> serialization) const;
         public: // issue management
             const std::vector<Issue*>& issues(const std::vector<IssueGenerator*>& issueGenerators);
+            bool issuesValid() const;
+
+            /**
+             * Validates the issues of each of the given nodes whose issues are not valid. Every generator is run on
+             * all of the nodes before the next one is, and the time it takes is added to the element of
+             * `generatorTimes` at the generator's index.
+             *
+             * This only modifies the issues of the given nodes, so it can be called from several threads at once for
+             * disjoint sets of nodes, provided that no other thread modifies the node tree in the meantime.
+             */
+            static void validateIssues(const std::vector<Node*>& nodes, const std::vector<IssueGenerator*>& issueGenerators, std::vector<std::chrono::nanoseconds>& generatorTimes);
 
             bool issueHidden(IssueType type) const;
             void setIssueHidden(IssueType type, bool hidden);
@@ -0,0 +1,279 @@
+/*
+ Copyright (C) 2021 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "NodeContentsDelta.h"
+
+#include "Ensure.h"
+#include "Model/BezierPatch.h"
+#include "Model/Brush.h"
+#include "Model/BrushGeometry.h"
+#include "Model/BrushNode.h"
+#include "Model/Entity.h"
+#include "Model/EntityNodeBase.h"
+#include "Model/Group.h"
+#include "Model/Layer.h"
+#include "Model/ParallelTexCoordSystem.h"
+#include "Model/ParaxialTexCoordSystem.h"
+#include "Model/Polyhedron.h"
+
+#include <kdl/overload.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+
+namespace TrenchBroom {
+    namespace Model {
+        static const Brush& currentBrush(const Node* node) {
+            const auto* brushNode = dynamic_cast<const BrushNode*>(node);
+            ensure(brushNode != nullptr, "node is a brush node");
+            return brushNode->brush();
+        }
+
+        static const Entity& currentEntity(const Node* node) {
+            const auto* entityNode = dynamic_cast<const EntityNodeBase*>(node);
+            ensure(entityNode != nullptr, "node is an entity node");
+            return entityNode->entity();
+        }
+
+        /**
+         * Selection is not part of the contents that are undone, so faces which only differ in their selection state
+         * are considered equal.
+         */
+        static bool equalIgnoringSelection(const BrushFace& lhs, const BrushFace& rhs) {
+            if (lhs.selected() == rhs.selected()) {
+                return lhs == rhs;
+            }
+
+            auto copy = lhs;
+            if (rhs.selected()) {
+                copy.select();
+            } else {
+                copy.deselect();
+            }
+            return copy == rhs;
+        }
+
+        std::optional<NodeContentsDelta::BrushFaces> NodeContentsDelta::diffFaces(const Brush& currentBrush, std::vector<BrushFace> faces) {
+            const auto& currentFaces = currentBrush.faces();
+            if (faces.size() != currentFaces.size()) {
+                return std::nullopt;
+            }
+
+            // the face points determine the geometry, so if any of them differ, the brush must be stored as it is
+            for (size_t i = 0u; i < faces.size(); ++i) {
+                if (faces[i].points() != currentFaces[i].points()) {
+                    return std::nullopt;
+                }
+            }
+
+            auto result = BrushFaces{};
+            for (size_t i = 0u; i < faces.size(); ++i) {
+                if (!equalIgnoringSelection(faces[i], currentFaces[i])) {
+                    faces[i].setTexture(nullptr);
+                    faces[i].setGeometry(nullptr);
+                    result.changedFaces.emplace_back(i, std::move(faces[i]));
+                }
+            }
+            return result;
+        }
+
+        NodeContentsDelta::EntityProperties NodeContentsDelta::diffProperties(const Entity& currentEntity, const Entity& entity) {
+            const auto& currentProperties = currentEntity.properties();
+            const auto& properties = entity.properties();
+
+            const auto maxLength = std::min(currentProperties.size(), properties.size());
+            auto prefixLength = size_t(0u);
+            while (prefixLength < maxLength && currentProperties[prefixLength] == properties[prefixLength]) {
+                ++prefixLength;
+            }
+
+            auto suffixLength = size_t(0u);
+            while (prefixLength + suffixLength < maxLength
+                   && currentProperties[currentProperties.size() - suffixLength - 1u] == properties[properties.size() - suffixLength - 1u]) {
+                ++suffixLength;
+            }
+
+            auto changedProperties = std::vector<EntityProperty>(
+                std::next(std::begin(properties), static_cast<std::ptrdiff_t>(prefixLength)),
+                std::prev(std::end(properties), static_cast<std::ptrdiff_t>(suffixLength)));
+
+            return EntityProperties{prefixLength, suffixLength, std::move(changedProperties), entity.protectedProperties(), entity.pointEntity()};
+        }
+
+        NodeContentsDelta NodeContentsDelta::create(const Node* node, NodeContents contents) {
+            if (auto* brush = std::get_if<Brush>(&contents.get())) {
+                if (dynamic_cast<const BrushNode*>(node)) {
+                    if (auto brushFaces = diffFaces(currentBrush(node), std::move(brush->faces()))) {
+                        return NodeContentsDelta(std::move(*brushFaces));
+                    }
+                }
+            } else if (auto* entity = std::get_if<Entity>(&contents.get())) {
+                if (dynamic_cast<const EntityNodeBase*>(node)) {
+                    return NodeContentsDelta(diffProperties(currentEntity(node), *entity));
+                }
+            }
+
+            return NodeContentsDelta(std::move(contents));
+        }
+
+        NodeContents NodeContentsDelta::restore(const Node* node) const {
+            return std::visit(kdl::overload(
+                [](const NodeContents& contents) {
+                    return contents;
+                },
+                [&](const BrushFaces&) {
+                    return NodeContents(restoreFaces(currentBrush(node)));
+                },
+                [&](const EntityProperties&) {
+                    return NodeContents(restoreProperties(currentEntity(node)));
+                }
+            ), m_delta);
+        }
+
+        void NodeContentsDelta::rebase(const Node* node, const NodeContentsDelta& other) {
+            if (std::holds_alternative<NodeContents>(m_delta)) {
+                // the stored contents don't depend on the node's current contents
+                return;
+            }
+
+            // restore the contents that this delta was created against and apply this delta to them
+            auto otherContents = other.restore(node);
+            auto contents = std::visit(kdl::overload(
+                [](const NodeContents& c) {
+                    return c;
+                },
+                [&](const BrushFaces&) {
+                    return NodeContents(restoreFaces(std::get<Brush>(std::move(otherContents.get()))));
+                },
+                [&](const EntityProperties&) {
+                    return NodeContents(restoreProperties(std::get<Entity>(std::move(otherContents.get()))));
+                }
+            ), m_delta);
+
+            *this = create(node, std::move(contents));
+        }
+
+        /*
+         * Texture names and property keys are interned and shared with the rest of the document, so only their handles
+         * are counted. The texture coordinate system is allocated separately, so the size of the larger implementation is
+         * counted for it.
+         */
+        static size_t memorySize(const BrushFace&) {
+            return sizeof(BrushFace) + std::max(sizeof(ParallelTexCoordSystem), sizeof(ParaxialTexCoordSystem));
+        }
+
+        static size_t memorySize(const EntityProperty& property) {
+            return sizeof(EntityProperty) + property.value().capacity();
+        }
+
+        static size_t memorySize(const Brush& brush) {
+            auto result = sizeof(Brush) + sizeof(BrushGeometry);
+            for (const auto& face : brush.faces()) {
+                result += memorySize(face) + sizeof(BrushFaceGeometry);
+            }
+            result += brush.vertexCount() * sizeof(BrushVertex);
+            result += brush.edgeCount() * (sizeof(BrushEdge) + 2u * sizeof(BrushHalfEdge));
+            return result;
+        }
+
+        static size_t memorySize(const Entity& entity) {
+            auto result = sizeof(Entity);
+            for (const auto& property : entity.properties()) {
+                result += memorySize(property);
+            }
+            return result;
+        }
+
+        size_t NodeContentsDelta::memorySize() const {
+            return std::visit(kdl::overload(
+                [](const NodeContents& contents) {
+                    return std::visit(kdl::overload(
+                        [](const Layer&)          { return sizeof(Layer); },
+                        [](const Group&)          { return sizeof(Group); },
+                        [](const Entity& entity)  { return Model::memorySize(entity); },
+                        [](const Brush& brush)    { return Model::memorySize(brush); },
+                        [](const BezierPatch& patch) {
+                            return sizeof(BezierPatch) + patch.controlPoints().size() * sizeof(BezierPatch::Point);
+                        }
+                    ), contents.get());
+                },
+                [](const BrushFaces& brushFaces) {
+                    auto result = sizeof(BrushFaces);
+                    for (const auto& [index, face] : brushFaces.changedFaces) {
+                        result += sizeof(index) + Model::memorySize(face);
+                    }
+                    return result;
+                },
+                [](const EntityProperties& entityProperties) {
+                    auto result = sizeof(EntityProperties);
+                    for (const auto& property : entityProperties.changedProperties) {
+                        result += Model::memorySize(property);
+                    }
+                    result += entityProperties.protectedProperties.size() * sizeof(std::string);
+                    return result;
+                }
+            ), m_delta);
+        }
+
+        NodeContentsDelta::NodeContentsDelta(std::variant<NodeContents, BrushFaces, EntityProperties> delta) :
+        m_delta(std::move(delta)) {}
+
+        Brush NodeContentsDelta::restoreFaces(Brush brush) const {
+            const auto& brushFaces = std::get<BrushFaces>(m_delta);
+            for (const auto& [index, face] : brushFaces.changedFaces) {
+                // the stored face has the same points as the current face, so the current geometry remains valid
+                auto& currentFace = brush.face(index);
+                auto* faceGeometry = currentFace.geometry();
+                const auto selected = currentFace.selected();
+
+                currentFace = face;
+                currentFace.setGeometry(faceGeometry);
+                if (selected) {
+                    currentFace.select();
+                } else {
+                    currentFace.deselect();
+                }
+            }
+            return brush;
+        }
+
+        Entity NodeContentsDelta::restoreProperties(Entity entity) const {
+            const auto& entityProperties = std::get<EntityProperties>(m_delta);
+            const auto& currentProperties = entity.properties();
+            assert(entityProperties.prefixLength + entityProperties.suffixLength <= currentProperties.size());
+
+            auto properties = std::vector<EntityProperty>{};
+            properties.reserve(entityProperties.prefixLength + entityProperties.changedProperties.size() + entityProperties.suffixLength);
+
+            const auto prefixEnd = std::next(std::begin(currentProperties), static_cast<std::ptrdiff_t>(entityProperties.prefixLength));
+            const auto suffixBegin = std::prev(std::end(currentProperties), static_cast<std::ptrdiff_t>(entityProperties.suffixLength));
+            properties.insert(std::end(properties), std::begin(currentProperties), prefixEnd);
+            properties.insert(std::end(properties), std::begin(entityProperties.changedProperties), std::end(entityProperties.changedProperties));
+            properties.insert(std::end(properties), suffixBegin, std::end(currentProperties));
+
+            entity.setProperties(std::move(properties));
+            entity.setProtectedProperties(entityProperties.protectedProperties);
+            entity.setPointEntity(entityProperties.pointEntity);
+            return entity;
+        }
+    }
+}
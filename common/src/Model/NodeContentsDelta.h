@@ -0,0 +1,97 @@
+/*
+ Copyright (C) 2021 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "Model/BrushFace.h"
+#include "Model/EntityProperties.h"
+#include "Model/NodeContents.h"
+
+#include <optional>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Model {
+        class Node;
+
+        /**
+         * Stores node contents relative to the current contents of a node.
+         *
+         * For brushes whose geometry is unchanged, only the faces which differ from the current faces of the node are
+         * stored, and they are restored into a copy of the node's brush, so the geometry is never rebuilt. Brushes whose
+         * geometry differs are stored as they are, so that restoring them is exact even after vertex edits.
+         *
+         * For entities, only the range of properties that differs from the current properties of the node is stored.
+         * All other contents are stored as they are.
+         */
+        class NodeContentsDelta {
+        private:
+            struct BrushFaces {
+                std::vector<std::pair<size_t, BrushFace>> changedFaces;
+            };
+
+            struct EntityProperties {
+                size_t prefixLength;
+                size_t suffixLength;
+                std::vector<EntityProperty> changedProperties;
+                std::vector<std::string> protectedProperties;
+                bool pointEntity;
+            };
+
+            std::variant<NodeContents, BrushFaces, EntityProperties> m_delta;
+        public:
+            /**
+             * Creates a delta that restores the given contents when it is applied to the current contents of the
+             * given node.
+             */
+            static NodeContentsDelta create(const Node* node, NodeContents contents);
+
+            /**
+             * Restores the stored contents by applying this delta to the current contents of the given node.
+             *
+             * Precondition: the node's contents are the same as when this delta was created.
+             */
+            NodeContents restore(const Node* node) const;
+
+            /**
+             * Makes this delta relative to the contents that the given delta restores, which must have been created
+             * for the same node. Afterwards, applying this delta to the current contents of the node restores the same
+             * contents as before.
+             */
+            void rebase(const Node* node, const NodeContentsDelta& other);
+
+            /**
+             * Returns an estimate of the number of bytes used by this delta.
+             */
+            size_t memorySize() const;
+        private:
+            explicit NodeContentsDelta(std::variant<NodeContents, BrushFaces, EntityProperties> delta);
+
+            static std::optional<BrushFaces> diffFaces(const Brush& currentBrush, std::vector<BrushFace> faces);
+            static EntityProperties diffProperties(const Entity& currentEntity, const Entity& entity);
+
+            Brush restoreFaces(Brush brush) const;
+            Entity restoreProperties(Entity entity) const;
+        };
+    }
+}
@@ -19,6 +19,7 @@
 
 #include "PatchNode.h"
 
+#include "AABBTree.h"
 #include "Macros.h"
 #include "Model/BrushNode.h"
 #include "Model/EntityNode.h"
@@ -37,13 +38,21 @@
 #include <vecmath/vec_io.h>
 
 #include <cassert>
+#include <numeric>
 #include <ostream>
 #include <string>
+#include <tuple>
+#include <vector>
 
 namespace TrenchBroom {
     namespace Model {
         constexpr static size_t DefaultSubdivisionsPerSurface = 3u;
 
+        /**
+         * The maximum distance between the rendered triangles of a patch and its actual surface.
+         */
+        constexpr static FloatType MaxTessellationError = 1.0;
+
         const PatchGrid::Point& PatchGrid::point(const size_t row, const size_t col) const {
             const auto index = row * pointColumnCount + col;
             assert(index < points.size());
@@ -250,11 +259,114 @@ namespace TrenchBroom {
             };
         }
 
+        size_t computeSubdivisionsPerSurface(const BezierPatch& patch, const FloatType maxError, const size_t maxSubdivisionsPerSurface) {
+            const auto controlPoint = [&](const size_t row, const size_t col) -> const BezierPatch::Point& {
+                return patch.controlPoint(row, col);
+            };
+
+            // Texture coordinates are scaled to the texels of a texture of this size so that their error can be
+            // compared to the error of the positions. Otherwise, a flat patch with curved texture coordinates would not
+            // be subdivided at all.
+            constexpr auto TexCoordScale = static_cast<FloatType>(256);
+            const auto length = [](const BezierPatch::Point& difference) {
+                return vm::max(vm::length(difference.xyz()), vm::length(vm::slice<2>(difference, 3)) * TexCoordScale);
+            };
+
+            // For a grid with k quads per surface side, the distance between its triangles and the surface is bounded by
+            // (M_uu + 2 * M_uv + M_vv) / (8 * k * k), where M_uu, M_uv and M_vv bound the second derivatives of the
+            // surface. For a quadratic Bezier surface, these are bounded by the second differences of its control points.
+            auto maxSecondDerivative = static_cast<FloatType>(0);
+            for (size_t surfaceRow = 0u; surfaceRow < patch.surfaceRowCount(); ++surfaceRow) {
+                for (size_t surfaceCol = 0u; surfaceCol < patch.surfaceColumnCount(); ++surfaceCol) {
+                    const auto r = 2u * surfaceRow;
+                    const auto c = 2u * surfaceCol;
+
+                    auto d_uu = static_cast<FloatType>(0);
+                    auto d_vv = static_cast<FloatType>(0);
+                    for (size_t i = 0u; i < 3u; ++i) {
+                        d_uu = vm::max(d_uu, length(controlPoint(r + i, c) - static_cast<FloatType>(2) * controlPoint(r + i, c + 1u) + controlPoint(r + i, c + 2u)));
+                        d_vv = vm::max(d_vv, length(controlPoint(r, c + i) - static_cast<FloatType>(2) * controlPoint(r + 1u, c + i) + controlPoint(r + 2u, c + i)));
+                    }
+
+                    auto d_uv = static_cast<FloatType>(0);
+                    for (size_t i = 0u; i < 2u; ++i) {
+                        for (size_t j = 0u; j < 2u; ++j) {
+                            d_uv = vm::max(d_uv, length(controlPoint(r + i, c + j) - controlPoint(r + i, c + j + 1u) - controlPoint(r + i + 1u, c + j) + controlPoint(r + i + 1u, c + j + 1u)));
+                        }
+                    }
+
+                    // M_uu = 2 * d_uu, M_uv = 4 * d_uv, M_vv = 2 * d_vv
+                    maxSecondDerivative = vm::max(maxSecondDerivative, static_cast<FloatType>(2) * d_uu + static_cast<FloatType>(8) * d_uv + static_cast<FloatType>(2) * d_vv);
+                }
+            }
+
+            size_t subdivisionsPerSurface = 0u;
+            while (subdivisionsPerSurface < maxSubdivisionsPerSurface) {
+                const auto quadsPerSurfaceSide = static_cast<FloatType>(size_t(1) << subdivisionsPerSurface);
+                if (maxSecondDerivative / (static_cast<FloatType>(8) * quadsPerSurfaceSide * quadsPerSurfaceSide) <= maxError) {
+                    break;
+                }
+                ++subdivisionsPerSurface;
+            }
+            return subdivisionsPerSurface;
+        }
+
+        /**
+         * Returns a grid containing every step-th row and column of the given grid.
+         */
+        static PatchGrid makeCoarseGrid(const PatchGrid& grid, const size_t step) {
+            assert(step > 0u);
+            assert(grid.quadRowCount() % step == 0u);
+            assert(grid.quadColumnCount() % step == 0u);
+
+            const auto pointRowCount = grid.quadRowCount() / step + 1u;
+            const auto pointColumnCount = grid.quadColumnCount() / step + 1u;
+
+            auto points = std::vector<PatchGrid::Point>{};
+            points.reserve(pointRowCount * pointColumnCount);
+
+            auto boundsBuilder = vm::bbox3::builder{};
+            for (size_t row = 0u; row < pointRowCount; ++row) {
+                for (size_t col = 0u; col < pointColumnCount; ++col) {
+                    const auto& point = grid.point(row * step, col * step);
+                    points.push_back(point);
+                    boundsBuilder.add(point.position);
+                }
+            }
+
+            return {
+                pointRowCount,
+                pointColumnCount,
+                std::move(points),
+                boundsBuilder.bounds()
+            };
+        }
+
         const HitType::Type PatchNode::PatchHitType = HitType::freeType();
 
+        /**
+         * Returns the corners of the triangle with the given index. Every quad of the grid is split into two triangles.
+         */
+        static std::tuple<vm::vec3, vm::vec3, vm::vec3> gridTriangle(const PatchGrid& grid, const size_t triangleIndex) {
+            const auto quadIndex = triangleIndex / 2u;
+            const auto row = quadIndex / grid.quadColumnCount();
+            const auto col = quadIndex % grid.quadColumnCount();
+
+            const auto& v0 = grid.point(row, col).position;
+            const auto& v2 = grid.point(row + 1u, col + 1u).position;
+            if (triangleIndex % 2u == 0u) {
+                return {v0, grid.point(row, col + 1u).position, v2};
+            } else {
+                return {v2, grid.point(row + 1u, col).position, v0};
+            }
+        }
+
         PatchNode::PatchNode(BezierPatch patch) :
         m_patch{std::move(patch)},
-        m_grid{makePatchGrid(m_patch, DefaultSubdivisionsPerSurface)} {}
+        m_grid{makePatchGrid(m_patch, DefaultSubdivisionsPerSurface)},
+        m_subdivisionsPerSurface{computeSubdivisionsPerSurface(m_patch, MaxTessellationError, DefaultSubdivisionsPerSurface)} {}
+
+        PatchNode::~PatchNode() = default;
 
         const EntityNodeBase* PatchNode::entity() const {
             return visitParent(kdl::overload(
@@ -281,6 +393,9 @@ namespace TrenchBroom {
 
             auto previousPatch = std::exchange(m_patch, std::move(patch));
             m_grid = makePatchGrid(m_patch, DefaultSubdivisionsPerSurface);
+            m_subdivisionsPerSurface = computeSubdivisionsPerSurface(m_patch, MaxTessellationError, DefaultSubdivisionsPerSurface);
+            m_coarseGrids.clear();
+            m_spacialTree.reset();
             return previousPatch;
         }
 
@@ -292,6 +407,28 @@ namespace TrenchBroom {
             return m_grid;
         }
 
+        const PatchGrid& PatchNode::grid(const size_t subdivisionsPerSurface) const {
+            assert(subdivisionsPerSurface <= DefaultSubdivisionsPerSurface);
+            if (subdivisionsPerSurface >= DefaultSubdivisionsPerSurface) {
+                return m_grid;
+            }
+
+            if (m_coarseGrids.size() <= subdivisionsPerSurface) {
+                m_coarseGrids.resize(subdivisionsPerSurface + 1u);
+            }
+
+            auto& coarseGrid = m_coarseGrids[subdivisionsPerSurface];
+            if (!coarseGrid) {
+                const auto step = size_t(1) << (DefaultSubdivisionsPerSurface - subdivisionsPerSurface);
+                coarseGrid = std::make_unique<PatchGrid>(makeCoarseGrid(m_grid, step));
+            }
+            return *coarseGrid;
+        }
+
+        size_t PatchNode::subdivisionsPerSurface() const {
+            return m_subdivisionsPerSurface;
+        }
+
         const std::string& PatchNode::doGetName() const {
             static const auto name = std::string{"patch"};
             return name;
@@ -345,27 +482,34 @@ namespace TrenchBroom {
         }
 
         void PatchNode::doPick(const vm::ray3& pickRay, PickResult& pickResult) {
-            const auto pickTriangle = [&](const auto& p0, const auto& p1, const auto& p2) {
-                if (const auto distance = vm::intersect_ray_triangle(pickRay, p0, p1, p2); !vm::is_nan(distance)) {
-                    const auto hitPoint = vm::point_at_distance(pickRay, distance);
-                    pickResult.addHit(Hit(PatchHitType, distance, hitPoint, this));
-                    return true;
-                }
-                return false;
-            };
-
-            for (size_t row = 0u; row < m_grid.pointRowCount - 1u; ++row) {
-                for (size_t col = 0u; col < m_grid.pointColumnCount - 1u; ++col) {
-                    const auto v0 = m_grid.point(row, col).position;
-                    const auto v1 = m_grid.point(row, col + 1u).position;
-                    const auto v2 = m_grid.point(row + 1u, col + 1u).position;
-                    const auto v3 = m_grid.point(row + 1u, col).position;
+            const auto hit = spacialTree().findClosestIntersection(pickRay, [&](const size_t triangleIndex) {
+                const auto [p0, p1, p2] = gridTriangle(m_grid, triangleIndex);
+                return vm::intersect_ray_triangle(pickRay, p0, p1, p2);
+            });
+
+            if (hit) {
+                const auto distance = hit->first;
+                const auto hitPoint = vm::point_at_distance(pickRay, distance);
+                pickResult.addHit(Hit(PatchHitType, distance, hitPoint, this));
+            }
+        }
 
-                    if (pickTriangle(v0, v1, v2) || pickTriangle(v2, v3, v0)) {
-                        return;
-                    }
-                }
+        const PatchNode::SpacialTree& PatchNode::spacialTree() {
+            if (!m_spacialTree) {
+                auto triangleIndices = std::vector<size_t>(m_grid.quadRowCount() * m_grid.quadColumnCount() * 2u);
+                std::iota(std::begin(triangleIndices), std::end(triangleIndices), size_t(0));
+
+                m_spacialTree = std::make_unique<SpacialTree>();
+                m_spacialTree->clearAndBuild(triangleIndices, [&](const size_t triangleIndex) {
+                    const auto [p0, p1, p2] = gridTriangle(m_grid, triangleIndex);
+                    auto bounds = vm::bbox3::builder{};
+                    bounds.add(p0);
+                    bounds.add(p1);
+                    bounds.add(p2);
+                    return bounds.bounds();
+                });
             }
+            return *m_spacialTree;
         }
 
         void PatchNode::doFindNodesContaining(const vm::vec3&, std::vector<Node*>&) {}
@@ -25,9 +25,12 @@
 #include "Model/Object.h"
 
 #include <iosfwd>
+#include <memory>
 #include <optional>
 
 namespace TrenchBroom {
+    template <typename T, size_t S, typename U> class AABBTree;
+
     namespace Assets {
         class Texture;
     }
@@ -59,6 +62,16 @@ namespace TrenchBroom {
         // public for testing
         PatchGrid makePatchGrid(const BezierPatch& patch, size_t subdivisionsPerSurface);
 
+        /**
+         * Returns the smallest number of subdivisions per surface such that no point of the resulting grid's triangles
+         * is farther than the given distance from the surface, but at most the given maximum. The distance is estimated
+         * from the second differences of the control points of each surface, so flat patches need no subdivisions.
+         *
+         * A patch is always evaluated with the same number of subdivisions for each of its surfaces, because adjacent
+         * surfaces share their grid points. Therefore, the result is the maximum of the values of all surfaces.
+         */
+        size_t computeSubdivisionsPerSurface(const BezierPatch& patch, FloatType maxError, size_t maxSubdivisionsPerSurface);
+
         bool operator==(const PatchGrid::Point& lhs, const PatchGrid::Point& rhs);
         bool operator!=(const PatchGrid::Point& lhs, const PatchGrid::Point& rhs);
         std::ostream& operator<<(std::ostream& str, const PatchGrid::Point& p);
@@ -69,8 +82,26 @@ namespace TrenchBroom {
         private:
             BezierPatch m_patch;
             PatchGrid m_grid;
+
+            /**
+             * The number of subdivisions per surface required to render this patch, depending on its curvature.
+             */
+            size_t m_subdivisionsPerSurface;
+
+            /**
+             * Grids with fewer subdivisions per surface than m_grid, indexed by their number of subdivisions. They are
+             * created from m_grid when they are first requested.
+             */
+            mutable std::vector<std::unique_ptr<PatchGrid>> m_coarseGrids;
+
+            /**
+             * The triangles of the grid, identified by their index, for picking. Built when the patch is first picked.
+             */
+            using SpacialTree = AABBTree<FloatType, 3, size_t>;
+            std::unique_ptr<SpacialTree> m_spacialTree;
         public:
             explicit PatchNode(BezierPatch patch);
+            ~PatchNode() override;
 
             EntityNodeBase* entity();
             const EntityNodeBase* entity() const;
@@ -81,6 +112,20 @@ namespace TrenchBroom {
             void setTexture(Assets::Texture* texture);
 
             const PatchGrid& grid() const;
+
+            /**
+             * Returns the grid of this patch with the given number of subdivisions per surface. The grid points are a
+             * subset of the points of the grid returned by grid(), so they share their normals.
+             *
+             * The given number of subdivisions must not exceed the number of subdivisions of grid().
+             */
+            const PatchGrid& grid(size_t subdivisionsPerSurface) const;
+
+            /**
+             * Returns the number of subdivisions per surface that suffices to render this patch. Flat patches need
+             * fewer subdivisions than curved patches.
+             */
+            size_t subdivisionsPerSurface() const;
         private: // implement Node interface
             const std::string& doGetName() const override;
             const vm::bbox3& doGetLogicalBounds() const override;
@@ -99,6 +144,7 @@ namespace TrenchBroom {
             bool doSelectable() const override;
 
             void doPick(const vm::ray3& ray, PickResult& pickResult) override;
+            const SpacialTree& spacialTree();
             void doFindNodesContaining(const vm::vec3& point, std::vector<Node*>& result) override;
 
             void doGenerateIssues(const IssueGenerator* generator, std::vector<Issue*>& issues) override;
@@ -22,6 +22,7 @@
 #include "Polyhedron_Forward.h"
 
 #include <kdl/intrusive_circular_list.h>
+#include <kdl/object_pool.h>
 
 #include <vecmath/forward.h>
 #include <vecmath/bbox.h>
@@ -29,6 +30,7 @@
 #include <vecmath/util.h>
 #include <vecmath/vec.h>
 
+#include <cstddef>
 #include <initializer_list>
 #include <limits>
 #include <optional>
@@ -39,6 +41,14 @@
 
 namespace TrenchBroom {
     namespace Model {
+        /**
+         * The pool that vertices, edges, half edges or faces of polyhedra are allocated from. Its chunks are large enough
+         * for the system allocator to return them to the system once they are released, see
+         * Polyhedron::releaseUnusedMemory.
+         */
+        template <typename E>
+        using Polyhedron_Pool = kdl::object_pool<E, 4096u>;
+
         /* ====================== Implementation in Polyhedron_Vertex.h ====================== */
 
         /**
@@ -73,6 +83,13 @@ namespace TrenchBroom {
             using Vertex = Polyhedron_Vertex<T,FP,VP>;
             using HalfEdge = Polyhedron_HalfEdge<T,FP,VP>;
             using Face = Polyhedron_Face<T,FP,VP>;
+        public:
+            /**
+             * Vertices, edges, half edges and faces are allocated from a Polyhedron_Pool because polyhedra create and
+             * destroy them in large numbers, e.g. when clipping or building convex hulls.
+             */
+            static void* operator new(std::size_t size);
+            static void operator delete(void* ptr) noexcept;
         private:
             /**
              * The vertex position.
@@ -211,6 +228,9 @@ namespace TrenchBroom {
             using Edge = Polyhedron_Edge<T,FP,VP>;
             using HalfEdge = Polyhedron_HalfEdge<T,FP,VP>;
             using Face = Polyhedron_Face<T,FP,VP>;
+        public:
+            static void* operator new(std::size_t size);
+            static void operator delete(void* ptr) noexcept;
         private:
             /**
              * The first half edge.
@@ -484,6 +504,9 @@ namespace TrenchBroom {
             using Edge = Polyhedron_Edge<T,FP,VP>;
             using HalfEdge = Polyhedron_HalfEdge<T,FP,VP>;
             using Face = Polyhedron_Face<T,FP,VP>;
+        public:
+            static void* operator new(std::size_t size);
+            static void operator delete(void* ptr) noexcept;
         private:
             /**
              * The origin vertex of this half edge.
@@ -687,6 +710,9 @@ namespace TrenchBroom {
             using Face = Polyhedron_Face<T,FP,VP>;
 
             using HalfEdgeList = Polyhedron_HalfEdgeList<T,FP,VP>;
+        public:
+            static void* operator new(std::size_t size);
+            static void operator delete(void* ptr) noexcept;
         private:
             /**
              * The boundary of this face. The boundary of a face is a circular list of half edges, usually three or
@@ -1123,6 +1149,16 @@ namespace TrenchBroom {
              * Move assignment operator.
              */
             Polyhedron<T,FP,VP>& operator=(Polyhedron<T,FP,VP>&& other);
+        public: // memory management
+            /**
+             * Returns the unused memory of the pools that the vertices, edges, half edges and faces of all polyhedra of
+             * this type are allocated from to the system and returns the number of bytes released.
+             *
+             * The pools are shared by all polyhedra of this type rather than owned by each polyhedron, so the memory
+             * freed by destroying a polyhedron is kept for other polyhedra until this function is called. See
+             * kdl::object_pool::release_unused_chunks.
+             */
+            static std::size_t releaseUnusedMemory();
         private: // Copy helper
             class Copy;
         public: // swap function, must be implemented here because it's a public template
@@ -22,6 +22,7 @@
 #include "Polyhedron.h"
 #include "Macros.h"
 
+
 #include <vecmath/vec.h>
 #include <vecmath/plane.h>
 #include <vecmath/segment.h>
@@ -40,6 +41,18 @@ namespace TrenchBroom {
             return edge->m_link;
         }
 
+        template <typename T, typename FP, typename VP>
+        void* Polyhedron_Edge<T,FP,VP>::operator new(const std::size_t size) {
+            assert(size == sizeof(Polyhedron_Edge<T,FP,VP>));
+            unused(size);
+            return Polyhedron_Pool<Polyhedron_Edge<T,FP,VP>>::allocate();
+        }
+
+        template <typename T, typename FP, typename VP>
+        void Polyhedron_Edge<T,FP,VP>::operator delete(void* ptr) noexcept {
+            Polyhedron_Pool<Polyhedron_Edge<T,FP,VP>>::deallocate(ptr);
+        }
+
         template <typename T, typename FP, typename VP>
         Polyhedron_Edge<T,FP,VP>::Polyhedron_Edge(HalfEdge* first, HalfEdge* second) :
             m_first(first),
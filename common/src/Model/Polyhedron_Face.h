@@ -23,6 +23,7 @@
 
 #include "Polyhedron.h"
 
+
 #include <vecmath/vec.h>
 #include <vecmath/ray.h>
 #include <vecmath/plane.h>
@@ -45,6 +46,18 @@ namespace TrenchBroom {
             return face->m_link;
         }
 
+        template <typename T, typename FP, typename VP>
+        void* Polyhedron_Face<T,FP,VP>::operator new(const std::size_t size) {
+            assert(size == sizeof(Polyhedron_Face<T,FP,VP>));
+            unused(size);
+            return Polyhedron_Pool<Polyhedron_Face<T,FP,VP>>::allocate();
+        }
+
+        template <typename T, typename FP, typename VP>
+        void Polyhedron_Face<T,FP,VP>::operator delete(void* ptr) noexcept {
+            Polyhedron_Pool<Polyhedron_Face<T,FP,VP>>::deallocate(ptr);
+        }
+
         template <typename T, typename FP, typename VP>
         Polyhedron_Face<T,FP,VP>::Polyhedron_Face(HalfEdgeList&& boundary, const vm::plane<T,3>& plane) :
             m_boundary(std::move(boundary)),
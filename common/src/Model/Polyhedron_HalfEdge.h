@@ -19,8 +19,13 @@
 
 #pragma once
 
+#include "Macros.h"
 #include "Polyhedron.h"
 
+
+#include <cassert>
+#include <cstddef>
+
 namespace TrenchBroom {
     namespace Model {
         template <typename T, typename FP, typename VP>
@@ -33,6 +38,18 @@ namespace TrenchBroom {
             return halfEdge->m_link;
         }
 
+        template <typename T, typename FP, typename VP>
+        void* Polyhedron_HalfEdge<T,FP,VP>::operator new(const std::size_t size) {
+            assert(size == sizeof(Polyhedron_HalfEdge<T,FP,VP>));
+            unused(size);
+            return Polyhedron_Pool<Polyhedron_HalfEdge<T,FP,VP>>::allocate();
+        }
+
+        template <typename T, typename FP, typename VP>
+        void Polyhedron_HalfEdge<T,FP,VP>::operator delete(void* ptr) noexcept {
+            Polyhedron_Pool<Polyhedron_HalfEdge<T,FP,VP>>::deallocate(ptr);
+        }
+
         template <typename T, typename FP, typename VP>
         Polyhedron_HalfEdge<T,FP,VP>::Polyhedron_HalfEdge(Vertex* origin) :
             m_origin(origin),
@@ -221,6 +221,14 @@ namespace TrenchBroom {
         template <typename T, typename FP, typename VP>
         Polyhedron<T,FP,VP>& Polyhedron<T,FP,VP>::operator=(Polyhedron<T,FP,VP>&& other) = default;
 
+        template <typename T, typename FP, typename VP>
+        std::size_t Polyhedron<T,FP,VP>::releaseUnusedMemory() {
+            return Polyhedron_Pool<Vertex>::release_unused_chunks()
+                + Polyhedron_Pool<Edge>::release_unused_chunks()
+                + Polyhedron_Pool<HalfEdge>::release_unused_chunks()
+                + Polyhedron_Pool<Face>::release_unused_chunks();
+        }
+
         /**
          * Copies a polyhedron.
          */
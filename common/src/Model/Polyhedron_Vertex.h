@@ -19,10 +19,14 @@
 
 #pragma once
 
+#include "Macros.h"
 #include "Polyhedron.h"
 
 #include <kdl/intrusive_circular_list.h>
 
+#include <cassert>
+#include <cstddef>
+
 namespace TrenchBroom {
     namespace Model {
         template <typename T, typename FP, typename VP>
@@ -35,6 +39,18 @@ namespace TrenchBroom {
             return vertex->m_link;
         }
 
+        template <typename T, typename FP, typename VP>
+        void* Polyhedron_Vertex<T,FP,VP>::operator new(const std::size_t size) {
+            assert(size == sizeof(Polyhedron_Vertex<T,FP,VP>));
+            unused(size);
+            return Polyhedron_Pool<Polyhedron_Vertex<T,FP,VP>>::allocate();
+        }
+
+        template <typename T, typename FP, typename VP>
+        void Polyhedron_Vertex<T,FP,VP>::operator delete(void* ptr) noexcept {
+            Polyhedron_Pool<Polyhedron_Vertex<T,FP,VP>>::deallocate(ptr);
+        }
+
         template <typename T, typename FP, typename VP>
         Polyhedron_Vertex<T,FP,VP>::Polyhedron_Vertex(const vm::vec<T,3>& position) :
             m_position(position),
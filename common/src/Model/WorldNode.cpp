@@ -50,7 +50,8 @@ namespace TrenchBroom {
         m_entityNodeIndex(std::make_unique<EntityNodeIndex>()),
         m_issueGeneratorRegistry(std::make_unique<IssueGeneratorRegistry>()),
         m_nodeTree(std::make_unique<NodeTree>()),
-        m_updateNodeTree(true) {
+        m_updateNodeTree(true),
+        m_nodeTreeBatchDepth(0) {
             entity.addOrUpdateProperty(PropertyKeys::Classname, PropertyValues::WorldspawnClassname);
             entity.setPointEntity(false);
             setEntity(std::move(entity));
@@ -189,9 +190,37 @@ namespace TrenchBroom {
                 [&](PatchNode* patch)                      { addNode(patch); }
             ));
 
+            m_pendingNodeTreeInsertions.clear();
             m_nodeTree->clearAndBuild(nodes, [](const auto* node){ return node->physicalBounds(); });
         }
 
+        void WorldNode::beginNodeTreeBatch() {
+            ++m_nodeTreeBatchDepth;
+        }
+
+        void WorldNode::endNodeTreeBatch() {
+            assert(m_nodeTreeBatchDepth > 0);
+            if (--m_nodeTreeBatchDepth == 0) {
+                flushPendingNodeTreeInsertions();
+            }
+        }
+
+        std::vector<Node*> WorldNode::findNodesInFrustum(const std::vector<vm::plane3>& planes) const {
+            return m_nodeTree->findInFrustum(planes);
+        }
+
+        std::vector<Node*> WorldNode::findNodesIntersecting(const vm::bbox3& bounds) const {
+            return m_nodeTree->findIntersectors(bounds);
+        }
+
+        void WorldNode::flushPendingNodeTreeInsertions() {
+            if (!m_pendingNodeTreeInsertions.empty()) {
+                auto nodes = std::move(m_pendingNodeTreeInsertions);
+                m_pendingNodeTreeInsertions.clear();
+                m_nodeTree->insertAll(nodes, [](const auto* node){ return node->physicalBounds(); });
+            }
+        }
+
         void WorldNode::invalidateAllIssues() {
             accept([](auto&& thisLambda, Node* node) {
                 node->invalidateIssues();
@@ -275,10 +304,14 @@ namespace TrenchBroom {
                     [&](auto&& thisLambda, WorldNode* world)   { world->visitChildren(thisLambda); },
                     [&](auto&& thisLambda, LayerNode* layer)   { layer->visitChildren(thisLambda); },
                     [&](auto&& thisLambda, GroupNode* group)   { group->visitChildren(thisLambda); },
-                    [&](auto&& thisLambda, EntityNode* entity) { m_nodeTree->insert(entity->physicalBounds(), entity); entity->visitChildren(thisLambda); },
-                    [&](BrushNode* brush)                      { m_nodeTree->insert(brush->physicalBounds(), brush); },
-                    [&](PatchNode* patch)                      { m_nodeTree->insert(patch->physicalBounds(), patch); }
+                    [&](auto&& thisLambda, EntityNode* entity) { m_pendingNodeTreeInsertions.push_back(entity); entity->visitChildren(thisLambda); },
+                    [&](BrushNode* brush)                      { m_pendingNodeTreeInsertions.push_back(brush); },
+                    [&](PatchNode* patch)                      { m_pendingNodeTreeInsertions.push_back(patch); }
                 ));
+
+                if (m_nodeTreeBatchDepth == 0) {
+                    flushPendingNodeTreeInsertions();
+                }
             }
 
             const auto updatePersistentId = [&](auto* persistentNode) {
@@ -302,6 +335,8 @@ namespace TrenchBroom {
 
         void WorldNode::doDescendantWillBeRemoved(Node* node, const size_t /* depth */) {
             if (m_updateNodeTree) {
+                flushPendingNodeTreeInsertions();
+
                 const auto doRemove = [&](auto* nodeToRemove) {
                 if (!m_nodeTree->remove(nodeToRemove)) {
                     auto str = std::stringstream();
@@ -323,6 +358,8 @@ namespace TrenchBroom {
 
         void WorldNode::doDescendantPhysicalBoundsDidChange(Node* node) {
             if (m_updateNodeTree) {
+                flushPendingNodeTreeInsertions();
+
                 node->accept(kdl::overload(
                     [] (WorldNode*) {},
                     [] (LayerNode*) {},
@@ -28,6 +28,8 @@
 
 #include <kdl/result_forward.h>
 
+#include <vecmath/forward.h>
+
 #include <memory>
 #include <string>
 #include <vector>
@@ -54,6 +56,8 @@ namespace TrenchBroom {
             using NodeTree = AABBTree<FloatType, 3, Node*>;
             std::unique_ptr<NodeTree> m_nodeTree;
             bool m_updateNodeTree;
+            size_t m_nodeTreeBatchDepth;
+            std::vector<Node*> m_pendingNodeTreeInsertions;
 
             IdType m_nextPersistentId = 1;
         public:
@@ -121,7 +125,33 @@ namespace TrenchBroom {
             void disableNodeTreeUpdates();
             void enableNodeTreeUpdates();
             void rebuildNodeTree();
+
+            /**
+             * Defers adding nodes to the spatial index until the matching call to endNodeTreeBatch. The deferred nodes
+             * are then inserted at once, which allows the node tree to rebuild itself if many nodes are added.
+             *
+             * Calls can be nested.
+             */
+            void beginNodeTreeBatch();
+            void endNodeTreeBatch();
+
+            /**
+             * Returns the nodes in the spatial index whose bounds are not entirely in front of any of the given planes.
+             * If the planes bound a view frustum and their normals point out of it, these are the nodes that may be
+             * visible in the frustum.
+             *
+             * Nodes that were added during a node tree batch are only found once the batch has ended.
+             */
+            std::vector<Node*> findNodesInFrustum(const std::vector<vm::plane3>& planes) const;
+
+            /**
+             * Returns the nodes in the spatial index whose physical bounds intersect with or touch the given bounds.
+             *
+             * Nodes that were added during a node tree batch are only found once the batch has ended.
+             */
+            std::vector<Node*> findNodesIntersecting(const vm::bbox3& bounds) const;
         private:
+            void flushPendingNodeTreeInsertions();
             void invalidateAllIssues();
         private: // implement Node interface
             const vm::bbox3& doGetLogicalBounds() const override;
@@ -136,6 +136,9 @@ namespace TrenchBroom {
         Preference<bool> TextureLock(IO::Path("Editor/Texture lock"), true);
         Preference<bool> UVLock(IO::Path("Editor/UV lock"), false);
 
+        Preference<int> UndoMemoryBudget(IO::Path("Editor/Undo memory budget"), 512);
+        Preference<int> BrushGeometryMemoryBudget(IO::Path("Editor/Brush geometry memory budget"), 1024);
+
         Preference<IO::Path>& RendererFontPath() {
             static Preference<IO::Path> fontPath(IO::Path("Renderer/Font name"), IO::Path("fonts/SourceSansPro-Regular.otf"));
             return fontPath;
@@ -298,6 +301,8 @@ namespace TrenchBroom {
                 &TextureMagFilter,
                 &TextureLock,
                 &UVLock,
+                &UndoMemoryBudget,
+                &BrushGeometryMemoryBudget,
                 &RendererFontPath(),
                 &RendererFontSize,
                 &BrowserFontSize,
@@ -129,6 +129,17 @@ namespace TrenchBroom {
         extern Preference<bool> TextureLock;
         extern Preference<bool> UVLock;
 
+        /**
+         * The number of megabytes that the undo history of a document may use, or 0 for no limit.
+         */
+        extern Preference<int> UndoMemoryBudget;
+
+        /**
+         * The number of megabytes that the geometry of all brushes may use before the geometry of unselected brushes is
+         * released, or 0 for no limit.
+         */
+        extern Preference<int> BrushGeometryMemoryBudget;
+
         Preference<IO::Path>& RendererFontPath();
         extern Preference<int> RendererFontSize;
 
@@ -0,0 +1,52 @@
+/*
+ Copyright (C) 2021 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+namespace TrenchBroom {
+    /**
+     * Receives the progress of a long running operation and allows the operation to be cancelled.
+     *
+     * Operations report their progress and check for cancellation only on the thread that started them, so
+     * implementations may interact with the user interface.
+     */
+    class ProgressMonitor {
+    public:
+        virtual ~ProgressMonitor();
+
+        /**
+         * Reports the progress of the operation as a value between 0 and 1.
+         */
+        void progress(double progress);
+
+        /**
+         * Indicates whether the operation should stop as soon as possible.
+         */
+        bool cancelled() const;
+    private:
+        virtual void doProgress(double progress) = 0;
+        virtual bool doCancelled() const = 0;
+    };
+
+    class NullProgressMonitor : public ProgressMonitor {
+    private:
+        void doProgress(double progress) override;
+        bool doCancelled() const override;
+    };
+}
@@ -39,6 +39,11 @@ namespace TrenchBroom {
             void set(const std::string& name, const T& value) {
                 m_program.set(name, value);
             }
+
+            template <class T>
+            void setAttribute(const std::string& name, const T& value) {
+                m_program.setAttribute(name, value);
+            }
         };
     }
 }
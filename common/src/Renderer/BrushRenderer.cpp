@@ -29,9 +29,13 @@
 #include "Model/TagAttribute.h"
 #include "Renderer/BrushRendererArrays.h"
 #include "Renderer/BrushRendererBrushCache.h"
+#include "Renderer/FrustumCuller.h"
 #include "Renderer/RenderContext.h"
 
+#include <vecmath/bbox.h>
+
 #include <cassert>
+#include <cmath>
 #include <cstring>
 #include <vector>
 
@@ -123,8 +127,24 @@ namespace TrenchBroom {
                                    EdgeRenderPolicy::RenderAll);
         }
 
+        // Chunk
+
+        BrushRenderer::Chunk::Chunk() :
+        vertexArray(std::make_shared<BrushVertexArray>()),
+        edgeIndices(std::make_shared<BrushIndexArray>()),
+        transparentFaces(std::make_shared<TextureToBrushIndicesMap>()),
+        opaqueFaces(std::make_shared<TextureToBrushIndicesMap>()),
+        visible(true) {}
+
         // BrushRenderer
 
+        /**
+         * The edge length of the world grid cells that brushes are partitioned into. Larger chunks require fewer draw
+         * calls, while smaller chunks cause less data to be uploaded when a brush changes and can be culled more
+         * precisely.
+         */
+        static constexpr FloatType ChunkSize = 2048.0;
+
         BrushRenderer::BrushRenderer() :
         m_filter(std::make_unique<NoFilter>()),
         m_showEdges(false),
@@ -133,7 +153,13 @@ namespace TrenchBroom {
         m_showOccludedEdges(false),
         m_forceTransparent(false),
         m_transparencyAlpha(1.0f),
-        m_showHiddenBrushes(false) {
+        m_showHiddenBrushes(false),
+        m_frustumCuller(nullptr),
+        m_drawRangesValid(false),
+        m_appliedCuller(nullptr),
+        m_appliedGeneration(0u),
+        m_drawnBrushCount(0u),
+        m_culledBrushCount(0u) {
             clear();
         }
 
@@ -163,6 +189,12 @@ namespace TrenchBroom {
             }
         }
 
+        void BrushRenderer::removeBrushes(const std::vector<Model::BrushNode*>& brushes) {
+            for (auto* brush : brushes) {
+                removeBrush(brush);
+            }
+        }
+
         void BrushRenderer::invalidate() {
             for (auto& brush : m_allBrushes) {
                 // this will also invalidate already invalid brushes, which
@@ -172,8 +204,7 @@ namespace TrenchBroom {
             m_invalidBrushes = m_allBrushes;
 
             assert(m_brushInfo.empty());
-            assert(m_transparentFaces->empty());
-            assert(m_opaqueFaces->empty());
+            assert(m_chunks.empty());
         }
 
         void BrushRenderer::invalidateBrushes(const std::vector<Model::BrushNode*>& brushes) {
@@ -199,15 +230,9 @@ namespace TrenchBroom {
             m_brushInfo.clear();
             m_allBrushes.clear();
             m_invalidBrushes.clear();
+            m_chunks.clear();
 
-            m_vertexArray = std::make_shared<BrushVertexArray>();
-            m_edgeIndices = std::make_shared<BrushIndexArray>();
-            m_transparentFaces = std::make_shared<TextureToBrushIndicesMap>();
-            m_opaqueFaces = std::make_shared<TextureToBrushIndicesMap>();
-
-            m_opaqueFaceRenderer = FaceRenderer(m_vertexArray, m_opaqueFaces, m_faceColor);
-            m_transparentFaceRenderer = FaceRenderer(m_vertexArray, m_transparentFaces, m_faceColor);
-            m_edgeRenderer = IndexedEdgeRenderer(m_vertexArray, m_edgeIndices);
+            invalidateDrawRanges();
         }
 
         void BrushRenderer::setFaceColor(const Color& faceColor) {
@@ -263,6 +288,23 @@ namespace TrenchBroom {
             }
         }
 
+        void BrushRenderer::setFrustumCuller(const FrustumCuller* frustumCuller) {
+            // the draw ranges are swapped lazily when rendering
+            m_frustumCuller = frustumCuller;
+        }
+
+        size_t BrushRenderer::drawnBrushCount() const {
+            return m_drawnBrushCount;
+        }
+
+        size_t BrushRenderer::culledBrushCount() const {
+            return m_culledBrushCount;
+        }
+
+        size_t BrushRenderer::chunkCount() const {
+            return m_chunks.size();
+        }
+
         void BrushRenderer::render(RenderContext& renderContext, RenderBatch& renderBatch) {
             renderOpaque(renderContext, renderBatch);
             renderTransparent(renderContext, renderBatch);
@@ -273,6 +315,7 @@ namespace TrenchBroom {
                 if (!valid()) {
                     validate();
                 }
+                validateDrawRanges();
                 if (renderContext.showFaces()) {
                     renderOpaqueFaces(renderBatch);
                 }
@@ -287,6 +330,7 @@ namespace TrenchBroom {
                 if (!valid()) {
                     validate();
                 }
+                validateDrawRanges();
                 if (renderContext.showFaces()) {
                     renderTransparentFaces(renderBatch);
                 }
@@ -294,25 +338,141 @@ namespace TrenchBroom {
         }
 
         void BrushRenderer::renderOpaqueFaces(RenderBatch& renderBatch) {
-            m_opaqueFaceRenderer.setGrayscale(m_grayscale);
-            m_opaqueFaceRenderer.setTint(m_tint);
-            m_opaqueFaceRenderer.setTintColor(m_tintColor);
-            m_opaqueFaceRenderer.render(renderBatch);
+            for (auto& [key, chunk] : m_chunks) {
+                if (chunk.visible) {
+                    chunk.opaqueFaceRenderer.setGrayscale(m_grayscale);
+                    chunk.opaqueFaceRenderer.setTint(m_tint);
+                    chunk.opaqueFaceRenderer.setTintColor(m_tintColor);
+                    chunk.opaqueFaceRenderer.render(renderBatch);
+                }
+            }
         }
 
         void BrushRenderer::renderTransparentFaces(RenderBatch& renderBatch) {
-            m_transparentFaceRenderer.setGrayscale(m_grayscale);
-            m_transparentFaceRenderer.setTint(m_tint);
-            m_transparentFaceRenderer.setTintColor(m_tintColor);
-            m_transparentFaceRenderer.setAlpha(m_transparencyAlpha);
-            m_transparentFaceRenderer.render(renderBatch);
+            for (auto& [key, chunk] : m_chunks) {
+                if (chunk.visible) {
+                    chunk.transparentFaceRenderer.setGrayscale(m_grayscale);
+                    chunk.transparentFaceRenderer.setTint(m_tint);
+                    chunk.transparentFaceRenderer.setTintColor(m_tintColor);
+                    chunk.transparentFaceRenderer.setAlpha(m_transparencyAlpha);
+                    chunk.transparentFaceRenderer.render(renderBatch);
+                }
+            }
         }
 
         void BrushRenderer::renderEdges(RenderBatch& renderBatch) {
-            if (m_showOccludedEdges) {
-                m_edgeRenderer.renderOnTop(renderBatch, m_occludedEdgeColor);
+            for (auto& [key, chunk] : m_chunks) {
+                if (chunk.visible) {
+                    if (m_showOccludedEdges) {
+                        chunk.edgeRenderer.renderOnTop(renderBatch, m_occludedEdgeColor);
+                    }
+                    chunk.edgeRenderer.render(renderBatch, m_edgeColor);
+                }
+            }
+        }
+
+        void BrushRenderer::invalidateDrawRanges() {
+            m_drawRanges.clear();
+            m_drawRangesValid = false;
+        }
+
+        void BrushRenderer::validateDrawRanges() {
+            const auto generation = m_frustumCuller != nullptr ? m_frustumCuller->generation() : 0u;
+            if (m_drawRangesValid && m_appliedCuller == m_frustumCuller && m_appliedGeneration == generation) {
+                return;
+            }
+
+            auto it = m_drawRanges.find(m_frustumCuller);
+            if (it == std::end(m_drawRanges) || it->second.generation != generation) {
+                it = m_drawRanges.insert_or_assign(m_frustumCuller, computeDrawRanges(generation)).first;
+            }
+            applyDrawRanges(it->second);
+
+            m_drawRangesValid = true;
+            m_appliedCuller = m_frustumCuller;
+            m_appliedGeneration = generation;
+        }
+
+        BrushRenderer::CullerDrawRanges BrushRenderer::computeDrawRanges(const size_t generation) const {
+            auto result = CullerDrawRanges{generation, 0u, 0u, {}};
+            result.chunks.reserve(m_chunks.size());
+
+            for (const auto& [key, chunk] : m_chunks) {
+                if (m_frustumCuller == nullptr || m_frustumCuller->contains(chunk.bounds)) {
+                    result.chunks.push_back(ChunkDrawRanges{true, nullptr, {}, {}});
+                    result.drawnBrushCount += chunk.brushes.size();
+                } else if (!m_frustumCuller->intersects(chunk.bounds)) {
+                    result.chunks.push_back(ChunkDrawRanges{false, nullptr, {}, {}});
+                    result.culledBrushCount += chunk.brushes.size();
+                } else {
+                    result.chunks.push_back(computeChunkDrawRanges(chunk, result));
+                }
+            }
+
+            return result;
+        }
+
+        BrushRenderer::ChunkDrawRanges BrushRenderer::computeChunkDrawRanges(const Chunk& chunk, CullerDrawRanges& drawRanges) const {
+            assert(m_frustumCuller != nullptr);
+
+            using Keys = std::vector<const AllocationTracker::Block*>;
+            Keys edgeKeys;
+            std::unordered_map<const Assets::Texture*, Keys> opaqueKeys;
+            std::unordered_map<const Assets::Texture*, Keys> transparentKeys;
+
+            for (const auto* brush : chunk.brushes) {
+                if (!m_frustumCuller->visible(brush)) {
+                    ++drawRanges.culledBrushCount;
+                    continue;
+                }
+
+                ++drawRanges.drawnBrushCount;
+                const BrushInfo& info = m_brushInfo.at(brush);
+                if (info.edgeIndicesKey != nullptr) {
+                    edgeKeys.push_back(info.edgeIndicesKey);
+                }
+                for (const auto& [texture, key] : info.opaqueFaceIndicesKeys) {
+                    opaqueKeys[texture].push_back(key);
+                }
+                for (const auto& [texture, key] : info.transparentFaceIndicesKeys) {
+                    transparentKeys[texture].push_back(key);
+                }
             }
-            m_edgeRenderer.render(renderBatch, m_edgeColor);
+
+            // index arrays without any visible brushes get empty draw ranges and render nothing
+            auto result = ChunkDrawRanges{true, BrushIndexArray::computeDrawRanges(std::move(edgeKeys)), {}, {}};
+            for (const auto& [texture, indexArray] : *chunk.opaqueFaces) {
+                result.opaqueFaces[texture] = BrushIndexArray::computeDrawRanges(std::move(opaqueKeys[texture]));
+            }
+            for (const auto& [texture, indexArray] : *chunk.transparentFaces) {
+                result.transparentFaces[texture] = BrushIndexArray::computeDrawRanges(std::move(transparentKeys[texture]));
+            }
+            return result;
+        }
+
+        void BrushRenderer::applyDrawRanges(const CullerDrawRanges& drawRanges) {
+            assert(drawRanges.chunks.size() == m_chunks.size());
+
+            const auto applyFaceDrawRanges = [](TextureToBrushIndicesMap& faces, const auto& faceDrawRanges) {
+                for (auto& [texture, indexArray] : faces) {
+                    const auto it = faceDrawRanges.find(texture);
+                    indexArray->setDrawRanges(it != std::end(faceDrawRanges) ? it->second : nullptr);
+                }
+            };
+
+            auto chunkDrawRanges = std::begin(drawRanges.chunks);
+            for (auto& [key, chunk] : m_chunks) {
+                chunk.visible = chunkDrawRanges->visible;
+                if (chunk.visible) {
+                    chunk.edgeIndices->setDrawRanges(chunkDrawRanges->edges);
+                    applyFaceDrawRanges(*chunk.opaqueFaces, chunkDrawRanges->opaqueFaces);
+                    applyFaceDrawRanges(*chunk.transparentFaces, chunkDrawRanges->transparentFaces);
+                }
+                ++chunkDrawRanges;
+            }
+
+            m_drawnBrushCount = drawRanges.drawnBrushCount;
+            m_culledBrushCount = drawRanges.culledBrushCount;
         }
 
         class BrushRenderer::FilterWrapper : public BrushRenderer::Filter {
@@ -346,10 +506,22 @@ namespace TrenchBroom {
             }
             m_invalidBrushes.clear();
             assert(valid());
+            invalidateDrawRanges();
+
+            for (auto& [key, chunk] : m_chunks) {
+                chunk.opaqueFaceRenderer = FaceRenderer(chunk.vertexArray, chunk.opaqueFaces, m_faceColor);
+                chunk.transparentFaceRenderer = FaceRenderer(chunk.vertexArray, chunk.transparentFaces, m_faceColor);
+                chunk.edgeRenderer = IndexedEdgeRenderer(chunk.vertexArray, chunk.edgeIndices);
+            }
+        }
 
-            m_opaqueFaceRenderer = FaceRenderer(m_vertexArray, m_opaqueFaces, m_faceColor);
-            m_transparentFaceRenderer = FaceRenderer(m_vertexArray, m_transparentFaces, m_faceColor);
-            m_edgeRenderer = IndexedEdgeRenderer(m_vertexArray, m_edgeIndices);
+        BrushRenderer::ChunkKey BrushRenderer::chunkKey(const vm::bbox3& bounds) {
+            const auto center = bounds.center();
+            return {
+                static_cast<long>(std::floor(center.x() / ChunkSize)),
+                static_cast<long>(std::floor(center.y() / ChunkSize)),
+                static_cast<long>(std::floor(center.z() / ChunkSize))
+            };
         }
 
         static size_t triIndicesCountForPolygon(const size_t vertexCount) {
@@ -455,7 +627,14 @@ namespace TrenchBroom {
                 return;
             }
 
+            const auto& bounds = brush->physicalBounds();
+            const auto brushChunkKey = chunkKey(bounds);
+            Chunk& chunk = m_chunks[brushChunkKey];
+            chunk.bounds = chunk.brushes.empty() ? bounds : vm::merge(chunk.bounds, bounds);
+            chunk.brushes.insert(brush);
+
             BrushInfo& info = m_brushInfo[brush];
+            info.chunkKey = brushChunkKey;
 
             // collect vertices
             auto& brushCache = brush->brushRendererBrushCache();
@@ -463,8 +642,7 @@ namespace TrenchBroom {
             const auto& cachedVertices = brushCache.cachedVertices();
             ensure(!cachedVertices.empty(), "Brush must have cached vertices");
 
-            assert(m_vertexArray != nullptr);
-            auto [vertBlock, dest] = m_vertexArray->getPointerToInsertVerticesAt(cachedVertices.size());
+            auto [vertBlock, dest] = chunk.vertexArray->getPointerToInsertVerticesAt(cachedVertices.size());
             std::memcpy(dest, cachedVertices.data(), cachedVertices.size() * sizeof(*dest));
             info.vertexHolderKey = vertBlock;
 
@@ -474,8 +652,8 @@ namespace TrenchBroom {
             {
                 const size_t edgeIndexCount = countMarkedEdgeIndices(brush, edgePolicy);
                 if (edgeIndexCount > 0) {
-                    auto [key, insertDest] = m_edgeIndices->getPointerToInsertElementsAt(edgeIndexCount);
-                    info.edgeIndicesKey = key;
+                    auto [edgeKey, insertDest] = chunk.edgeIndices->getPointerToInsertElementsAt(edgeIndexCount);
+                    info.edgeIndicesKey = edgeKey;
                     getMarkedEdgeIndices(brush, edgePolicy, brushVerticesStartIndex, insertDest);
                 } else {
                     // it's possible to have no edges to render
@@ -514,7 +692,7 @@ namespace TrenchBroom {
                 }
 
                 if (transparentIndexCount > 0) {
-                    TextureToBrushIndicesMap& faceVboMap = *m_transparentFaces;
+                    TextureToBrushIndicesMap& faceVboMap = *chunk.transparentFaces;
                     auto& holderPtr = faceVboMap[texture];
                     if (holderPtr == nullptr) {
                         // inserts into map!
@@ -541,7 +719,7 @@ namespace TrenchBroom {
                 }
 
                 if (opaqueIndexCount > 0) {
-                    TextureToBrushIndicesMap& faceVboMap = *m_opaqueFaces;
+                    TextureToBrushIndicesMap& faceVboMap = *chunk.opaqueFaces;
                     auto& holderPtr = faceVboMap[texture];
                     if (holderPtr == nullptr) {
                         // inserts into map!
@@ -602,31 +780,40 @@ namespace TrenchBroom {
 
             const BrushInfo& info = it->second;
 
+            auto chunkIt = m_chunks.find(info.chunkKey);
+            assert(chunkIt != std::end(m_chunks));
+            Chunk& chunk = chunkIt->second;
+
             // update Vbo's
-            m_vertexArray->deleteVerticesWithKey(info.vertexHolderKey);
+            chunk.vertexArray->deleteVerticesWithKey(info.vertexHolderKey);
             if (info.edgeIndicesKey != nullptr) {
-                m_edgeIndices->zeroElementsWithKey(info.edgeIndicesKey);
+                chunk.edgeIndices->zeroElementsWithKey(info.edgeIndicesKey);
             }
 
             for (const auto& [texture, opaqueKey] : info.opaqueFaceIndicesKeys) {
-                std::shared_ptr<BrushIndexArray> faceIndexHolder = m_opaqueFaces->at(texture);
+                std::shared_ptr<BrushIndexArray> faceIndexHolder = chunk.opaqueFaces->at(texture);
                 faceIndexHolder->zeroElementsWithKey(opaqueKey);
 
                 if (!faceIndexHolder->hasValidIndices()) {
                     // There are no indices left to render for this texture, so delete the <Texture, BrushIndexArray> entry from the map
-                    m_opaqueFaces->erase(texture);
+                    chunk.opaqueFaces->erase(texture);
                 }
             }
             for (const auto& [texture, transparentKey] : info.transparentFaceIndicesKeys) {
-                std::shared_ptr<BrushIndexArray> faceIndexHolder = m_transparentFaces->at(texture);
+                std::shared_ptr<BrushIndexArray> faceIndexHolder = chunk.transparentFaces->at(texture);
                 faceIndexHolder->zeroElementsWithKey(transparentKey);
 
                 if (!faceIndexHolder->hasValidIndices()) {
                     // There are no indices left to render for this texture, so delete the <Texture, BrushIndexArray> entry from the map
-                    m_transparentFaces->erase(texture);
+                    chunk.transparentFaces->erase(texture);
                 }
             }
 
+            chunk.brushes.erase(brush);
+            if (chunk.brushes.empty()) {
+                m_chunks.erase(chunkIt);
+            }
+
             m_brushInfo.erase(it);
         }
     }
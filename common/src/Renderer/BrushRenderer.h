@@ -20,11 +20,16 @@
 #pragma once
 
 #include "Color.h"
+#include "FloatType.h"
 #include "Model/BrushGeometry.h"
 #include "Renderer/AllocationTracker.h"
+#include "Renderer/BrushRendererArrays.h"
 #include "Renderer/EdgeRenderer.h"
 #include "Renderer/FaceRenderer.h"
 
+#include <vecmath/bbox.h>
+
+#include <map>
 #include <memory>
 #include <tuple>
 #include <unordered_map>
@@ -39,6 +44,8 @@ namespace TrenchBroom {
     }
 
     namespace Renderer {
+        class FrustumCuller;
+
         class BrushRenderer {
         public:
             class Filter {
@@ -117,7 +124,38 @@ namespace TrenchBroom {
         private:
             std::unique_ptr<Filter> m_filter;
 
+            using TextureToBrushIndicesMap = std::unordered_map<const Assets::Texture*, std::shared_ptr<BrushIndexArray>>;
+
+            /**
+             * Brushes are partitioned into the cells of a world grid by the centers of their bounds. Each chunk has its
+             * own vertex and index arrays, so that changing a brush only causes the arrays of its chunk to be uploaded
+             * again, and chunks outside of the view frustum can be skipped without looking at their brushes.
+             */
+            using ChunkKey = std::tuple<long, long, long>;
+
+            struct Chunk {
+                /**
+                 * Contains the bounds of all brushes in this chunk. Only grows until the chunk is removed.
+                 */
+                vm::bbox3 bounds;
+                std::unordered_set<const Model::BrushNode*> brushes;
+
+                std::shared_ptr<BrushVertexArray> vertexArray;
+                std::shared_ptr<BrushIndexArray> edgeIndices;
+                std::shared_ptr<TextureToBrushIndicesMap> transparentFaces;
+                std::shared_ptr<TextureToBrushIndicesMap> opaqueFaces;
+
+                FaceRenderer opaqueFaceRenderer;
+                FaceRenderer transparentFaceRenderer;
+                IndexedEdgeRenderer edgeRenderer;
+
+                bool visible;
+
+                Chunk();
+            };
+
             struct BrushInfo {
+                ChunkKey chunkKey;
                 AllocationTracker::Block* vertexHolderKey;
                 AllocationTracker::Block* edgeIndicesKey;
                 std::vector<std::pair<const Assets::Texture*, AllocationTracker::Block*>> opaqueFaceIndicesKeys;
@@ -138,16 +176,11 @@ namespace TrenchBroom {
             std::unordered_set<const Model::BrushNode*> m_allBrushes;
             std::unordered_set<const Model::BrushNode*> m_invalidBrushes;
 
-            std::shared_ptr<BrushVertexArray> m_vertexArray;
-            std::shared_ptr<BrushIndexArray> m_edgeIndices;
-
-            using TextureToBrushIndicesMap = std::unordered_map<const Assets::Texture*, std::shared_ptr<BrushIndexArray>>;
-            std::shared_ptr<TextureToBrushIndicesMap> m_transparentFaces;
-            std::shared_ptr<TextureToBrushIndicesMap> m_opaqueFaces;
-
-            FaceRenderer m_opaqueFaceRenderer;
-            FaceRenderer m_transparentFaceRenderer;
-            IndexedEdgeRenderer m_edgeRenderer;
+            /**
+             * Chunks are removed as soon as they contain no brushes. Their addresses are stable because the map is
+             * node based, which the render batch relies on.
+             */
+            std::map<ChunkKey, Chunk> m_chunks;
 
             Color m_faceColor;
             bool m_showEdges;
@@ -161,6 +194,42 @@ namespace TrenchBroom {
             float m_transparencyAlpha;
 
             bool m_showHiddenBrushes;
+
+            /**
+             * The draw ranges of the index arrays of a chunk for one culler. Null draw ranges and missing textures
+             * render all indices of an index array.
+             */
+            struct ChunkDrawRanges {
+                bool visible;
+                std::shared_ptr<const BrushIndexArray::DrawRanges> edges;
+                std::unordered_map<const Assets::Texture*, std::shared_ptr<const BrushIndexArray::DrawRanges>> opaqueFaces;
+                std::unordered_map<const Assets::Texture*, std::shared_ptr<const BrushIndexArray::DrawRanges>> transparentFaces;
+            };
+
+            /**
+             * The draw ranges of all chunks for one culler, in the order of m_chunks.
+             */
+            struct CullerDrawRanges {
+                size_t generation;
+                size_t drawnBrushCount;
+                size_t culledBrushCount;
+                std::vector<ChunkDrawRanges> chunks;
+            };
+
+            /**
+             * If set, only the brushes that the culler considers visible are submitted for rendering. The draw ranges
+             * of the index arrays are recomputed whenever the culler's generation or the VBO contents change.
+             *
+             * Each view renders with its own culler, so the draw ranges are cached per culler and swapped into the
+             * index arrays when a different culler is set. The cache is cleared whenever the VBO contents change.
+             */
+            const FrustumCuller* m_frustumCuller;
+            std::unordered_map<const FrustumCuller*, CullerDrawRanges> m_drawRanges;
+            bool m_drawRangesValid;
+            const FrustumCuller* m_appliedCuller;
+            size_t m_appliedGeneration;
+            size_t m_drawnBrushCount;
+            size_t m_culledBrushCount;
         public:
             template <typename FilterT>
             explicit BrushRenderer(const FilterT& filter) :
@@ -171,7 +240,13 @@ namespace TrenchBroom {
             m_showOccludedEdges(false),
             m_forceTransparent(false),
             m_transparencyAlpha(1.0f),
-            m_showHiddenBrushes(false) {
+            m_showHiddenBrushes(false),
+            m_frustumCuller(nullptr),
+            m_drawRangesValid(false),
+            m_appliedCuller(nullptr),
+            m_appliedGeneration(0u),
+            m_drawnBrushCount(0u),
+            m_culledBrushCount(0u) {
                 clear();
             }
 
@@ -185,6 +260,10 @@ namespace TrenchBroom {
              * New brushes are invalidated, brushes already in the BrushRenderer are not invalidated.
              */
             void setBrushes(const std::vector<Model::BrushNode*>& brushes);
+            /**
+             * Removes the given brushes from this BrushRenderer. Every given brush must have been added before.
+             */
+            void removeBrushes(const std::vector<Model::BrushNode*>& brushes);
             void clear();
 
             /**
@@ -194,8 +273,8 @@ namespace TrenchBroom {
              *
              * Until a brush is invalidated, we don't re-evaluate the Filter, and don't check the Brush object for modification.
              *
-             * Additionally, calling `invalidate()` guarantees the m_brushInfo, m_transparentFaces, and m_opaqueFaces
-             * maps will be empty, so the BrushRenderer will not have any lingering Texture* pointers.
+             * Additionally, calling `invalidate()` guarantees the m_brushInfo and m_chunks maps will be empty, so the
+             * BrushRenderer will not have any lingering Texture* pointers.
              */
             void invalidate();
             void invalidateBrushes(const std::vector<Model::BrushNode*>& brushes);
@@ -265,6 +344,28 @@ namespace TrenchBroom {
              * Specifies whether or not brushes which are currently hidden should be rendered regardless.
              */
             void setShowHiddenBrushes(bool showHiddenBrushes);
+
+            /**
+             * Sets the culler that decides which brushes are submitted for rendering. Pass null to render all brushes.
+             * The culler must outlive this renderer or be reset before it is destroyed.
+             */
+            void setFrustumCuller(const FrustumCuller* frustumCuller);
+
+            /**
+             * Returns the number of brushes that were submitted for rendering in the last frame.
+             */
+            size_t drawnBrushCount() const;
+
+            /**
+             * Returns the number of brushes that were skipped in the last frame because they were outside of the view
+             * frustum.
+             */
+            size_t culledBrushCount() const;
+
+            /**
+             * Returns the number of chunks that the brushes are currently partitioned into.
+             */
+            size_t chunkCount() const;
         public: // rendering
             void render(RenderContext& renderContext, RenderBatch& renderBatch);
             void renderOpaque(RenderContext& renderContext, RenderBatch& renderBatch);
@@ -274,6 +375,11 @@ namespace TrenchBroom {
             void renderTransparentFaces(RenderBatch& renderBatch);
             void renderEdges(RenderBatch& renderBatch);
 
+            void invalidateDrawRanges();
+            void validateDrawRanges();
+            CullerDrawRanges computeDrawRanges(size_t generation) const;
+            ChunkDrawRanges computeChunkDrawRanges(const Chunk& chunk, CullerDrawRanges& drawRanges) const;
+            void applyDrawRanges(const CullerDrawRanges& drawRanges);
         public:
             /**
              * Only exposed for benchmarking.
@@ -282,6 +388,7 @@ namespace TrenchBroom {
         private:
             bool shouldDrawFaceInTransparentPass(const Model::BrushNode* brush, const Model::BrushFace& face) const;
             void validateBrush(const Model::BrushNode* brush);
+            static ChunkKey chunkKey(const vm::bbox3& bounds);
             void addBrush(const Model::BrushNode* brush);
             void removeBrush(const Model::BrushNode* brush);
 
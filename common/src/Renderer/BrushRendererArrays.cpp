@@ -87,6 +87,18 @@ namespace TrenchBroom {
             glAssert(glDrawElements(toGL(primType), renderCount, glType<Index>(), renderOffset));
         }
 
+        void IndexHolder::render(const PrimType primType, const GLIndices& offsets, const GLCounts& counts) const {
+            assert(offsets.size() == counts.size());
+
+            std::vector<const GLvoid*> renderOffsets;
+            renderOffsets.reserve(offsets.size());
+            for (const auto offset : offsets) {
+                renderOffsets.push_back(reinterpret_cast<GLvoid *>(m_vbo->offset() + sizeof(Index) * static_cast<size_t>(offset)));
+            }
+
+            glAssert(glMultiDrawElements(toGL(primType), counts.data(), glType<Index>(), renderOffsets.data(), static_cast<GLsizei>(counts.size())));
+        }
+
         std::shared_ptr<IndexHolder> IndexHolder::swap(std::vector<IndexHolder::Index> &elements) {
             return std::make_shared<IndexHolder>(elements);
         }
@@ -131,9 +143,36 @@ namespace TrenchBroom {
             m_indexHolder.zeroRange(pos, size);
         }
 
+        std::shared_ptr<const BrushIndexArray::DrawRanges> BrushIndexArray::computeDrawRanges(std::vector<const AllocationTracker::Block*> keys) {
+            std::sort(std::begin(keys), std::end(keys), [](const auto* lhs, const auto* rhs) { return lhs->pos < rhs->pos; });
+
+            auto result = std::make_shared<DrawRanges>();
+            for (const auto* key : keys) {
+                if (!result->offsets.empty() && static_cast<size_t>(result->offsets.back() + result->counts.back()) == key->pos) {
+                    result->counts.back() += static_cast<GLsizei>(key->size);
+                } else {
+                    result->offsets.push_back(static_cast<GLint>(key->pos));
+                    result->counts.push_back(static_cast<GLsizei>(key->size));
+                }
+            }
+            return result;
+        }
+
+        void BrushIndexArray::setDrawRanges(std::shared_ptr<const DrawRanges> drawRanges) {
+            m_drawRanges = std::move(drawRanges);
+        }
+
+        void BrushIndexArray::clearDrawRanges() {
+            m_drawRanges = nullptr;
+        }
+
         void BrushIndexArray::render(const PrimType primType) const {
             assert(m_indexHolder.prepared());
-            m_indexHolder.render(primType, 0, m_indexHolder.size());
+            if (m_drawRanges == nullptr) {
+                m_indexHolder.render(primType, 0, m_indexHolder.size());
+            } else if (!m_drawRanges->counts.empty()) {
+                m_indexHolder.render(primType, m_drawRanges->offsets, m_drawRanges->counts);
+            }
         }
 
         bool BrushIndexArray::prepared() const {
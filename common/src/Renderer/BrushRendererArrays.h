@@ -224,6 +224,10 @@ namespace TrenchBroom {
             explicit IndexHolder(std::vector<Index>& elements);
             void zeroRange(size_t offsetWithinBlock, size_t count);
             void render(PrimType primType, size_t offset, size_t count) const;
+            /**
+             * Renders the given ranges of elements with a single draw call.
+             */
+            void render(PrimType primType, const GLIndices& offsets, const GLCounts& counts) const;
 
             static std::shared_ptr<IndexHolder> swap(std::vector<Index>& elements);
         };
@@ -233,9 +237,22 @@ namespace TrenchBroom {
          * supports freeing allocations and zeroing the corresponding indicies so they become degenerate primitives.
          */
         class BrushIndexArray {
+        public:
+            /**
+             * Ranges of indices that are submitted with a single draw call.
+             */
+            struct DrawRanges {
+                GLIndices offsets;
+                GLCounts counts;
+            };
         private:
             IndexHolder m_indexHolder;
             AllocationTracker m_allocationTracker;
+
+            /**
+             * If null, all indices are rendered.
+             */
+            std::shared_ptr<const DrawRanges> m_drawRanges;
         public:
             BrushIndexArray();
 
@@ -259,6 +276,26 @@ namespace TrenchBroom {
              */
             void zeroElementsWithKey(AllocationTracker::Block* key);
 
+            /**
+             * Computes the draw ranges that cover the allocations with the given keys, e.g. the brushes that survived
+             * culling. Adjacent allocations are merged so that they can be submitted as few ranges as possible.
+             *
+             * Only the positions of the allocations are remembered, so the draw ranges must be computed again whenever
+             * allocations are added or freed.
+             */
+            static std::shared_ptr<const DrawRanges> computeDrawRanges(std::vector<const AllocationTracker::Block*> keys);
+
+            /**
+             * Restricts rendering to the given draw ranges. Draw ranges can be shared and swapped cheaply, e.g. when
+             * several views with different cullers render the same array.
+             */
+            void setDrawRanges(std::shared_ptr<const DrawRanges> drawRanges);
+
+            /**
+             * Lifts the restriction set by setDrawRanges(), so that all indices are rendered again.
+             */
+            void clearDrawRanges();
+
             void render(const PrimType primType) const;
             bool prepared() const;
             void prepare(VboManager& vboManager);
@@ -19,6 +19,7 @@
 
 #include "EntityModelRenderer.h"
 
+#include "Ensure.h"
 #include "Logger.h"
 #include "PreferenceManager.h"
 #include "Preferences.h"
@@ -31,26 +32,46 @@
 #include "Model/Entity.h"
 #include "Model/EntityNode.h"
 #include "Renderer/ActiveShader.h"
+#include "Renderer/FrustumCuller.h"
+#include "Renderer/GL.h"
 #include "Renderer/RenderBatch.h"
 #include "Renderer/RenderContext.h"
+#include "Renderer/RenderUtils.h"
 #include "Renderer/Shaders.h"
 #include "Renderer/ShaderManager.h"
+#include "Renderer/ShaderProgram.h"
 #include "Renderer/TexturedIndexRangeRenderer.h"
-#include "Renderer/Transformation.h"
+#include "Renderer/Vbo.h"
+#include "Renderer/VboManager.h"
+#include "Renderer/VertexArray.h"
 
 #include <vecmath/mat.h>
 
+#include <cassert>
+#include <utility>
+
 namespace TrenchBroom {
     namespace Renderer {
+        // used for models without a skin
+        static const Color DefaultModelColor(0.5f, 0.5f, 0.5f);
+
         EntityModelRenderer::EntityModelRenderer(Logger& logger, Assets::EntityModelManager& entityModelManager, const Model::EditorContext& editorContext) :
         m_logger(logger),
         m_entityModelManager(entityModelManager),
         m_editorContext(editorContext),
         m_applyTinting(false),
-        m_showHiddenEntities(false) {}
+        m_showHiddenEntities(false),
+        m_frustumCuller(nullptr),
+        m_vboManager(nullptr),
+        m_instanceVbo(nullptr),
+        m_drawCallCount(0) {}
 
         EntityModelRenderer::~EntityModelRenderer() {
             clear();
+            if (m_instanceVbo != nullptr) {
+                m_vboManager->destroyVbo(m_instanceVbo);
+                m_instanceVbo = nullptr;
+            }
         }
 
         void EntityModelRenderer::addEntity(Model::EntityNode* entityNode) {
@@ -59,8 +80,8 @@ namespace TrenchBroom {
             });
 
             auto* renderer = m_entityModelManager.renderer(modelSpec);
-            if (renderer != nullptr) {
-                m_entities.insert(std::make_pair(entityNode, renderer));
+            if (renderer != nullptr && m_entities.insert(std::make_pair(entityNode, renderer)).second) {
+                addToRenderer(entityNode, renderer);
             }
         }
 
@@ -78,17 +99,31 @@ namespace TrenchBroom {
 
             if (it == std::end(m_entities)) {
                 m_entities.insert(std::make_pair(entityNode, renderer));
+                addToRenderer(entityNode, renderer);
             } else {
                 if (renderer == nullptr) {
+                    removeFromRenderer(entityNode, it->second);
                     m_entities.erase(it);
                 } else if (it->second != renderer) {
+                    removeFromRenderer(entityNode, it->second);
                     it->second = renderer;
+                    addToRenderer(entityNode, renderer);
                 }
             }
         }
 
+        void EntityModelRenderer::removeEntity(Model::EntityNode* entityNode) {
+            const auto it = m_entities.find(entityNode);
+            if (it != std::end(m_entities)) {
+                removeFromRenderer(entityNode, it->second);
+                m_entities.erase(it);
+            }
+        }
+
         void EntityModelRenderer::clear() {
             m_entities.clear();
+            m_entitiesByRenderer.clear();
+            m_drawCallCount = 0;
         }
 
         bool EntityModelRenderer::applyTinting() const {
@@ -115,11 +150,85 @@ namespace TrenchBroom {
             m_showHiddenEntities = showHiddenEntities;
         }
 
+        void EntityModelRenderer::setFrustumCuller(const FrustumCuller* frustumCuller) {
+            m_frustumCuller = frustumCuller;
+        }
+
+        size_t EntityModelRenderer::drawCallCount() const {
+            return m_drawCallCount;
+        }
+
+        size_t EntityModelRenderer::modelRendererCount() const {
+            return m_entitiesByRenderer.size();
+        }
+
+        const TexturedRenderer* EntityModelRenderer::modelRenderer(const Model::EntityNode* entityNode) const {
+            const auto it = m_entities.find(const_cast<Model::EntityNode*>(entityNode));
+            return it != std::end(m_entities) ? it->second : nullptr;
+        }
+
+        size_t EntityModelRenderer::entityCount(const TexturedRenderer* modelRenderer) const {
+            const auto it = m_entitiesByRenderer.find(const_cast<TexturedRenderer*>(modelRenderer));
+            return it != std::end(m_entitiesByRenderer) ? it->second.size() : 0u;
+        }
+
+        std::vector<std::pair<TexturedRenderer*, size_t>> EntityModelRenderer::collectInstances(std::vector<vm::vec4f>& instanceData) const {
+            auto batches = std::vector<std::pair<TexturedRenderer*, size_t>>{};
+            batches.reserve(m_entitiesByRenderer.size());
+
+            for (const auto& [renderer, entityNodes] : m_entitiesByRenderer) {
+                auto instanceCount = size_t(0);
+                for (auto* entityNode : entityNodes) {
+                    if (visible(entityNode)) {
+                        const auto transformation = vm::mat4x4f(entityNode->entity().modelTransformation());
+                        for (size_t i = 0; i < 4; ++i) {
+                            instanceData.push_back(transformation[i]);
+                        }
+                        ++instanceCount;
+                    }
+                }
+                if (instanceCount > 0) {
+                    batches.emplace_back(renderer, instanceCount);
+                }
+            }
+
+            return batches;
+        }
+
+        size_t EntityModelRenderer::instanceBufferCapacity(const size_t currentCapacity, const size_t instanceDataSize) {
+            return currentCapacity < instanceDataSize ? 2 * instanceDataSize : currentCapacity;
+        }
+
         void EntityModelRenderer::render(RenderBatch& renderBatch) {
             renderBatch.add(this);
         }
 
+        void EntityModelRenderer::addToRenderer(Model::EntityNode* entityNode, TexturedRenderer* renderer) {
+            m_entitiesByRenderer[renderer].insert(entityNode);
+        }
+
+        void EntityModelRenderer::removeFromRenderer(Model::EntityNode* entityNode, TexturedRenderer* renderer) {
+            const auto it = m_entitiesByRenderer.find(renderer);
+            assert(it != std::end(m_entitiesByRenderer));
+
+            it->second.erase(entityNode);
+            if (it->second.empty()) {
+                m_entitiesByRenderer.erase(it);
+            }
+        }
+
+        bool EntityModelRenderer::visible(Model::EntityNode* entityNode) const {
+            if (!m_showHiddenEntities && !m_editorContext.visible(entityNode)) {
+                return false;
+            }
+            if (m_frustumCuller != nullptr && !m_frustumCuller->visible(entityNode)) {
+                return false;
+            }
+            return true;
+        }
+
         void EntityModelRenderer::doPrepareVertices(VboManager& vboManager) {
+            m_vboManager = &vboManager;
             m_entityModelManager.prepare(vboManager);
         }
 
@@ -143,17 +252,72 @@ namespace TrenchBroom {
             glAssert(glEnable(GL_TEXTURE_2D));
             glAssert(glActiveTexture(GL_TEXTURE0));
 
-            for (const auto& [entityNode, renderer] : m_entities) {
-                if (!m_showHiddenEntities && !m_editorContext.visible(entityNode)) {
-                    continue;
+            const auto drawCallCountBefore = VertexArray::drawCallCount();
+            if (glSupportsInstancing()) {
+                renderInstanced(renderContext, shader);
+            } else {
+                renderIndividually(shader);
+            }
+            m_drawCallCount = VertexArray::drawCallCount() - drawCallCountBefore;
+        }
+
+        void EntityModelRenderer::renderInstanced(RenderContext& renderContext, ActiveShader& shader) {
+            ensure(m_vboManager != nullptr, "vertices must be prepared before rendering");
+
+            m_instanceData.clear();
+            const auto batches = collectInstances(m_instanceData);
+            if (batches.empty()) {
+                return;
+            }
+
+            const auto instanceDataSize = m_instanceData.size() * sizeof(vm::vec4f);
+            const auto currentCapacity = m_instanceVbo != nullptr ? m_instanceVbo->capacity() : size_t(0);
+            const auto capacity = instanceBufferCapacity(currentCapacity, instanceDataSize);
+            if (capacity != currentCapacity) {
+                if (m_instanceVbo != nullptr) {
+                    m_vboManager->destroyVbo(m_instanceVbo);
                 }
+                m_instanceVbo = m_vboManager->allocateVbo(VboType::ArrayBuffer, capacity, VboUsage::DynamicDraw);
+            }
+            m_instanceVbo->writeBuffer(0, m_instanceData);
 
-                const auto transformation = entityNode->entity().modelTransformation();
-                MultiplyModelMatrix multMatrix(renderContext.transformation(), vm::mat4x4f(transformation));
+            const auto location = static_cast<GLuint>(renderContext.shaderManager().currentProgram()->findAttributeLocation("ModelMatrix"));
+            const auto stride = static_cast<GLsizei>(4 * sizeof(vm::vec4f));
+            for (GLuint i = 0; i < 4; ++i) {
+                glAssert(glEnableVertexAttribArray(location + i));
+                glAssert(glVertexAttribDivisorARB(location + i, 1));
+            }
 
-                shader.set("ModelMatrix", vm::mat4x4f(transformation));
+            auto func = ApplyTextureRenderFunc{shader, DefaultModelColor};
+            auto firstInstance = size_t(0);
+            for (const auto& [renderer, instanceCount] : batches) {
+                // GL 2.1 has no base instance, so point the attribute at the first instance of this batch instead
+                m_instanceVbo->bind();
+                for (GLuint i = 0; i < 4; ++i) {
+                    const auto offset = (4 * firstInstance + i) * sizeof(vm::vec4f);
+                    glAssert(glVertexAttribPointer(location + i, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<GLvoid*>(offset)));
+                }
+                m_instanceVbo->unbind();
 
-                renderer->render();
+                renderer->renderInstanced(func, instanceCount);
+                firstInstance += instanceCount;
+            }
+
+            for (GLuint i = 0; i < 4; ++i) {
+                glAssert(glVertexAttribDivisorARB(location + i, 0));
+                glAssert(glDisableVertexAttribArray(location + i));
+            }
+        }
+
+        void EntityModelRenderer::renderIndividually(ActiveShader& shader) {
+            auto func = ApplyTextureRenderFunc{shader, DefaultModelColor};
+            for (const auto& [renderer, entityNodes] : m_entitiesByRenderer) {
+                for (auto* entityNode : entityNodes) {
+                    if (visible(entityNode)) {
+                        shader.setAttribute("ModelMatrix", vm::mat4x4f(entityNode->entity().modelTransformation()));
+                        renderer->render(func);
+                    }
+                }
             }
         }
     }
@@ -22,7 +22,13 @@
 #include "Color.h"
 #include "Renderer/Renderable.h"
 
+#include <vecmath/vec.h>
+
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace TrenchBroom {
     class Logger;
@@ -37,12 +43,16 @@ namespace TrenchBroom {
     }
 
     namespace Renderer {
+        class ActiveShader;
+        class FrustumCuller;
         class RenderBatch;
         class TexturedRenderer;
+        class Vbo;
 
         class EntityModelRenderer : public DirectRenderable {
         private:
             using EntityMap = std::map<Model::EntityNode*, TexturedRenderer*>;
+            using RendererMap = std::unordered_map<TexturedRenderer*, std::unordered_set<Model::EntityNode*>>;
 
             Logger& m_logger;
 
@@ -50,11 +60,27 @@ namespace TrenchBroom {
             const Model::EditorContext& m_editorContext;
 
             EntityMap m_entities;
+            /**
+             * The entities grouped by their renderer, i.e., by model, skin and frame. All entities sharing a renderer
+             * are drawn together.
+             */
+            RendererMap m_entitiesByRenderer;
 
             bool m_applyTinting;
             Color m_tintColor;
 
             bool m_showHiddenEntities;
+
+            const FrustumCuller* m_frustumCuller;
+
+            VboManager* m_vboManager;
+            /**
+             * Holds the model transformations of the rendered entities when rendering instanced.
+             */
+            Vbo* m_instanceVbo;
+            std::vector<vm::vec4f> m_instanceData;
+
+            size_t m_drawCallCount;
         public:
             EntityModelRenderer(Logger& logger, Assets::EntityModelManager& entityModelManager, const Model::EditorContext& editorContext);
             ~EntityModelRenderer() override;
@@ -81,8 +107,17 @@ namespace TrenchBroom {
                 }
             }
 
+            template <typename I>
+            void removeEntities(I cur, I end) {
+                while (cur != end) {
+                    removeEntity(*cur);
+                    ++cur;
+                }
+            }
+
             void addEntity(Model::EntityNode* entityNode);
             void updateEntity(Model::EntityNode* entityNode);
+            void removeEntity(Model::EntityNode* entityNode);
             void clear();
 
             bool applyTinting() const;
@@ -93,10 +128,65 @@ namespace TrenchBroom {
             bool showHiddenEntities() const;
             void setShowHiddenEntities(bool showHiddenEntities);
 
+            /**
+             * Sets the culler that decides which entity models are rendered. Pass null to render all models.
+             */
+            void setFrustumCuller(const FrustumCuller* frustumCuller);
+
+            /**
+             * Returns the number of draw calls issued when this renderer was last rendered.
+             */
+            size_t drawCallCount() const;
+
+            /**
+             * Returns the number of distinct model renderers, i.e., combinations of model, skin and frame, that the
+             * added entities use.
+             */
+            size_t modelRendererCount() const;
+
+            /**
+             * Returns the model renderer of the given entity, or null if the entity was not added or has no model.
+             */
+            const TexturedRenderer* modelRenderer(const Model::EntityNode* entityNode) const;
+
+            /**
+             * Returns the number of added entities that use the given model renderer.
+             */
+            size_t entityCount(const TexturedRenderer* modelRenderer) const;
+
+            /**
+             * Appends the model transformations of the visible entities to the given vector, four columns per entity,
+             * so that the entities sharing a model renderer are adjacent. Returns the model renderers in the same
+             * order, each with the number of its visible entities. Model renderers without visible entities are
+             * omitted.
+             */
+            std::vector<std::pair<TexturedRenderer*, size_t>> collectInstances(std::vector<vm::vec4f>& instanceData) const;
+
+            /**
+             * Returns the capacity in bytes of the instance buffer required to hold the given number of bytes of
+             * instance data. The current capacity is kept if it suffices, otherwise the buffer is reallocated with
+             * room for more entities so that it isn't reallocated every time an entity is added.
+             */
+            static size_t instanceBufferCapacity(size_t currentCapacity, size_t instanceDataSize);
+
             void render(RenderBatch& renderBatch);
         private:
+            void addToRenderer(Model::EntityNode* entityNode, TexturedRenderer* renderer);
+            void removeFromRenderer(Model::EntityNode* entityNode, TexturedRenderer* renderer);
+
+            bool visible(Model::EntityNode* entityNode) const;
+
             void doPrepareVertices(VboManager& vboManager) override;
             void doRender(RenderContext& renderContext) override;
+            /**
+             * Renders all visible entities sharing a renderer with one instanced draw call per range of primitives.
+             * The model transformations of the entities are passed to the shader as a per instance attribute.
+             */
+            void renderInstanced(RenderContext& renderContext, ActiveShader& shader);
+            /**
+             * Fallback if the context does not support instancing: renders each visible entity on its own.
+             */
+            void renderIndividually(ActiveShader& shader);
         };
     }
 }
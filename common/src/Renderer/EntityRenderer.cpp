@@ -36,12 +36,15 @@
 #include "Renderer/TextAnchor.h"
 #include "Renderer/GLVertexType.h"
 
+#include <kdl/vector_utils.h>
+
 #include <vecmath/forward.h>
 #include <vecmath/vec.h>
 #include <vecmath/mat.h>
 #include <vecmath/mat_ext.h>
 #include <vecmath/scalar.h>
 
+#include <unordered_set>
 #include <vector>
 
 namespace TrenchBroom {
@@ -84,6 +87,19 @@ namespace TrenchBroom {
             invalidate();
         }
 
+        void EntityRenderer::addEntities(const std::vector<Model::EntityNode*>& entities) {
+            m_entities.insert(std::end(m_entities), std::begin(entities), std::end(entities));
+            m_modelRenderer.addEntities(std::begin(entities), std::end(entities));
+            invalidateBounds();
+        }
+
+        void EntityRenderer::removeEntities(const std::vector<Model::EntityNode*>& entities) {
+            const auto toRemove = std::unordered_set<Model::EntityNode*>(std::begin(entities), std::end(entities));
+            m_entities = kdl::vec_erase_if(std::move(m_entities), [&](auto* entity) { return toRemove.count(entity) > 0u; });
+            m_modelRenderer.removeEntities(std::begin(entities), std::end(entities));
+            invalidateBounds();
+        }
+
         void EntityRenderer::invalidate() {
             invalidateBounds();
             reloadModels();
@@ -153,6 +169,14 @@ namespace TrenchBroom {
             m_showHiddenEntities = showHiddenEntities;
         }
 
+        void EntityRenderer::setFrustumCuller(const FrustumCuller* frustumCuller) {
+            m_modelRenderer.setFrustumCuller(frustumCuller);
+        }
+
+        size_t EntityRenderer::modelDrawCallCount() const {
+            return m_modelRenderer.drawCallCount();
+        }
+
         void EntityRenderer::render(RenderContext& renderContext, RenderBatch& renderBatch) {
             if (!m_entities.empty()) {
                 renderBounds(renderContext, renderBatch);
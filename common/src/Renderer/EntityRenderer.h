@@ -43,6 +43,7 @@ namespace TrenchBroom {
 
     namespace Renderer {
         class AttrString;
+        class FrustumCuller;
 
         class EntityRenderer {
         private:
@@ -76,7 +77,13 @@ namespace TrenchBroom {
             EntityRenderer(Logger& logger, Assets::EntityModelManager& entityModelManager, const Model::EditorContext& editorContext);
 
             void setEntities(const std::vector<Model::EntityNode*>& entities);
+            void addEntities(const std::vector<Model::EntityNode*>& entities);
+            void removeEntities(const std::vector<Model::EntityNode*>& entities);
             void invalidate();
+            /**
+             * Invalidates the entity bounds without reloading the entity models.
+             */
+            void invalidateBounds();
             void clear();
             void reloadModels();
 
@@ -98,6 +105,16 @@ namespace TrenchBroom {
             void setAngleColor(const Color& angleColor);
 
             void setShowHiddenEntities(bool showHiddenEntities);
+
+            /**
+             * Sets the culler that decides which entity models are rendered. Pass null to render all models.
+             */
+            void setFrustumCuller(const FrustumCuller* frustumCuller);
+        public: // statistics
+            /**
+             * Returns the number of draw calls issued for entity models in the last frame.
+             */
+            size_t modelDrawCallCount() const;
         public: // rendering
             void render(RenderContext& renderContext, RenderBatch& renderBatch);
         private:
@@ -114,7 +131,6 @@ namespace TrenchBroom {
             struct BuildColoredWireframeBoundsVertices;
             struct BuildWireframeBoundsVertices;
 
-            void invalidateBounds();
             void validateBounds();
 
             AttrString entityString(const Model::EntityNode* entityNode) const;
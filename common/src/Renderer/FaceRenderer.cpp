@@ -45,18 +45,19 @@ namespace TrenchBroom {
             defaultColor(i_defaultColor) {}
 
             void before(const Assets::Texture* texture) override {
-                if (texture != nullptr) {
+                // textures are uploaded in batches, so faces whose texture isn't prepared yet show its average color
+                if (texture != nullptr && texture->isPrepared()) {
                     texture->activate();
                     shader.set("ApplyTexture", applyTexture);
                     shader.set("Color", texture->averageColor());
                 } else {
                     shader.set("ApplyTexture", false);
-                    shader.set("Color", defaultColor);
+                    shader.set("Color", texture != nullptr ? texture->averageColor() : defaultColor);
                 }
             }
 
             void after(const Assets::Texture* texture) override {
-                if (texture != nullptr) {
+                if (texture != nullptr && texture->isPrepared()) {
                     texture->deactivate();
                 }
             }
@@ -0,0 +1,125 @@
+/*
+ Copyright (C) 2021 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FrustumCuller.h"
+
+#include "AABBTree.h"
+#include "Model/WorldNode.h"
+#include "Renderer/Camera.h"
+
+#include <vecmath/bbox.h>
+#include <vecmath/plane.h>
+#include <vecmath/vec.h>
+
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        static std::vector<vm::plane3> frustumPlanes(const Camera& camera) {
+            vm::plane3f top, right, bottom, left;
+            camera.frustumPlanes(top, right, bottom, left);
+
+            auto planes = std::vector<vm::plane3f>{top, right, bottom, left};
+            if (camera.perspectiveProjection()) {
+                // the side planes meet at the camera position, so only the far plane is missing
+                planes.emplace_back(camera.position() + camera.farPlane() * camera.direction(), camera.direction());
+            }
+
+            auto result = std::vector<vm::plane3>{};
+            result.reserve(planes.size());
+            for (const auto& plane : planes) {
+                result.emplace_back(vm::vec3(plane.anchor()), vm::vec3(plane.normal));
+            }
+            return result;
+        }
+
+        FrustumCuller::FrustumCuller() :
+        m_culling(false),
+        m_valid(false),
+        m_generation(0u) {}
+
+        void FrustumCuller::update(const Model::WorldNode& world, const Camera& camera) {
+            if (m_valid && m_projectionMatrix == camera.projectionMatrix() && m_viewMatrix == camera.viewMatrix()) {
+                return;
+            }
+
+            m_planes = frustumPlanes(camera);
+            const auto visibleNodes = world.findNodesInFrustum(m_planes);
+
+            m_visibleNodes.clear();
+            m_culling = visibleNodes.size() < world.nodeTree().size();
+            if (m_culling) {
+                m_visibleNodes.insert(std::begin(visibleNodes), std::end(visibleNodes));
+            }
+
+            m_valid = true;
+            m_projectionMatrix = camera.projectionMatrix();
+            m_viewMatrix = camera.viewMatrix();
+            ++m_generation;
+        }
+
+        void FrustumCuller::invalidate() {
+            m_valid = false;
+        }
+
+        bool FrustumCuller::culling() const {
+            return m_culling;
+        }
+
+        bool FrustumCuller::visible(const Model::Node* node) const {
+            return !m_culling || m_visibleNodes.count(node) > 0u;
+        }
+
+        bool FrustumCuller::contains(const vm::bbox3& bounds) const {
+            if (!m_culling) {
+                return true;
+            }
+
+            const auto center = bounds.center();
+            const auto halfSize = bounds.size() / 2.0;
+            for (const auto& plane : m_planes) {
+                const auto radius = vm::dot(vm::abs(plane.normal), halfSize);
+                if (plane.point_distance(center) + radius > 0.0) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool FrustumCuller::intersects(const vm::bbox3& bounds) const {
+            if (!m_culling) {
+                return true;
+            }
+
+            const auto center = bounds.center();
+            const auto halfSize = bounds.size() / 2.0;
+            for (const auto& plane : m_planes) {
+                const auto radius = vm::dot(vm::abs(plane.normal), halfSize);
+                if (plane.point_distance(center) - radius > 0.0) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        size_t FrustumCuller::generation() const {
+            return m_generation;
+        }
+    }
+}
@@ -0,0 +1,97 @@
+/*
+ Copyright (C) 2021 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vecmath/forward.h>
+#include <vecmath/mat.h>
+#include <vecmath/plane.h>
+
+#include <unordered_set>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Model {
+        class Node;
+        class WorldNode;
+    }
+
+    namespace Renderer {
+        class Camera;
+
+        /**
+         * Determines which nodes may be visible through the view frustum of a camera by querying the spatial index of
+         * the world. The renderers use this to skip brushes and entity models that are outside of the frustum.
+         *
+         * Only the nodes that are stored in the spatial index, i.e., entities, brushes and patches, can be culled.
+         *
+         * A culler caches the visible nodes for one view, so every camera should have its own culler.
+         */
+        class FrustumCuller {
+        private:
+            std::vector<vm::plane3> m_planes;
+            std::unordered_set<const Model::Node*> m_visibleNodes;
+            bool m_culling;
+            bool m_valid;
+            vm::mat4x4f m_projectionMatrix;
+            vm::mat4x4f m_viewMatrix;
+            size_t m_generation;
+        public:
+            FrustumCuller();
+
+            /**
+             * Recomputes the visible nodes for the current view of the given camera unless they are still valid for
+             * that view.
+             */
+            void update(const Model::WorldNode& world, const Camera& camera);
+
+            /**
+             * Forces the visible nodes to be recomputed on the next update, e.g. because nodes were added, removed or
+             * moved.
+             */
+            void invalidate();
+
+            /**
+             * Indicates whether any node is outside of the frustum. If not, every node is considered visible.
+             */
+            bool culling() const;
+
+            /**
+             * Indicates whether the given node may be visible in the frustum.
+             */
+            bool visible(const Model::Node* node) const;
+
+            /**
+             * Indicates whether the given box is entirely inside of the frustum. Always true if nothing is culled.
+             */
+            bool contains(const vm::bbox3& bounds) const;
+
+            /**
+             * Indicates whether the given box may intersect the frustum. Always true if nothing is culled.
+             */
+            bool intersects(const vm::bbox3& bounds) const;
+
+            /**
+             * Returns a number that changes whenever the visible nodes are recomputed. Renderers can compare it to decide
+             * whether their draw lists are up to date.
+             */
+            size_t generation() const;
+        };
+    }
+}
@@ -110,4 +110,8 @@ namespace TrenchBroom {
                 return "Unknown OpenGL enum";
         }
     }
+
+    bool glSupportsInstancing() {
+        return GLEW_ARB_draw_instanced && GLEW_ARB_instanced_arrays;
+    }
 }
@@ -34,6 +34,12 @@ namespace TrenchBroom {
     GLenum glGetEnum(const std::string& name);
     std::string glGetEnumName(GLenum _enum);
 
+    /**
+     * Indicates whether the current context supports instanced rendering with per instance vertex attributes.
+     * Requires that GLEW was initialized.
+     */
+    bool glSupportsInstancing();
+
 // #define GL_DEBUG 1
 // #define GL_LOG 1
 
@@ -30,6 +30,9 @@
 #include "Renderer/RenderService.h"
 #include "Renderer/TextAnchor.h"
 
+#include <kdl/vector_utils.h>
+
+#include <unordered_set>
 #include <vector>
 
 #include <vector>
@@ -68,6 +71,17 @@ namespace TrenchBroom {
             invalidate();
         }
 
+        void GroupRenderer::addGroups(const std::vector<Model::GroupNode*>& groups) {
+            m_groups.insert(std::end(m_groups), std::begin(groups), std::end(groups));
+            invalidateBounds();
+        }
+
+        void GroupRenderer::removeGroups(const std::vector<Model::GroupNode*>& groups) {
+            const auto toRemove = std::unordered_set<Model::GroupNode*>(std::begin(groups), std::end(groups));
+            m_groups = kdl::vec_erase_if(std::move(m_groups), [&](auto* group) { return toRemove.count(group) > 0u; });
+            invalidateBounds();
+        }
+
         void GroupRenderer::invalidate() {
             invalidateBounds();
         }
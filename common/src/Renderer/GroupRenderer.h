@@ -60,28 +60,8 @@ namespace TrenchBroom {
             void invalidate();
             void clear();
 
-            template <typename Iter>
-            void addGroups(Iter cur, const Iter end) {
-                while (cur != end) {
-                    addGroup(*cur);
-                    ++cur;
-                }
-            }
-            template <typename Iter>
-            void updateGroups(Iter cur, const Iter end) {
-                while (cur != end) {
-                    updateGroup(*cur);
-                    ++cur;
-                }
-            }
-
-            template <typename Iter>
-            void removeGroups(Iter cur, const Iter end) {
-                while (cur != end) {
-                    removeGroup(*cur);
-                    ++cur;
-                }
-            }
+            void addGroups(const std::vector<Model::GroupNode*>& groups);
+            void removeGroups(const std::vector<Model::GroupNode*>& groups);
 
             void setOverrideColors(bool overrideColors);
 
@@ -145,6 +145,15 @@ namespace TrenchBroom {
              */
             void render(VertexArray& vertexArray) const;
 
+            /**
+             * Renders the primitives stored in this index range map using the vertices in the given vertex array
+             * several times. Each range of primitives is rendered using one instanced draw call.
+             *
+             * @param vertexArray the vertex array to render with
+             * @param instanceCount the number of instances to render
+             */
+            void renderInstanced(VertexArray& vertexArray, size_t instanceCount) const;
+
             /**
              * Invokes the given function for each primitive stored in this map.
              *
@@ -29,11 +29,13 @@
 #include "Model/EntityNode.h"
 #include "Model/GroupNode.h"
 #include "Model/LayerNode.h"
+#include "Model/ModelUtils.h"
 #include "Model/Node.h"
 #include "Model/PatchNode.h"
 #include "Model/WorldNode.h"
 #include "Renderer/BrushRenderer.h"
 #include "Renderer/EntityLinkRenderer.h"
+#include "Renderer/FrustumCuller.h"
 #include "Renderer/GroupLinkRenderer.h"
 #include "Renderer/ObjectRenderer.h"
 #include "Renderer/RenderBatch.h"
@@ -45,6 +47,7 @@
 #include <kdl/memory_utils.h>
 #include <kdl/overload.h>
 #include <kdl/vector_set.h>
+#include <kdl/vector_utils.h>
 
 #include <set>
 #include <vector>
@@ -171,8 +174,10 @@ namespace TrenchBroom {
             m_defaultRenderer->clear();
             m_selectionRenderer->clear();
             m_lockedRenderer->clear();
+            m_nodeRenderers.clear();
             m_entityLinkRenderer->invalidate();
             m_groupLinkRenderer->invalidate();
+            invalidateFrustumCullers();
         }
 
         void MapRenderer::overrideSelectionColors(const Color& color, const float mix) {
@@ -192,6 +197,7 @@ namespace TrenchBroom {
 
         void MapRenderer::render(RenderContext& renderContext, RenderBatch& renderBatch) {
             commitPendingChanges();
+            updateFrustumCuller(renderContext);
             setupGL(renderBatch);
             renderDefaultOpaque(renderContext, renderBatch);
             renderLockedOpaque(renderContext, renderBatch);
@@ -205,11 +211,58 @@ namespace TrenchBroom {
             renderGroupLinks(renderContext, renderBatch);
         }
 
+        size_t MapRenderer::drawnBrushCount() const {
+            return m_defaultRenderer->drawnBrushCount() + m_selectionRenderer->drawnBrushCount() + m_lockedRenderer->drawnBrushCount();
+        }
+
+        size_t MapRenderer::culledBrushCount() const {
+            return m_defaultRenderer->culledBrushCount() + m_selectionRenderer->culledBrushCount() + m_lockedRenderer->culledBrushCount();
+        }
+
+        size_t MapRenderer::entityModelDrawCallCount() const {
+            return m_defaultRenderer->entityModelDrawCallCount() + m_selectionRenderer->entityModelDrawCallCount() + m_lockedRenderer->entityModelDrawCallCount();
+        }
+
+        bool MapRenderer::isInDefaultRenderer(const Model::Node* node) const {
+            return (currentRenderers(node) & Renderer_Default) != 0;
+        }
+
+        bool MapRenderer::isInSelectionRenderer(const Model::Node* node) const {
+            return (currentRenderers(node) & Renderer_Selection) != 0;
+        }
+
+        bool MapRenderer::isInLockedRenderer(const Model::Node* node) const {
+            return (currentRenderers(node) & Renderer_Locked) != 0;
+        }
+
         void MapRenderer::commitPendingChanges() {
             auto document = kdl::mem_lock(m_document);
             document->commitPendingAssets();
         }
 
+        void MapRenderer::updateFrustumCuller(const RenderContext& renderContext) {
+            const auto* camera = &renderContext.camera();
+            auto& frustumCuller = m_frustumCullers[camera];
+            if (frustumCuller == nullptr) {
+                frustumCuller = std::make_unique<FrustumCuller>();
+            }
+
+            auto document = kdl::mem_lock(m_document);
+            if (const auto* world = document->world()) {
+                frustumCuller->update(*world, *camera);
+            }
+
+            m_defaultRenderer->setFrustumCuller(frustumCuller.get());
+            m_selectionRenderer->setFrustumCuller(frustumCuller.get());
+            m_lockedRenderer->setFrustumCuller(frustumCuller.get());
+        }
+
+        void MapRenderer::invalidateFrustumCullers() {
+            for (auto& [camera, frustumCuller] : m_frustumCullers) {
+                frustumCuller->invalidate();
+            }
+        }
+
         class SetupGL : public Renderable {
         private:
             void doRender(RenderContext&) override {
@@ -327,90 +380,135 @@ namespace TrenchBroom {
             renderer.setBrushEdgeColor(pref(Preferences::LockedEdgeColor));
         }
 
-        void MapRenderer::updateRenderers(const Renderer renderers) {
-            const auto renderDefault   = (renderers & Renderer_Default) != 0;
-            const auto renderSelection = (renderers & Renderer_Selection) != 0;
-            const auto renderLocked    = (renderers & Renderer_Locked) != 0;
-
-            struct RenderableNodes {
-                std::vector<Model::GroupNode*> groups;
-                std::vector<Model::EntityNode*> entities;
-                std::vector<Model::BrushNode*> brushes;
-                std::vector<Model::PatchNode*> patches;
+        MapRenderer::Renderer MapRenderer::renderersForNode(const Model::Node* node) {
+            const auto selected = [](const auto* n) {
+                return n->selected() || n->descendantSelected() || n->parentSelected();
             };
 
-            RenderableNodes defaultNodes;
-            RenderableNodes selectedNodes;
-            RenderableNodes lockedNodes;
-
-            const auto selected = [](const auto* node) {
-                return node->selected() || node->descendantSelected() || node->parentSelected();
-            };
-
-            auto document = kdl::mem_lock(m_document);
-            document->world()->accept(kdl::overload(
-                [](auto&& thisLambda, Model::WorldNode* world) { world->visitChildren(thisLambda); },
-                [](auto&& thisLambda, Model::LayerNode* layer) { layer->visitChildren(thisLambda); },
-                [&](auto&& thisLambda, Model::GroupNode* group) {
+            return node->accept(kdl::overload(
+                [](const Model::WorldNode*) { return Renderer_None; },
+                [](const Model::LayerNode*) { return Renderer_None; },
+                [&](const Model::GroupNode* group) {
                     if (group->locked()) {
-                        if (renderLocked) lockedNodes.groups.push_back(group);
+                        return Renderer_Locked;
                     } else if (selected(group) || group->opened()) {
-                        if (renderSelection) selectedNodes.groups.push_back(group);
+                        return Renderer_Selection;
                     } else {
-                        if (renderDefault) defaultNodes.groups.push_back(group);
+                        return Renderer_Default;
                     }
-                    group->visitChildren(thisLambda);
                 },
-                [&](auto&& thisLambda, Model::EntityNode* entity) {
+                [&](const Model::EntityNode* entity) {
                     if (entity->locked()) {
-                        if (renderLocked) lockedNodes.entities.push_back(entity);
+                        return Renderer_Locked;
                     } else if (selected(entity)) {
-                        if (renderSelection) selectedNodes.entities.push_back(entity);
+                        return Renderer_Selection;
                     } else {
-                        if (renderDefault) defaultNodes.entities.push_back(entity);
+                        return Renderer_Default;
                     }
-                    entity->visitChildren(thisLambda);
                 },
-                [&](Model::BrushNode* brush) {
+                [&](const Model::BrushNode* brush) {
+                    // a brush with selected faces is rendered by both the default and the selection renderer
+                    auto result = int(Renderer_None);
                     if (brush->locked()) {
-                        if (renderLocked) lockedNodes.brushes.push_back(brush);
+                        result |= Renderer_Locked;
                     } else if (selected(brush) || brush->hasSelectedFaces()) {
-                        if (renderSelection) selectedNodes.brushes.push_back(brush);
+                        result |= Renderer_Selection;
                     }
                     if (!brush->selected() && !brush->parentSelected() && !brush->locked()) {
-                        if (renderDefault) defaultNodes.brushes.push_back(brush);
+                        result |= Renderer_Default;
                     }
+                    return static_cast<Renderer>(result);
                 },
-                [&](Model::PatchNode* patchNode) {
+                [&](const Model::PatchNode* patchNode) {
+                    auto result = int(Renderer_None);
                     if (patchNode->locked()) {
-                        if (renderLocked) lockedNodes.patches.push_back(patchNode);
+                        result |= Renderer_Locked;
                     } else if (selected(patchNode)) {
-                        if (renderSelection) selectedNodes.patches.push_back(patchNode);
+                        result |= Renderer_Selection;
                     }
                     if (!patchNode->selected() && !patchNode->parentSelected() && !patchNode->locked()) {
-                        if (renderDefault) defaultNodes.patches.push_back(patchNode);
+                        result |= Renderer_Default;
                     }
+                    return static_cast<Renderer>(result);
                 }
             ));
+        }
 
-            if (renderDefault) {
-                m_defaultRenderer->setObjects(defaultNodes.groups,
-                                              defaultNodes.entities,
-                                              defaultNodes.brushes,
-                                              defaultNodes.patches);
-            }
-            if (renderSelection) {
-                m_selectionRenderer->setObjects(selectedNodes.groups,
-                                                selectedNodes.entities,
-                                                selectedNodes.brushes,
-                                                selectedNodes.patches);
-            }
-            if (renderLocked) {
-                m_lockedRenderer->setObjects(lockedNodes.groups,
-                                             lockedNodes.entities,
-                                             lockedNodes.brushes,
-                                             lockedNodes.patches);
+        MapRenderer::Renderer MapRenderer::currentRenderers(const Model::Node* node) const {
+            const auto it = m_nodeRenderers.find(const_cast<Model::Node*>(node));
+            return it != std::end(m_nodeRenderers) ? it->second : Renderer_None;
+        }
+
+        /**
+         * Returns the given nodes, their descendants and their ancestors without duplicates. Selecting, locking or adding
+         * a node can change the renderers of all of these nodes.
+         */
+        static std::vector<Model::Node*> collectAffectedNodes(const std::vector<Model::Node*>& nodes) {
+            return kdl::vec_sort_and_remove_duplicates(kdl::vec_concat(Model::collectNodes(nodes), Model::collectParents(nodes)));
+        }
+
+        void MapRenderer::updateRenderers(const std::vector<Model::Node*>& nodes) {
+            setRenderers(kdl::vec_transform(nodes, [](auto* node) {
+                return std::make_pair(node, renderersForNode(node));
+            }));
+        }
+
+        void MapRenderer::removeFromRenderers(const std::vector<Model::Node*>& nodes) {
+            setRenderers(kdl::vec_transform(Model::collectNodes(nodes), [](auto* node) {
+                return std::make_pair(node, Renderer_None);
+            }));
+        }
+
+        namespace {
+            struct RendererChanges {
+                std::vector<Model::Node*> addedNodes;
+                std::vector<Model::Node*> removedNodes;
+
+                void record(Model::Node* node, const bool wasAdded, const bool isAdded) {
+                    if (!wasAdded && isAdded) {
+                        addedNodes.push_back(node);
+                    } else if (wasAdded && !isAdded) {
+                        removedNodes.push_back(node);
+                    }
+                }
+
+                void apply(ObjectRenderer& renderer) const {
+                    if (!removedNodes.empty()) {
+                        renderer.removeNodes(removedNodes);
+                    }
+                    if (!addedNodes.empty()) {
+                        renderer.addNodes(addedNodes);
+                    }
+                }
+            };
+        }
+
+        void MapRenderer::setRenderers(const std::vector<std::pair<Model::Node*, Renderer>>& nodeRenderers) {
+            auto defaultChanges = RendererChanges{};
+            auto selectionChanges = RendererChanges{};
+            auto lockedChanges = RendererChanges{};
+
+            for (const auto& [node, newRenderers] : nodeRenderers) {
+                const auto it = m_nodeRenderers.find(node);
+                const auto oldRenderers = it != std::end(m_nodeRenderers) ? it->second : Renderer_None;
+                if (newRenderers == oldRenderers) {
+                    continue;
+                }
+
+                defaultChanges.record(node, (oldRenderers & Renderer_Default) != 0, (newRenderers & Renderer_Default) != 0);
+                selectionChanges.record(node, (oldRenderers & Renderer_Selection) != 0, (newRenderers & Renderer_Selection) != 0);
+                lockedChanges.record(node, (oldRenderers & Renderer_Locked) != 0, (newRenderers & Renderer_Locked) != 0);
+
+                if (newRenderers == Renderer_None) {
+                    m_nodeRenderers.erase(it);
+                } else {
+                    m_nodeRenderers[node] = newRenderers;
+                }
             }
+
+            defaultChanges.apply(*m_defaultRenderer);
+            selectionChanges.apply(*m_selectionRenderer);
+            lockedChanges.apply(*m_lockedRenderer);
             invalidateEntityLinkRenderer();
         }
 
@@ -423,6 +521,12 @@ namespace TrenchBroom {
                 m_lockedRenderer->invalidate();
         }
 
+        void MapRenderer::invalidateBoundsInRenderers() {
+            m_defaultRenderer->invalidateBounds();
+            m_selectionRenderer->invalidateBounds();
+            m_lockedRenderer->invalidateBounds();
+        }
+
         void MapRenderer::invalidateBrushesInRenderers(Renderer renderers, const std::vector<Model::BrushNode*>& brushes) {
             if ((renderers & Renderer_Default) != 0) {
                 m_defaultRenderer->invalidateBrushes(brushes);
@@ -502,42 +606,51 @@ namespace TrenchBroom {
             clear();
         }
 
-        void MapRenderer::documentWasNewedOrLoaded(View::MapDocument*) {
+        void MapRenderer::documentWasNewedOrLoaded(View::MapDocument* document) {
             clear();
-            updateRenderers(Renderer_All);
+            updateRenderers(Model::collectNodes({document->world()}));
         }
 
-        void MapRenderer::nodesWereAdded(const std::vector<Model::Node*>&) {
-            updateRenderers(Renderer_All);
+        void MapRenderer::nodesWereAdded(const std::vector<Model::Node*>& nodes) {
+            updateRenderers(collectAffectedNodes(nodes));
+            // the bounds of the groups and entities that the nodes were added to have changed
+            invalidateBoundsInRenderers();
             invalidateGroupLinkRenderer();
+            invalidateFrustumCullers();
         }
 
-        void MapRenderer::nodesWereRemoved(const std::vector<Model::Node*>&) {
-            updateRenderers(Renderer_All);
+        void MapRenderer::nodesWereRemoved(const std::vector<Model::Node*>& nodes) {
+            removeFromRenderers(nodes);
+            invalidateBoundsInRenderers();
             invalidateGroupLinkRenderer();
+            invalidateFrustumCullers();
         }
 
         void MapRenderer::nodesDidChange(const std::vector<Model::Node*>&) {
             invalidateRenderers(Renderer_Selection);
             invalidateEntityLinkRenderer();
             invalidateGroupLinkRenderer();
+            invalidateFrustumCullers();
         }
 
         void MapRenderer::nodeVisibilityDidChange(const std::vector<Model::Node*>&) {
             invalidateRenderers(Renderer_All);
         }
 
-        void MapRenderer::nodeLockingDidChange(const std::vector<Model::Node*>&) {
-            updateRenderers(Renderer_Default_Locked);
+        void MapRenderer::nodeLockingDidChange(const std::vector<Model::Node*>& nodes) {
+            // the descendants of the given nodes inherit their lock state
+            updateRenderers(collectAffectedNodes(nodes));
         }
 
-        void MapRenderer::groupWasOpened(Model::GroupNode*) {
-            updateRenderers(Renderer_Default_Selection);
+        void MapRenderer::groupWasOpened(Model::GroupNode* group) {
+            // opening a group also changes the edit state of its ancestors
+            updateRenderers(collectAffectedNodes({group}));
             invalidateGroupLinkRenderer();
         }
 
-        void MapRenderer::groupWasClosed(Model::GroupNode*) {
-            updateRenderers(Renderer_Default_Selection);
+        void MapRenderer::groupWasClosed(Model::GroupNode* group) {
+            // closing a group reopens its containing group
+            updateRenderers(collectAffectedNodes({group}));
             invalidateGroupLinkRenderer();
         }
 
@@ -546,7 +659,14 @@ namespace TrenchBroom {
         }
 
         void MapRenderer::selectionDidChange(const View::Selection& selection) {
-            updateRenderers(Renderer_All); // need to update locked objects also because a selected object may have been reparented into a locked layer before deselection
+            // only the (de)selected nodes, their ancestors and their descendants can move between renderers; this also
+            // moves a deselected node to the locked renderer if it was reparented into a locked layer while selected
+            const auto toNode = [](const auto& handle) -> Model::Node* { return handle.node(); };
+            updateRenderers(collectAffectedNodes(kdl::vec_concat(
+                selection.selectedNodes(),
+                selection.deselectedNodes(),
+                kdl::vec_transform(selection.selectedBrushFaces(), toNode),
+                kdl::vec_transform(selection.deselectedBrushFaces(), toNode))));
 
             // selecting faces needs to invalidate the brushes
             if (!selection.selectedBrushFaces().empty()
@@ -23,6 +23,8 @@
 
 #include <map>
 #include <memory>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace TrenchBroom {
@@ -47,7 +49,9 @@ namespace TrenchBroom {
     }
 
     namespace Renderer {
+        class Camera;
         class EntityLinkRenderer;
+        class FrustumCuller;
         class GroupLinkRenderer;
         class ObjectRenderer;
         class RenderBatch;
@@ -68,6 +72,12 @@ namespace TrenchBroom {
             std::unique_ptr<ObjectRenderer> m_lockedRenderer;
             std::unique_ptr<EntityLinkRenderer> m_entityLinkRenderer;
             std::unique_ptr<GroupLinkRenderer> m_groupLinkRenderer;
+
+            /**
+             * The 2D and 3D views can share this renderer, so every camera gets its own culler. Otherwise the views
+             * would recompute the visible nodes for each other's cameras in every frame.
+             */
+            std::unordered_map<const Camera*, std::unique_ptr<FrustumCuller>> m_frustumCullers;
         public:
             explicit MapRenderer(std::weak_ptr<View::MapDocument> document);
             ~MapRenderer();
@@ -83,8 +93,33 @@ namespace TrenchBroom {
             void restoreSelectionColors();
         public: // rendering
             void render(RenderContext& renderContext, RenderBatch& renderBatch);
+        public: // statistics
+            /**
+             * Returns the number of brushes that were submitted for rendering in the last frame.
+             */
+            size_t drawnBrushCount() const;
+
+            /**
+             * Returns the number of brushes that were skipped in the last frame because they were outside of the view
+             * frustum.
+             */
+            size_t culledBrushCount() const;
+
+            /**
+             * Returns the number of draw calls issued for entity models in the last frame.
+             */
+            size_t entityModelDrawCallCount() const;
+        public: // renderer membership
+            /**
+             * Returns whether the given node is currently added to the default, selection or locked renderer.
+             */
+            bool isInDefaultRenderer(const Model::Node* node) const;
+            bool isInSelectionRenderer(const Model::Node* node) const;
+            bool isInLockedRenderer(const Model::Node* node) const;
         private:
             void commitPendingChanges();
+            void updateFrustumCuller(const RenderContext& renderContext);
+            void invalidateFrustumCullers();
             void setupGL(RenderBatch& renderBatch);
             void renderDefaultOpaque(RenderContext& renderContext, RenderBatch& renderBatch);
             void renderDefaultTransparent(RenderContext& renderContext, RenderBatch& renderBatch);
@@ -101,6 +136,7 @@ namespace TrenchBroom {
             void setupLockedRenderer(ObjectRenderer& renderer);
 
             typedef enum {
+                Renderer_None               = 0,
                 Renderer_Default            = 1,
                 Renderer_Selection          = 2,
                 Renderer_Locked             = 4,
@@ -110,13 +146,41 @@ namespace TrenchBroom {
             } Renderer;
 
             /**
-             * This moves nodes between default / selection / locked renderers as needed,
+             * The renderers that each group, entity, brush and patch node is currently added to. Nodes that are not
+             * added to any renderer are not contained.
+             */
+            std::unordered_map<Model::Node*, Renderer> m_nodeRenderers;
+
+            /**
+             * Returns the renderers that the given node should be added to according to its current selection and
+             * locking state.
+             */
+            static Renderer renderersForNode(const Model::Node* node);
+
+            /**
+             * Returns the renderers that the given node is currently added to.
+             */
+            Renderer currentRenderers(const Model::Node* node) const;
+
+            /**
+             * This moves the given nodes between default / selection / locked renderers as needed,
              * but doesn't otherwise invalidate them.
              * (in particular, brushes are not updated unless they move between renderers.)
              * If brushes are modified, you need to call invalidateRenderers() or invalidateObjectsInRenderers()
+             *
+             * Only the given nodes are considered, so the caller must pass every node whose renderers might have
+             * changed, e.g. the ancestors and descendants of newly selected nodes.
+             */
+            void updateRenderers(const std::vector<Model::Node*>& nodes);
+
+            /**
+             * Removes the given nodes and their descendants from all renderers.
              */
-            void updateRenderers(Renderer renderers);
+            void removeFromRenderers(const std::vector<Model::Node*>& nodes);
+
+            void setRenderers(const std::vector<std::pair<Model::Node*, Renderer>>& nodeRenderers);
             void invalidateRenderers(Renderer renderers);
+            void invalidateBoundsInRenderers();
             void invalidateBrushesInRenderers(Renderer renderers, const std::vector<Model::BrushNode*>& brushes);
             void invalidateEntityLinkRenderer();
             void invalidateGroupLinkRenderer();
@@ -19,15 +19,72 @@
 
 #include "ObjectRenderer.h"
 
+#include "Model/BrushNode.h"
+#include "Model/EntityNode.h"
 #include "Model/GroupNode.h"
+#include "Model/LayerNode.h"
+#include "Model/Node.h"
+#include "Model/PatchNode.h"
+#include "Model/WorldNode.h"
+
+#include <kdl/overload.h>
 
 namespace TrenchBroom {
     namespace Renderer {
-        void ObjectRenderer::setObjects(const std::vector<Model::GroupNode*>& groups, const std::vector<Model::EntityNode*>& entities, const std::vector<Model::BrushNode*>& brushes, const std::vector<Model::PatchNode*>& patches) {
-            m_groupRenderer.setGroups(groups);
-            m_entityRenderer.setEntities(entities);
-            m_brushRenderer.setBrushes(brushes);
-            m_patchRenderer.setPatches(patches);
+        namespace {
+            struct ObjectNodes {
+                std::vector<Model::GroupNode*> groups;
+                std::vector<Model::EntityNode*> entities;
+                std::vector<Model::BrushNode*> brushes;
+                std::vector<Model::PatchNode*> patches;
+            };
+        }
+
+        static ObjectNodes sortObjectNodes(const std::vector<Model::Node*>& nodes) {
+            auto result = ObjectNodes{};
+            for (auto* node : nodes) {
+                node->accept(kdl::overload(
+                    [](Model::WorldNode*)            {},
+                    [](Model::LayerNode*)            {},
+                    [&](Model::GroupNode* group)     { result.groups.push_back(group); },
+                    [&](Model::EntityNode* entity)   { result.entities.push_back(entity); },
+                    [&](Model::BrushNode* brush)     { result.brushes.push_back(brush); },
+                    [&](Model::PatchNode* patchNode) { result.patches.push_back(patchNode); }
+                ));
+            }
+            return result;
+        }
+
+        void ObjectRenderer::addNodes(const std::vector<Model::Node*>& nodes) {
+            const auto objectNodes = sortObjectNodes(nodes);
+            if (!objectNodes.groups.empty()) {
+                m_groupRenderer.addGroups(objectNodes.groups);
+            }
+            if (!objectNodes.entities.empty()) {
+                m_entityRenderer.addEntities(objectNodes.entities);
+            }
+            if (!objectNodes.brushes.empty()) {
+                m_brushRenderer.addBrushes(objectNodes.brushes);
+            }
+            if (!objectNodes.patches.empty()) {
+                m_patchRenderer.addPatches(objectNodes.patches);
+            }
+        }
+
+        void ObjectRenderer::removeNodes(const std::vector<Model::Node*>& nodes) {
+            const auto objectNodes = sortObjectNodes(nodes);
+            if (!objectNodes.groups.empty()) {
+                m_groupRenderer.removeGroups(objectNodes.groups);
+            }
+            if (!objectNodes.entities.empty()) {
+                m_entityRenderer.removeEntities(objectNodes.entities);
+            }
+            if (!objectNodes.brushes.empty()) {
+                m_brushRenderer.removeBrushes(objectNodes.brushes);
+            }
+            if (!objectNodes.patches.empty()) {
+                m_patchRenderer.removePatches(objectNodes.patches);
+            }
         }
 
         void ObjectRenderer::invalidate() {
@@ -37,6 +94,11 @@ namespace TrenchBroom {
             m_patchRenderer.invalidate();
         }
 
+        void ObjectRenderer::invalidateBounds() {
+            m_groupRenderer.invalidate();
+            m_entityRenderer.invalidateBounds();
+        }
+
         void ObjectRenderer::invalidateBrushes(const std::vector<Model::BrushNode*>& brushes) {
             m_brushRenderer.invalidateBrushes(brushes);
         }
@@ -147,6 +209,23 @@ namespace TrenchBroom {
             m_brushRenderer.setShowHiddenBrushes(showHiddenObjects);
         }
 
+        void ObjectRenderer::setFrustumCuller(const FrustumCuller* frustumCuller) {
+            m_entityRenderer.setFrustumCuller(frustumCuller);
+            m_brushRenderer.setFrustumCuller(frustumCuller);
+        }
+
+        size_t ObjectRenderer::drawnBrushCount() const {
+            return m_brushRenderer.drawnBrushCount();
+        }
+
+        size_t ObjectRenderer::culledBrushCount() const {
+            return m_brushRenderer.culledBrushCount();
+        }
+
+        size_t ObjectRenderer::entityModelDrawCallCount() const {
+            return m_entityRenderer.modelDrawCallCount();
+        }
+
         void ObjectRenderer::renderOpaque(RenderContext& renderContext, RenderBatch& renderBatch) {
             m_brushRenderer.renderOpaque(renderContext, renderBatch);
             m_patchRenderer.render(renderContext, renderBatch);
@@ -39,11 +39,13 @@ namespace TrenchBroom {
         class EditorContext;
         class EntityNode;
         class GroupNode;
+        class Node;
         class PatchNode;
     }
 
     namespace Renderer {
         class FontManager;
+        class FrustumCuller;
         class RenderBatch;
 
         class ObjectRenderer {
@@ -60,8 +62,21 @@ namespace TrenchBroom {
             m_brushRenderer(brushFilter),
             m_patchRenderer{} {}
         public: // object management
-            void setObjects(const std::vector<Model::GroupNode*>& groups, const std::vector<Model::EntityNode*>& entities, const std::vector<Model::BrushNode*>& brushes, const std::vector<Model::PatchNode*>& patches);
+            /**
+             * Adds the given nodes to this renderer. The nodes must not have been added already. World and layer nodes
+             * are ignored.
+             */
+            void addNodes(const std::vector<Model::Node*>& nodes);
+            /**
+             * Removes the given nodes from this renderer. The nodes must have been added before. World and layer nodes
+             * are ignored.
+             */
+            void removeNodes(const std::vector<Model::Node*>& nodes);
             void invalidate();
+            /**
+             * Invalidates the bounds of the groups and entities, e.g. because nodes were added to or removed from them.
+             */
+            void invalidateBounds();
             void invalidateBrushes(const std::vector<Model::BrushNode*>& brushes);
             void clear();
             void reloadModels();
@@ -93,6 +108,12 @@ namespace TrenchBroom {
             void setBrushEdgeColor(const Color& brushEdgeColor);
 
             void setShowHiddenObjects(bool showHiddenObjects);
+
+            void setFrustumCuller(const FrustumCuller* frustumCuller);
+        public: // statistics
+            size_t drawnBrushCount() const;
+            size_t culledBrushCount() const;
+            size_t entityModelDrawCallCount() const;
         public: // rendering
             void renderOpaque(RenderContext& renderContext, RenderBatch& renderBatch);
             void renderTransparent(RenderContext& renderContext, RenderBatch& renderBatch);
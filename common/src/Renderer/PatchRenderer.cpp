@@ -20,6 +20,7 @@
 #include "PatchRenderer.h"
 
 #include "Assets/Texture.h"
+#include "FloatType.h"
 #include "PreferenceManager.h"
 #include "Preferences.h"
 #include "Model/PatchNode.h"
@@ -40,8 +41,14 @@
 #include <kdl/vector_utils.h>
 
 #include <vecmath/forward.h>
+#include <vecmath/scalar.h>
 #include <vecmath/vec.h>
 
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <unordered_set>
+
 namespace TrenchBroom {
     namespace Renderer {
         PatchRenderer::PatchRenderer() :
@@ -90,6 +97,17 @@ namespace TrenchBroom {
             invalidate();
         }
 
+        void PatchRenderer::addPatches(const std::vector<Model::PatchNode*>& patchNodes) {
+            m_patchNodes.insert(std::end(m_patchNodes), std::begin(patchNodes), std::end(patchNodes));
+            invalidate();
+        }
+
+        void PatchRenderer::removePatches(const std::vector<Model::PatchNode*>& patchNodes) {
+            const auto toRemove = std::unordered_set<Model::PatchNode*>(std::begin(patchNodes), std::end(patchNodes));
+            m_patchNodes = kdl::vec_erase_if(std::move(m_patchNodes), [&](auto* patchNode) { return toRemove.count(patchNode) > 0u; });
+            invalidate();
+        }
+
         void PatchRenderer::invalidate() {
             m_valid = false;
         }
@@ -104,6 +122,12 @@ namespace TrenchBroom {
                 validate();
             }
 
+            // Only perspective views use levels of detail, orthographic views show the patches at full detail.
+            m_useLevelsOfDetail = renderContext.camera().perspectiveProjection();
+            if (m_useLevelsOfDetail) {
+                validateLevelsOfDetail(renderContext.camera());
+            }
+
             if (renderContext.showFaces()) {
                 renderBatch.add(this);
             }
@@ -116,49 +140,106 @@ namespace TrenchBroom {
             }
         }
 
-        static TexturedIndexArrayRenderer buildMeshRenderer(const std::vector<Model::PatchNode*>& patchNodes) {
-                size_t vertexCount = 0u;
+        /**
+         * Patches closer to the camera than this are rendered with all of their subdivisions. Beyond this distance,
+         * every doubling of the distance to the camera halves the number of quads per surface side.
+         */
+        constexpr static auto LevelOfDetailDistance = static_cast<FloatType>(1024);
+
+        /**
+         * Returns the grid used to render the given patch node.
+         */
+        static const Model::PatchGrid& renderGrid(const Model::PatchNode& patchNode) {
+            return patchNode.grid(patchNode.subdivisionsPerSurface());
+        }
+
+        /**
+         * Returns how many times the number of quads per surface side of the given patch's render grid should be
+         * halved when the patch is seen by the given camera.
+         */
+        static size_t levelOfDetail(const Model::PatchNode& patchNode, const Camera& camera) {
+            const auto& bounds = patchNode.physicalBounds();
+            const auto position = vm::vec3{camera.position()};
+
+            auto closestPoint = position;
+            for (size_t i = 0u; i < 3u; ++i) {
+                closestPoint[i] = vm::clamp(position[i], bounds.min[i], bounds.max[i]);
+            }
+
+            const auto distance = vm::distance(position, closestPoint);
+            if (distance <= LevelOfDetailDistance) {
+                return 0u;
+            }
+
+            const auto level = static_cast<size_t>(std::log2(distance / LevelOfDetailDistance));
+            return std::min(level, patchNode.subdivisionsPerSurface());
+        }
+
+        using MeshVertex = GLVertexTypes::P3NT2::Vertex;
+
+        static VertexArray buildMeshVertices(const std::vector<Model::PatchNode*>& patchNodes) {
+            size_t vertexCount = 0u;
+            for (const auto* patchNode : patchNodes) {
+                const auto& grid = renderGrid(*patchNode);
+                vertexCount += grid.pointRowCount * grid.pointColumnCount;
+            }
+
+            auto vertices = std::vector<MeshVertex>{};
+            vertices.reserve(vertexCount);
+
+            for (const auto* patchNode : patchNodes) {
+                for (const auto& p : renderGrid(*patchNode).points) {
+                    vertices.emplace_back(vm::vec3f{p.position}, vm::vec3f{p.normal}, vm::vec2f{p.texCoords});
+                }
+            }
+
+            return VertexArray::move(std::move(vertices));
+        }
+
+        /**
+         * Builds the triangles of the given patch nodes. The vertices of each patch's render grid are expected to be
+         * stored consecutively in the given vertex array. For each patch, the given level of detail determines the
+         * stride with which the grid points are connected.
+         */
+        static TexturedIndexArrayRenderer buildMeshRenderer(const std::vector<Model::PatchNode*>& patchNodes, VertexArray vertexArray, const std::vector<size_t>& levelsOfDetail) {
+                assert(patchNodes.size() == levelsOfDetail.size());
+
                 auto indexArrayMapSize = TexturedIndexArrayMap::Size{};
-                
-                for (const auto* patchNode : patchNodes) {
-                    vertexCount += patchNode->grid().pointRowCount * patchNode->grid().pointColumnCount;
+                for (size_t i = 0u; i < patchNodes.size(); ++i) {
+                    const auto& grid = renderGrid(*patchNodes[i]);
+                    const auto stride = size_t(1) << levelsOfDetail[i];
 
-                    const auto* texture = patchNode->patch().texture();
-                    const auto quadCount = patchNode->grid().quadRowCount() * patchNode->grid().quadColumnCount();
+                    const auto* texture = patchNodes[i]->patch().texture();
+                    const auto quadCount = (grid.quadRowCount() / stride) * (grid.quadColumnCount() / stride);
                     indexArrayMapSize.inc(texture, PrimType::Triangles, 6u * quadCount);
                 }
 
-                using Vertex = GLVertexTypes::P3NT2::Vertex;
-                auto vertices = std::vector<Vertex>{};
-                vertices.reserve(vertexCount);
-
                 auto indexArrayMapBuilder = TexturedIndexArrayMapBuilder{indexArrayMapSize};
                 using Index = TexturedIndexArrayMapBuilder::Index;
 
-                for (const auto* patchNode : patchNodes) {
-                    const auto vertexOffset = vertices.size();
-
-                    const auto& grid = patchNode->grid();
-                    auto gridVertices = kdl::vec_transform(grid.points, [](const auto& p) { return Vertex{vm::vec3f{p.position}, vm::vec3f{p.normal}, vm::vec2f{p.texCoords}}; });
-                    vertices = kdl::vec_concat(std::move(vertices), std::move(gridVertices));
+                size_t vertexOffset = 0u;
+                for (size_t i = 0u; i < patchNodes.size(); ++i) {
+                    const auto& grid = renderGrid(*patchNodes[i]);
+                    const auto stride = size_t(1) << levelsOfDetail[i];
 
-                    const auto* texture = patchNode->patch().texture();
+                    const auto* texture = patchNodes[i]->patch().texture();
 
                     const auto pointsPerRow = grid.pointColumnCount;
-                    for (size_t row = 0u; row < grid.quadRowCount(); ++row) {
-                        for (size_t col = 0u; col < grid.quadColumnCount(); ++col) {
+                    for (size_t row = 0u; row < grid.quadRowCount(); row += stride) {
+                        for (size_t col = 0u; col < grid.quadColumnCount(); col += stride) {
                             const auto i0 = vertexOffset + row * pointsPerRow + col;
-                            const auto i1 = vertexOffset + row * pointsPerRow + col + 1u;
-                            const auto i2 = vertexOffset + (row + 1u) * pointsPerRow + col + 1u;
-                            const auto i3 = vertexOffset + (row + 1u) * pointsPerRow + col;
+                            const auto i1 = vertexOffset + row * pointsPerRow + col + stride;
+                            const auto i2 = vertexOffset + (row + stride) * pointsPerRow + col + stride;
+                            const auto i3 = vertexOffset + (row + stride) * pointsPerRow + col;
 
                             indexArrayMapBuilder.addTriangle(texture, static_cast<Index>(i0), static_cast<Index>(i1), static_cast<Index>(i2));
                             indexArrayMapBuilder.addTriangle(texture, static_cast<Index>(i2), static_cast<Index>(i3), static_cast<Index>(i0));
                         }
                     }
+
+                    vertexOffset += grid.pointRowCount * grid.pointColumnCount;
                 }
 
-                auto vertexArray = VertexArray::move(std::move(vertices));
                 auto indexArray = IndexArray::move(std::move(indexArrayMapBuilder.indices()));
                 return TexturedIndexArrayRenderer{std::move(vertexArray), std::move(indexArray), std::move(indexArrayMapBuilder.ranges())};
         }
@@ -168,14 +249,15 @@ namespace TrenchBroom {
                 auto indexRangeMapSize = IndexRangeMap::Size{};
 
                 for (const auto* patchNode : patchNodes) {
-                    vertexCount += (patchNode->grid().pointRowCount + patchNode->grid().pointColumnCount - 2u) * 2u;
+                    const auto& grid = renderGrid(*patchNode);
+                    vertexCount += (grid.pointRowCount + grid.pointColumnCount - 2u) * 2u;
                     indexRangeMapSize.inc(PrimType::LineLoop, vertexCount);
                 }
 
                 auto indexRangeMapBuilder = IndexRangeMapBuilder<GLVertexTypes::P3>{vertexCount, indexRangeMapSize};
 
                 for (const auto* patchNode : patchNodes) {
-                    const auto& grid = patchNode->grid();
+                    const auto& grid = renderGrid(*patchNode);
 
                     auto edgeLoopVertices = std::vector<GLVertexTypes::P3::Vertex>{};
                     edgeLoopVertices.reserve((grid.pointRowCount + grid.pointColumnCount - 2u) * 2u);
@@ -221,15 +303,31 @@ namespace TrenchBroom {
 
         void PatchRenderer::validate() {
             if (!m_valid) {
-                m_patchMeshRenderer = buildMeshRenderer(m_patchNodes);
+                m_meshVertices = buildMeshVertices(m_patchNodes);
+                m_patchMeshRenderer = buildMeshRenderer(m_patchNodes, m_meshVertices, std::vector<size_t>(m_patchNodes.size(), 0u));
                 m_edgeRenderer = buildEdgeRenderer(m_patchNodes);
 
+                m_levelsOfDetail.clear();
+                m_lodMeshRenderer = TexturedIndexArrayRenderer{};
+
                 m_valid = true;
             }
         }
 
+        void PatchRenderer::validateLevelsOfDetail(const Camera& camera) {
+            auto levelsOfDetail = kdl::vec_transform(m_patchNodes, [&](const auto* patchNode) { return levelOfDetail(*patchNode, camera); });
+            if (levelsOfDetail != m_levelsOfDetail) {
+                m_lodMeshRenderer = buildMeshRenderer(m_patchNodes, m_meshVertices, levelsOfDetail);
+                m_levelsOfDetail = std::move(levelsOfDetail);
+            }
+        }
+
+        TexturedIndexArrayRenderer& PatchRenderer::meshRenderer() {
+            return m_useLevelsOfDetail ? m_lodMeshRenderer : m_patchMeshRenderer;
+        }
+
         void PatchRenderer::prepareVerticesAndIndices(VboManager& vboManager) {
-            m_patchMeshRenderer.prepare(vboManager);
+            meshRenderer().prepare(vboManager);
         }
 
         namespace {
@@ -245,18 +343,18 @@ namespace TrenchBroom {
 
                 void before(const Assets::Texture* texture) override {
                     shader.set("GridColor", gridColorForTexture(texture));
-                    if (texture != nullptr) {
+                    if (texture != nullptr && texture->isPrepared()) {
                         texture->activate();
                         shader.set("ApplyTexture", applyTexture);
                         shader.set("Color", texture->averageColor());
                     } else {
                         shader.set("ApplyTexture", false);
-                        shader.set("Color", defaultColor);
+                        shader.set("Color", texture != nullptr ? texture->averageColor() : defaultColor);
                     }
                 }
 
                 void after(const Assets::Texture* texture) override {
-                    if (texture != nullptr) {
+                    if (texture != nullptr && texture->isPrepared()) {
                         texture->deactivate();
                     }
                 }
@@ -305,7 +403,7 @@ namespace TrenchBroom {
             }
             */
 
-            m_patchMeshRenderer.render(func);
+            meshRenderer().render(func);
 
             /*
             if (m_alpha < 1.0f) {
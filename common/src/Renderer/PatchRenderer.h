@@ -23,6 +23,7 @@
 #include "Renderer/EdgeRenderer.h"
 #include "Renderer/Renderable.h"
 #include "Renderer/TexturedIndexArrayRenderer.h"
+#include "Renderer/VertexArray.h"
 
 #include <vector>
 
@@ -32,6 +33,7 @@ namespace TrenchBroom {
     }
 
     namespace Renderer {
+        class Camera;
         class RenderBatch;
         class RenderContext;
         class VboManager;
@@ -41,7 +43,24 @@ namespace TrenchBroom {
             bool m_valid = true;
             std::vector<Model::PatchNode*> m_patchNodes;
 
+            /**
+             * The vertices of the patches' render grids, shared by both mesh renderers.
+             */
+            VertexArray m_meshVertices;
+
+            /**
+             * Renders every patch with all quads of its render grid.
+             */
             TexturedIndexArrayRenderer m_patchMeshRenderer;
+
+            /**
+             * Renders every patch with fewer quads the farther it is from the camera. Only the indices are rebuilt when
+             * the levels of detail change.
+             */
+            TexturedIndexArrayRenderer m_lodMeshRenderer;
+            std::vector<size_t> m_levelsOfDetail;
+            bool m_useLevelsOfDetail = false;
+
             DirectEdgeRenderer m_edgeRenderer;
 
             Color m_defaultColor;
@@ -84,12 +103,16 @@ namespace TrenchBroom {
             void setOccludedEdgeColor(const Color& occludedEdgeColor);
 
             void setPatches(std::vector<Model::PatchNode*> patchNodes);
+            void addPatches(const std::vector<Model::PatchNode*>& patchNodes);
+            void removePatches(const std::vector<Model::PatchNode*>& patchNodes);
             void invalidate();
             void clear();
 
             void render(RenderContext& renderContext, RenderBatch& renderBatch);
         private:
             void validate();
+            void validateLevelsOfDetail(const Camera& camera);
+            TexturedIndexArrayRenderer& meshRenderer();
         private: // implement IndexedRenderable interface
             void prepareVerticesAndIndices(VboManager& vboManager) override;
             void doRender(RenderContext& renderContext) override;
@@ -20,6 +20,7 @@
 #include "RenderUtils.h"
 
 #include "Assets/Texture.h"
+#include "Renderer/ActiveShader.h"
 #include "Renderer/GL.h"
 
 #include <vecmath/forward.h>
@@ -90,6 +91,27 @@ namespace TrenchBroom {
             }
         }
 
+        ApplyTextureRenderFunc::ApplyTextureRenderFunc(ActiveShader& shader, const Color& defaultColor) :
+        m_shader(shader),
+        m_defaultColor(defaultColor) {}
+
+        void ApplyTextureRenderFunc::before(const Assets::Texture* texture) {
+            if (texture != nullptr && texture->isPrepared()) {
+                texture->activate();
+                m_shader.set("ApplyTexture", true);
+                m_shader.set("Color", texture->averageColor());
+            } else {
+                m_shader.set("ApplyTexture", false);
+                m_shader.set("Color", texture != nullptr ? texture->averageColor() : m_defaultColor);
+            }
+        }
+
+        void ApplyTextureRenderFunc::after(const Assets::Texture* texture) {
+            if (texture != nullptr && texture->isPrepared()) {
+                texture->deactivate();
+            }
+        }
+
         std::vector<vm::vec2f> circle2D(const float radius, const size_t segments) {
             std::vector<vm::vec2f> vertices = circle2D(radius, 0.0f, vm::Cf::two_pi(), segments);
             vertices.push_back(vm::vec2f::zero());
@@ -19,6 +19,8 @@
 
 #pragma once
 
+#include "Color.h"
+
 #include <vecmath/forward.h>
 #include <vecmath/util.h>
 
@@ -31,6 +33,8 @@ namespace TrenchBroom {
     }
 
     namespace Renderer {
+        class ActiveShader;
+
         vm::vec3f gridColorForTexture(const Assets::Texture* texture);
 
         void glSetEdgeOffset(double f);
@@ -53,6 +57,21 @@ namespace TrenchBroom {
             void after(const Assets::Texture* texture) override;
         };
 
+        /**
+         * Activates each texture that is prepared and sets the "ApplyTexture" and "Color" uniforms of the given shader
+         * accordingly. For textures that are not prepared yet, the shader is told to use their average color instead.
+         */
+        class ApplyTextureRenderFunc : public TextureRenderFunc {
+        private:
+            ActiveShader& m_shader;
+            Color m_defaultColor;
+        public:
+            ApplyTextureRenderFunc(ActiveShader& shader, const Color& defaultColor);
+
+            void before(const Assets::Texture* texture) override;
+            void after(const Assets::Texture* texture) override;
+        };
+
         std::vector<vm::vec2f> circle2D(float radius, size_t segments);
         std::vector<vm::vec2f> circle2D(float radius, float startAngle, float angleLength, size_t segments);
         std::vector<vm::vec3f> circle2D(float radius, vm::axis::type axis, float startAngle, float angleLength, size_t segments);
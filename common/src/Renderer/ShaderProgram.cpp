@@ -134,6 +134,14 @@ namespace TrenchBroom {
             glAssert(glUniformMatrix4fv(findUniformLocation(name), 1, false, reinterpret_cast<const float*>(value.v)));
         }
 
+        void ShaderProgram::setAttribute(const std::string& name, const vm::mat4x4f& value) {
+            assert(checkActive());
+            const auto location = static_cast<GLuint>(findAttributeLocation(name));
+            for (size_t i = 0; i < 4; ++i) {
+                glAssert(glVertexAttrib4fv(location + static_cast<GLuint>(i), reinterpret_cast<const float*>(&value.v[i])));
+            }
+        }
+
         void ShaderProgram::link() {
             glAssert(glLinkProgram(m_programId));
 
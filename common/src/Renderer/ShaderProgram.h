@@ -63,6 +63,12 @@ namespace TrenchBroom {
             void set(const std::string& name, const vm::mat3x3f& value);
             void set(const std::string& name, const vm::mat4x4f& value);
 
+            /**
+             * Sets the constant value of a matrix attribute, which is used for every vertex unless the attribute is
+             * sourced from a vertex array. The matrix occupies one attribute location per column.
+             */
+            void setAttribute(const std::string& name, const vm::mat4x4f& value);
+
             GLint findAttributeLocation(const std::string& name) const;
         private:
             void link();
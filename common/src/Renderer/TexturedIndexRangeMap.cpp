@@ -115,6 +115,14 @@ namespace TrenchBroom {
             }
         }
 
+        void TexturedIndexRangeMap::renderInstanced(VertexArray& vertexArray, TextureRenderFunc& func, const size_t instanceCount) {
+            for (const auto& [texture, indexArray] : *m_data) {
+                func.before(texture);
+                indexArray.renderInstanced(vertexArray, instanceCount);
+                func.after(texture);
+            }
+        }
+
         void TexturedIndexRangeMap::forEachPrimitive(std::function<void(const Texture*, PrimType, size_t, size_t)> func) const {
             for (const auto& entry : *m_data) {
                 const auto* texture = entry.first;
@@ -168,6 +168,18 @@ namespace TrenchBroom {
              */
             void render(VertexArray& vertexArray, TextureRenderFunc& func);
 
+            /**
+             * Renders the primitives stored in this index range map using the vertices in the given vertex array
+             * several times using instanced draw calls. The primitives are batched by their associated textures, and
+             * the given render function is called before and after all instances of the primitives with a given
+             * texture are rendered.
+             *
+             * @param vertexArray the vertex array to render with
+             * @param func the texture callbacks
+             * @param instanceCount the number of instances to render
+             */
+            void renderInstanced(VertexArray& vertexArray, TextureRenderFunc& func, size_t instanceCount);
+
             /**
              * Invokes the given function for each primitive stored in this map.
              *
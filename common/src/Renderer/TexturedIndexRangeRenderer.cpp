@@ -57,6 +57,13 @@ namespace TrenchBroom {
             }
         }
 
+        void TexturedIndexRangeRenderer::renderInstanced(TextureRenderFunc& func, const size_t instanceCount) {
+            if (m_vertexArray.setup()) {
+                m_indexRange.renderInstanced(m_vertexArray, func, instanceCount);
+                m_vertexArray.cleanup();
+            }
+        }
+
         MultiTexturedIndexRangeRenderer::MultiTexturedIndexRangeRenderer(std::vector<std::unique_ptr<TexturedIndexRangeRenderer>> renderers) :
         m_renderers(std::move(renderers)) {}
 
@@ -88,5 +95,11 @@ namespace TrenchBroom {
                 renderer->render(func);
             }
         }
+
+        void MultiTexturedIndexRangeRenderer::renderInstanced(TextureRenderFunc& func, const size_t instanceCount) {
+            for (auto& renderer : m_renderers) {
+                renderer->renderInstanced(func, instanceCount);
+            }
+        }
     }
 }
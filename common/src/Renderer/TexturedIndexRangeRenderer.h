@@ -43,6 +43,12 @@ namespace TrenchBroom {
             virtual void prepare(VboManager& vboManager) = 0;
             virtual void render() = 0;
             virtual void render(TextureRenderFunc& func) = 0;
+
+            /**
+             * Renders the given number of instances of this renderer's primitives. The caller must set up any per
+             * instance vertex attributes beforehand.
+             */
+            virtual void renderInstanced(TextureRenderFunc& func, size_t instanceCount) = 0;
         };
 
         class TexturedIndexRangeRenderer : public TexturedRenderer {
@@ -60,6 +66,7 @@ namespace TrenchBroom {
             void prepare(VboManager& vboManager) override;
             void render() override;
             void render(TextureRenderFunc& func) override;
+            void renderInstanced(TextureRenderFunc& func, size_t instanceCount) override;
         };
 
         class MultiTexturedIndexRangeRenderer : public TexturedRenderer {
@@ -74,6 +81,7 @@ namespace TrenchBroom {
             void prepare(VboManager& vboManager) override;
             void render() override;
             void render(TextureRenderFunc& func) override;
+            void renderInstanced(TextureRenderFunc& func, size_t instanceCount) override;
         };
     }
 }
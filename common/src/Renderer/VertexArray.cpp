@@ -25,6 +25,8 @@
 
 namespace TrenchBroom {
     namespace Renderer {
+        static size_t s_drawCallCount = 0;
+
         VertexArray::BaseHolder::~BaseHolder() = default;
 
         VertexArray::VertexArray() :
@@ -83,10 +85,12 @@ namespace TrenchBroom {
             if (!m_setup) {
                 if (setup()) {
                     glAssert(glDrawArrays(toGL(primType), index, count));
+                    ++s_drawCallCount;
                     cleanup();
                 }
             } else {
                 glAssert(glDrawArrays(toGL(primType), index, count));
+                ++s_drawCallCount;
             }
         }
 
@@ -97,12 +101,14 @@ namespace TrenchBroom {
                     const auto* indexArray = indices.data();
                     const auto* countArray = counts.data();
                     glAssert(glMultiDrawArrays(toGL(primType), indexArray, countArray, primCount));
+                    ++s_drawCallCount;
                     cleanup();
                 }
             } else {
                 const auto* indexArray = indices.data();
                 const auto* countArray = counts.data();
                 glAssert(glMultiDrawArrays(toGL(primType), indexArray, countArray, primCount));
+                ++s_drawCallCount;
             }
 
         }
@@ -113,14 +119,34 @@ namespace TrenchBroom {
                 if (setup()) {
                     const auto* indexArray = indices.data();
                     glAssert(glDrawElements(toGL(primType), count, GL_UNSIGNED_INT, indexArray));
+                    ++s_drawCallCount;
                     cleanup();
                 }
             } else {
                 const auto* indexArray = indices.data();
                 glAssert(glDrawElements(toGL(primType), count, GL_UNSIGNED_INT, indexArray));
+                ++s_drawCallCount;
+            }
+        }
+
+        void VertexArray::renderInstanced(const PrimType primType, const GLint index, const GLsizei count, const GLsizei instanceCount) {
+            assert(prepared());
+            if (!m_setup) {
+                if (setup()) {
+                    glAssert(glDrawArraysInstancedARB(toGL(primType), index, count, instanceCount));
+                    ++s_drawCallCount;
+                    cleanup();
+                }
+            } else {
+                glAssert(glDrawArraysInstancedARB(toGL(primType), index, count, instanceCount));
+                ++s_drawCallCount;
             }
         }
 
+        size_t VertexArray::drawCallCount() {
+            return s_drawCallCount;
+        }
+
         VertexArray::VertexArray(std::shared_ptr<BaseHolder> holder) :
         m_holder(std::move(holder)),
         m_prepared(false),
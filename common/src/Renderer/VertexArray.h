@@ -286,7 +286,28 @@ namespace TrenchBroom {
              * @param count the number of vertices to render
              */
             void render(PrimType primType, const GLIndices& indices, GLsizei count);
+
+            /**
+             * Renders a sub range of this vertex array as a range of primitives of the given type several times
+             * using a single draw call. The caller must set up any per instance vertex attributes beforehand.
+             *
+             * Requires that instanced rendering is supported by the current context, see glSupportsInstancing().
+             *
+             * @param primType the primitive type to render
+             * @param index the index of the first vertex in this vertex array to render
+             * @param count the number of vertices to render
+             * @param instanceCount the number of instances to render
+             */
+            void renderInstanced(PrimType primType, GLint index, GLsizei count, GLsizei instanceCount);
             void cleanup();
+
+            /**
+             * Returns the total number of draw calls issued by all vertex arrays so far. Callers can determine the
+             * number of draw calls issued by some rendering code by taking the difference before and after.
+             *
+             * @return the total number of draw calls issued
+             */
+            static size_t drawCallCount();
         private:
             explicit VertexArray(std::shared_ptr<BaseHolder> holder);
         };
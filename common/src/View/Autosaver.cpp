@@ -22,17 +22,23 @@
 #include "Exceptions.h"
 #include "IO/DiskFileSystem.h"
 #include "IO/DiskIO.h"
+#include "Model/Game.h"
+#include "Model/Node.h"
+#include "Model/WorldNode.h"
 #include "View/MapDocument.h"
 
 #include <kdl/memory_utils.h>
 #include <kdl/string_compare.h>
 #include <kdl/string_format.h>
 #include <kdl/string_utils.h>
+#include <kdl/vector_utils.h>
 
 #include <algorithm> // for std::sort
 #include <cassert>
+#include <chrono>
 #include <limits>
 #include <memory>
+#include <utility>
 
 namespace TrenchBroom {
     namespace View {
@@ -69,7 +75,17 @@ namespace TrenchBroom {
         m_lastSaveTime(Clock::now()),
         m_lastModificationCount(kdl::mem_lock(m_document)->modificationCount()) {}
 
+        Autosaver::~Autosaver() {
+            if (m_pendingBackup.valid()) {
+                m_pendingBackup.wait();
+            }
+        }
+
         void Autosaver::triggerAutosave(Logger& logger) {
+            if (!collectPendingBackup(logger, false)) {
+                return;
+            }
+
             if (kdl::mem_expired(m_document)) {
                 return;
             }
@@ -116,17 +132,71 @@ namespace TrenchBroom {
                 const auto backupNo = backups.size() + 1;
 
                 const auto backupFilePath = fs.makeAbsolute(makeBackupName(mapBasename, backupNo));
+                const auto tempFilePath = backupFilePath.addExtension("tmp");
 
                 m_lastSaveTime = Clock::now();
                 m_lastModificationCount = document->modificationCount();
-                document->saveDocumentTo(backupFilePath);
 
-                logger.info() << "Created autosave backup at " << backupFilePath;
+                // this is the only part of an autosave that blocks the main thread apart from the preparations above
+                const auto snapshotStart = std::chrono::steady_clock::now();
+                auto snapshot = document->createWorldSnapshot();
+                const auto snapshotTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - snapshotStart);
+
+                logger.debug() << "Created autosave snapshot in " << snapshotTime.count() << "ms, copied " << snapshot.copiedNodes.size() << " brushes and patches";
+                logger.debug() << "Writing autosave backup to " << backupFilePath;
+
+                // The backup is written to a temporary file first and then renamed, so that a backup file is never
+                // incomplete, even if the editor crashes while it is being written.
+                m_pendingBackup = std::async(std::launch::async, [game = document->game(), snapshot = std::move(snapshot), backupFilePath, tempFilePath]() mutable {
+                    auto result = BackupResult{backupFilePath, std::nullopt, {}, snapshot.changeCount};
+                    try {
+                        game->writeMap(*snapshot.world, tempFilePath);
+                        IO::Disk::moveFile(tempFilePath, backupFilePath, true);
+
+                        const auto mapFormat = snapshot.world->mapFormat();
+                        result.serializations = kdl::vec_transform(snapshot.copiedNodes, [&](const auto& nodes) {
+                            return std::make_pair(nodes.first, nodes.second->cachedSerialization(mapFormat));
+                        });
+                    } catch (const Exception& e) {
+                        result.error = e.what();
+                        if (IO::Disk::fileExists(tempFilePath)) {
+                            try {
+                                IO::Disk::deleteFile(tempFilePath);
+                            } catch (const FileSystemException&) {}
+                        }
+                    }
+                    return result;
+                });
             } catch (const FileSystemException& e) {
                 logger.error() << "Aborting autosave: " << e.what();
             }
         }
 
+        void Autosaver::finishPendingAutosave(Logger& logger) {
+            collectPendingBackup(logger, true);
+        }
+
+        bool Autosaver::collectPendingBackup(Logger& logger, const bool wait) {
+            if (!m_pendingBackup.valid()) {
+                return true;
+            }
+
+            if (!wait && m_pendingBackup.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                return false;
+            }
+
+            const auto result = m_pendingBackup.get();
+            if (result.error) {
+                logger.error() << "Aborting autosave: " << *result.error;
+            } else {
+                logger.info() << "Created autosave backup at " << result.backupFilePath;
+                if (!kdl::mem_expired(m_document)) {
+                    kdl::mem_lock(m_document)->cacheSnapshotSerializations(result.serializations, result.changeCount);
+                }
+            }
+            return true;
+        }
+
         IO::WritableDiskFileSystem Autosaver::createBackupFileSystem(Logger& logger, const IO::Path& mapPath) const {
             const auto basePath = mapPath.deleteLastComponent();
             const auto autosavePath = basePath + IO::Path("autosave");
@@ -22,7 +22,12 @@
 #include "IO/Path.h"
 
 #include <chrono>
+#include <future>
 #include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace TrenchBroom {
     class Logger;
@@ -31,6 +36,11 @@ namespace TrenchBroom {
         class WritableDiskFileSystem;
     }
 
+    namespace Model {
+        class Node;
+        struct NodeSerialization;
+    }
+
     namespace View {
         class Command;
         class MapDocument;
@@ -46,6 +56,21 @@ namespace TrenchBroom {
             };
         private:
             using Clock = std::chrono::system_clock;
+
+            /**
+             * The outcome of writing a backup on a worker thread.
+             */
+            struct BackupResult {
+                IO::Path backupFilePath;
+                std::optional<std::string> error;
+
+                /**
+                 * The serializations of the document's nodes that were copied into the snapshot, and the change count
+                 * of the document when the snapshot was created, see MapDocument::cacheSnapshotSerializations.
+                 */
+                std::vector<std::pair<const Model::Node*, std::shared_ptr<const Model::NodeSerialization>>> serializations;
+                size_t changeCount;
+            };
             
             std::weak_ptr<MapDocument> m_document;
 
@@ -69,12 +94,34 @@ namespace TrenchBroom {
              * The modification count that was last recorded.
              */
             size_t m_lastModificationCount;
-            
+
+            /**
+             * The backup that is currently being written, if any.
+             */
+            std::future<BackupResult> m_pendingBackup;
         public:
             explicit Autosaver(std::weak_ptr<MapDocument> document, std::chrono::milliseconds saveInterval = std::chrono::milliseconds(10 * 60 * 1000), size_t maxBackups = 50);
+            ~Autosaver();
 
+            /**
+             * Creates a backup of the document if it was modified since the last backup and the save interval has
+             * elapsed. The backup is written from a snapshot of the document on a worker thread, and the outcome is
+             * logged by a later call to this function or to finishPendingAutosave. No backup is created while another
+             * one is still being written.
+             */
             void triggerAutosave(Logger& logger);
+
+            /**
+             * Waits until the backup that is currently being written, if any, is complete and logs the outcome.
+             */
+            void finishPendingAutosave(Logger& logger);
         private:
+            /**
+             * Logs the outcome of the pending backup if it is complete or if `wait` is true, in which case this function
+             * blocks until it is complete, and caches the serializations that were computed while writing the backup in
+             * the document. Returns true if no backup is pending afterwards.
+             */
+            bool collectPendingBackup(Logger& logger, bool wait);
             void autosave(Logger& logger, std::shared_ptr<View::MapDocument> document);
             IO::WritableDiskFileSystem createBackupFileSystem(Logger& logger, const IO::Path& mapPath) const;
             std::vector<IO::Path> collectBackups(const IO::WritableDiskFileSystem& fs, const IO::Path& mapBasename) const;
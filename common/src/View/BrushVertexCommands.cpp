@@ -37,7 +37,7 @@ namespace TrenchBroom {
             return swapResult;
         }
 
-        static auto collectBrushNodes(const std::vector<std::pair<Model::Node*, Model::NodeContents>> nodes) {
+        static auto collectBrushNodes(const std::vector<std::pair<Model::Node*, Model::NodeContentsDelta>>& nodes) {
             auto result = std::vector<Model::BrushNode*>{};
             for (const auto& [node, contents] : nodes) {
                 if (auto* brushNode = dynamic_cast<Model::BrushNode*>(node)) {
@@ -29,6 +29,7 @@
 #include <kdl/vector_utils.h>
 
 #include <algorithm>
+#include <iterator>
 
 #include <QDateTime>
 
@@ -108,6 +109,14 @@ namespace TrenchBroom {
             bool doCollateWith(UndoableCommand*) override {
                 return false;
             }
+
+            size_t doGetMemorySize() const override {
+                auto result = size_t(0);
+                for (const auto& command : m_commands) {
+                    result += command->memorySize();
+                }
+                return result;
+            }
         };
 
         const Command::CommandType CommandProcessor::TransactionCommand::Type = Command::freeType();
@@ -115,7 +124,8 @@ namespace TrenchBroom {
         CommandProcessor::CommandProcessor(MapDocumentCommandFacade* document, const std::chrono::milliseconds collationInterval) :
         m_document(document),
         m_collationInterval(collationInterval),
-        m_lastCommandTimestamp(std::chrono::time_point<std::chrono::system_clock>()) {}
+        m_lastCommandTimestamp(std::chrono::time_point<std::chrono::system_clock>()),
+        m_undoMemoryBudget(0u) {}
 
         CommandProcessor::~CommandProcessor() = default;
 
@@ -143,6 +153,21 @@ namespace TrenchBroom {
             }
         }
 
+        size_t CommandProcessor::undoStackMemorySize() const {
+            auto result = size_t(0);
+            for (const auto& command : m_undoStack) {
+                result += command->memorySize();
+            }
+            return result;
+        }
+
+        void CommandProcessor::setUndoMemoryBudget(const size_t undoMemoryBudget) {
+            m_undoMemoryBudget = undoMemoryBudget;
+            if (m_transactionStack.empty()) {
+                pruneUndoStack();
+            }
+        }
+
         void CommandProcessor::startTransaction(const std::string& name) {
             m_transactionStack.push_back(TransactionState(name));
         }
@@ -315,11 +340,13 @@ namespace TrenchBroom {
             if (collatable(collate, timestamp)) {
                 auto& lastCommand = m_undoStack.back();
                 if (lastCommand->collateWith(command.get())) {
+                    pruneUndoStack();
                     return false;
                 }
             }
 
             m_undoStack.push_back(std::move(command));
+            pruneUndoStack();
             return true;
         }
 
@@ -330,6 +357,28 @@ namespace TrenchBroom {
             return kdl::vec_pop_back(m_undoStack);
         }
 
+        void CommandProcessor::pruneUndoStack() {
+            assert(m_transactionStack.empty());
+
+            if (m_undoMemoryBudget == 0u || m_undoStack.size() < 2u) {
+                return;
+            }
+
+            // find the oldest command that still fits into the budget, counting from the top of the stack
+            auto memorySize = size_t(0);
+            auto first = m_undoStack.end();
+            while (first != m_undoStack.begin()) {
+                const auto commandMemorySize = (*std::prev(first))->memorySize();
+                if (first != m_undoStack.end() && memorySize + commandMemorySize > m_undoMemoryBudget) {
+                    break;
+                }
+                memorySize += commandMemorySize;
+                --first;
+            }
+
+            m_undoStack.erase(m_undoStack.begin(), first);
+        }
+
         bool CommandProcessor::collatable(const bool collate, const std::chrono::system_clock::time_point timestamp) const {
             return collate && !m_undoStack.empty() && timestamp - m_lastCommandTimestamp <= m_collationInterval;
         }
@@ -76,6 +76,12 @@ namespace TrenchBroom {
              */
             std::chrono::system_clock::time_point m_lastCommandTimestamp;
 
+            /**
+             * The maximum number of bytes that the commands on the undo stack may use, or 0 if the undo stack is not
+             * limited.
+             */
+            size_t m_undoMemoryBudget;
+
             struct TransactionState;
 
             /**
@@ -157,6 +163,20 @@ namespace TrenchBroom {
              */
             const std::string& redoCommandName() const;
 
+            /**
+             * Returns an estimate of the number of bytes used by the commands on the undo stack.
+             */
+            size_t undoStackMemorySize() const;
+
+            /**
+             * Limits the number of bytes that the commands on the undo stack may use. Whenever a command is pushed onto
+             * the undo stack and the budget is exceeded, the oldest commands are discarded until the undo stack fits
+             * into the budget again. The most recently executed command is never discarded.
+             *
+             * @param undoMemoryBudget the budget in bytes, or 0 to keep all commands
+             */
+            void setUndoMemoryBudget(size_t undoMemoryBudget);
+
             /**
              * Starts a new transaction. If a transaction is currently executing, then the newly started transaction
              * becomes a nested transaction and will be added as a command to its parent transaction upon commit.
@@ -341,6 +361,12 @@ namespace TrenchBroom {
              */
             std::unique_ptr<UndoableCommand> popFromUndoStack();
 
+            /**
+             * Discards the oldest commands on the undo stack until it fits into the undo memory budget, but keeps at
+             * least the topmost command.
+             */
+            void pruneUndoStack();
+
             bool collatable(bool collate, std::chrono::system_clock::time_point timestamp) const;
 
             /**
@@ -33,6 +33,7 @@
 #include "Renderer/FontDescriptor.h"
 #include "Renderer/FontManager.h"
 #include "Renderer/PrimType.h"
+#include "Renderer/RenderUtils.h"
 #include "Renderer/ShaderManager.h"
 #include "Renderer/Shaders.h"
 #include "Renderer/TextureFont.h"
@@ -302,11 +303,14 @@ namespace TrenchBroom {
             shader.set("ApplyTinting", false);
             shader.set("Brightness", pref(Preferences::Brightness));
             shader.set("GrayScale", false);
+            // the cell transformations are applied to the model view matrix instead
+            shader.setAttribute("ModelMatrix", vm::mat4x4f::identity());
 
             glAssert(glFrontFace(GL_CW));
 
             m_entityModelManager.prepare(vboManager());
 
+            auto func = Renderer::ApplyTextureRenderFunc{shader, Color(0.5f, 0.5f, 0.5f)};
             for (size_t i = 0; i < layout.size(); ++i) {
                 const auto& group = layout[i];
                 if (group.intersectsY(y, height)) {
@@ -320,7 +324,7 @@ namespace TrenchBroom {
                                 if (modelRenderer != nullptr) {
                                     const auto itemTrans = itemTransformation(cell, y, height);
                                     Renderer::MultiplyModelMatrix multMatrix(transformation, itemTrans);
-                                    modelRenderer->render();
+                                    modelRenderer->render(func);
                                 }
                             }
                         }
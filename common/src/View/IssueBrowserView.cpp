@@ -21,6 +21,7 @@
 
 #include "Ensure.h"
 #include "Model/Issue.h"
+#include "Model/IssueGenerator.h"
 #include "Model/IssueQuickFix.h"
 #include "Model/BrushNode.h"
 #include "Model/EntityNode.h"
@@ -32,9 +33,16 @@
 
 #include <kdl/memory_utils.h>
 #include <kdl/overload.h>
+#include <kdl/parallel.h>
+#include <kdl/thread_pool.h>
 #include <kdl/vector_utils.h>
 #include <kdl/vector_set.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <iterator>
 #include <vector>
 
 #include <QHBoxLayout>
@@ -45,12 +53,24 @@
 
 namespace TrenchBroom {
     namespace View {
+        /**
+         * The issues of invalid nodes are generated on the thread pool. Each worker claims small chunks of nodes until the
+         * time slice is used up, so a time slice overruns by at most one chunk per worker. The UI thread waits for the
+         * workers because the generators read the nodes, and it returns to the event loop after each time slice so that
+         * the editor stays responsive and any change to the document can cancel the validation.
+         */
+        static constexpr size_t ValidationChunkSize = 16u;
+        static constexpr auto ValidationTimeSlice = std::chrono::milliseconds(10);
+        static constexpr auto ValidationReportThreshold = std::chrono::milliseconds(100);
+
         IssueBrowserView::IssueBrowserView(std::weak_ptr<MapDocument> document, QWidget* parent) :
         QWidget(parent),
         m_document(document),
         m_hiddenGenerators(0),
         m_showHiddenIssues(false),
-        m_valid(false) {
+        m_valid(false),
+        m_validatedNodeCount(0u),
+        m_validationQueued(false) {
             createGui();
             bindEvents();
         }
@@ -115,14 +135,22 @@ namespace TrenchBroom {
         }
 
         void IssueBrowserView::updateIssues() {
+            m_pendingNodes.clear();
+            m_validatedNodeCount = 0u;
+
             auto document = kdl::mem_lock(m_document);
             if (document->world() != nullptr) {
                 const auto& issueGenerators = document->world()->registeredIssueGenerators();
-                
+
+                // the issues of valid nodes are shown right away, all other nodes are validated later
                 auto issues = std::vector<Model::Issue*>{};
                 const auto collectIssues = [&](auto* node) {
+                    if (!node->issuesValid()) {
+                        m_pendingNodes.push_back(node);
+                        return;
+                    }
                     for (auto* issue : node->issues(issueGenerators)) {
-                        if (m_showHiddenIssues || (!issue->hidden() && (issue->type() & m_hiddenGenerators) == 0)) {
+                        if (isIssueVisible(issue)) {
                             issues.push_back(issue);
                         }
                     }
@@ -139,6 +167,40 @@ namespace TrenchBroom {
 
                 issues = kdl::vec_sort(std::move(issues), [](const auto* lhs, const auto* rhs) { return lhs->seqId() > rhs->seqId(); });
                 m_tableModel->setIssues(std::move(issues));
+
+                if (!m_pendingNodes.empty()) {
+                    m_generatorTimes = std::vector<std::chrono::nanoseconds>(issueGenerators.size());
+                    m_validationStart = std::chrono::steady_clock::now();
+                    queueValidatePendingNodes();
+                }
+            } else {
+                m_tableModel->setIssues({});
+            }
+        }
+
+        bool IssueBrowserView::isIssueVisible(const Model::Issue* issue) const {
+            return m_showHiddenIssues || (!issue->hidden() && (issue->type() & m_hiddenGenerators) == 0);
+        }
+
+        void IssueBrowserView::logValidationTimes() const {
+            const auto elapsed = std::chrono::steady_clock::now() - m_validationStart;
+            if (elapsed < ValidationReportThreshold) {
+                return;
+            }
+
+            auto document = kdl::mem_lock(m_document);
+            const auto& issueGenerators = document->world()->registeredIssueGenerators();
+
+            auto indices = std::vector<size_t>(issueGenerators.size());
+            for (size_t i = 0u; i < indices.size(); ++i) {
+                indices[i] = i;
+            }
+            std::sort(std::begin(indices), std::end(indices), [&](const auto lhs, const auto rhs) { return m_generatorTimes[lhs] > m_generatorTimes[rhs]; });
+
+            using Milliseconds = std::chrono::duration<double, std::milli>;
+            document->debug() << "Validated " << m_pendingNodes.size() << " objects in " << Milliseconds(elapsed).count() << "ms";
+            for (const auto i : indices) {
+                document->debug() << "  " << issueGenerators[i]->description() << ": " << Milliseconds(m_generatorTimes[i]).count() << "ms";
             }
         }
 
@@ -260,6 +322,10 @@ namespace TrenchBroom {
         void IssueBrowserView::invalidate() {
             m_valid = false;
 
+            // the pending nodes may be deleted before the validation is restarted
+            m_pendingNodes.clear();
+            m_validatedNodeCount = 0u;
+
             QMetaObject::invokeMethod(this, "validate", Qt::QueuedConnection);
         }
 
@@ -271,6 +337,74 @@ namespace TrenchBroom {
             }
         }
 
+        void IssueBrowserView::queueValidatePendingNodes() {
+            if (!m_validationQueued) {
+                m_validationQueued = true;
+                QMetaObject::invokeMethod(this, "validatePendingNodes", Qt::QueuedConnection);
+            }
+        }
+
+        void IssueBrowserView::validatePendingNodes() {
+            m_validationQueued = false;
+            if (!m_valid || m_validatedNodeCount >= m_pendingNodes.size()) {
+                // the validation was cancelled by a change, or it has already finished
+                return;
+            }
+
+            auto document = kdl::mem_lock(m_document);
+            const auto& issueGenerators = document->world()->registeredIssueGenerators();
+
+            const auto deadline = std::chrono::steady_clock::now() + ValidationTimeSlice;
+            const auto first = m_validatedNodeCount;
+            const auto last = m_pendingNodes.size();
+
+            // every claimed chunk is validated, so the validated nodes are those before the next unclaimed chunk
+            auto nextChunkFirst = std::atomic<size_t>(first);
+            const auto workerCount = kdl::global_thread_pool().thread_count() + 1u;
+            auto workerTimes = std::vector<std::vector<std::chrono::nanoseconds>>(workerCount, std::vector<std::chrono::nanoseconds>(issueGenerators.size()));
+            kdl::parallel_for(workerCount, [&](const size_t worker) {
+                do {
+                    const auto chunkFirst = nextChunkFirst.fetch_add(ValidationChunkSize);
+                    if (chunkFirst >= last) {
+                        break;
+                    }
+
+                    const auto chunkLast = std::min(chunkFirst + ValidationChunkSize, last);
+                    const auto nodes = std::vector<Model::Node*>(
+                        std::next(std::begin(m_pendingNodes), static_cast<std::ptrdiff_t>(chunkFirst)),
+                        std::next(std::begin(m_pendingNodes), static_cast<std::ptrdiff_t>(chunkLast)));
+                    Model::Node::validateIssues(nodes, issueGenerators, workerTimes[worker]);
+                } while (std::chrono::steady_clock::now() < deadline);
+            });
+
+            for (const auto& times : workerTimes) {
+                for (size_t i = 0u; i < times.size(); ++i) {
+                    m_generatorTimes[i] += times[i];
+                }
+            }
+
+            m_validatedNodeCount = std::min(nextChunkFirst.load(), last);
+
+            auto issues = std::vector<Model::Issue*>{};
+            for (size_t i = first; i < m_validatedNodeCount; ++i) {
+                for (auto* issue : m_pendingNodes[i]->issues(issueGenerators)) {
+                    if (isIssueVisible(issue)) {
+                        issues.push_back(issue);
+                    }
+                }
+            }
+
+            // the new issues were generated after every issue that is already shown, so they go to the top
+            issues = kdl::vec_sort(std::move(issues), [](const auto* lhs, const auto* rhs) { return lhs->seqId() > rhs->seqId(); });
+            m_tableModel->prependIssues(std::move(issues));
+
+            if (m_validatedNodeCount < m_pendingNodes.size()) {
+                queueValidatePendingNodes();
+            } else {
+                logValidationTimes();
+            }
+        }
+
         // IssueBrowserModel
 
         IssueBrowserModel::IssueBrowserModel(QObject* parent)
@@ -283,6 +417,16 @@ namespace TrenchBroom {
             endResetModel();
         }
 
+        void IssueBrowserModel::prependIssues(std::vector<Model::Issue*> issues) {
+            if (issues.empty()) {
+                return;
+            }
+
+            beginInsertRows(QModelIndex(), 0, static_cast<int>(issues.size()) - 1);
+            m_issues = kdl::vec_concat(std::move(issues), std::move(m_issues));
+            endInsertRows();
+        }
+
         const std::vector<Model::Issue*>& IssueBrowserModel::issues() {
             return m_issues;
         }
@@ -21,6 +21,7 @@
 
 #include "Model/IssueType.h"
 
+#include <chrono>
 #include <memory>
 #include <vector>
 
@@ -34,6 +35,7 @@ namespace TrenchBroom {
     namespace Model {
         class Issue;
         class IssueQuickFix;
+        class Node;
     }
 
     namespace View {
@@ -50,6 +52,15 @@ namespace TrenchBroom {
 
             bool m_valid;
 
+            /**
+             * The nodes whose issues are being validated, and how many of them have been validated so far.
+             */
+            std::vector<Model::Node*> m_pendingNodes;
+            size_t m_validatedNodeCount;
+            std::vector<std::chrono::nanoseconds> m_generatorTimes;
+            std::chrono::steady_clock::time_point m_validationStart;
+            bool m_validationQueued;
+
             QTableView* m_tableView;
             IssueBrowserModel* m_tableModel;
         public:
@@ -64,6 +75,8 @@ namespace TrenchBroom {
             void deselectAll();
         private:
             void updateIssues();
+            bool isIssueVisible(const Model::Issue* issue) const;
+            void logValidationTimes() const;
 
             std::vector<Model::Issue*> collectIssues(const QList<QModelIndex>& indices) const;
             std::vector<Model::IssueQuickFix*> collectQuickFixes(const QList<QModelIndex>& indices) const;
@@ -82,13 +95,17 @@ namespace TrenchBroom {
             void applyQuickFix(const Model::IssueQuickFix* quickFix);
         private:
             void invalidate();
+            void queueValidatePendingNodes();
         public slots:
             void validate();
+            void validatePendingNodes();
         };
 
         /**
          * Trivial QAbstractTableModel subclass, when the issues list changes,
          * it just refreshes the entire list with beginResetModel()/endResetModel().
+         * Newly generated issues can be prepended without resetting the model so
+         * that the selection is kept while the issues are being validated.
          */
         class IssueBrowserModel : public QAbstractTableModel {
             Q_OBJECT
@@ -98,6 +115,7 @@ namespace TrenchBroom {
             explicit IssueBrowserModel(QObject* parent);
 
             void setIssues(std::vector<Model::Issue*> issues);
+            void prependIssues(std::vector<Model::Issue*> issues);
             const std::vector<Model::Issue*>& issues();
         public: // QAbstractTableModel overrides
             int rowCount(const QModelIndex& parent) const override;
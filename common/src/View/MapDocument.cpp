@@ -20,6 +20,7 @@
 #include "View/MapDocument.h"
 
 #include "Exceptions.h"
+#include "ProgressMonitor.h"
 #include "Uuid.h"
 #include "Model/EntityProperties.h"
 #include "PreferenceManager.h"
@@ -105,6 +106,8 @@
 #include <kdl/map_utils.h>
 #include <kdl/memory_utils.h>
 #include <kdl/overload.h>
+#include <kdl/invoke.h>
+#include <kdl/parallel.h>
 #include <kdl/string_format.h>
 #include <kdl/result.h>
 #include <kdl/result_for_each.h>
@@ -117,13 +120,17 @@
 #include <vecmath/vec_io.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstdlib> // for std::abs
 #include <map>
+#include <optional>
 #include <sstream>
 #include <string>
 #include <type_traits>
 #include <unordered_map>
+#include <utility>
+#include <variant>
 #include <vector>
 
 namespace TrenchBroom {
@@ -179,6 +186,67 @@ namespace TrenchBroom {
             return findLinkedGroupsToUpdate(worldNode, nodes, true);
         }
 
+        /**
+         * Calls the given lambda for each index in [0, count) in parallel and returns true if it returned true for every index.
+         *
+         * Once the lambda has failed for some index, it is no longer called for greater indices. The messages logged by the lambda
+         * are collected per index and logged to the given logger in index order, up to and including the first failed index. This
+         * yields the same messages as calling the lambda for each index in order until it fails for the first time.
+         */
+        template <typename L>
+        static bool applyInParallel(CachingLogger& logger, const size_t count, L lambda) {
+            auto messages = std::vector<Logger::DeferredMessageList>(count);
+            auto firstFailedIndex = std::atomic<size_t>{count};
+
+            kdl::parallel_for(count, [&](const size_t index) {
+                if (index > firstFailedIndex.load()) {
+                    return;
+                }
+
+                const Logger::DeferMessages deferMessages(messages[index]);
+                if (!lambda(index)) {
+                    auto current = firstFailedIndex.load();
+                    while (index < current && !firstFailedIndex.compare_exchange_weak(current, index)) {}
+                }
+            });
+
+            const auto lastIndex = firstFailedIndex.load();
+            for (size_t i = 0; i < count && i <= lastIndex; ++i) {
+                for (const auto& message : messages[i]) {
+                    logger.log(message.level, message.str);
+                }
+            }
+
+            return lastIndex == count;
+        }
+
+        /**
+         * Like applyInParallel, but processes the indices in batches. In between batches, the progress is reported to the given monitor and the
+         * operation stops if the monitor was cancelled. Returns false if the lambda failed for some index or if the operation was cancelled.
+         */
+        template <typename L>
+        static bool applyInParallel(CachingLogger& logger, ProgressMonitor& progressMonitor, const size_t count, L lambda) {
+            // large enough to keep all workers busy, small enough to keep the progress dialog responsive
+            const auto batchSize = std::max(count / 100u, size_t(256));
+
+            for (size_t first = 0; first < count; first += batchSize) {
+                if (progressMonitor.cancelled()) {
+                    return false;
+                }
+
+                const auto last = std::min(first + batchSize, count);
+                if (!applyInParallel(logger, last - first, [&](const size_t index) { return lambda(first + index); })) {
+                    return false;
+                }
+
+                progressMonitor.progress(static_cast<double>(last) / static_cast<double>(count));
+            }
+
+            return !progressMonitor.cancelled();
+        }
+
+        using NodeContentType = std::variant<Model::Layer, Model::Group, Model::Entity, Model::Brush, Model::BezierPatch>;
+
         /**
          * Applies the given lambda to a copy of the contents of each of the given nodes and returns a vector of pairs of the original node and the modified contents.
          *
@@ -187,33 +255,63 @@ namespace TrenchBroom {
          * - bool operator()(Model::Brush&);
          * - bool operator()(Model::BezierPatch&);
          *
-         * The given node contents should be modified in place and the lambda should return true if it was applied successfully and false otherwise.
+         * The given node contents should be modified in place and the lambda should return true if it was applied successfully and false otherwise. An
+         * overload may take the index of the node in the given vector as a second argument, e.g. to store results per node.
+         *
+         * Brushes and patches are copied and the lambda is applied to the node contents in parallel, so the lambda must not modify shared state without
+         * synchronization and must not access the preferences. Messages it logs to the given document are logged in the order of the given nodes.
          *
          * Returns a vector of pairs which map each node to its modified contents if the lambda succeeded for every given node, or an empty optional otherwise.
          */        
         template <typename N, typename L>
-        static std::optional<std::vector<std::pair<Model::Node*, Model::NodeContents>>> applyToNodeContents(const std::vector<N*>& nodes, L lambda) {
-            using NodeContentType = std::variant<Model::Layer, Model::Group, Model::Entity, Model::Brush, Model::BezierPatch>;
+        static std::optional<std::vector<std::pair<Model::Node*, Model::NodeContents>>> applyToNodeContents(MapDocument& document, const std::vector<N*>& nodes, L lambda) {
+            // Copying an entity changes the usage count of its definition, which notifies observers, so entities must be copied on this thread.
+            auto nodeContents = kdl::vec_transform(nodes, [](auto* node) {
+                return node->accept(kdl::overload(
+                    [](const Model::WorldNode* worldNode)   -> std::optional<NodeContentType> { return worldNode->entity(); },
+                    [](const Model::LayerNode* layerNode)   -> std::optional<NodeContentType> { return layerNode->layer(); },
+                    [](const Model::GroupNode* groupNode)   -> std::optional<NodeContentType> { return groupNode->group(); },
+                    [](const Model::EntityNode* entityNode) -> std::optional<NodeContentType> { return entityNode->entity(); },
+                    [](const Model::BrushNode*)             -> std::optional<NodeContentType> { return std::nullopt; },
+                    [](const Model::PatchNode*)             -> std::optional<NodeContentType> { return std::nullopt; }
+                ));
+            });
+
+            const auto success = applyInParallel(document, nodes.size(), [&](const size_t index) {
+                auto& contents = nodeContents[index];
+                if (!contents) {
+                    contents = nodes[index]->accept(kdl::overload(
+                        [](const Model::WorldNode*)             -> std::optional<NodeContentType> { return std::nullopt; },
+                        [](const Model::LayerNode*)             -> std::optional<NodeContentType> { return std::nullopt; },
+                        [](const Model::GroupNode*)             -> std::optional<NodeContentType> { return std::nullopt; },
+                        [](const Model::EntityNode*)            -> std::optional<NodeContentType> { return std::nullopt; },
+                        [](const Model::BrushNode* brushNode)   -> std::optional<NodeContentType> { return brushNode->brush(); },
+                        [](const Model::PatchNode* patchNode)   -> std::optional<NodeContentType> { return patchNode->patch(); }
+                    ));
+                }
+
+                assert(contents.has_value());
+                return std::visit([&](auto& content) {
+                    if constexpr (std::is_invocable_v<L&, decltype(content), size_t>) {
+                        return lambda(content, index);
+                    } else {
+                        return lambda(content);
+                    }
+                }, *contents);
+            });
+
+            if (!success) {
+                return std::nullopt;
+            }
 
             auto newNodes = std::vector<std::pair<Model::Node*, Model::NodeContents>>{};
             newNodes.reserve(nodes.size());
 
-            bool success = true;
-            std::transform(std::begin(nodes), std::end(nodes), std::back_inserter(newNodes), [&](auto* node) {
-                NodeContentType nodeContents = node->accept(kdl::overload(
-                    [](const Model::WorldNode* worldNode)   -> NodeContentType { return worldNode->entity(); },
-                    [](const Model::LayerNode* layerNode)   -> NodeContentType { return layerNode->layer(); },
-                    [](const Model::GroupNode* groupNode)   -> NodeContentType { return groupNode->group(); },
-                    [](const Model::EntityNode* entityNode) -> NodeContentType { return entityNode->entity(); },
-                    [](const Model::BrushNode* brushNode)   -> NodeContentType { return brushNode->brush(); },
-                    [](const Model::PatchNode* patchNode)   -> NodeContentType { return patchNode->patch(); }
-                ));
-
-                success = success && std::visit(lambda, nodeContents);
-                return std::make_pair(node, Model::NodeContents(std::move(nodeContents)));
-            });
+            for (size_t i = 0; i < nodes.size(); ++i) {
+                newNodes.emplace_back(nodes[i], Model::NodeContents(std::move(*nodeContents[i])));
+            }
 
-            return success ? std::make_optional(newNodes) : std::nullopt;
+            return newNodes;
         }
 
         /**
@@ -224,7 +322,8 @@ namespace TrenchBroom {
          * - bool operator()(Model::Brush&);
          * - bool operator()(Model::BezierPatch&);
          *
-         * The given node contents should be modified in place and the lambda should return true if it was applied successfully and false otherwise.
+         * The given node contents should be modified in place and the lambda should return true if it was applied successfully and false otherwise. The lambda
+         * is applied in parallel, see applyToNodeContents.
          *
          * For each linked group in the given list of linked groups, its changes are distributed to the connected members of its link set.
          *
@@ -237,7 +336,7 @@ namespace TrenchBroom {
                 return true;
             }
 
-            if (auto newNodes = applyToNodeContents(nodes, std::move(lambda))) {
+            if (auto newNodes = applyToNodeContents(document, nodes, std::move(lambda))) {
                 return document.swapNodeContents(commandName, std::move(*newNodes), std::move(linkedGroupsToUpdate));
             }
 
@@ -253,7 +352,8 @@ namespace TrenchBroom {
          * The lambda L needs to accept brush faces:
          * - bool operator()(Model::BrushFace&);
          *
-         * The given node contents should be modified in place and the lambda should return true if it was applied successfully and false otherwise.
+         * The given node contents should be modified in place and the lambda should return true if it was applied successfully and false otherwise. The brushes
+         * are processed in parallel, so the same restrictions as for applyToNodeContents apply to the lambda.
          *
          * For each linked group in the given list of linked groups, its changes are distributed to the connected members of its link set.
          *
@@ -266,26 +366,34 @@ namespace TrenchBroom {
                 return true;
             }
 
-            auto brushes = std::unordered_map<Model::BrushNode*, Model::Brush>{};
-
-            bool success = true;
-            std::for_each(std::begin(faces), std::end(faces), [&](const auto& faceHandle) {
+            // group the face indices by brush node in the order in which the brush nodes first appear
+            auto brushNodes = std::vector<Model::BrushNode*>{};
+            auto faceIndices = std::vector<std::vector<size_t>>{};
+            auto brushNodeIndices = std::unordered_map<Model::BrushNode*, size_t>{};
+            for (const auto& faceHandle : faces) {
                 auto* brushNode = faceHandle.node();
-                auto it = brushes.find(brushNode);
-                if (it == std::end(brushes)) {
-                    it = brushes.emplace(brushNode, brushNode->brush()).first;
+                const auto [it, inserted] = brushNodeIndices.emplace(brushNode, brushNodes.size());
+                if (inserted) {
+                    brushNodes.push_back(brushNode);
+                    faceIndices.emplace_back();
                 }
+                faceIndices[it->second].push_back(faceHandle.faceIndex());
+            }
 
-                auto& brush = it->second;
-                success = success && lambda(brush.face(faceHandle.faceIndex()));
+            auto brushes = std::vector<std::optional<Model::Brush>>(brushNodes.size());
+            const auto success = applyInParallel(document, brushNodes.size(), [&](const size_t index) {
+                auto& brush = brushes[index].emplace(brushNodes[index]->brush());
+                return std::all_of(std::begin(faceIndices[index]), std::end(faceIndices[index]), [&](const size_t faceIndex) {
+                    return lambda(brush.face(faceIndex));
+                });
             });
 
             if (success) {
                 auto newNodes = std::vector<std::pair<Model::Node*, Model::NodeContents>>{};
-                newNodes.reserve(brushes.size());
+                newNodes.reserve(brushNodes.size());
 
-                for (auto& [brushNode, brush] : brushes) {
-                    newNodes.emplace_back(brushNode, Model::NodeContents(std::move(brush)));
+                for (size_t i = 0; i < brushNodes.size(); ++i) {
+                    newNodes.emplace_back(brushNodes[i], Model::NodeContents(std::move(*brushes[i])));
                 }
 
                 auto linkedGroupsToUpdate = findContainingLinkedGroupsToUpdate(*document.world(), kdl::vec_transform(newNodes, [](const auto& p) { return p.first; }));
@@ -322,6 +430,7 @@ namespace TrenchBroom {
         m_lastSelectionBounds(0.0, 32.0),
         m_selectionBoundsValid(true),
         m_viewEffectsService(nullptr),
+        m_changeCount(0),
         m_repeatStack(std::make_unique<RepeatStack>()) {
             bindObservers();
         }
@@ -507,29 +616,159 @@ namespace TrenchBroom {
             documentWasLoadedNotifier(this);
         }
 
-        void MapDocument::saveDocument() {
-            doSaveDocument(m_path);
+        size_t MapDocument::saveDocument() {
+            return doSaveDocument(m_path);
         }
 
-        void MapDocument::saveDocumentAs(const IO::Path& path) {
-            doSaveDocument(path);
+        size_t MapDocument::saveDocumentAs(const IO::Path& path) {
+            return doSaveDocument(path);
         }
 
-        void MapDocument::saveDocumentTo(const IO::Path& path) {
+        size_t MapDocument::saveDocumentTo(const IO::Path& path) {
             ensure(m_game.get() != nullptr, "game is null");
             ensure(m_world != nullptr, "world is null");
-            m_game->writeMap(*m_world, path);
+            return m_game->writeMap(*m_world, path);
         }
 
         void MapDocument::exportDocumentAs(const Model::ExportFormat format, const IO::Path& path) {
             m_game->exportMap(*m_world, format, path);
         }
 
-        void MapDocument::doSaveDocument(const IO::Path& path) {
-            saveDocumentTo(path);
+        /**
+         * Returns a copy of the given node and its descendants for a world snapshot. A brush or patch whose serialization
+         * in the given map format is cached is replaced by an empty brush that shares the cached serialization because
+         * that is all that writing it needs. All other brushes and patches are copied and recorded in `copiedNodes`.
+         *
+         * The persistent IDs are set before the copies are added to their parents, otherwise new IDs are assigned.
+         */
+        static Model::Node* createSnapshot(const Model::Node* node, const vm::bbox3& worldBounds, const Model::MapFormat mapFormat, std::vector<std::pair<const Model::Node*, const Model::Node*>>& copiedNodes) {
+            const auto addChildSnapshots = [&](const Model::Node* original, Model::Node* copy) {
+                copy->addChildren(kdl::vec_transform(original->children(), [&](const auto* child) {
+                    return createSnapshot(child, worldBounds, mapFormat, copiedNodes);
+                }));
+                return copy;
+            };
+
+            const auto copyNode = [&](const Model::Node* original) {
+                auto* copy = original->clone(worldBounds);
+                copiedNodes.emplace_back(original, copy);
+                return copy;
+            };
+
+            return node->accept(kdl::overload(
+                [] (const Model::WorldNode*) -> Model::Node* { ensure(false, "world is not part of its snapshot"); },
+                [&](const Model::LayerNode* layerNode) -> Model::Node* {
+                    auto* layerCopy = static_cast<Model::LayerNode*>(layerNode->clone(worldBounds));
+                    if (const auto& persistentId = layerNode->persistentId()) {
+                        layerCopy->setPersistentId(*persistentId);
+                    }
+                    return addChildSnapshots(layerNode, layerCopy);
+                },
+                [&](const Model::GroupNode* groupNode) -> Model::Node* {
+                    auto* groupCopy = static_cast<Model::GroupNode*>(groupNode->clone(worldBounds));
+                    if (const auto& persistentId = groupNode->persistentId()) {
+                        groupCopy->setPersistentId(*persistentId);
+                    }
+                    return addChildSnapshots(groupNode, groupCopy);
+                },
+                [&](const Model::EntityNode* entityNode) -> Model::Node* {
+                    return addChildSnapshots(entityNode, entityNode->clone(worldBounds));
+                },
+                [&](const Model::BrushNode* brushNode) -> Model::Node* {
+                    if (auto serialization = brushNode->cachedSerialization(mapFormat)) {
+                        auto* placeholder = new Model::BrushNode(Model::Brush());
+                        placeholder->setCachedSerialization(std::move(serialization));
+                        return placeholder;
+                    }
+                    return copyNode(brushNode);
+                },
+                [&](const Model::PatchNode* patchNode) -> Model::Node* {
+                    return copyNode(patchNode);
+                }
+            ));
+        }
+
+        MapDocument::WorldSnapshot MapDocument::createWorldSnapshot() const {
+            ensure(m_world != nullptr, "world is null");
+
+            const auto mapFormat = m_world->mapFormat();
+            auto snapshot = WorldSnapshot{std::make_unique<Model::WorldNode>(m_world->entity(), mapFormat), {}, m_changeCount};
+            snapshot.world->disableNodeTreeUpdates();
+
+            const auto* defaultLayer = m_world->defaultLayer();
+            auto* defaultLayerCopy = snapshot.world->defaultLayer();
+            defaultLayerCopy->setLayer(defaultLayer->layer());
+            defaultLayerCopy->setVisibilityState(defaultLayer->visibilityState());
+            defaultLayerCopy->setLockState(defaultLayer->lockState());
+            defaultLayerCopy->addChildren(kdl::vec_transform(defaultLayer->children(), [&](const auto* child) {
+                return createSnapshot(child, m_worldBounds, mapFormat, snapshot.copiedNodes);
+            }));
+
+            for (const auto* customLayer : m_world->customLayers()) {
+                snapshot.world->addChild(createSnapshot(customLayer, m_worldBounds, mapFormat, snapshot.copiedNodes));
+            }
+
+            // the snapshot must not refer to any assets because they may be unloaded while it exists
+            snapshot.world->accept(kdl::overload(
+                [](auto&& thisLambda, Model::WorldNode* world)   { world->setDefinition(nullptr); world->visitChildren(thisLambda); },
+                [](auto&& thisLambda, Model::LayerNode* layer)   { layer->visitChildren(thisLambda); },
+                [](auto&& thisLambda, Model::GroupNode* group)   { group->visitChildren(thisLambda); },
+                [](auto&& thisLambda, Model::EntityNode* entity) {
+                    entity->setDefinition(nullptr);
+                    entity->setModelFrame(nullptr);
+                    entity->visitChildren(thisLambda);
+                },
+                [](Model::BrushNode* brush) { brush->unsetFaceTextures(); },
+                [](Model::PatchNode* patch) { patch->setTexture(nullptr); }
+            ));
+
+            return snapshot;
+        }
+
+        void MapDocument::cacheSnapshotSerializations(const std::vector<std::pair<const Model::Node*, std::shared_ptr<const Model::NodeSerialization>>>& serializations, const size_t changeCount) {
+            // the nodes may have changed or may have been deleted since the snapshot was created
+            if (changeCount != m_changeCount) {
+                return;
+            }
+
+            for (const auto& [node, serialization] : serializations) {
+                if (serialization != nullptr) {
+                    node->setCachedSerialization(serialization);
+                }
+            }
+        }
+
+        std::pair<size_t, size_t> MapDocument::countCachedSerializations() const {
+            const Model::WorldNode& world = *m_world;
+            const auto mapFormat = world.mapFormat();
+
+            auto cached = size_t(0);
+            auto total = size_t(0);
+            const auto count = [&](const Model::Node* node) {
+                if (node->cachedSerialization(mapFormat) != nullptr) {
+                    ++cached;
+                }
+                ++total;
+            };
+
+            world.accept(kdl::overload(
+                [](auto&& thisLambda, const Model::WorldNode* w) { w->visitChildren(thisLambda); },
+                [](auto&& thisLambda, const Model::LayerNode* layer) { layer->visitChildren(thisLambda); },
+                [](auto&& thisLambda, const Model::GroupNode* group) { group->visitChildren(thisLambda); },
+                [](auto&& thisLambda, const Model::EntityNode* entity) { entity->visitChildren(thisLambda); },
+                [&](const Model::BrushNode* brush) { count(brush); },
+                [&](const Model::PatchNode* patch) { count(patch); }
+            ));
+
+            return {cached, total};
+        }
+
+        size_t MapDocument::doSaveDocument(const IO::Path& path) {
+            const auto reusedSerializationCount = saveDocumentTo(path);
             setLastSaveModificationCount();
             setPath(path);
             documentWasSavedNotifier(this);
+            return reusedSerializationCount;
         }
 
         void MapDocument::clearDocument() {
@@ -542,6 +781,7 @@ namespace TrenchBroom {
                 clearTagActions();
                 clearWorld();
                 clearModificationCount();
+                ++m_changeCount;
 
                 documentWasClearedNotifier(this);
             }
@@ -900,7 +1140,7 @@ namespace TrenchBroom {
 
         void MapDocument::selectTouching(const bool del) {
             const auto nodes = kdl::vec_filter(
-                Model::collectTouchingNodes(std::vector<Model::Node*>{m_world.get()}, m_selectedNodes.brushes()),
+                Model::collectTouchingNodes(*m_world, m_selectedNodes.brushes()),
                 [&](Model::Node* node) { return m_editorContext->selectable(node); });
 
             Transaction transaction(this, "Select Touching");
@@ -913,7 +1153,7 @@ namespace TrenchBroom {
 
         void MapDocument::selectInside(const bool del) {
             const auto nodes = kdl::vec_filter(
-                Model::collectContainedNodes(std::vector<Model::Node*>{m_world.get()}, m_selectedNodes.brushes()),
+                Model::collectContainedNodes(*m_world, m_selectedNodes.brushes()),
                 [&](Model::Node* node) { return m_editorContext->selectable(node); });
 
             Transaction transaction(this, "Select Inside");
@@ -1040,7 +1280,7 @@ namespace TrenchBroom {
                 deleteObjects();
 
                 const auto nodesToSelect = kdl::vec_filter(
-                    Model::collectContainedNodes(std::vector<Model::Node*>{world()}, kdl::vec_transform(tallBrushes, [](const auto& b) { return b.get(); })), 
+                    Model::collectContainedNodes(*world(), kdl::vec_transform(tallBrushes, [](const auto& b) { return b.get(); })), 
                     [&](const auto* node) { return editorContext().selectable(node); });
                 select(nodesToSelect);
             }).handle_errors([&](const Model::BrushError& e) {
@@ -2032,32 +2272,44 @@ namespace TrenchBroom {
                 ));
             }
 
-            auto nodesToUpdate = std::vector<std::pair<Model::Node*, Model::NodeContents>>{};
-            nodesToUpdate.reserve(nodesToTransform.size());
-            for (auto* node : nodesToTransform) {
-                bool success = true;
-
-                node->accept(kdl::overload(
-                    [&](Model::WorldNode*) {},
-                    [&](Model::LayerNode*) {},
-                    [&](Model::GroupNode* groupNode) {
+            // Copying an entity changes the usage count of its definition, which notifies observers, so groups and entities are transformed on
+            // this thread. Brushes and patches are copied and transformed in parallel.
+            auto transformedContents = kdl::vec_transform(nodesToTransform, [&](auto* node) {
+                return node->accept(kdl::overload(
+                    [] (const Model::WorldNode*) -> std::optional<NodeContentType> { return std::nullopt; },
+                    [] (const Model::LayerNode*) -> std::optional<NodeContentType> { return std::nullopt; },
+                    [&](const Model::GroupNode* groupNode) -> std::optional<NodeContentType> {
                         auto group = groupNode->group();
                         group.transform(transformation);
-                        nodesToUpdate.emplace_back(groupNode, std::move(group));
+                        return group;
                     },
-                    [&](Model::EntityNode* entityNode) {
+                    [&](const Model::EntityNode* entityNode) -> std::optional<NodeContentType> {
                         auto entity = entityNode->entity();
                         entity.transform(transformation);
-                        nodesToUpdate.emplace_back(entityNode, std::move(entity));
+                        return entity;
                     },
+                    [] (const Model::BrushNode*) -> std::optional<NodeContentType> { return std::nullopt; },
+                    [] (const Model::PatchNode*) -> std::optional<NodeContentType> { return std::nullopt; }
+                ));
+            });
+
+            const auto textureLock = pref(Preferences::TextureLock);
+            const auto transformed = applyInParallel(*this, nodesToTransform.size(), [&](const size_t index) {
+                bool success = true;
+
+                nodesToTransform[index]->accept(kdl::overload(
+                    [] (Model::WorldNode*) {},
+                    [] (Model::LayerNode*) {},
+                    [] (Model::GroupNode*) {},
+                    [] (Model::EntityNode*) {},
                     [&](Model::BrushNode* brushNode) {
-                        const bool lockTextures = pref(Preferences::TextureLock)
+                        const bool lockTextures = textureLock
                             || (Model::findContainingLinkedGroup(*brushNode) != nullptr);
 
                         auto brush = brushNode->brush();
                         brush.transform(m_worldBounds, transformation, lockTextures)
                             .and_then([&](){
-                                nodesToUpdate.emplace_back(brushNode, std::move(brush));
+                                transformedContents[index] = std::move(brush);
                             }).handle_errors([&](const Model::BrushError e) {
                                 error() << "Could not transform brush: " << e;
                                 success = false;
@@ -2066,12 +2318,22 @@ namespace TrenchBroom {
                     [&](Model::PatchNode* patchNode) {
                         auto patch = patchNode->patch();
                         patch.transform(transformation);
-                        nodesToUpdate.emplace_back(patchNode, std::move(patch));
+                        transformedContents[index] = std::move(patch);
                     }
                 ));
 
-                if (!success) {
-                    return false;
+                return success;
+            });
+
+            if (!transformed) {
+                return false;
+            }
+
+            auto nodesToUpdate = std::vector<std::pair<Model::Node*, Model::NodeContents>>{};
+            nodesToUpdate.reserve(nodesToTransform.size());
+            for (size_t i = 0; i < nodesToTransform.size(); ++i) {
+                if (transformedContents[i]) {
+                    nodesToUpdate.emplace_back(nodesToTransform[i], Model::NodeContents(std::move(*transformedContents[i])));
                 }
             }
 
@@ -2186,30 +2448,55 @@ namespace TrenchBroom {
         }
 
         bool MapDocument::csgSubtract() {
+            auto progressMonitor = NullProgressMonitor{};
+            return csgSubtract(progressMonitor);
+        }
+
+        bool MapDocument::csgSubtract(ProgressMonitor& progressMonitor) {
             const auto subtrahendNodes = std::vector<Model::BrushNode*>{selectedNodes().brushes()};
             if (subtrahendNodes.empty()) {
                 return false;
             }
 
-            Transaction transaction(this, "CSG Subtract");
-            // Select touching, but don't delete the subtrahends yet
-            selectTouching(false);
+            deferPreferenceChanges();
+            const auto applyPreferenceChanges = kdl::invoke_later{[&]() { applyDeferredPreferenceChanges(); }};
 
-            const auto minuendNodes = std::vector<Model::BrushNode*>{selectedNodes().brushes()};
-            const auto subtrahends = kdl::vec_transform(subtrahendNodes, [](const auto* subtrahendNode) { return &subtrahendNode->brush(); });
+            // Reporting the progress may process pending events, so the fragments are computed from copies of the brushes
+            const auto minuendNodes = Model::filterBrushNodes(kdl::vec_filter(
+                Model::collectTouchingNodes(*m_world, subtrahendNodes),
+                [&](Model::Node* node) { return m_editorContext->selectable(node); }));
+            const auto minuends = kdl::vec_transform(minuendNodes, [](const auto* minuendNode) { return minuendNode->brush(); });
+            const auto subtrahends = kdl::vec_transform(subtrahendNodes, [](const auto* subtrahendNode) { return subtrahendNode->brush(); });
+            const auto subtrahendPtrs = kdl::vec_transform(subtrahends, [](const auto& subtrahend) { return &subtrahend; });
 
-            auto toAdd = std::map<Model::Node*, std::vector<Model::Node*>>{};
-            auto toRemove = std::vector<Model::Node*>{std::begin(subtrahendNodes), std::end(subtrahendNodes)};
+            const auto mapFormat = m_world->mapFormat();
+            const auto textureName = currentTextureName();
+            const auto changeCount = m_changeCount;
 
-            for (auto* minuendNode : minuendNodes) {
-                const Model::Brush& minuend = minuendNode->brush();
-                auto currentSubtractionResults = minuend.subtract(m_world->mapFormat(), m_worldBounds, currentTextureName(), subtrahends);
-                auto currentBrushes = kdl::collect_values(std::move(currentSubtractionResults), [&](const Model::BrushError& e) { 
+            auto fragments = std::vector<std::vector<Model::Brush>>(minuends.size());
+            const auto completed = applyInParallel(*this, progressMonitor, minuends.size(), [&](const size_t index) {
+                auto currentSubtractionResults = minuends[index].subtract(mapFormat, m_worldBounds, textureName, subtrahendPtrs);
+                fragments[index] = kdl::collect_values(std::move(currentSubtractionResults), [&](const Model::BrushError& e) { 
                     error() << "Could not create brush: " << e;
                 });
+                return true;
+            });
+
+            if (!completed) {
+                return false;
+            }
+            if (m_changeCount != changeCount) {
+                warn() << "The document was changed while subtracting brushes, discarding the result";
+                return false;
+            }
+
+            auto toAdd = std::map<Model::Node*, std::vector<Model::Node*>>{};
+            auto toRemove = std::vector<Model::Node*>{std::begin(subtrahendNodes), std::end(subtrahendNodes)};
 
-                if (!currentBrushes.empty()) {
-                    auto resultNodes = kdl::vec_transform(std::move(currentBrushes), [&](auto b) { return new Model::BrushNode(std::move(b)); });
+            for (size_t i = 0; i < minuendNodes.size(); ++i) {
+                auto* minuendNode = minuendNodes[i];
+                if (!fragments[i].empty()) {
+                    auto resultNodes = kdl::vec_transform(std::move(fragments[i]), [&](auto b) { return new Model::BrushNode(std::move(b)); });
                     auto& toAddForParent = toAdd[minuendNode->parent()];
                     toAddForParent = kdl::vec_concat(std::move(toAddForParent), std::move(resultNodes));
                 }
@@ -2217,6 +2504,7 @@ namespace TrenchBroom {
                 toRemove.push_back(minuendNode);
             }
 
+            Transaction transaction(this, "CSG Subtract");
             deselectAll();
             const auto added = addNodes(toAdd);
             removeNodes(toRemove);
@@ -2260,35 +2548,57 @@ namespace TrenchBroom {
         }
 
         bool MapDocument::csgHollow() {
+            auto progressMonitor = NullProgressMonitor{};
+            return csgHollow(progressMonitor);
+        }
+
+        bool MapDocument::csgHollow(ProgressMonitor& progressMonitor) {
             const std::vector<Model::BrushNode*> brushNodes = selectedNodes().brushes();
             if (brushNodes.empty()) {
                 return false;
             }
 
-            bool didHollowAnything = false;
-            std::vector<std::pair<Model::BrushNode*, std::vector<Model::Brush>>> fragmentsAndSourceNodes =
-                kdl::vec_transform(brushNodes, [&](Model::BrushNode* brushNode) {
-                    const auto& originalBrush = brushNode->brush();
+            const auto mapFormat = m_world->mapFormat();
+            const auto textureName = currentTextureName();
+            const auto thickness = static_cast<FloatType>(m_grid->actualSize());
+            const auto changeCount = m_changeCount;
 
-                    auto shrunkenBrush = originalBrush;
-                    std::vector<Model::Brush> fragments;
-                    shrunkenBrush.expand(m_worldBounds, -1.0 * static_cast<FloatType>(m_grid->actualSize()), true)
-                        .and_then([&]() {
-                            didHollowAnything = true;
+            deferPreferenceChanges();
+            const auto applyPreferenceChanges = kdl::invoke_later{[&]() { applyDeferredPreferenceChanges(); }};
 
-                            auto subtractionResults = originalBrush.subtract(m_world->mapFormat(), m_worldBounds, currentTextureName(), shrunkenBrush);
-                            fragments = kdl::collect_values(std::move(subtractionResults), [&](const Model::BrushError& e) { 
-                                error() << "Could not create brush: " << e;
-                            });
-                        }).handle_errors([&](const Model::BrushError& e) {
-                            error() << "Could not hollow brush: " << e;
-                            fragments = { originalBrush };
-                        });
+            // Reporting the progress may process pending events, so the fragments are computed from copies of the brushes
+            const auto originalBrushes = kdl::vec_transform(brushNodes, [](const auto* brushNode) { return brushNode->brush(); });
 
-                    return std::make_pair(brushNode, std::move(fragments));
-                });
+            auto didHollowAnything = std::atomic<bool>{false};
+            auto fragmentsAndSourceNodes = kdl::vec_transform(brushNodes, [](Model::BrushNode* brushNode) {
+                return std::make_pair(brushNode, std::vector<Model::Brush>{});
+            });
+
+            const auto completed = applyInParallel(*this, progressMonitor, brushNodes.size(), [&](const size_t index) {
+                auto& fragments = fragmentsAndSourceNodes[index].second;
+                const auto& originalBrush = originalBrushes[index];
+
+                auto shrunkenBrush = originalBrush;
+                shrunkenBrush.expand(m_worldBounds, -1.0 * thickness, true)
+                    .and_then([&]() {
+                        didHollowAnything = true;
+
+                        auto subtractionResults = originalBrush.subtract(mapFormat, m_worldBounds, textureName, shrunkenBrush);
+                        fragments = kdl::collect_values(std::move(subtractionResults), [&](const Model::BrushError& e) { 
+                            error() << "Could not create brush: " << e;
+                        });
+                    }).handle_errors([&](const Model::BrushError& e) {
+                        error() << "Could not hollow brush: " << e;
+                        fragments = { originalBrush };
+                    });
+                return true;
+            });
 
-            if (!didHollowAnything) {
+            if (!completed || !didHollowAnything) {
+                return false;
+            }
+            if (m_changeCount != changeCount) {
+                warn() << "The document was changed while hollowing brushes, discarding the result";
                 return false;
             }
 
@@ -2517,6 +2827,7 @@ namespace TrenchBroom {
 
         bool MapDocument::resizeBrushes(const std::vector<vm::polygon3>& faces, const vm::vec3& delta) {
             const auto nodes = m_selectedNodes.nodes();
+            const auto textureLock = pref(Preferences::TextureLock);
             return applyAndSwap(*this, "Resize Brushes", nodes, findContainingLinkedGroupsToUpdate(*m_world, nodes), kdl::overload(
                 [] (Model::Layer&)       { return true; },
                 [] (Model::Group&)       { return true; },
@@ -2528,7 +2839,7 @@ namespace TrenchBroom {
                         return true;
                     }
 
-                    return brush.moveBoundary(m_worldBounds, *faceIndex, delta, pref(Preferences::TextureLock))
+                    return brush.moveBoundary(m_worldBounds, *faceIndex, delta, textureLock)
                         .visit(kdl::overload(
                             [&]() {
                                 return m_worldBounds.contains(brush.bounds());
@@ -2599,9 +2910,10 @@ namespace TrenchBroom {
         }
 
         bool MapDocument::snapVertices(const FloatType snapTo) {
-            size_t succeededBrushCount = 0;
-            size_t failedBrushCount = 0;
+            auto succeededBrushCount = std::atomic<size_t>{0};
+            auto failedBrushCount = std::atomic<size_t>{0};
 
+            const auto uvLock = pref(Preferences::UVLock);
             const auto allSelectedBrushes = m_selectedNodes.brushesRecursively();
             applyAndSwap(*this, "Snap Brush Vertices", allSelectedBrushes, findContainingLinkedGroupsToUpdate(*m_world, allSelectedBrushes), kdl::overload(
                 [] (Model::Layer&)  { return true; },
@@ -2609,7 +2921,7 @@ namespace TrenchBroom {
                 [] (Model::Entity&) { return true; },
                 [&](Model::Brush& originalBrush) {
                     if (originalBrush.canSnapVertices(m_worldBounds, snapTo)) {
-                        originalBrush.snapVertices(m_worldBounds, snapTo, pref(Preferences::UVLock))
+                        originalBrush.snapVertices(m_worldBounds, snapTo, uvLock)
                             .and_then([&]() {
                                 succeededBrushCount += 1;
                             }).handle_errors([&](const Model::BrushError e) {
@@ -2624,23 +2936,25 @@ namespace TrenchBroom {
                 [] (Model::BezierPatch&) { return true; }
             ));
 
-            if (succeededBrushCount > 0) {
-                info(kdl::str_to_string("Snapped vertices of ", succeededBrushCount, " ", kdl::str_plural(succeededBrushCount, "brush", "brushes")));
+            if (const size_t succeeded = succeededBrushCount; succeeded > 0) {
+                info(kdl::str_to_string("Snapped vertices of ", succeeded, " ", kdl::str_plural(succeeded, "brush", "brushes")));
             }
-            if (failedBrushCount > 0) {
-                info(kdl::str_to_string("Failed to snap vertices of ", failedBrushCount, " ", kdl::str_plural(failedBrushCount, "brush", "brushes")));
+            if (const size_t failed = failedBrushCount; failed > 0) {
+                info(kdl::str_to_string("Failed to snap vertices of ", failed, " ", kdl::str_plural(failed, "brush", "brushes")));
             }
 
             return true;
         }
 
         MapDocument::MoveVerticesResult MapDocument::moveVertices(std::vector<vm::vec3> vertexPositions, const vm::vec3& delta) {
-            auto newVertexPositions = std::vector<vm::vec3>{};
-            auto newNodes = applyToNodeContents(m_selectedNodes.nodes(), kdl::overload(
+            // one slot per node so that the new positions are in the order of the nodes
+            auto newVertexPositionsPerNode = std::vector<std::vector<vm::vec3>>(m_selectedNodes.nodes().size());
+            const auto uvLock = pref(Preferences::UVLock);
+            auto newNodes = applyToNodeContents(*this, m_selectedNodes.nodes(), kdl::overload(
                 [] (Model::Layer&) { return true; },
                 [] (Model::Group&) { return true; },
                 [] (Model::Entity&) { return true; },
-                [&](Model::Brush& brush) {
+                [&](Model::Brush& brush, const size_t index) {
                     const auto verticesToMove = kdl::vec_filter(vertexPositions, [&](const auto& vertex) { return brush.hasVertex(vertex); });
                     if (verticesToMove.empty()) {
                         return true;
@@ -2650,10 +2964,9 @@ namespace TrenchBroom {
                         return false;
                     }
 
-                    return brush.moveVertices(m_worldBounds, verticesToMove, delta, pref(Preferences::UVLock))
+                    return brush.moveVertices(m_worldBounds, verticesToMove, delta, uvLock)
                         .and_then([&]() {
-                            auto newPositions = brush.findClosestVertexPositions(verticesToMove + delta);
-                            newVertexPositions = kdl::vec_concat(std::move(newVertexPositions), std::move(newPositions));
+                            newVertexPositionsPerNode[index] = brush.findClosestVertexPositions(verticesToMove + delta);
                         }).handle_errors([&](const Model::BrushError e) {
                             error() << "Could not move brush vertices: " << e;
                         });
@@ -2662,6 +2975,7 @@ namespace TrenchBroom {
             ));
 
             if (newNodes) {
+                auto newVertexPositions = kdl::vec_flatten(std::move(newVertexPositionsPerNode));
                 kdl::vec_sort_and_remove_duplicates(newVertexPositions);
 
                 const auto commandName = kdl::str_plural(vertexPositions.size(), "Move Brush Vertex", "Move Brush Vertices");
@@ -2678,12 +2992,14 @@ namespace TrenchBroom {
         }
 
         bool MapDocument::moveEdges(std::vector<vm::segment3> edgePositions, const vm::vec3& delta) {
-            auto newEdgePositions = std::vector<vm::segment3>{};
-            auto newNodes = applyToNodeContents(m_selectedNodes.nodes(), kdl::overload(
+            // one slot per node so that the new positions are in the order of the nodes
+            auto newEdgePositionsPerNode = std::vector<std::vector<vm::segment3>>(m_selectedNodes.nodes().size());
+            const auto uvLock = pref(Preferences::UVLock);
+            auto newNodes = applyToNodeContents(*this, m_selectedNodes.nodes(), kdl::overload(
                 [] (Model::Layer&) { return true; },
                 [] (Model::Group&) { return true; },
                 [] (Model::Entity&) { return true; },
-                [&](Model::Brush& brush) {
+                [&](Model::Brush& brush, const size_t index) {
                     const auto edgesToMove = kdl::vec_filter(edgePositions, [&](const auto& edge) { return brush.hasEdge(edge); });
                     if (edgesToMove.empty()) {
                         return true;
@@ -2693,12 +3009,11 @@ namespace TrenchBroom {
                         return false;
                     }
 
-                    return brush.moveEdges(m_worldBounds, edgesToMove, delta, pref(Preferences::UVLock))
+                    return brush.moveEdges(m_worldBounds, edgesToMove, delta, uvLock)
                         .and_then([&]() {
-                            auto newPositions = brush.findClosestEdgePositions(kdl::vec_transform(edgesToMove, [&](const auto& edge) {
+                            newEdgePositionsPerNode[index] = brush.findClosestEdgePositions(kdl::vec_transform(edgesToMove, [&](const auto& edge) {
                                 return edge.translate(delta);
                             }));
-                            newEdgePositions = kdl::vec_concat(std::move(newEdgePositions), std::move(newPositions));
                         }).handle_errors([&](const Model::BrushError e) {
                             error() << "Could not move brush edges: " << e;
                         });
@@ -2707,6 +3022,7 @@ namespace TrenchBroom {
             ));
 
             if (newNodes) {
+                auto newEdgePositions = kdl::vec_flatten(std::move(newEdgePositionsPerNode));
                 kdl::vec_sort_and_remove_duplicates(newEdgePositions);
 
                 const auto commandName = kdl::str_plural(edgePositions.size(), "Move Brush Edge", "Move Brush Edges");
@@ -2718,12 +3034,14 @@ namespace TrenchBroom {
         }
 
         bool MapDocument::moveFaces(std::vector<vm::polygon3> facePositions, const vm::vec3& delta) {
-            auto newFacePositions = std::vector<vm::polygon3>{};
-            auto newNodes = applyToNodeContents(m_selectedNodes.nodes(), kdl::overload(
+            // one slot per node so that the new positions are in the order of the nodes
+            auto newFacePositionsPerNode = std::vector<std::vector<vm::polygon3>>(m_selectedNodes.nodes().size());
+            const auto uvLock = pref(Preferences::UVLock);
+            auto newNodes = applyToNodeContents(*this, m_selectedNodes.nodes(), kdl::overload(
                 [] (Model::Layer&) { return true; },
                 [] (Model::Group&) { return true; },
                 [] (Model::Entity&) { return true; },
-                [&](Model::Brush& brush) {
+                [&](Model::Brush& brush, const size_t index) {
                     const auto facesToMove = kdl::vec_filter(facePositions, [&](const auto& face) { return brush.hasFace(face); });
                     if (facesToMove.empty()) {
                         return true;
@@ -2733,12 +3051,11 @@ namespace TrenchBroom {
                         return false;
                     }
 
-                    return brush.moveFaces(m_worldBounds, facesToMove, delta, pref(Preferences::UVLock))
+                    return brush.moveFaces(m_worldBounds, facesToMove, delta, uvLock)
                         .and_then([&]() {
-                            auto newPositions = brush.findClosestFacePositions(kdl::vec_transform(facesToMove, [&](const auto& face) {
+                            newFacePositionsPerNode[index] = brush.findClosestFacePositions(kdl::vec_transform(facesToMove, [&](const auto& face) {
                                 return face.translate(delta);
                             }));
-                            newFacePositions = kdl::vec_concat(std::move(newFacePositions), std::move(newPositions));
                         }).handle_errors([&](const Model::BrushError e) {
                             error() << "Could not move brush faces: " << e;
                         });
@@ -2747,6 +3064,7 @@ namespace TrenchBroom {
             ));
 
             if (newNodes) {
+                auto newFacePositions = kdl::vec_flatten(std::move(newFacePositionsPerNode));
                 kdl::vec_sort_and_remove_duplicates(newFacePositions);
 
                 const auto commandName = kdl::str_plural(facePositions.size(), "Move Brush Face", "Move Brush Faces");
@@ -2758,7 +3076,7 @@ namespace TrenchBroom {
         }
 
         bool MapDocument::addVertex(const vm::vec3& vertexPosition) {
-            auto newNodes = applyToNodeContents(m_selectedNodes.nodes(), kdl::overload(
+            auto newNodes = applyToNodeContents(*this, m_selectedNodes.nodes(), kdl::overload(
                 [] (Model::Layer&) { return true; },
                 [] (Model::Group&) { return true; },
                 [] (Model::Entity&) { return true; },
@@ -2784,7 +3102,7 @@ namespace TrenchBroom {
         }
 
         bool MapDocument::removeVertices(const std::string& commandName, std::vector<vm::vec3> vertexPositions) {
-            auto newNodes = applyToNodeContents(m_selectedNodes.nodes(), kdl::overload(
+            auto newNodes = applyToNodeContents(*this, m_selectedNodes.nodes(), kdl::overload(
                 [] (Model::Layer&) { return true; },
                 [] (Model::Group&) { return true; },
                 [] (Model::Entity&) { return true; },
@@ -2882,10 +3200,18 @@ namespace TrenchBroom {
             return doGetRedoCommandName();
         }
 
+        size_t MapDocument::undoStackMemorySize() const {
+            return doGetUndoStackMemorySize();
+        }
+
         void MapDocument::undoCommand() {
             doUndoCommand();
         }
 
+        size_t MapDocument::undoMemoryBudget() {
+            return static_cast<size_t>(std::max(0, pref(Preferences::UndoMemoryBudget))) * 1024u * 1024u;
+        }
+
         void MapDocument::redoCommand() {
             doRedoCommand();
         }
@@ -2948,6 +3274,49 @@ namespace TrenchBroom {
             return result;
         }
 
+        void MapDocument::evictBrushGeometry(const size_t memoryBudget) {
+            if (m_world == nullptr || memoryBudget == 0u || Model::Brush::geometryMemorySize() <= memoryBudget) {
+                return;
+            }
+
+            // a long running operation may be reading brush geometry on other threads while it reports its progress
+            if (m_deferredPreferenceChanges) {
+                return;
+            }
+
+            auto candidates = std::vector<Model::BrushNode*>{};
+            m_world->accept(kdl::overload(
+                [] (auto&& thisLambda, Model::WorldNode* world)   { world->visitChildren(thisLambda); },
+                [] (auto&& thisLambda, Model::LayerNode* layer)   { layer->visitChildren(thisLambda); },
+                [] (auto&& thisLambda, Model::GroupNode* group)   { group->visitChildren(thisLambda); },
+                [] (auto&& thisLambda, Model::EntityNode* entity) { entity->visitChildren(thisLambda); },
+                [&](Model::BrushNode* brush) {
+                    // tools and commands only hold on to the geometry of selected brushes, including the brushes of selected groups and entities
+                    if (brush->brush().hasGeometry() && !brush->transitivelySelected() && !brush->hasSelectedFaces()) {
+                        candidates.push_back(brush);
+                    }
+                },
+                [] (Model::PatchNode*)                            {}
+            ));
+
+            // release the least recently used geometry first and stop once the budget is met so that the geometry of
+            // the brushes that are currently rendered or picked isn't rebuilt over and over
+            std::stable_sort(std::begin(candidates), std::end(candidates), [](const auto* lhs, const auto* rhs) {
+                return lhs->brush().lastGeometryAccess() < rhs->brush().lastGeometryAccess();
+            });
+
+            for (auto* brush : candidates) {
+                if (Model::Brush::geometryMemorySize() <= memoryBudget) {
+                    break;
+                }
+                brush->releaseBrushGeometry();
+            }
+
+            // the polyhedron pools keep the freed memory otherwise
+            Model::Brush::releaseUnusedGeometryMemory();
+            Model::Brush::advanceGeometryAccessClock();
+        }
+
         void MapDocument::createWorld(const Model::MapFormat mapFormat, const vm::bbox3& worldBounds, std::shared_ptr<Model::Game> game) {
             m_worldBounds = worldBounds;
             m_game = game;
@@ -3108,7 +3477,7 @@ namespace TrenchBroom {
                 [&](Model::BrushNode* brushNode) { 
                     const Model::Brush& brush = brushNode->brush();
                     for (size_t i = 0u; i < brush.faceCount(); ++i) {
-                        const Model::BrushFace& face = brush.face(i);
+                        const Model::BrushFace& face = brush.facesWithoutGeometry()[i];
                         Assets::Texture* texture = manager.texture(face.attributes().textureName());
                         brushNode->setFaceTexture(i, texture);
                     }
@@ -3583,6 +3952,11 @@ namespace TrenchBroom {
         }
 
         void MapDocument::preferenceDidChange(const IO::Path& path) {
+            if (m_deferredPreferenceChanges) {
+                m_deferredPreferenceChanges->push_back(path);
+                return;
+            }
+
             if (isGamePathPreference(path)) {
                 const Model::GameFactory& gameFactory = Model::GameFactory::instance();
                 const IO::Path newGamePath = gameFactory.gamePath(m_game->gameName());
@@ -3597,14 +3971,33 @@ namespace TrenchBroom {
                        path == Preferences::TextureMagFilter.path()) {
                 m_entityModelManager->setTextureMode(pref(Preferences::TextureMinFilter), pref(Preferences::TextureMagFilter));
                 m_textureManager->setTextureMode(pref(Preferences::TextureMinFilter), pref(Preferences::TextureMagFilter));
+            } else if (path == Preferences::UndoMemoryBudget.path()) {
+                doSetUndoMemoryBudget(undoMemoryBudget());
+            }
+        }
+
+        void MapDocument::deferPreferenceChanges() {
+            assert(!m_deferredPreferenceChanges);
+            m_deferredPreferenceChanges = std::vector<IO::Path>{};
+        }
+
+        void MapDocument::applyDeferredPreferenceChanges() {
+            assert(m_deferredPreferenceChanges);
+            const auto paths = std::move(*m_deferredPreferenceChanges);
+            m_deferredPreferenceChanges = std::nullopt;
+
+            for (const auto& path : paths) {
+                preferenceDidChange(path);
             }
         }
 
         void MapDocument::commandDone(Command* command) {
+            ++m_changeCount;
             debug() << "Command '" << command->name() << "' executed";
         }
 
         void MapDocument::commandUndone(UndoableCommand* command) {
+            ++m_changeCount;
             debug() << "Command '" << command->name() << "' undone";
         }
 
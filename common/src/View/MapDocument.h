@@ -36,11 +36,13 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 #include <variant>
 #include <vector>
 
 namespace TrenchBroom {
     class Color;
+    class ProgressMonitor;
 
     namespace Assets {
         class EntityDefinition;
@@ -62,6 +64,7 @@ namespace TrenchBroom {
         class Game;
         class Issue;
         enum class MapFormat;
+        struct NodeSerialization;
         class PickResult;
         class PointFile;
         class PortalFile;
@@ -125,6 +128,19 @@ namespace TrenchBroom {
 
             ViewEffectsService* m_viewEffectsService;
 
+            /*
+             * Reporting the progress of a long running operation may process pending events. Preference changes that
+             * arrive while such an operation is running are recorded here and applied when the operation is done.
+             */
+            std::optional<std::vector<IO::Path>> m_deferredPreferenceChanges;
+
+            /*
+             * Incremented whenever a command is executed or undone and whenever the document is cleared. Unlike the
+             * modification count, this never returns to a previous value, so long running operations can use it to
+             * detect that the document was changed while they were computing their result.
+             */
+            size_t m_changeCount;
+
             /*
              * All actions pushed to this stack can be repeated later. The stack must be
              * primed to be cleared whenever the selection changes. The effect is that
@@ -258,12 +274,58 @@ namespace TrenchBroom {
         public: // new, load, save document
             void newDocument(Model::MapFormat mapFormat, const vm::bbox3& worldBounds, std::shared_ptr<Model::Game> game);
             void loadDocument(Model::MapFormat mapFormat, const vm::bbox3& worldBounds, std::shared_ptr<Model::Game> game, const IO::Path& path);
-            void saveDocument();
-            void saveDocumentAs(const IO::Path& path);
-            void saveDocumentTo(const IO::Path& path);
+
+            /**
+             * The save functions return the number of brushes and patches whose cached serialization was reused.
+             */
+            size_t saveDocument();
+            size_t saveDocumentAs(const IO::Path& path);
+            size_t saveDocumentTo(const IO::Path& path);
+
             void exportDocumentAs(Model::ExportFormat format, const IO::Path& path);
+
+            /**
+             * A copy of the world that can be written to a file on another thread while this document is being edited.
+             */
+            struct WorldSnapshot {
+                std::unique_ptr<Model::WorldNode> world;
+
+                /**
+                 * The brushes and patches of this document that were copied into the snapshot, paired with their copies.
+                 * Writing the snapshot caches the serializations of the copies.
+                 */
+                std::vector<std::pair<const Model::Node*, const Model::Node*>> copiedNodes;
+
+                /**
+                 * Identifies the state of this document that the snapshot was created from.
+                 */
+                size_t changeCount;
+            };
+
+            /**
+             * Returns a snapshot of the world. The snapshot retains the persistent IDs of all layers and groups and the
+             * state of the default layer, so it is written like the world itself. It has no spatial index and does not
+             * refer to any textures, entity definitions or entity models, so it can also be destroyed on another thread.
+             *
+             * Brushes whose serialization is cached are not copied, their copies share the cached serialization instead.
+             * Pass the serializations of the copied nodes to cacheSnapshotSerializations once the snapshot was written
+             * so that the next snapshot needs to copy fewer brushes.
+             */
+            WorldSnapshot createWorldSnapshot() const;
+
+            /**
+             * Caches the given serializations of the nodes of a world snapshot in the nodes that they were copied from,
+             * unless this document has changed since the snapshot was created.
+             */
+            void cacheSnapshotSerializations(const std::vector<std::pair<const Model::Node*, std::shared_ptr<const Model::NodeSerialization>>>& serializations, size_t changeCount);
+
+            /**
+             * Returns the number of brushes and patches whose serialization in the current map format is cached, and
+             * the total number of brushes and patches. Cached serializations are reused when the map is saved.
+             */
+            std::pair<size_t, size_t> countCachedSerializations() const;
         private:
-            void doSaveDocument(const IO::Path& path);
+            size_t doSaveDocument(const IO::Path& path);
             void clearDocument();
         public: // text encoding
             MapTextEncoding encoding() const;
@@ -436,8 +498,22 @@ namespace TrenchBroom {
             bool createBrush(const std::vector<vm::vec3>& points);
             bool csgConvexMerge();
             bool csgSubtract();
+            /**
+             * Subtracts the selected brushes from every brush that touches them. The fragments of the touched brushes are
+             * computed in parallel from copies of the brushes and applied in a single transaction afterwards. Returns false
+             * if nothing was selected, if the operation was cancelled via the given progress monitor or if the document was
+             * changed while the fragments were computed, in which case the document remains unchanged.
+             */
+            bool csgSubtract(ProgressMonitor& progressMonitor);
             bool csgIntersect();
             bool csgHollow();
+            /**
+             * Hollows out copies of the selected brushes in parallel and applies the result in a single transaction
+             * afterwards. Returns false if nothing could be hollowed, if the operation was cancelled via the given progress
+             * monitor or if the document was changed while the fragments were computed, in which case the document remains
+             * unchanged.
+             */
+            bool csgHollow(ProgressMonitor& progressMonitor);
         public: // Clipping operations, declared in MapFacade interface
             bool clipBrushes(const vm::vec3& p1, const vm::vec3& p2, const vm::vec3& p3);
         public: // modifying entity properties, declared in MapFacade interface
@@ -479,6 +555,7 @@ namespace TrenchBroom {
             bool canRedoCommand() const;
             const std::string& undoCommandName() const;
             const std::string& redoCommandName() const;
+            size_t undoStackMemorySize() const;
             void undoCommand();
             void redoCommand();
             bool canRepeatCommands() const;
@@ -489,6 +566,11 @@ namespace TrenchBroom {
             void rollbackTransaction();
             void commitTransaction();
             void cancelTransaction();
+        protected:
+            /**
+             * Returns the undo memory budget preference in bytes.
+             */
+            static size_t undoMemoryBudget();
         private:
             std::unique_ptr<CommandResult> execute(std::unique_ptr<Command>&& command);
             std::unique_ptr<CommandResult> executeAndStore(std::unique_ptr<UndoableCommand>&& command);
@@ -497,6 +579,8 @@ namespace TrenchBroom {
             virtual bool doCanRedoCommand() const = 0;
             virtual const std::string& doGetUndoCommandName() const = 0;
             virtual const std::string& doGetRedoCommandName() const = 0;
+            virtual size_t doGetUndoStackMemorySize() const = 0;
+            virtual void doSetUndoMemoryBudget(size_t undoMemoryBudget) = 0;
             virtual void doUndoCommand() = 0;
             virtual void doRedoCommand() = 0;
 
@@ -511,6 +595,17 @@ namespace TrenchBroom {
         public: // picking
             void pick(const vm::ray3& pickRay, Model::PickResult& pickResult) const;
             std::vector<Model::Node*> findNodesContaining(const vm::vec3& point) const;
+        public: // brush geometry
+            /**
+             * Releases the geometry of brushes that are neither selected nor have selected faces until the geometry of
+             * all brushes uses at most the given number of bytes. The least recently used geometry is released first. A
+             * budget of 0 means no limit. The memory of the released geometry is returned to the system.
+             *
+             * Must be called on the main thread and not while a tool or an operation holds on to brush geometry. Does
+             * nothing while an operation is reporting its progress. Brushes in selected groups or entities are kept, and
+             * so are brushes that cannot rebuild their geometry.
+             */
+            void evictBrushGeometry(size_t memoryBudget);
         private: // world management
             void createWorld(Model::MapFormat mapFormat, const vm::bbox3& worldBounds, std::shared_ptr<Model::Game> game);
             void loadWorld(Model::MapFormat mapFormat, const vm::bbox3& worldBounds, std::shared_ptr<Model::Game> game, const IO::Path& path);
@@ -614,6 +709,8 @@ namespace TrenchBroom {
             void modsWillChange();
             void modsDidChange();
             void preferenceDidChange(const IO::Path& path);
+            void deferPreferenceChanges();
+            void applyDeferredPreferenceChanges();
             void commandDone(Command* command);
             void commandUndone(UndoableCommand* command);
             void transactionDone(const std::string& name);
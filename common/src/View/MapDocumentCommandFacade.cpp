@@ -43,6 +43,7 @@
 #include "View/UndoableCommand.h"
 #include "View/Selection.h"
 
+#include <kdl/invoke.h>
 #include <kdl/map_utils.h>
 #include <kdl/overload.h>
 #include <kdl/result.h>
@@ -68,6 +69,7 @@ namespace TrenchBroom {
 
         MapDocumentCommandFacade::MapDocumentCommandFacade() :
         m_commandProcessor(std::make_unique<CommandProcessor>(this)) {
+            m_commandProcessor->setUndoMemoryBudget(undoMemoryBudget());
             bindObservers();
         }
 
@@ -231,10 +233,16 @@ namespace TrenchBroom {
             const std::vector<Model::Node*> parents = collectParents(nodes);
             Notifier<const std::vector<Model::Node*>&>::NotifyBeforeAndAfter notifyParents(nodesWillChangeNotifier, nodesDidChangeNotifier, parents);
 
+            // add the nodes to the spatial index in one go
             std::vector<Model::Node*> addedNodes;
-            for (const auto& [parent, children] : nodes) {
-                parent->addChildren(children);
-                addedNodes = kdl::vec_concat(std::move(addedNodes), children);
+            {
+                m_world->beginNodeTreeBatch();
+                const auto endNodeTreeBatch = kdl::invoke_later{[&]() { m_world->endNodeTreeBatch(); }};
+
+                for (const auto& [parent, children] : nodes) {
+                    parent->addChildren(children);
+                    addedNodes = kdl::vec_concat(std::move(addedNodes), children);
+                }
             }
 
             setEntityDefinitions(addedNodes);
@@ -509,6 +517,14 @@ namespace TrenchBroom {
             return m_commandProcessor->redoCommandName();
         }
 
+        size_t MapDocumentCommandFacade::doGetUndoStackMemorySize() const {
+            return m_commandProcessor->undoStackMemorySize();
+        }
+
+        void MapDocumentCommandFacade::doSetUndoMemoryBudget(const size_t undoMemoryBudget) {
+            m_commandProcessor->setUndoMemoryBudget(undoMemoryBudget);
+        }
+
         void MapDocumentCommandFacade::doUndoCommand() {
             m_commandProcessor->undo();
         }
@@ -111,6 +111,8 @@ namespace TrenchBroom {
             bool doCanRedoCommand() const override;
             const std::string& doGetUndoCommandName() const override;
             const std::string& doGetRedoCommandName() const override;
+            size_t doGetUndoStackMemorySize() const override;
+            void doSetUndoMemoryBudget(size_t undoMemoryBudget) override;
             void doUndoCommand() override;
             void doRedoCommand() override;
 
@@ -62,6 +62,7 @@
 #include "View/MainMenuBuilder.h"
 #include "View/MapDocument.h"
 #include "View/PasteType.h"
+#include "View/ProgressDialogMonitor.h"
 #include "View/RenderView.h"
 #include "View/ReplaceTextureDialog.h"
 #include "View/Splitter.h"
@@ -71,6 +72,7 @@
 #include "View/QtUtils.h"
 #include "View/MapViewToolBox.h"
 
+#include <kdl/invoke.h>
 #include <kdl/overload.h>
 #include <kdl/string_format.h>
 #include <kdl/string_utils.h>
@@ -78,6 +80,7 @@
 #include <vecmath/vec.h>
 #include <vecmath/vec_io.h>
 
+#include <algorithm>
 #include <cassert>
 #include <chrono>
 #include <iterator>
@@ -186,7 +189,9 @@ namespace TrenchBroom {
 
             // let's trigger a final autosave before releasing the document
             NullLogger logger;
+            m_autosaver->finishPendingAutosave(logger);
             m_autosaver->triggerAutosave(logger);
+            m_autosaver->finishPendingAutosave(logger);
 
             m_document->setViewEffectsService(nullptr);
             m_document.reset();
@@ -635,7 +640,9 @@ namespace TrenchBroom {
         }
 
         void MapFrame::updateStatusBar() {
-            m_statusBarLabel->setText(QString(describeSelection(m_document.get())));
+            const auto undoStackMegabytes = static_cast<double>(m_document->undoStackMemorySize()) / (1024.0 * 1024.0);
+            m_statusBarLabel->setText(describeSelection(m_document.get())
+                + tr("   |   Undo history: %1 MB").arg(undoStackMegabytes, 0, 'f', 1));
         }
 
         void MapFrame::bindObservers() {
@@ -714,6 +721,7 @@ namespace TrenchBroom {
                 // pushed onto the undo stack, but we need to read the undo stack in updateUndoRedoActions(),
                 // so this QTimer::singleShot is needed for now.
                 updateUndoRedoActions();
+                updateStatusBar();
             });
         }
 
@@ -721,6 +729,7 @@ namespace TrenchBroom {
             QTimer::singleShot(0, this, [this]() {
                 // FIXME: see MapFrame::transactionDone
                 updateUndoRedoActions();
+                updateStatusBar();
             });
         }
 
@@ -777,6 +786,7 @@ namespace TrenchBroom {
 
         void MapFrame::bindEvents() {
             connect(m_autosaveTimer, &QTimer::timeout, this, &MapFrame::triggerAutosave);
+            connect(m_autosaveTimer, &QTimer::timeout, this, &MapFrame::evictBrushGeometry);
             connect(qApp, &QApplication::focusChanged, this, &MapFrame::focusChange);
             connect(m_gridChoice, QOverload<int>::of(&QComboBox::activated), this, [this](const int index) { setGridSize(index + Grid::MinSize); });
             connect(QApplication::clipboard(), &QClipboard::dataChanged, this, [this]() {
@@ -815,11 +825,14 @@ namespace TrenchBroom {
             try {
                 if (m_document->persistent()) {
                     const auto startTime = std::chrono::high_resolution_clock::now();
-                    m_document->saveDocument();
+                    const auto reused = m_document->saveDocument();
                     const auto endTime = std::chrono::high_resolution_clock::now();
 
+                    // all brushes and patches have a cached serialization after saving
+                    const auto total = m_document->countCachedSerializations().second;
                     logger().info() << "Saved " << m_document->path() << " in "
-                                    << std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count() << "ms";
+                                    << std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count() << "ms"
+                                    << " (reused " << reused << " of " << total << " brush and patch serializations)";
                     return true;
                 } else {
                     return saveDocumentAs();
@@ -847,11 +860,14 @@ namespace TrenchBroom {
                 const IO::Path path = IO::pathFromQString(newFileName);
 
                 const auto startTime = std::chrono::high_resolution_clock::now();
-                m_document->saveDocumentAs(path);
+                const auto reused = m_document->saveDocumentAs(path);
                 const auto endTime = std::chrono::high_resolution_clock::now();
 
+                // all brushes and patches have a cached serialization after saving
+                const auto total = m_document->countCachedSerializations().second;
                 logger().info() << "Saved " << m_document->path() << " in "
-                                << std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count() << "ms";
+                                << std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count() << "ms"
+                                << " (reused " << reused << " of " << total << " brush and patch serializations)";
                 return true;
             } catch (const FileSystemException& e) {
                 QMessageBox::critical(this, "", e.what());
@@ -1487,7 +1503,12 @@ namespace TrenchBroom {
 
         void MapFrame::csgSubtract() {
             if (canDoCsgSubtract()) {
-                m_document->csgSubtract();
+                // reporting the progress processes pending events, so autosave and geometry eviction are paused until the operation is done
+                m_autosaveTimer->stop();
+                const auto restartTimer = kdl::invoke_later{[&]() { m_autosaveTimer->start(); }};
+
+                ProgressDialogMonitor progressMonitor(tr("Subtracting brushes..."), this);
+                m_document->csgSubtract(progressMonitor);
             }
         }
 
@@ -1497,7 +1518,11 @@ namespace TrenchBroom {
 
         void MapFrame::csgHollow() {
             if (canDoCsgHollow()) {
-                m_document->csgHollow();
+                m_autosaveTimer->stop();
+                const auto restartTimer = kdl::invoke_later{[&]() { m_autosaveTimer->start(); }};
+
+                ProgressDialogMonitor progressMonitor(tr("Hollowing brushes..."), this);
+                m_document->csgHollow(progressMonitor);
             }
         }
 
@@ -1898,6 +1923,14 @@ namespace TrenchBroom {
             }
         }
 
+        void MapFrame::evictBrushGeometry() {
+            // tools may hold on to brush geometry while the mouse is pressed
+            if (QGuiApplication::mouseButtons() == Qt::NoButton) {
+                const auto budget = static_cast<size_t>(std::max(0, pref(Preferences::BrushGeometryMemoryBudget))) * 1024u * 1024u;
+                m_document->evictBrushGeometry(budget);
+            }
+        }
+
         // DebugPaletteWindow
 
         DebugPaletteWindow::DebugPaletteWindow(QWidget *parent)
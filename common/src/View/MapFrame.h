@@ -377,6 +377,7 @@ namespace TrenchBroom {
             bool eventFilter(QObject* target, QEvent* event) override;
         private:
             void triggerAutosave();
+            void evictBrushGeometry();
         };
 
         class DebugPaletteWindow : public QDialog {
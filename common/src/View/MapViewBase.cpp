@@ -26,6 +26,7 @@
 #include "Assets/EntityDefinition.h"
 #include "Assets/EntityDefinitionGroup.h"
 #include "Assets/EntityDefinitionManager.h"
+#include "Assets/TextureManager.h"
 #include "Model/BezierPatch.h"
 #include "Model/BrushNode.h"
 #include "Model/BrushFace.h"
@@ -74,6 +75,7 @@
 #include <vecmath/util.h>
 
 #include <sstream>
+#include <string>
 #include <vector>
 
 #include <QtGlobal>
@@ -876,6 +878,11 @@ namespace TrenchBroom {
             renderFPS(renderContext, renderBatch);
 
             renderBatch.render(renderContext);
+
+            if (document->textureManager().hasPendingChanges()) {
+                // textures are uploaded in batches, so render another frame to upload the next batch
+                update();
+            }
         }
 
         void MapViewBase::setupGL(Renderer::RenderContext& context) {
@@ -965,7 +972,9 @@ namespace TrenchBroom {
             if (pref(Preferences::ShowFPS)) {
                 Renderer::RenderService renderService(renderContext, renderBatch);
 
-                renderService.renderHeadsUp(m_currentFPS);
+                renderService.renderHeadsUp(m_currentFPS + " Brushes drawn: " + std::to_string(m_renderer.drawnBrushCount()) +
+                                            ", culled: " + std::to_string(m_renderer.culledBrushCount()) +
+                                            ", entity model draw calls: " + std::to_string(m_renderer.entityModelDrawCallCount()));
             }
         }
 
@@ -0,0 +1,51 @@
+/*
+ Copyright (C) 2021 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ProgressDialogMonitor.h"
+
+#include <QProgressDialog>
+#include <QString>
+
+namespace TrenchBroom {
+    namespace View {
+        static constexpr int MaxProgress = 1000;
+
+        ProgressDialogMonitor::ProgressDialogMonitor(const QString& label, QWidget* parent) :
+        m_dialog(new QProgressDialog(label, QObject::tr("Cancel"), 0, MaxProgress, parent)) {
+            // block input to all windows, including other documents and the preferences dialog, while the operation runs
+            m_dialog->setWindowModality(Qt::ApplicationModal);
+            m_dialog->setMinimumDuration(500);
+            m_dialog->setValue(0);
+        }
+
+        ProgressDialogMonitor::~ProgressDialogMonitor() {
+            m_dialog->close();
+            m_dialog->deleteLater();
+        }
+
+        void ProgressDialogMonitor::doProgress(const double progress) {
+            // for modal dialogs, this also processes pending events so that the cancel button is responsive
+            m_dialog->setValue(static_cast<int>(progress * MaxProgress));
+        }
+
+        bool ProgressDialogMonitor::doCancelled() const {
+            return m_dialog->wasCanceled();
+        }
+    }
+}
@@ -0,0 +1,51 @@
+/*
+ Copyright (C) 2021 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Macros.h"
+#include "ProgressMonitor.h"
+
+class QProgressDialog;
+class QString;
+class QWidget;
+
+namespace TrenchBroom {
+    namespace View {
+        /**
+         * Shows the progress of an operation in a window modal progress dialog with a cancel button. The dialog only
+         * appears if the operation takes a noticeable amount of time.
+         *
+         * Reporting the progress processes pending events, so timers fire and views repaint while the operation is
+         * running. Callers must make sure that none of these modify the data the operation is working on.
+         */
+        class ProgressDialogMonitor : public ProgressMonitor {
+        private:
+            QProgressDialog* m_dialog;
+        public:
+            ProgressDialogMonitor(const QString& label, QWidget* parent);
+            ~ProgressDialogMonitor() override;
+
+            deleteCopyAndMove(ProgressDialogMonitor)
+        private:
+            void doProgress(double progress) override;
+            bool doCancelled() const override;
+        };
+    }
+}
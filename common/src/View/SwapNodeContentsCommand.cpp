@@ -22,38 +22,48 @@
 #include "Model/Brush.h"
 #include "Model/Entity.h"
 #include "Model/Node.h"
+#include "Model/NodeContentsDelta.h"
 #include "Model/UpdateLinkedGroupsError.h"
 #include "View/MapDocumentCommandFacade.h"
 
 #include <kdl/result.h>
 #include <kdl/vector_utils.h>
 
+#include <map>
+
 namespace TrenchBroom {
     namespace View {
         const Command::CommandType SwapNodeContentsCommand::Type = Command::freeType();
 
         SwapNodeContentsCommand::SwapNodeContentsCommand(const std::string& name, std::vector<std::pair<Model::Node*, Model::NodeContents>> nodes, std::vector<std::pair<const Model::GroupNode*, std::vector<Model::GroupNode*>>> linkedGroupsToUpdate) :
         UndoableCommand(Type, name, true),
-        m_nodes(std::move(nodes)),
-        m_updateLinkedGroupsHelper(std::move(linkedGroupsToUpdate)) {}
+        m_updateLinkedGroupsHelper(std::move(linkedGroupsToUpdate)),
+        m_memorySize(0u) {
+            storeContents(std::move(nodes));
+        }
 
         SwapNodeContentsCommand::~SwapNodeContentsCommand() = default;
 
         std::unique_ptr<CommandResult> SwapNodeContentsCommand::doPerformDo(MapDocumentCommandFacade* document) {
-            document->performSwapNodeContents(m_nodes);
+            auto nodes = restoreContents();
+            document->performSwapNodeContents(nodes);
 
             const auto success = m_updateLinkedGroupsHelper.applyLinkedGroupUpdates(*document)
                 .handle_errors([&](const Model::UpdateLinkedGroupsError& e) {
                     document->error() << e;
-                    document->performSwapNodeContents(m_nodes);
+                    document->performSwapNodeContents(nodes);
                 });
 
+            storeContents(std::move(nodes));
             return std::make_unique<CommandResult>(success);
         }
 
         std::unique_ptr<CommandResult> SwapNodeContentsCommand::doPerformUndo(MapDocumentCommandFacade* document) {
-            document->performSwapNodeContents(m_nodes);
+            auto nodes = restoreContents();
+            document->performSwapNodeContents(nodes);
             m_updateLinkedGroupsHelper.undoLinkedGroupUpdates(*document);
+
+            storeContents(std::move(nodes));
             return std::make_unique<CommandResult>(true);
         }
 
@@ -67,11 +77,45 @@ namespace TrenchBroom {
             kdl::vec_sort(theirNodes);
             
             if (myNodes == theirNodes) {
+                // our contents are stored relative to the contents that the other command has replaced
+                auto theirDeltas = std::map<Model::Node*, const Model::NodeContentsDelta*>{};
+                for (auto& [node, delta] : other->m_nodes) {
+                    theirDeltas[node] = &delta;
+                }
+
+                m_memorySize = 0u;
+                for (auto& [node, delta] : m_nodes) {
+                    delta.rebase(node, *theirDeltas.at(node));
+                    m_memorySize += delta.memorySize();
+                }
+
                 m_updateLinkedGroupsHelper.collateWith(other->m_updateLinkedGroupsHelper);
                 return true;
             }
 
             return false;
         }
+
+        size_t SwapNodeContentsCommand::doGetMemorySize() const {
+            return m_memorySize;
+        }
+
+        std::vector<std::pair<Model::Node*, Model::NodeContents>> SwapNodeContentsCommand::restoreContents() const {
+            return kdl::vec_transform(m_nodes, [](const auto& pair) {
+                return std::make_pair(pair.first, pair.second.restore(pair.first));
+            });
+        }
+
+        void SwapNodeContentsCommand::storeContents(std::vector<std::pair<Model::Node*, Model::NodeContents>> nodes) {
+            m_nodes.clear();
+            m_nodes.reserve(nodes.size());
+            m_memorySize = 0u;
+
+            for (auto& [node, contents] : nodes) {
+                auto delta = Model::NodeContentsDelta::create(node, std::move(contents));
+                m_memorySize += delta.memorySize();
+                m_nodes.emplace_back(node, std::move(delta));
+            }
+        }
     }
 }
@@ -21,6 +21,7 @@
 
 #include "Macros.h"
 #include "Model/NodeContents.h"
+#include "Model/NodeContentsDelta.h"
 #include "View/UndoableCommand.h"
 #include "View/UpdateLinkedGroupsHelper.h"
 
@@ -42,8 +43,12 @@ namespace TrenchBroom {
         public:
             static const CommandType Type;
         protected:
-            std::vector<std::pair<Model::Node*, Model::NodeContents>> m_nodes;
+            /**
+             * The contents to swap in, stored relative to the current contents of each node.
+             */
+            std::vector<std::pair<Model::Node*, Model::NodeContentsDelta>> m_nodes;
             UpdateLinkedGroupsHelper m_updateLinkedGroupsHelper;
+            size_t m_memorySize;
         public:
             SwapNodeContentsCommand(const std::string& name, std::vector<std::pair<Model::Node*, Model::NodeContents>> nodes, std::vector<std::pair<const Model::GroupNode*, std::vector<Model::GroupNode*>>> linkedGroupsToUpdate);
             ~SwapNodeContentsCommand();
@@ -52,6 +57,11 @@ namespace TrenchBroom {
             std::unique_ptr<CommandResult> doPerformUndo(MapDocumentCommandFacade* document) override;
 
             bool doCollateWith(UndoableCommand* command) override;
+        private:
+            size_t doGetMemorySize() const override;
+
+            std::vector<std::pair<Model::Node*, Model::NodeContents>> restoreContents() const;
+            void storeContents(std::vector<std::pair<Model::Node*, Model::NodeContents>> nodes);
 
             deleteCopyAndMove(SwapNodeContentsCommand)
         };
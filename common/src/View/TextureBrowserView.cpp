@@ -301,6 +301,11 @@ namespace TrenchBroom {
             renderBounds(layout, y, height);
             renderTextures(layout, y, height);
             renderNames(layout, y, height);
+
+            if (doc->textureManager().hasPendingChanges()) {
+                // textures are uploaded in batches, so render another frame to upload the next batch
+                update();
+            }
         }
 
         bool TextureBrowserView::doShouldRenderFocusIndicator() const {
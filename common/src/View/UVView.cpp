@@ -264,7 +264,7 @@ namespace TrenchBroom {
                 texture->activate();
 
                 Renderer::ActiveShader shader(renderContext.shaderManager(), Renderer::Shaders::UVViewShader);
-                shader.set("ApplyTexture", true);
+                shader.set("ApplyTexture", texture->isPrepared());
                 shader.set("Color", texture->averageColor());
                 shader.set("Brightness", pref(Preferences::Brightness));
                 shader.set("RenderGrid", true);
@@ -64,5 +64,13 @@ namespace TrenchBroom {
             }
             return false;
         }
+
+        size_t UndoableCommand::memorySize() const {
+            return doGetMemorySize();
+        }
+
+        size_t UndoableCommand::doGetMemorySize() const {
+            return 0u;
+        }
     }
 }
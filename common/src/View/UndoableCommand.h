@@ -41,11 +41,18 @@ namespace TrenchBroom {
             virtual std::unique_ptr<CommandResult> performUndo(MapDocumentCommandFacade* document);
 
             virtual bool collateWith(UndoableCommand* command);
+
+            /**
+             * Returns an estimate of the number of bytes used by the state this command keeps for undo and redo.
+             */
+            size_t memorySize() const;
         private:
             virtual std::unique_ptr<CommandResult> doPerformUndo(MapDocumentCommandFacade* document) = 0;
 
             virtual bool doCollateWith(UndoableCommand* command) = 0;
 
+            virtual size_t doGetMemorySize() const;
+
             deleteCopyAndMove(UndoableCommand)
         };
     }
@@ -19,11 +19,21 @@
 
 #include "AABBTree.h"
 
+#include <kdl/vector_utils.h>
+
+#include <vecmath/approx.h>
+#include <vecmath/intersection.h>
+#include <vecmath/plane.h>
 #include <vecmath/vec.h>
 #include <vecmath/ray.h>
 
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <numeric>
 #include <set>
 #include <sstream>
+#include <vector>
 
 #include "Catch2.h"
 
@@ -32,6 +42,7 @@ namespace TrenchBroom {
     using BOX = AABB::Box;
     using RAY = vm::ray<AABB::FloatType, AABB::Components>;
     using VEC = vm::vec<AABB::FloatType, AABB::Components>;
+    using PLANE = vm::plane<AABB::FloatType, AABB::Components>;
 
 
     static void assertTree(const std::string& exp, const AABB& actual) {
@@ -550,4 +561,248 @@ L [ ( -1 -1 -1 ) ( 1 1 1 ) ]: 1
         CHECK_FALSE(tree.contains(2u));
         REQUIRE_THAT(tree.findContainers(vm::vec3d{0.5, 0.5, 0.5}), Catch::UnorderedEquals(std::vector<size_t>{}));
     }
+
+    TEST_CASE("AABBTreeTest.reuseRemovedNodes", "[AABBTreeTest]") {
+        // insert a row of boxes, remove every other one and insert them again so that the freed slots are reused
+        const auto boxAt = [](const size_t i) {
+            const auto x = static_cast<double>(i);
+            return BOX(VEC(x, 0.0, 0.0), VEC(x + 1.0, 1.0, 1.0));
+        };
+
+        AABB tree;
+        for (size_t i = 0u; i < 32u; ++i) {
+            tree.insert(boxAt(i), i);
+        }
+
+        for (size_t i = 0u; i < 32u; i += 2u) {
+            REQUIRE(tree.remove(i));
+            assertTreeDoesNotContain(tree, boxAt(i), i);
+        }
+
+        for (size_t i = 0u; i < 32u; i += 2u) {
+            tree.insert(boxAt(i), i);
+        }
+
+        for (size_t i = 0u; i < 32u; ++i) {
+            assertTreeContains(tree, boxAt(i), i);
+        }
+
+        CHECK(tree.bounds() == BOX(VEC(0.0, 0.0, 0.0), VEC(32.0, 1.0, 1.0)));
+        assertIntersectors(tree, RAY(VEC(4.5, 0.5, -1.0), VEC::pos_z()), { 4u });
+    }
+
+    static std::vector<std::pair<BOX, size_t>> makeGridBoxes(const size_t count) {
+        // boxes of varying sizes on a grid, some of them overlapping
+        std::vector<std::pair<BOX, size_t>> result;
+        for (size_t i = 0u; i < count; ++i) {
+            const auto x = static_cast<double>(i % 17u) * 4.0;
+            const auto y = static_cast<double>((i / 17u) % 13u) * 4.0;
+            const auto z = static_cast<double>(i / (17u * 13u)) * 4.0;
+            const auto size = 1.0 + static_cast<double>(i % 5u);
+            result.emplace_back(BOX(VEC(x, y, z), VEC(x + size, y + size, z + size)), i);
+        }
+        return result;
+    }
+
+    static void assertTreeMatchesBoxes(const AABB& tree, const std::vector<std::pair<BOX, size_t>>& boxes) {
+        for (const auto& [box, data] : boxes) {
+            assertTreeContains(tree, box, data);
+        }
+
+        const auto ray = RAY(VEC(-1.0, 2.5, 2.5), VEC::pos_x());
+
+        std::set<size_t> expected;
+        for (const auto& [box, data] : boxes) {
+            if (!vm::is_nan(vm::intersect_ray_bbox(ray, box))) {
+                expected.insert(data);
+            }
+        }
+
+        std::set<size_t> actual;
+        tree.findIntersectors(ray, std::inserter(actual, std::end(actual)));
+        CHECK(actual == expected);
+    }
+
+    TEST_CASE("AABBTreeTest.clearAndBuild", "[AABBTreeTest]") {
+        const auto count = static_cast<size_t>(GENERATE(1, 2, 3, 100, 5000));
+        const auto boxes = makeGridBoxes(count);
+
+        AABB tree;
+        tree.insert(BOX(VEC(-8.0, -8.0, -8.0), VEC(-7.0, -7.0, -7.0)), count);
+
+        tree.clearAndBuild(kdl::vec_transform(boxes, [](const auto& pair) { return pair.second; }), [&](const size_t i) { return boxes[i].first; });
+
+        CHECK_FALSE(tree.contains(count));
+        assertTreeMatchesBoxes(tree, boxes);
+
+        // a balanced tree has a height of 1 + ceil(log2(count))
+        CHECK(tree.height() <= 2u * static_cast<size_t>(std::ceil(std::log2(static_cast<double>(count)))) + 1u);
+        CHECK(tree.sahCost() >= 0.0);
+    }
+
+    TEST_CASE("AABBTreeTest.clearAndBuildWithDuplicates", "[AABBTreeTest]") {
+        const auto bounds = BOX(VEC(0.0, 0.0, 0.0), VEC(1.0, 1.0, 1.0));
+
+        AABB tree;
+        CHECK_THROWS_AS(tree.clearAndBuild(std::vector<size_t>{1u, 2u, 1u}, [&](const size_t) { return bounds; }), NodeTreeException);
+        CHECK(tree.empty());
+    }
+
+    TEST_CASE("AABBTreeTest.insertAll", "[AABBTreeTest]") {
+        const auto count = static_cast<size_t>(GENERATE(10, 5000));
+        const auto boxes = makeGridBoxes(count);
+
+        const auto firstHalf = std::vector<std::pair<BOX, size_t>>(std::begin(boxes), std::next(std::begin(boxes), static_cast<std::ptrdiff_t>(count / 2u)));
+        const auto secondHalf = std::vector<std::pair<BOX, size_t>>(std::next(std::begin(boxes), static_cast<std::ptrdiff_t>(count / 2u)), std::end(boxes));
+
+        const auto getBounds = [](const auto& pair) { return pair.first; };
+        const auto getData = [](const auto& pair) { return pair.second; };
+
+        AABB tree;
+        tree.insertAll(kdl::vec_transform(firstHalf, getData), [&](const size_t i) { return getBounds(boxes[i]); });
+        tree.insertAll(kdl::vec_transform(secondHalf, getData), [&](const size_t i) { return getBounds(boxes[i]); });
+        assertTreeMatchesBoxes(tree, boxes);
+
+        CHECK_THROWS_AS(tree.insertAll(std::vector<size_t>{0u}, [&](const size_t i) { return getBounds(boxes[i]); }), NodeTreeException);
+    }
+
+    TEST_CASE("AABBTreeTest.insertAllWithDuplicates", "[AABBTreeTest]") {
+        // small batches are inserted one by one, large batches rebuild the tree
+        const auto count = static_cast<size_t>(GENERATE(10, 5000));
+        const auto boxes = makeGridBoxes(count + 1u);
+        const auto getBounds = [&](const size_t i) { return boxes[i].first; };
+
+        AABB tree;
+        tree.insert(getBounds(count), count);
+
+        auto data = std::vector<size_t>{};
+        for (size_t i = 0u; i < count; ++i) {
+            data.push_back(i);
+        }
+        data.push_back(count / 2u);
+
+        CHECK_THROWS_AS(tree.insertAll(data, getBounds), NodeTreeException);
+        CHECK(tree.size() == 1u);
+        CHECK(tree.contains(count));
+        CHECK_FALSE(tree.contains(0u));
+    }
+
+    TEST_CASE("AABBTreeTest.findInFrustum", "[AABBTreeTest]") {
+        const auto boxes = makeGridBoxes(1000);
+
+        AABB tree;
+        CHECK(tree.findInFrustum({ PLANE(0.0, VEC::pos_x()) }).empty());
+
+        tree.clearAndBuild(kdl::vec_transform(boxes, [](const auto& pair) { return pair.second; }), [&](const size_t i) { return boxes[i].first; });
+        CHECK(tree.size() == boxes.size());
+
+        // a box that is open towards +z, the plane normals point outwards
+        const auto planes = std::vector<PLANE>{
+            PLANE(VEC(10.0, 0.0, 0.0), VEC::neg_x()),
+            PLANE(VEC(30.0, 0.0, 0.0), VEC::pos_x()),
+            PLANE(VEC(0.0, 10.0, 0.0), VEC::neg_y()),
+            PLANE(VEC(0.0, 30.0, 0.0), VEC::pos_y()),
+            PLANE(VEC(0.0, 0.0, 6.0), VEC::neg_z())
+        };
+
+        std::set<size_t> expected;
+        for (const auto& [box, data] : boxes) {
+            if (std::none_of(std::begin(planes), std::end(planes), [&](const auto& plane) {
+                return plane.point_distance(box.min) > 0.0 && plane.point_distance(box.max) > 0.0;
+            })) {
+                expected.insert(data);
+            }
+        }
+
+        std::set<size_t> actual;
+        tree.findInFrustum(planes, std::inserter(actual, std::end(actual)));
+
+        CHECK_FALSE(expected.empty());
+        CHECK(expected.size() < boxes.size());
+        CHECK(actual == expected);
+
+        // all boxes are behind a plane that does not intersect the tree
+        CHECK(tree.findInFrustum({ PLANE(VEC(100.0, 0.0, 0.0), VEC::pos_x()) }).size() == boxes.size());
+        CHECK(tree.findInFrustum({ PLANE(VEC(-100.0, 0.0, 0.0), VEC::pos_x()) }).empty());
+    }
+
+    TEST_CASE("AABBTreeTest.findIntersectorsOfBox", "[AABBTreeTest]") {
+        const auto boxes = makeGridBoxes(1000);
+
+        AABB tree;
+        CHECK(tree.findIntersectors(BOX(VEC(0.0, 0.0, 0.0), VEC(1.0, 1.0, 1.0))).empty());
+
+        tree.clearAndBuild(kdl::vec_transform(boxes, [](const auto& pair) { return pair.second; }), [&](const size_t i) { return boxes[i].first; });
+
+        const auto query = BOX(VEC(10.0, 10.0, 6.0), VEC(30.0, 30.0, 12.0));
+
+        std::set<size_t> expected;
+        for (const auto& [box, data] : boxes) {
+            if (box.intersects(query)) {
+                expected.insert(data);
+            }
+        }
+
+        std::set<size_t> actual;
+        tree.findIntersectors(query, std::inserter(actual, std::end(actual)));
+
+        CHECK_FALSE(expected.empty());
+        CHECK(expected.size() < boxes.size());
+        CHECK(actual == expected);
+
+        // boxes that only touch the query box are found
+        CHECK_THAT(tree.findIntersectors(BOX(VEC(-1.0, -1.0, -1.0), VEC(0.0, 0.0, 0.0))), Catch::Equals(std::vector<size_t>{0u}));
+        CHECK(tree.findIntersectors(BOX(VEC(-2.0, -2.0, -2.0), VEC(-1.0, -1.0, -1.0))).empty());
+    }
+
+    TEST_CASE("AABBTreeTest.sahCost", "[AABBTreeTest]") {
+        AABB tree;
+        CHECK(tree.sahCost() == 0.0);
+
+        tree.insert(BOX(VEC(0.0, 0.0, 0.0), VEC(1.0, 1.0, 1.0)), 1u);
+        CHECK(tree.sahCost() == 1.0);
+
+        tree.insert(BOX(VEC(1.0, 0.0, 0.0), VEC(2.0, 1.0, 1.0)), 2u);
+        // root area is 5, each leaf has area 3
+        CHECK(tree.sahCost() == vm::approx(11.0 / 5.0));
+    }
+    TEST_CASE("AABBTreeTest.findClosestIntersection", "[AABBTreeTest]") {
+        auto boxes = std::vector<BOX>{};
+        for (size_t i = 0u; i < 100u; ++i) {
+            const auto x = static_cast<double>(i) * 2.0;
+            boxes.push_back(BOX(VEC(x, 0.0, 0.0), VEC(x + 1.0, 1.0, 1.0)));
+        }
+
+        AABB tree;
+        CHECK_FALSE(tree.findClosestIntersection(RAY(VEC(-1.0, 0.5, 0.5), VEC::pos_x()), [](const size_t) { return 0.0; }).has_value());
+
+        auto indices = std::vector<size_t>(boxes.size());
+        std::iota(std::begin(indices), std::end(indices), size_t(0));
+        tree.clearAndBuild(indices, [&](const size_t i) { return boxes[i]; });
+
+        size_t intersectCount = 0u;
+        const auto intersect = [&](const RAY& ray) {
+            return [&, ray](const size_t i) {
+                ++intersectCount;
+                return vm::intersect_ray_bbox(ray, boxes[i]);
+            };
+        };
+
+        const auto fromLeft = RAY(VEC(-1.0, 0.5, 0.5), VEC::pos_x());
+        const auto leftHit = tree.findClosestIntersection(fromLeft, intersect(fromLeft));
+        REQUIRE(leftHit.has_value());
+        CHECK(leftHit->first == vm::approx(1.0));
+        CHECK(leftHit->second == 0u);
+        // subtrees behind the first hit are skipped
+        CHECK(intersectCount < boxes.size() / 4u);
+
+        const auto fromRight = RAY(VEC(300.0, 0.5, 0.5), VEC::neg_x());
+        const auto rightHit = tree.findClosestIntersection(fromRight, intersect(fromRight));
+        REQUIRE(rightHit.has_value());
+        CHECK(rightHit->first == vm::approx(101.0));
+        CHECK(rightHit->second == 99u);
+
+        const auto miss = RAY(VEC(-1.0, 2.0, 0.5), VEC::pos_x());
+        CHECK_FALSE(tree.findClosestIntersection(miss, intersect(miss)).has_value());
+    }
 }
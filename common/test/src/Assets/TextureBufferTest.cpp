@@ -0,0 +1,171 @@
+/*
+ Copyright (C) 2021 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Color.h"
+#include "Assets/TextureBuffer.h"
+
+#include <vecmath/vec.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "Catch2.h"
+
+namespace TrenchBroom {
+    namespace Assets {
+        static TextureBuffer makeBuffer(const std::vector<unsigned char>& data) {
+            auto result = TextureBuffer(data.size());
+            std::copy(std::begin(data), std::end(data), result.data());
+            return result;
+        }
+
+        static std::vector<unsigned char> contents(const TextureBuffer& buffer) {
+            return std::vector<unsigned char>(buffer.data(), buffer.data() + buffer.size());
+        }
+
+        /**
+         * Returns a buffer of the given size in which every channel of every pixel has a different value.
+         */
+        static TextureBuffer makePattern(const size_t width, const size_t height) {
+            auto result = TextureBuffer(4u * width * height);
+            for (size_t i = 0u; i < result.size(); ++i) {
+                result.data()[i] = static_cast<unsigned char>((i * 37u) % 251u);
+            }
+            return result;
+        }
+
+        static void checkColor(const Color& actual, const Color& expected) {
+            CHECK(actual.r() == Approx(expected.r()));
+            CHECK(actual.g() == Approx(expected.g()));
+            CHECK(actual.b() == Approx(expected.b()));
+            CHECK(actual.a() == Approx(expected.a()));
+        }
+
+        TEST_CASE("TextureBufferTest.mipLevelCount", "[TextureBufferTest]") {
+            CHECK(mipLevelCount(1u, 1u) == 1u);
+            CHECK(mipLevelCount(2u, 1u) == 2u);
+            CHECK(mipLevelCount(64u, 64u) == 7u);
+            CHECK(mipLevelCount(64u, 16u) == 7u);
+            CHECK(mipLevelCount(5u, 3u) == 3u);
+        }
+
+        TEST_CASE("TextureBufferTest.applyPalette", "[TextureBufferTest]") {
+            auto palette = std::vector<unsigned char>(1024u);
+            for (size_t i = 0u; i < palette.size(); ++i) {
+                palette[i] = static_cast<unsigned char>(255u - i / 4u);
+            }
+
+            // more than one vector of pixels and some remaining pixels
+            const auto indices = std::vector<unsigned char>{ 0u, 1u, 2u, 3u, 255u, 128u, 7u };
+            auto rgbaImage = std::vector<unsigned char>(4u * indices.size());
+            applyPalette(indices.data(), indices.size(), palette.data(), rgbaImage.data());
+
+            for (size_t i = 0u; i < indices.size(); ++i) {
+                const auto expected = static_cast<unsigned char>(255u - indices[i]);
+                CHECK(rgbaImage[4u * i + 0u] == expected);
+                CHECK(rgbaImage[4u * i + 1u] == expected);
+                CHECK(rgbaImage[4u * i + 2u] == expected);
+                CHECK(rgbaImage[4u * i + 3u] == expected);
+            }
+        }
+
+        TEST_CASE("TextureBufferTest.averageColor", "[TextureBufferTest]") {
+            const auto buffer = makeBuffer({
+                255u, 0u,   0u,   255u,
+                0u,   255u, 0u,   255u,
+                0u,   0u,   255u, 255u,
+                255u, 255u, 255u, 255u,
+                0u,   0u,   0u,   255u,
+            });
+
+            checkColor(averageColor(buffer, GL_RGBA), Color(0.4f, 0.4f, 0.4f, 1.0f));
+            checkColor(averageColor(makeBuffer({10u, 20u, 30u, 40u}), GL_RGBA), Color(10, 20, 30, 40));
+            checkColor(averageColor(makeBuffer({10u, 20u, 30u, 40u}), GL_BGRA), Color(30, 20, 10, 40));
+        }
+
+        TEST_CASE("TextureBufferTest.averageColorOfLargeBuffer", "[TextureBufferTest]") {
+            // large enough to require several blocks of vectorized sums
+            const auto pixelCount = size_t(1000u);
+            auto buffer = TextureBuffer(4u * pixelCount);
+            for (size_t i = 0u; i < pixelCount; ++i) {
+                buffer.data()[4u * i + 0u] = 255u;
+                buffer.data()[4u * i + 1u] = static_cast<unsigned char>(i % 2u == 0u ? 255u : 0u);
+                buffer.data()[4u * i + 2u] = 0u;
+                buffer.data()[4u * i + 3u] = 255u;
+            }
+
+            checkColor(averageColor(buffer, GL_RGBA), Color(1.0f, 0.5f, 0.0f, 1.0f));
+        }
+
+        TEST_CASE("TextureBufferTest.generateMips", "[TextureBufferTest]") {
+            auto buffers = TextureBufferList{};
+            buffers.push_back(makeBuffer({
+                0u,  0u,  0u,  0u,     4u,  8u,  12u, 16u,    100u, 0u, 0u, 0u,    101u, 0u, 0u, 0u,
+                2u,  2u,  2u,  2u,     6u,  10u, 14u, 18u,    102u, 0u, 0u, 0u,    104u, 0u, 0u, 0u,
+            }));
+
+            generateMips(buffers, 4u, 2u, GL_RGBA);
+
+            REQUIRE(buffers.size() == 3u);
+            CHECK(contents(buffers[1]) == std::vector<unsigned char>{
+                3u, 5u, 7u, 9u,    102u, 0u, 0u, 0u,
+            });
+            CHECK(contents(buffers[2]) == std::vector<unsigned char>{
+                53u, 3u, 4u, 5u,
+            });
+        }
+
+        TEST_CASE("TextureBufferTest.generateMipsMatchesBoxFilter", "[TextureBufferTest]") {
+            // odd and non square sizes as well as sizes that are not a multiple of the vector width
+            for (const auto& size : { vm::vec2s(37u, 13u), vm::vec2s(64u, 64u), vm::vec2s(1u, 9u), vm::vec2s(10u, 1u) }) {
+                const auto width = size.x();
+                const auto height = size.y();
+
+                auto buffers = TextureBufferList{};
+                buffers.push_back(makePattern(width, height));
+                generateMips(buffers, width, height, GL_RGBA);
+
+                REQUIRE(buffers.size() == mipLevelCount(width, height));
+                for (size_t level = 1u; level < buffers.size(); ++level) {
+                    const auto srcSize = sizeAtMipLevel(width, height, level - 1u);
+                    const auto dstSize = sizeAtMipLevel(width, height, level);
+                    const auto* src = buffers[level - 1u].data();
+                    const auto* dst = buffers[level].data();
+
+                    REQUIRE(buffers[level].size() == 4u * dstSize.x() * dstSize.y());
+                    for (size_t y = 0u; y < dstSize.y(); ++y) {
+                        for (size_t x = 0u; x < dstSize.x(); ++x) {
+                            const auto x0 = std::min(2u * x, srcSize.x() - 1u);
+                            const auto x1 = std::min(2u * x + 1u, srcSize.x() - 1u);
+                            const auto y0 = std::min(2u * y, srcSize.y() - 1u);
+                            const auto y1 = std::min(2u * y + 1u, srcSize.y() - 1u);
+                            for (size_t c = 0u; c < 4u; ++c) {
+                                const auto sum = static_cast<unsigned int>(src[4u * (y0 * srcSize.x() + x0) + c])
+                                    + src[4u * (y0 * srcSize.x() + x1) + c]
+                                    + src[4u * (y1 * srcSize.x() + x0) + c]
+                                    + src[4u * (y1 * srcSize.x() + x1) + c];
+                                CHECK(static_cast<unsigned int>(dst[4u * (y * dstSize.x() + x) + c]) == (sum + 2u) / 4u);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
@@ -149,6 +149,21 @@ namespace TrenchBroom {
             CHECK(Disk::openFile(env.dir() + Path("anotherDir/subDirTest/test2.map")) != nullptr);
         }
 
+        TEST_CASE("DiskTest.openMappedFile", "[DiskTest]") {
+            FSTestEnvironment env;
+
+            CHECK_THROWS_AS(Disk::openMappedFile(Path("asdf/bleh")), FileSystemException);
+            CHECK_THROWS_AS(Disk::openMappedFile(env.dir() + Path("does/not/exist")), FileNotFoundException);
+            CHECK_THROWS_AS(Disk::openMappedFile(env.dir() + Path("does_not_exist.txt")), FileNotFoundException);
+
+            const auto file = Disk::openMappedFile(env.dir() + Path("test.txt"));
+            REQUIRE(file != nullptr);
+            CHECK(file->size() == 12u);
+
+            const auto reader = file->reader().buffer();
+            CHECK(reader.stringView() == "some content");
+        }
+
         TEST_CASE("DiskTest.resolvePath", "[DiskTest]") {
             FSTestEnvironment env;
 
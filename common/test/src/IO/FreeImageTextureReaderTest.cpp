@@ -85,7 +85,7 @@ namespace TrenchBroom {
 
             CHECK(texture.width() == w);
             CHECK(texture.height() == h);
-            CHECK(texture.buffersIfUnprepared().size() == 1u);
+            CHECK(texture.buffersIfUnprepared().size() == 7u);
             CHECK((GL_BGRA == texture.format() || GL_RGBA == texture.format()));
             CHECK(texture.type() == Assets::TextureType::Opaque);
 
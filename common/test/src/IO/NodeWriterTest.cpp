@@ -46,6 +46,7 @@
 #include <fmt/format.h>
 
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <vector>
 
@@ -1181,6 +1182,84 @@ common/caulk
             CHECK(actual == expected);
         }
 
+        TEST_CASE("NodeWriterTest.reuseCachedSerialization", "[NodeWriterTest]") {
+            const auto worldBounds = vm::bbox3{8192.0};
+
+            auto map = Model::WorldNode{Model::Entity{}, Model::MapFormat::Standard};
+
+            const auto builder = Model::BrushBuilder{map.mapFormat(), worldBounds};
+            auto* brushNode = new Model::BrushNode{builder.createCube(64.0, "none").value()};
+            map.defaultLayer()->addChild(brushNode);
+
+            const auto writeMap = [](const Model::WorldNode& world) {
+                auto str = std::stringstream{};
+                auto writer = NodeWriter{world, str};
+                writer.writeMap();
+                return str.str();
+            };
+
+            CHECK(brushNode->cachedSerialization(Model::MapFormat::Standard) == nullptr);
+
+            const auto original = writeMap(map);
+            const auto cachedSerialization = brushNode->cachedSerialization(Model::MapFormat::Standard);
+            REQUIRE(cachedSerialization != nullptr);
+            CHECK(cachedSerialization->lineCount == 6u);
+            CHECK(brushNode->cachedSerialization(Model::MapFormat::Valve) == nullptr);
+
+            SECTION("Writing again reuses the cached serialization") {
+                CHECK(writeMap(map) == original);
+                CHECK(brushNode->cachedSerialization(Model::MapFormat::Standard) == cachedSerialization);
+            }
+
+            SECTION("Clones share the cached serialization") {
+                auto clone = std::unique_ptr<Model::Node>{brushNode->clone(worldBounds)};
+                CHECK(clone->cachedSerialization(Model::MapFormat::Standard) == cachedSerialization);
+            }
+
+            SECTION("Changing the brush invalidates the cached serialization") {
+                auto brush = brushNode->brush();
+                REQUIRE(brush.transform(worldBounds, vm::translation_matrix(vm::vec3{16.0, 0.0, 0.0}), false).is_success());
+                brushNode->setBrush(std::move(brush));
+                CHECK(brushNode->cachedSerialization(Model::MapFormat::Standard) == nullptr);
+
+                auto expectedMap = Model::WorldNode{Model::Entity{}, Model::MapFormat::Standard};
+                expectedMap.defaultLayer()->addChild(new Model::BrushNode{brushNode->brush()});
+
+                const auto expected = writeMap(expectedMap);
+                CHECK(expected != original);
+                CHECK(writeMap(map) == expected);
+                CHECK(brushNode->cachedSerialization(Model::MapFormat::Standard) != nullptr);
+            }
+        }
+
+        TEST_CASE("NodeWriterTest.countReusedSerializations", "[NodeWriterTest]") {
+            const auto worldBounds = vm::bbox3{8192.0};
+
+            auto map = Model::WorldNode{Model::Entity{}, Model::MapFormat::Standard};
+
+            const auto builder = Model::BrushBuilder{map.mapFormat(), worldBounds};
+            auto* brushNode1 = new Model::BrushNode{builder.createCube(64.0, "none").value()};
+            auto* brushNode2 = new Model::BrushNode{builder.createCube(32.0, "none").value()};
+            map.defaultLayer()->addChild(brushNode1);
+            map.defaultLayer()->addChild(brushNode2);
+
+            const auto writeMap = [](const Model::WorldNode& world) {
+                auto str = std::stringstream{};
+                auto writer = NodeWriter{world, str};
+                return writer.writeMap();
+            };
+
+            CHECK(writeMap(map) == 0u);
+            CHECK(writeMap(map) == 2u);
+
+            auto brush = brushNode1->brush();
+            REQUIRE(brush.transform(worldBounds, vm::translation_matrix(vm::vec3{16.0, 0.0, 0.0}), false).is_success());
+            brushNode1->setBrush(std::move(brush));
+
+            CHECK(writeMap(map) == 1u);
+            CHECK(writeMap(map) == 2u);
+        }
+
 
     }
 }
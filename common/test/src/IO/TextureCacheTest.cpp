@@ -0,0 +1,189 @@
+/*
+ Copyright (C) 2021 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Color.h"
+#include "Exceptions.h"
+#include "Assets/Texture.h"
+#include "Assets/TextureBuffer.h"
+#include "IO/Path.h"
+#include "IO/TestEnvironment.h"
+#include "IO/TextureCache.h"
+
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Catch2.h"
+
+namespace TrenchBroom {
+    namespace IO {
+        static Assets::Texture makeTexture(const std::string& name) {
+            auto buffers = Assets::TextureBufferList(2);
+            Assets::setMipBufferSize(buffers, 2, 4, 2, GL_RGBA);
+            for (size_t i = 0; i < buffers.size(); ++i) {
+                for (size_t j = 0; j < buffers[i].size(); ++j) {
+                    buffers[i].data()[j] = static_cast<unsigned char>(i + j);
+                }
+            }
+
+            auto texture = Assets::Texture(name, 4, 2, Color(0.25f, 0.5f, 0.75f, 1.0f), std::move(buffers), GL_RGBA, Assets::TextureType::Masked);
+            texture.setRelativePath(Path("textures/" + name + ".png"));
+            texture.setSurfaceParms({"nodraw", "trans"});
+            texture.setCulling(Assets::TextureCulling::CullNone);
+            texture.setBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+            return texture;
+        }
+
+        TEST_CASE("TextureCacheTest.storeAndFind", "[TextureCacheTest]") {
+            const auto env = TestEnvironment("TextureCacheTest");
+            const auto key = TextureCache::Key{Path("/textures.wad"), Path("texture.D"), 1234};
+            const auto texture = makeTexture("texture");
+
+            {
+                auto cache = TextureCache(env.dir(), "collection");
+                CHECK(cache.size() == 0u);
+                CHECK_FALSE(cache.find(key).has_value());
+
+                cache.store({{key, &texture}});
+            }
+
+            const auto cache = TextureCache(env.dir(), "collection");
+            CHECK(cache.size() == 1u);
+
+            const auto cached = cache.find(key);
+            REQUIRE(cached.has_value());
+            CHECK(cached->name() == texture.name());
+            CHECK(cached->relativePath() == texture.relativePath());
+            CHECK(cached->width() == texture.width());
+            CHECK(cached->height() == texture.height());
+            CHECK(cached->averageColor() == texture.averageColor());
+            CHECK(cached->format() == texture.format());
+            CHECK(cached->type() == texture.type());
+            CHECK(cached->surfaceParms() == texture.surfaceParms());
+            CHECK(cached->culling() == texture.culling());
+            CHECK(cached->blendFunc().enable == texture.blendFunc().enable);
+            CHECK(cached->blendFunc().srcFactor == texture.blendFunc().srcFactor);
+            CHECK(cached->blendFunc().destFactor == texture.blendFunc().destFactor);
+
+            const auto& expectedBuffers = texture.buffersIfUnprepared();
+            const auto& actualBuffers = cached->buffersIfUnprepared();
+            REQUIRE(actualBuffers.size() == expectedBuffers.size());
+            for (size_t i = 0; i < expectedBuffers.size(); ++i) {
+                CHECK(std::vector<unsigned char>(actualBuffers[i].data(), actualBuffers[i].data() + actualBuffers[i].size())
+                   == std::vector<unsigned char>(expectedBuffers[i].data(), expectedBuffers[i].data() + expectedBuffers[i].size()));
+            }
+        }
+
+        TEST_CASE("TextureCacheTest.findModifiedTexture", "[TextureCacheTest]") {
+            const auto env = TestEnvironment("TextureCacheTest");
+            const auto key = TextureCache::Key{Path("/textures.wad"), Path("texture.D"), 1234};
+            const auto texture = makeTexture("texture");
+
+            TextureCache(env.dir(), "collection").store({{key, &texture}});
+
+            const auto cache = TextureCache(env.dir(), "collection");
+            CHECK(cache.find(key).has_value());
+            CHECK_FALSE(cache.find(TextureCache::Key{key.sourcePath, key.entryPath, 1235}).has_value());
+            CHECK_FALSE(cache.find(TextureCache::Key{key.sourcePath, Path("other.D"), 1234}).has_value());
+        }
+
+        TEST_CASE("TextureCacheTest.collectionKey", "[TextureCacheTest]") {
+            const auto env = TestEnvironment("TextureCacheTest");
+            const auto key = TextureCache::Key{Path("/textures.wad"), Path("texture.D"), 1234};
+            const auto texture = makeTexture("texture");
+
+            TextureCache(env.dir(), "collection").store({{key, &texture}});
+
+            CHECK(TextureCache(env.dir(), "collection").size() == 1u);
+            CHECK(TextureCache(env.dir(), "other collection").size() == 0u);
+        }
+
+        TEST_CASE("TextureCacheTest.storeError", "[TextureCacheTest]") {
+            auto env = TestEnvironment("TextureCacheTest");
+            const auto key = TextureCache::Key{Path("/textures.wad"), Path("texture.D"), 1234};
+            const auto texture = makeTexture("texture");
+
+            // the cache directory cannot be created where a file exists
+            env.createFile(Path("file"), "");
+            const auto cacheDirectory = env.dir() + Path("file");
+
+            const auto store = TextureCache(cacheDirectory, "collection").store({{key, &texture}});
+            CHECK_THROWS_AS(store.get(), FileSystemException);
+
+            const auto cache = TextureCache(cacheDirectory, "collection");
+            CHECK(cache.storeError().has_value());
+            CHECK(cache.size() == 0u);
+        }
+
+        TEST_CASE("TextureCacheTest.corruptCacheFile", "[TextureCacheTest]") {
+            auto env = TestEnvironment("TextureCacheTest");
+            const auto key = TextureCache::Key{Path("/textures.wad"), Path("texture.D"), 1234};
+            const auto texture = makeTexture("texture");
+
+            auto cache = TextureCache(env.dir(), "collection");
+            cache.store({{key, &texture}}).wait();
+
+            const auto cacheFileName = Path(TextureCache::fingerprint("collection")).addExtension("texcache");
+            REQUIRE(env.fileExists(cacheFileName));
+            env.createFile(cacheFileName, "TBTC garbage");
+
+            CHECK(TextureCache(env.dir(), "collection").size() == 0u);
+        }
+
+        static void overwriteAfter(const Path& filePath, const std::string& marker, const std::uint32_t value) {
+            auto file = std::fstream(filePath.asString(), std::ios::in | std::ios::out | std::ios::binary);
+            REQUIRE(file.is_open());
+
+            const auto contents = std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            const auto position = contents.find(marker);
+            REQUIRE(position != std::string::npos);
+
+            file.clear();
+            file.seekp(static_cast<std::streamoff>(position + marker.size()));
+            file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+
+        TEST_CASE("TextureCacheTest.corruptTexture", "[TextureCacheTest]") {
+            auto env = TestEnvironment("TextureCacheTest");
+            const auto key = TextureCache::Key{Path("/textures.wad"), Path("texture.D"), 1234};
+            const auto texture = makeTexture("texture");
+            TextureCache(env.dir(), "collection").store({{key, &texture}});
+
+            const auto cacheFilePath = env.dir() + Path(TextureCache::fingerprint("collection")).addExtension("texcache");
+
+            SECTION("Invalid texture size") {
+                // the width follows the relative path of the texture
+                overwriteAfter(cacheFilePath, "textures/texture.png", 0xFFFFFFFFu);
+            }
+
+            SECTION("Invalid string length") {
+                // the relative path follows the absolute path of the texture, which is empty
+                overwriteAfter(cacheFilePath, std::string("texture\0\0\0\0", 11u), 0x7FFFFFFFu);
+            }
+
+            const auto cache = TextureCache(env.dir(), "collection");
+            CHECK(cache.size() == 1u);
+            CHECK_FALSE(cache.find(key).has_value());
+        }
+    }
+}
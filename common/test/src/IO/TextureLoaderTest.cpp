@@ -51,7 +51,7 @@ namespace TrenchBroom {
             auto logger = NullLogger();
             auto textureManager = Assets::TextureManager(0, 0, logger);
 
-            IO::TextureLoader textureLoader(fileSystem, fileSearchPaths, textureConfig, logger);
+            IO::TextureLoader textureLoader(fileSystem, fileSearchPaths, textureConfig, IO::Path(), logger);
             textureLoader.loadTextures(paths, textureManager);
 
             using TexInfo = std::tuple<std::string, size_t, size_t>;
@@ -112,7 +112,7 @@ namespace TrenchBroom {
             auto logger = NullLogger();
             auto textureManager = Assets::TextureManager(0, 0, logger);
 
-            IO::TextureLoader textureLoader(fileSystem, fileSearchPaths, textureConfig, logger);
+            IO::TextureLoader textureLoader(fileSystem, fileSearchPaths, textureConfig, IO::Path(), logger);
             textureLoader.loadTextures(paths, textureManager);
 
             using TexInfo = std::tuple<std::string, size_t, size_t>;
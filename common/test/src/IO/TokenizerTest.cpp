@@ -17,6 +17,7 @@
  along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "IO/StandardMapParser.h"
 #include "IO/Token.h"
 #include "IO/Tokenizer.h"
 
@@ -242,5 +243,53 @@ namespace TrenchBroom {
             CHECK((token = tokenizer.nextToken()).type() == SimpleToken::CBrace);
             CHECK(tokenizer.nextToken().type() == SimpleToken::Eof);
         }
+
+        TEST_CASE("TokenizerTest.quakeMapTokenizerNumbersAndWords", "[TokenizerTest]") {
+            const std::string testString("( -64 +16.5 .5 1e3 12) abc) 3.5.1 -1.5e-3)");
+
+            QuakeMapTokenizer tokenizer(testString);
+            QuakeMapTokenizer::Token token;
+            CHECK((token = tokenizer.nextToken()).type() == QuakeMapToken::OParenthesis);
+            CHECK((token = tokenizer.nextToken()).type() == QuakeMapToken::Integer);
+            CHECK(token.toInteger<int>() == -64);
+            CHECK((token = tokenizer.nextToken()).type() == QuakeMapToken::Decimal);
+            CHECK(token.toFloat<double>() == vm::approx(16.5));
+            CHECK((token = tokenizer.nextToken()).type() == QuakeMapToken::Decimal);
+            CHECK(token.toFloat<double>() == vm::approx(0.5));
+            CHECK((token = tokenizer.nextToken()).type() == QuakeMapToken::Decimal);
+            CHECK(token.toFloat<double>() == vm::approx(1000.0));
+            CHECK((token = tokenizer.nextToken()).type() == QuakeMapToken::Integer);
+            CHECK(token.toInteger<int>() == 12);
+            CHECK((token = tokenizer.nextToken()).type() == QuakeMapToken::CParenthesis);
+            CHECK((token = tokenizer.nextToken()).type() == QuakeMapToken::String);
+            CHECK(token.data() == "abc)");
+            CHECK((token = tokenizer.nextToken()).type() == QuakeMapToken::String);
+            CHECK(token.data() == "3.5.1");
+            CHECK((token = tokenizer.nextToken()).type() == QuakeMapToken::Decimal);
+            CHECK(token.toFloat<double>() == vm::approx(-0.0015));
+            CHECK((token = tokenizer.nextToken()).type() == QuakeMapToken::CParenthesis);
+            CHECK(tokenizer.nextToken().type() == QuakeMapToken::Eof);
+        }
+
+        TEST_CASE("TokenizerTest.quakeMapTokenizerLineAndColumn", "[TokenizerTest]") {
+            const std::string testString("{\r\n                    \t  \n\n            \"classname\"\r\n  \r\n  1\n}");
+
+            QuakeMapTokenizer tokenizer(testString);
+            QuakeMapTokenizer::Token token;
+            CHECK((token = tokenizer.nextToken()).type() == QuakeMapToken::OBrace);
+            CHECK(token.line() == 1u);
+            CHECK(token.column() == 1u);
+            CHECK((token = tokenizer.nextToken()).type() == QuakeMapToken::String);
+            CHECK(token.data() == "classname");
+            CHECK(token.line() == 4u);
+            CHECK(token.column() == 13u);
+            CHECK((token = tokenizer.nextToken()).type() == QuakeMapToken::Integer);
+            CHECK(token.line() == 6u);
+            CHECK(token.column() == 3u);
+            CHECK((token = tokenizer.nextToken()).type() == QuakeMapToken::CBrace);
+            CHECK(token.line() == 7u);
+            CHECK(token.column() == 1u);
+            CHECK(tokenizer.nextToken().type() == QuakeMapToken::Eof);
+        }
     }
 }
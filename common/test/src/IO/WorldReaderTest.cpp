@@ -1554,6 +1554,56 @@ common/caulk
             }
         }
 
+        TEST_CASE("WorldReaderTest.parseManyBrushes", "[WorldReaderTest]") {
+            // enough brushes so that their nodes are created in several batches while parsing
+            const auto brush = std::string{R"(
+{
+( -64 -64 -16 ) ( -64 -63 -16 ) ( -64 -64 -15 ) __TB_empty 0 0 0 1 1
+( -64 -64 -16 ) ( -64 -64 -15 ) ( -63 -64 -16 ) __TB_empty 0 0 0 1 1
+( -64 -64 -16 ) ( -63 -64 -16 ) ( -64 -63 -16 ) __TB_empty 0 0 0 1 1
+( 64 64 16 ) ( 64 65 16 ) ( 65 64 16 ) __TB_empty 0 0 0 1 1
+( 64 64 16 ) ( 65 64 16 ) ( 64 64 17 ) __TB_empty 0 0 0 1 1
+( 64 64 16 ) ( 64 64 17 ) ( 64 65 16 ) __TB_empty 0 0 0 1 1
+})"};
+
+            auto data = std::string{"{\n\"classname\" \"worldspawn\""};
+            for (size_t i = 0; i < 1000; ++i) {
+                data += brush;
+            }
+            data += "\n}\n{\n\"classname\" \"func_detail\"";
+            for (size_t i = 0; i < 500; ++i) {
+                data += brush;
+            }
+            data += "\n}\n{\n\"classname\" \"info_player_start\"\n}\n";
+
+            const vm::bbox3 worldBounds(8192.0);
+
+            IO::TestParserStatus status;
+            WorldReader reader(data, Model::MapFormat::Standard);
+
+            auto world = reader.read(worldBounds, status);
+            REQUIRE(world != nullptr);
+
+            const auto& children = world->defaultLayer()->children();
+            REQUIRE(children.size() == 1002u);
+
+            for (size_t i = 0; i < 1000; ++i) {
+                const auto* brushNode = dynamic_cast<Model::BrushNode*>(children[i]);
+                REQUIRE(brushNode != nullptr);
+                CHECK(brushNode->lineNumber() == 3u + 8u * i);
+            }
+
+            const auto* detailNode = dynamic_cast<Model::EntityNode*>(children[1000]);
+            REQUIRE(detailNode != nullptr);
+            CHECK(detailNode->entity().classname() == "func_detail");
+            CHECK(detailNode->childCount() == 500u);
+            CHECK(detailNode->lineNumber() == 8004u);
+
+            const auto* playerStartNode = dynamic_cast<Model::EntityNode*>(children[1001]);
+            REQUIRE(playerStartNode != nullptr);
+            CHECK(playerStartNode->entity().classname() == "info_player_start");
+        }
+
         TEST_CASE("WorldReaderTest.parseUnknownFormatEmptyMap", "[WorldReaderTest]") {
             const auto data = R"(
 {
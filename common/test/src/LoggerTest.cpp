@@ -0,0 +1,62 @@
+/*
+ Copyright (C) 2021 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "Logger.h"
+#include "TestLogger.h"
+
+#include <thread>
+
+#include "Catch2.h"
+
+namespace TrenchBroom {
+    TEST_CASE("LoggerTest.deferMessages", "[LoggerTest]") {
+        auto logger = TestLogger{};
+        auto messages = Logger::DeferredMessageList{};
+
+        {
+            const Logger::DeferMessages deferMessages(messages);
+            logger.info("info");
+            logger.warn() << "warn";
+        }
+
+        CHECK(logger.countMessages() == 0u);
+        REQUIRE(messages.size() == 2u);
+        CHECK(messages[0].level == LogLevel::Info);
+        CHECK(messages[0].str == "info");
+        CHECK(messages[1].level == LogLevel::Warn);
+        CHECK(messages[1].str == "warn");
+
+        logger.error("error");
+        CHECK(logger.countMessages(LogLevel::Error) == 1u);
+        CHECK(messages.size() == 2u);
+    }
+
+    TEST_CASE("LoggerTest.deferMessagesOnlyAffectsCurrentThread", "[LoggerTest]") {
+        auto logger = TestLogger{};
+        auto messages = Logger::DeferredMessageList{};
+
+        const Logger::DeferMessages deferMessages(messages);
+        auto thread = std::thread{[&]() { logger.info("info"); }};
+        thread.join();
+
+        CHECK(logger.countMessages(LogLevel::Info) == 1u);
+        CHECK(messages.empty());
+    }
+}
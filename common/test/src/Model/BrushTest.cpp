@@ -132,6 +132,185 @@ namespace TrenchBroom {
             }).is_error());
         }
 
+        TEST_CASE("BrushTest.copyBuildsGeometryOnDemand", "[BrushTest]") {
+            const vm::bbox3 worldBounds(4096.0);
+            const BrushBuilder builder(MapFormat::Standard, worldBounds);
+
+            const Brush original = builder.createCuboid(vm::bbox3(vm::vec3(-64, -64, -64), vm::vec3(64, 64, 64)), "texture").value();
+            REQUIRE(original.hasGeometry());
+
+            const Brush copy = original;
+            CHECK_FALSE(copy.hasGeometry());
+            CHECK(copy.bounds() == original.bounds());
+            CHECK(copy.containsPoint(vm::vec3::zero()));
+            CHECK_FALSE(copy.hasGeometry());
+
+            CHECK(copy.vertexCount() == 8u);
+            CHECK(copy.hasGeometry());
+            CHECK_THAT(copy.vertexPositions(), Catch::UnorderedEquals(original.vertexPositions()));
+            for (size_t i = 0u; i < copy.faceCount(); ++i) {
+                CHECK(copy.face(i).geometry() != original.face(i).geometry());
+                CHECK_THAT(copy.face(i).vertexPositions(), Catch::UnorderedEquals(original.face(i).vertexPositions()));
+            }
+        }
+
+        TEST_CASE("BrushTest.releaseGeometry", "[BrushTest]") {
+            const vm::bbox3 worldBounds(4096.0);
+            const BrushBuilder builder(MapFormat::Standard, worldBounds);
+
+            Brush brush = builder.createCuboid(vm::bbox3(vm::vec3(-64, -64, -64), vm::vec3(64, 64, 64)), "texture").value();
+            const auto bounds = brush.bounds();
+            const auto vertexPositions = brush.vertexPositions();
+
+            CHECK(brush.releaseGeometry());
+            CHECK_FALSE(brush.hasGeometry());
+            CHECK(brush.bounds() == bounds);
+
+            CHECK_THAT(brush.vertexPositions(), Catch::UnorderedEquals(vertexPositions));
+            CHECK(brush.fullySpecified());
+
+            // editing a brush without geometry rebuilds it from the edited faces
+            brush.releaseGeometry();
+            REQUIRE(brush.moveBoundary(worldBounds, *brush.findFace(vm::vec3::pos_z()), vm::vec3(0, 0, 16), true).is_success());
+            CHECK(brush.bounds() == vm::bbox3(vm::vec3(-64, -64, -64), vm::vec3(64, 64, 80)));
+        }
+
+        TEST_CASE("BrushTest.keepGeometryIfFacesWereDropped", "[BrushTest]") {
+            const vm::bbox3 worldBounds(4096.0);
+
+            // a cube with length 16 at the origin and a redundant face outside of it
+            Brush brush = Brush::create(worldBounds, {
+                createParaxial(
+                    vm::vec3(0.0, 0.0, 0.0),
+                    vm::vec3(0.0, 1.0, 0.0),
+                    vm::vec3(0.0, 0.0, 1.0)),
+                createParaxial(
+                    vm::vec3(16.0, 0.0, 0.0),
+                    vm::vec3(16.0, 0.0, 1.0),
+                    vm::vec3(16.0, 1.0, 0.0)),
+                createParaxial(
+                    vm::vec3(32.0, 0.0, 0.0),
+                    vm::vec3(32.0, 0.0, 1.0),
+                    vm::vec3(32.0, 1.0, 0.0)),
+                createParaxial(
+                    vm::vec3(0.0, 0.0, 0.0),
+                    vm::vec3(0.0, 0.0, 1.0),
+                    vm::vec3(1.0, 0.0, 0.0)),
+                createParaxial(
+                    vm::vec3(0.0, 16.0, 0.0),
+                    vm::vec3(1.0, 16.0, 0.0),
+                    vm::vec3(0.0, 16.0, 1.0)),
+                createParaxial(
+                    vm::vec3(0.0, 0.0, 16.0),
+                    vm::vec3(0.0, 1.0, 16.0),
+                    vm::vec3(1.0, 0.0, 16.0)),
+                createParaxial(
+                    vm::vec3(0.0, 0.0, 0.0),
+                    vm::vec3(1.0, 0.0, 0.0),
+                    vm::vec3(0.0, 1.0, 0.0)),
+            }).value();
+            REQUIRE(brush.faceCount() == 6u);
+
+            // the dropped face took part in building the geometry, so it cannot be rebuilt from the remaining faces
+            CHECK_FALSE(brush.releaseGeometry());
+            CHECK(brush.hasGeometry());
+
+            const Brush copy = brush;
+            CHECK(copy.hasGeometry());
+            CHECK_THAT(copy.vertexPositions(), Catch::UnorderedEquals(brush.vertexPositions()));
+            for (size_t i = 0u; i < copy.faceCount(); ++i) {
+                CHECK(copy.face(i).geometry() != brush.face(i).geometry());
+                CHECK_THAT(copy.face(i).vertexPositions(), Catch::UnorderedEquals(brush.face(i).vertexPositions()));
+            }
+        }
+
+        TEST_CASE("BrushTest.createDeferred", "[BrushTest]") {
+            const vm::bbox3 worldBounds(4096.0);
+
+            // a cube with length 16 at the origin
+            auto faces = std::vector<BrushFace>{
+                createParaxial(
+                    vm::vec3(0.0, 0.0, 0.0),
+                    vm::vec3(0.0, 1.0, 0.0),
+                    vm::vec3(0.0, 0.0, 1.0)),
+                createParaxial(
+                    vm::vec3(16.0, 0.0, 0.0),
+                    vm::vec3(16.0, 0.0, 1.0),
+                    vm::vec3(16.0, 1.0, 0.0)),
+                createParaxial(
+                    vm::vec3(0.0, 0.0, 0.0),
+                    vm::vec3(0.0, 0.0, 1.0),
+                    vm::vec3(1.0, 0.0, 0.0)),
+                createParaxial(
+                    vm::vec3(0.0, 16.0, 0.0),
+                    vm::vec3(1.0, 16.0, 0.0),
+                    vm::vec3(0.0, 16.0, 1.0)),
+                createParaxial(
+                    vm::vec3(0.0, 0.0, 16.0),
+                    vm::vec3(0.0, 1.0, 16.0),
+                    vm::vec3(1.0, 0.0, 16.0)),
+                createParaxial(
+                    vm::vec3(0.0, 0.0, 0.0),
+                    vm::vec3(1.0, 0.0, 0.0),
+                    vm::vec3(0.0, 1.0, 0.0)),
+            };
+
+            SECTION("Valid brush") {
+                const Brush brush = Brush::createDeferred(worldBounds, faces).value();
+                const Brush expected = Brush::create(worldBounds, faces).value();
+
+                CHECK_FALSE(brush.hasGeometry());
+                CHECK(brush.bounds() == vm::bbox3(vm::vec3(0, 0, 0), vm::vec3(16, 16, 16)));
+                CHECK(brush.bounds() == expected.bounds());
+                CHECK(brush.facesWithoutGeometry().size() == 6u);
+                CHECK_FALSE(brush.hasGeometry());
+
+                CHECK_THAT(brush.vertexPositions(), Catch::UnorderedEquals(expected.vertexPositions()));
+                CHECK(brush.hasGeometry());
+                for (const auto& face : brush.faces()) {
+                    CHECK(face.geometry() != nullptr);
+                }
+            }
+
+            SECTION("Redundant face") {
+                faces.push_back(createParaxial(
+                    vm::vec3(32.0, 0.0, 0.0),
+                    vm::vec3(32.0, 0.0, 1.0),
+                    vm::vec3(32.0, 1.0, 0.0)));
+
+                const Brush brush = Brush::createDeferred(worldBounds, faces).value();
+                CHECK(brush.hasGeometry());
+                CHECK(brush.faceCount() == 6u);
+            }
+
+            SECTION("Open brush") {
+                faces.pop_back();
+                CHECK(Brush::createDeferred(worldBounds, faces).is_error());
+            }
+
+            SECTION("Brush touching the world bounds") {
+                CHECK(Brush::createDeferred(vm::bbox3(16.0), faces).is_error());
+            }
+        }
+
+        TEST_CASE("BrushTest.lastGeometryAccess", "[BrushTest]") {
+            const vm::bbox3 worldBounds(4096.0);
+            const BrushBuilder builder(MapFormat::Standard, worldBounds);
+
+            const Brush used = builder.createCube(64.0, "").value();
+            const Brush unused = builder.createCube(32.0, "").value();
+            CHECK(used.lastGeometryAccess() == unused.lastGeometryAccess());
+
+            Brush::advanceGeometryAccessClock();
+            CHECK(used.lastGeometryAccess() == unused.lastGeometryAccess());
+
+            used.vertexCount();
+            CHECK(used.lastGeometryAccess() > unused.lastGeometryAccess());
+
+            const Brush copy = used;
+            CHECK(copy.lastGeometryAccess() == used.lastGeometryAccess());
+        }
+
         TEST_CASE("BrushTest.clip", "[BrushTest]") {
             const vm::bbox3 worldBounds(4096.0);
 
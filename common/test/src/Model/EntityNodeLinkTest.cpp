@@ -26,6 +26,7 @@
 
 #include <kdl/vector_utils.h>
 
+#include <string>
 #include <vector>
 
 #include "Catch2.h"
@@ -379,5 +380,54 @@ namespace TrenchBroom {
 
             delete targetNode;
         }
+
+        TEST_CASE("EntityNodeLinkTest.testFindMissingTargets", "[EntityNodeLinkTest]") {
+            WorldNode world(Model::Entity(), MapFormat::Standard);
+            EntityNode* sourceNode = new Model::EntityNode(Model::Entity({
+                { PropertyKeys::Target, "a"},
+                { PropertyKeys::Target + "2", "b"},
+                { PropertyKeys::Target + "3", ""},
+                { PropertyKeys::Killtarget, "a"},
+                { PropertyKeys::Killtarget + "2", "c"}
+            }));
+            EntityNode* targetNode = new Model::EntityNode(Model::Entity({
+                { PropertyKeys::Targetname, "a"}
+            }));
+            EntityNode* otherNode = new Model::EntityNode(Model::Entity({
+                { PropertyKeys::Targetname, "d"}
+            }));
+
+            world.defaultLayer()->addChild(sourceNode);
+            world.defaultLayer()->addChild(targetNode);
+            world.defaultLayer()->addChild(otherNode);
+
+            CHECK(sourceNode->findMissingLinkTargets() == std::vector<std::string>{ PropertyKeys::Target + "2", PropertyKeys::Target + "3" });
+            CHECK(sourceNode->findMissingKillTargets() == std::vector<std::string>{ PropertyKeys::Killtarget + "2" });
+
+            // validate the issues so that we can check which nodes are invalidated
+            sourceNode->issues({});
+            targetNode->issues({});
+            otherNode->issues({});
+
+            EntityNode* secondTargetNode = new Model::EntityNode(Model::Entity({
+                { PropertyKeys::Targetname, "b"}
+            }));
+            world.defaultLayer()->addChild(secondTargetNode);
+
+            CHECK(sourceNode->findMissingLinkTargets() == std::vector<std::string>{ PropertyKeys::Target + "3" });
+            CHECK_FALSE(sourceNode->issuesValid());
+            CHECK(targetNode->issuesValid());
+            CHECK(otherNode->issuesValid());
+
+            sourceNode->issues({});
+            targetNode->setEntity(Entity({
+                { PropertyKeys::Targetname, "c"}
+            }));
+
+            CHECK(sourceNode->findMissingLinkTargets() == std::vector<std::string>{ PropertyKeys::Target, PropertyKeys::Target + "3" });
+            CHECK(sourceNode->findMissingKillTargets() == std::vector<std::string>{ PropertyKeys::Killtarget });
+            CHECK_FALSE(sourceNode->issuesValid());
+            CHECK(otherNode->issuesValid());
+        }
     }
 }
@@ -45,6 +45,9 @@
 #include <vecmath/vec.h>
 #include <vecmath/vec_io.h>
 
+#include <memory>
+#include <vector>
+
 #include "TestUtils.h"
 #include "Catch2.h"
 
@@ -380,6 +383,64 @@ namespace TrenchBroom {
             }));
         }
 
+        TEST_CASE("ModelUtils.collectMatchingNodesInWorld") {
+            constexpr auto worldBounds = vm::bbox3d{8192.0};
+            constexpr auto mapFormat = MapFormat::Quake3;
+
+            const auto builder = BrushBuilder{mapFormat, worldBounds};
+            const auto makeBrushNode = [&](const double size, const vm::vec3d& offset) {
+                auto* brushNode = new BrushNode{builder.createCube(size, "texture").value()};
+                transformNode(*brushNode, vm::translation_matrix(offset), worldBounds);
+                return brushNode;
+            };
+
+            auto worldNode = WorldNode{Entity{}, mapFormat};
+            auto* layerNode = worldNode.defaultLayer();
+
+            // the bounds of this group contain the origin, but none of its members do
+            auto* groupNode = new GroupNode{Group{"group"}};
+            groupNode->addChildren({makeBrushNode(32.0, {-100, 0, 0}), makeBrushNode(32.0, {100, 0, 0})});
+
+            auto* brushEntityNode = new EntityNode{Entity{}};
+            brushEntityNode->addChild(makeBrushNode(32.0, {0, 200, 0}));
+
+            auto* patchNode = new PatchNode{BezierPatch{3, 3, {
+                {0, 0, 0}, {1, 0, 1}, {2, 0, 0},
+                {0, 1, 1}, {1, 1, 2}, {2, 1, 1},
+                {0, 2, 0}, {1, 2, 1}, {2, 2, 0} }, "texture"}};
+            transformNode(*patchNode, vm::translation_matrix(vm::vec3d{0, -200, 0}), worldBounds);
+
+            auto* brushNode = makeBrushNode(32.0, {0, 0, 200});
+            auto* queryBrushInWorld = makeBrushNode(16.0, {0, 0, 220});
+
+            layerNode->addChildren({groupNode, brushEntityNode, patchNode, brushNode, queryBrushInWorld, new EntityNode{Entity{}}});
+
+            auto touchesGroupBounds = std::unique_ptr<BrushNode>{makeBrushNode(16.0, {0, 0, 0})};
+            auto containsAll = std::unique_ptr<BrushNode>{makeBrushNode(1024.0, {0, 0, 0})};
+            auto touchesNothing = std::unique_ptr<BrushNode>{makeBrushNode(16.0, {1000, 1000, 1000})};
+
+            const auto queries = std::vector<std::vector<BrushNode*>>{
+                {touchesGroupBounds.get()},
+                {containsAll.get()},
+                {touchesNothing.get()},
+                {queryBrushInWorld},
+                {touchesGroupBounds.get(), queryBrushInWorld},
+                {containsAll.get(), queryBrushInWorld, touchesNothing.get()}
+            };
+
+            for (const auto& brushes : queries) {
+                CHECK_THAT(collectTouchingNodes(worldNode, brushes), Catch::Matchers::UnorderedEquals(collectTouchingNodes(std::vector<Node*>{&worldNode}, brushes)));
+                CHECK_THAT(collectContainedNodes(worldNode, brushes), Catch::Matchers::UnorderedEquals(collectContainedNodes(std::vector<Node*>{&worldNode}, brushes)));
+            }
+
+            CHECK_THAT(collectTouchingNodes(worldNode, {touchesGroupBounds.get()}), Catch::Matchers::Equals(std::vector<Node*>{groupNode}));
+            CHECK_THAT(collectTouchingNodes(worldNode, {queryBrushInWorld}), Catch::Matchers::Equals(std::vector<Node*>{brushNode}));
+
+            groupNode->open();
+            CHECK_THAT(collectTouchingNodes(worldNode, {touchesGroupBounds.get()}), Catch::Matchers::Equals(std::vector<Node*>{}));
+            CHECK_THAT(collectContainedNodes(worldNode, {containsAll.get()}), Catch::Matchers::UnorderedEquals(collectContainedNodes(std::vector<Node*>{&worldNode}, {containsAll.get()})));
+        }
+
         TEST_CASE("ModelUtils.collectSelectedNodes") {
             constexpr auto worldBounds = vm::bbox3d{8192.0};
             constexpr auto mapFormat = MapFormat::Quake3;
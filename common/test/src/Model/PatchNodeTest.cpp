@@ -177,5 +177,99 @@ namespace TrenchBroom {
                 CHECK(pickResult.size() == 0u);
             }
         }
+
+        TEST_CASE("PatchNode.pickClosestHit") {
+            // the patch is bent so that a ray along the z axis at x = 1 hits it twice
+            using P = BezierPatch::Point;
+            auto patchNode = PatchNode{BezierPatch{3, 3, {
+                P{0.0, 0.0, 0.0}, P{8.0, 0.0, 4.0}, P{0.0, 0.0, 8.0},
+                P{0.0, 1.0, 0.0}, P{8.0, 1.0, 4.0}, P{0.0, 1.0, 8.0},
+                P{0.0, 2.0, 0.0}, P{8.0, 2.0, 4.0}, P{0.0, 2.0, 8.0},
+            }, "texture"}};
+
+            auto upwardPickResult = PickResult{};
+            patchNode.pick(vm::ray3{vm::vec3{1, 1, -8}, vm::vec3::pos_z()}, upwardPickResult);
+            REQUIRE(upwardPickResult.size() == 1u);
+            CHECK(upwardPickResult.all().front().hitPoint().z() < 4.0);
+
+            auto downwardPickResult = PickResult{};
+            patchNode.pick(vm::ray3{vm::vec3{1, 1, 16}, vm::vec3::neg_z()}, downwardPickResult);
+            REQUIRE(downwardPickResult.size() == 1u);
+            CHECK(downwardPickResult.all().front().hitPoint().z() > 4.0);
+
+            // the picking structure is rebuilt when the patch changes
+            patchNode.setPatch(BezierPatch{3, 3, {
+                P{0.0, 0.0, 0.0}, P{1.0, 0.0, 0.0}, P{2.0, 0.0, 0.0},
+                P{0.0, 1.0, 0.0}, P{1.0, 1.0, 0.0}, P{2.0, 1.0, 0.0},
+                P{0.0, 2.0, 0.0}, P{1.0, 2.0, 0.0}, P{2.0, 2.0, 0.0},
+            }, "texture"});
+
+            auto flatPickResult = PickResult{};
+            patchNode.pick(vm::ray3{vm::vec3{1, 1, 16}, vm::vec3::neg_z()}, flatPickResult);
+            REQUIRE(flatPickResult.size() == 1u);
+            CHECK(flatPickResult.all().front().hitPoint() == vm::approx{vm::vec3{1, 1, 0}});
+        }
+
+        TEST_CASE("PatchNode.computeSubdivisionsPerSurface") {
+            using P = BezierPatch::Point;
+
+            const auto flatPatch = BezierPatch{3, 3, {
+                P{0.0, 2.0, 0.0, 0.0, 0.0}, P{1.0, 2.0, 0.0, 0.5, 0.0}, P{2.0, 2.0, 0.0, 1.0, 0.0},
+                P{0.0, 1.0, 0.0, 0.0, 0.5}, P{1.0, 1.0, 0.0, 0.5, 0.5}, P{2.0, 1.0, 0.0, 1.0, 0.5},
+                P{0.0, 0.0, 0.0, 0.0, 1.0}, P{1.0, 0.0, 0.0, 0.5, 1.0}, P{2.0, 0.0, 0.0, 1.0, 1.0},
+            }, "texture"};
+            CHECK(computeSubdivisionsPerSurface(flatPatch, 1.0, 3u) == 0u);
+
+            // a flat patch with curved texture coordinates must be subdivided
+            const auto flatPatchWithCurvedTexCoords = BezierPatch{3, 3, {
+                P{0.0, 2.0, 0.0, 0.0, 0.0}, P{1.0, 2.0, 0.0, 0.5, 0.0}, P{2.0, 2.0, 0.0, 1.0, 0.0},
+                P{0.0, 1.0, 0.0, 0.0, 0.5}, P{1.0, 1.0, 0.0, 0.8, 0.5}, P{2.0, 1.0, 0.0, 1.0, 0.5},
+                P{0.0, 0.0, 0.0, 0.0, 1.0}, P{1.0, 0.0, 0.0, 0.5, 1.0}, P{2.0, 0.0, 0.0, 1.0, 1.0},
+            }, "texture"};
+            CHECK(computeSubdivisionsPerSurface(flatPatchWithCurvedTexCoords, 1.0, 3u) > 0u);
+
+            // the second differences of this hill sum up to 64, so the error is 8 / (k * k) for k quads per side
+            const auto hillPatch = BezierPatch{3, 3, {
+                P{0.0, 2.0, 0.0, 0.0, 0.0}, P{1.0, 2.0, 0.0, 0.5, 0.0}, P{2.0, 2.0, 0.0, 1.0, 0.0},
+                P{0.0, 1.0, 0.0, 0.0, 0.5}, P{1.0, 1.0, 4.0, 0.5, 0.5}, P{2.0, 1.0, 0.0, 1.0, 0.5},
+                P{0.0, 0.0, 0.0, 0.0, 1.0}, P{1.0, 0.0, 0.0, 0.5, 1.0}, P{2.0, 0.0, 0.0, 1.0, 1.0},
+            }, "texture"};
+            CHECK(computeSubdivisionsPerSurface(hillPatch, 8.0, 3u) == 0u);
+            CHECK(computeSubdivisionsPerSurface(hillPatch, 2.0, 3u) == 1u);
+            CHECK(computeSubdivisionsPerSurface(hillPatch, 1.0, 3u) == 2u);
+            CHECK(computeSubdivisionsPerSurface(hillPatch, 0.1, 3u) == 3u);
+            CHECK(computeSubdivisionsPerSurface(hillPatch, 0.1, 2u) == 2u);
+        }
+
+        TEST_CASE("PatchNode.coarseGrid") {
+            using P = BezierPatch::Point;
+            const auto patch = BezierPatch{5, 3, {
+                P{0.0, 4.0, 0.0, 0.0, 0.0 }, P{1.0, 4.0, 0.0, 0.5, 0.0 }, P{2.0, 4.0, 0.0, 1.0, 0.0 },
+                P{0.0, 3.0, 0.0, 0.0, 0.25}, P{1.0, 3.0, 4.0, 0.5, 0.25}, P{2.0, 3.0, 0.0, 1.0, 0.25},
+                P{0.0, 2.0, 0.0, 0.0, 0.5 }, P{1.0, 2.0, 0.0, 0.5, 0.5 }, P{2.0, 2.0, 0.0, 1.0, 0.5 },
+                P{0.0, 1.0, 0.0, 0.0, 0.75}, P{1.0, 1.0, 2.0, 0.5, 0.75}, P{2.0, 1.0, 0.0, 1.0, 0.75},
+                P{0.0, 0.0, 0.0, 0.0, 1.0 }, P{1.0, 0.0, 0.0, 0.5, 1.0 }, P{2.0, 0.0, 0.0, 1.0, 1.0 },
+            }, "texture"};
+            const auto patchNode = PatchNode{patch};
+
+            CHECK(patchNode.subdivisionsPerSurface() == 2u);
+            CHECK(&patchNode.grid(3u) == &patchNode.grid());
+
+            const auto subdivisionsPerSurface = GENERATE(0u, 1u, 2u);
+            CAPTURE(subdivisionsPerSurface);
+
+            const auto& coarseGrid = patchNode.grid(subdivisionsPerSurface);
+            const auto expectedGrid = makePatchGrid(patch, subdivisionsPerSurface);
+            CHECK(coarseGrid.pointRowCount == expectedGrid.pointRowCount);
+            CHECK(coarseGrid.pointColumnCount == expectedGrid.pointColumnCount);
+            CHECK(coarseGrid.bounds == expectedGrid.bounds);
+
+            // the grid points are taken from the finest grid, so only the normals differ
+            CHECK(kdl::vec_transform(coarseGrid.points, [](const auto& p) { return p.position; }) == kdl::vec_transform(expectedGrid.points, [](const auto& p) { return p.position; }));
+            CHECK(kdl::vec_transform(coarseGrid.points, [](const auto& p) { return p.texCoords; }) == kdl::vec_transform(expectedGrid.points, [](const auto& p) { return p.texCoords; }));
+
+            // the grid is cached
+            CHECK(&patchNode.grid(subdivisionsPerSurface) == &coarseGrid);
+        }
     }
 }
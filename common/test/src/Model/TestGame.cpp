@@ -39,8 +39,6 @@
 #include <memory>
 #include <vector>
 
-#include "Catch2.h"
-
 #include "TestGame.h"
 
 namespace TrenchBroom {
@@ -107,7 +105,7 @@ namespace TrenchBroom {
             }
         }
 
-        void TestGame::doWriteMap(WorldNode& world, const IO::Path& path) const {
+        size_t TestGame::doWriteMap(WorldNode& world, const IO::Path& path) const {
             const auto mapFormatName = formatName(world.mapFormat());
 
             std::ofstream file = openPathAsOutputStream(path);
@@ -117,7 +115,7 @@ namespace TrenchBroom {
             IO::writeGameComment(file, gameName(), mapFormatName);
 
             IO::NodeWriter writer(world, file);
-            writer.writeMap();
+            return writer.writeMap();
         }
 
         void TestGame::doExportMap(WorldNode& /* world */, const Model::ExportFormat /* format */, const IO::Path& /* path */) const {}
@@ -163,7 +161,7 @@ namespace TrenchBroom {
                     IO::Path(),
                     {});
 
-            IO::TextureLoader textureLoader(fileSystem, fileSearchPaths, textureConfig, logger);
+            IO::TextureLoader textureLoader(fileSystem, fileSearchPaths, textureConfig, IO::Path(), logger);
             textureLoader.loadTextures(paths, textureManager);
         }
 
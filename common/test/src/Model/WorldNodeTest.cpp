@@ -38,6 +38,7 @@
 #include <vecmath/mat.h>
 #include <vecmath/mat_ext.h>
 #include <vecmath/mat_io.h>
+#include <vecmath/plane.h>
 
 #include "TestUtils.h"
 #include "Catch2.h"
@@ -280,6 +281,68 @@ namespace TrenchBroom {
             CHECK(nodeTree.contains(patchNode));
         }
 
+        TEST_CASE("WorldNodeTest.nodeTreeBatch") {
+            constexpr auto worldBounds = vm::bbox3d{8192.0};
+            constexpr auto mapFormat = MapFormat::Quake3;
+
+            auto worldNode = WorldNode{Entity{}, mapFormat};
+            auto* entityNode = new EntityNode{Entity{}};
+            auto* brushNode = new BrushNode{BrushBuilder{mapFormat, worldBounds}.createCube(64.0, "texture").value()};
+            auto* otherBrushNode = new BrushNode{BrushBuilder{mapFormat, worldBounds}.createCube(32.0, "texture").value()};
+
+            const auto& nodeTree = worldNode.nodeTree();
+
+            worldNode.beginNodeTreeBatch();
+            worldNode.beginNodeTreeBatch();
+            worldNode.defaultLayer()->addChild(entityNode);
+            worldNode.defaultLayer()->addChild(brushNode);
+
+            CHECK_FALSE(nodeTree.contains(entityNode));
+            CHECK_FALSE(nodeTree.contains(brushNode));
+
+            worldNode.endNodeTreeBatch();
+            CHECK_FALSE(nodeTree.contains(entityNode));
+            CHECK_FALSE(nodeTree.contains(brushNode));
+
+            worldNode.defaultLayer()->addChild(otherBrushNode);
+
+            // removing a node adds all pending nodes first
+            worldNode.defaultLayer()->removeChild(otherBrushNode);
+            delete otherBrushNode;
+
+            CHECK(nodeTree.contains(entityNode));
+            CHECK(nodeTree.contains(brushNode));
+
+            worldNode.endNodeTreeBatch();
+            CHECK(nodeTree.contains(entityNode));
+            CHECK(nodeTree.contains(brushNode));
+        }
+
+        TEST_CASE("WorldNodeTest.findNodesInFrustum") {
+            constexpr auto worldBounds = vm::bbox3d{8192.0};
+            constexpr auto mapFormat = MapFormat::Quake3;
+
+            auto worldNode = WorldNode{Entity{}, mapFormat};
+            auto* leftBrushNode = new BrushNode{BrushBuilder{mapFormat, worldBounds}.createCuboid(vm::bbox3{{-128.0, -16.0, -16.0}, {-96.0, 16.0, 16.0}}, "texture").value()};
+            auto* rightBrushNode = new BrushNode{BrushBuilder{mapFormat, worldBounds}.createCuboid(vm::bbox3{{96.0, -16.0, -16.0}, {128.0, 16.0, 16.0}}, "texture").value()};
+            auto* entityNode = new EntityNode{Entity{}};
+
+            worldNode.defaultLayer()->addChild(leftBrushNode);
+            worldNode.defaultLayer()->addChild(rightBrushNode);
+            worldNode.defaultLayer()->addChild(entityNode);
+
+            // a frustum looking along the positive X axis from the origin, the plane normals point outwards
+            const auto planes = std::vector<vm::plane3>{
+                vm::plane3{vm::vec3::zero(), vm::normalize(vm::vec3{-1.0, 0.0, 1.0})},
+                vm::plane3{vm::vec3::zero(), vm::normalize(vm::vec3{-1.0, 0.0, -1.0})},
+                vm::plane3{vm::vec3::zero(), vm::normalize(vm::vec3{-1.0, 1.0, 0.0})},
+                vm::plane3{vm::vec3::zero(), vm::normalize(vm::vec3{-1.0, -1.0, 0.0})},
+            };
+
+            CHECK_THAT(worldNode.findNodesInFrustum(planes), Catch::UnorderedEquals(std::vector<Node*>{rightBrushNode, entityNode}));
+            CHECK(worldNode.findNodesInFrustum({}).size() == 3u);
+        }
+
         TEST_CASE("WorldNodeTest.persistentIdOfDefaultLayer", "[WorldNodeTest]") {
             auto worldNode = WorldNode{Entity{}, MapFormat::Standard};
             CHECK(worldNode.defaultLayer()->persistentId() == std::nullopt);
@@ -0,0 +1,253 @@
+/*
+ Copyright (C) 2021 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+
+#include "Color.h"
+#include "Logger.h"
+#include "Assets/EntityDefinition.h"
+#include "Assets/EntityModel.h"
+#include "Assets/EntityModelManager.h"
+#include "Assets/ModelDefinition.h"
+#include "Assets/Palette.h"
+#include "EL/Expression.h"
+#include "EL/Value.h"
+#include "IO/DiskFileSystem.h"
+#include "IO/DiskIO.h"
+#include "IO/EntityModelLoader.h"
+#include "IO/File.h"
+#include "IO/MdlParser.h"
+#include "IO/Path.h"
+#include "IO/Reader.h"
+#include "Model/EditorContext.h"
+#include "Model/Entity.h"
+#include "Model/EntityNode.h"
+#include "Model/EntityProperties.h"
+#include "Model/VisibilityState.h"
+#include "Renderer/EntityModelRenderer.h"
+
+#include <vecmath/bbox.h>
+#include <vecmath/vec.h>
+
+#include <memory>
+#include <vector>
+
+#include "Catch2.h"
+
+namespace TrenchBroom {
+    namespace Renderer {
+        namespace {
+            /**
+             * Loads the mdl models in the mdl test fixture directory.
+             */
+            class MdlLoader : public IO::EntityModelLoader {
+            private:
+                IO::DiskFileSystem m_fs;
+                Assets::Palette m_palette;
+            public:
+                MdlLoader() :
+                m_fs(IO::Disk::getCurrentWorkingDir() + IO::Path("fixture/test/IO/Mdl")),
+                m_palette(Assets::Palette::loadFile(IO::DiskFileSystem(IO::Disk::getCurrentWorkingDir()), IO::Path("fixture/test/palette.lmp"))) {}
+            private:
+                std::unique_ptr<Assets::EntityModel> doInitializeModel(const IO::Path& path, Logger& logger) const override {
+                    const auto file = m_fs.openFile(path);
+                    auto reader = file->reader().buffer();
+                    auto parser = IO::MdlParser(path.lastComponent().asString(), std::begin(reader), std::end(reader), m_palette);
+                    return parser.initializeModel(logger);
+                }
+
+                void doLoadFrame(const IO::Path& path, const size_t frameIndex, Assets::EntityModel& model, Logger& logger) const override {
+                    const auto file = m_fs.openFile(path);
+                    auto reader = file->reader().buffer();
+                    auto parser = IO::MdlParser(path.lastComponent().asString(), std::begin(reader), std::end(reader), m_palette);
+                    parser.loadFrame(frameIndex, model, logger);
+                }
+            };
+
+            Assets::ModelDefinition makeModelDefinition(const size_t skinIndex) {
+                const auto model = EL::Value(EL::MapType{
+                    {"path", EL::Value("armor.mdl")},
+                    {"skin", EL::Value(skinIndex)}
+                });
+                return Assets::ModelDefinition(EL::Expression(EL::LiteralExpression(model), 0, 0));
+            }
+
+            std::unique_ptr<Model::EntityNode> makeEntityNode(Assets::EntityDefinition& definition, const std::string& origin) {
+                auto entityNode = std::make_unique<Model::EntityNode>(Model::Entity({
+                    {Model::EntityPropertyKeys::Classname, definition.name()},
+                    {Model::EntityPropertyKeys::Origin, origin}
+                }));
+                entityNode->setDefinition(&definition);
+                return entityNode;
+            }
+        }
+
+        class EntityModelRendererTest {
+        protected:
+            NullLogger logger;
+            MdlLoader loader;
+            Assets::EntityModelManager entityModelManager;
+            Model::EditorContext editorContext;
+            EntityModelRenderer renderer;
+
+            // armor.mdl has three skins, so every definition has its own model renderer
+            Assets::PointEntityDefinition skin0Definition;
+            Assets::PointEntityDefinition skin1Definition;
+            Assets::PointEntityDefinition noModelDefinition;
+
+            EntityModelRendererTest() :
+            entityModelManager(0, 0, logger),
+            renderer(logger, entityModelManager, editorContext),
+            skin0Definition("item_armor", Color(), vm::bbox3(16.0), "", {}, makeModelDefinition(0)),
+            skin1Definition("item_armor", Color(), vm::bbox3(16.0), "", {}, makeModelDefinition(1)),
+            noModelDefinition("info_null", Color(), vm::bbox3(16.0), "", {}, {}) {
+                entityModelManager.setLoader(&loader);
+                // the frame is loaded before the model renderers are built
+                REQUIRE(entityModelManager.frame(Assets::ModelSpecification(IO::Path("armor.mdl"))) != nullptr);
+
+                renderer.setShowHiddenEntities(true);
+            }
+        };
+
+        TEST_CASE_METHOD(EntityModelRendererTest, "EntityModelRendererTest.groupEntitiesByModelRenderer", "[EntityModelRendererTest]") {
+            auto entity1 = makeEntityNode(skin0Definition, "0 0 0");
+            auto entity2 = makeEntityNode(skin0Definition, "64 0 0");
+            auto entity3 = makeEntityNode(skin1Definition, "128 0 0");
+            auto entity4 = makeEntityNode(noModelDefinition, "192 0 0");
+
+            auto entityNodes = std::vector<Model::EntityNode*>{entity1.get(), entity2.get(), entity3.get(), entity4.get()};
+            renderer.addEntities(std::begin(entityNodes), std::end(entityNodes));
+
+            CHECK(renderer.modelRendererCount() == 2u);
+            REQUIRE(renderer.modelRenderer(entity1.get()) != nullptr);
+            REQUIRE(renderer.modelRenderer(entity3.get()) != nullptr);
+            CHECK(renderer.modelRenderer(entity1.get()) == renderer.modelRenderer(entity2.get()));
+            CHECK(renderer.modelRenderer(entity1.get()) != renderer.modelRenderer(entity3.get()));
+            CHECK(renderer.modelRenderer(entity4.get()) == nullptr);
+
+            CHECK(renderer.entityCount(renderer.modelRenderer(entity1.get())) == 2u);
+            CHECK(renderer.entityCount(renderer.modelRenderer(entity3.get())) == 1u);
+
+            // adding an entity again has no effect
+            renderer.addEntity(entity1.get());
+            CHECK(renderer.entityCount(renderer.modelRenderer(entity1.get())) == 2u);
+        }
+
+        TEST_CASE_METHOD(EntityModelRendererTest, "EntityModelRendererTest.updateAndRemoveEntities", "[EntityModelRendererTest]") {
+            auto entity1 = makeEntityNode(skin0Definition, "0 0 0");
+            auto entity2 = makeEntityNode(skin0Definition, "64 0 0");
+
+            renderer.addEntity(entity1.get());
+            renderer.addEntity(entity2.get());
+            const auto* skin0Renderer = renderer.modelRenderer(entity1.get());
+            REQUIRE(skin0Renderer != nullptr);
+            REQUIRE(renderer.modelRendererCount() == 1u);
+
+            SECTION("Changing the model moves an entity to another model renderer") {
+                entity2->setDefinition(&skin1Definition);
+                renderer.updateEntity(entity2.get());
+
+                CHECK(renderer.modelRendererCount() == 2u);
+                CHECK(renderer.modelRenderer(entity2.get()) != nullptr);
+                CHECK(renderer.modelRenderer(entity2.get()) != skin0Renderer);
+                CHECK(renderer.entityCount(skin0Renderer) == 1u);
+                CHECK(renderer.entityCount(renderer.modelRenderer(entity2.get())) == 1u);
+            }
+
+            SECTION("Removing the model removes an entity") {
+                entity2->setDefinition(&noModelDefinition);
+                renderer.updateEntity(entity2.get());
+
+                CHECK(renderer.modelRendererCount() == 1u);
+                CHECK(renderer.modelRenderer(entity2.get()) == nullptr);
+                CHECK(renderer.entityCount(skin0Renderer) == 1u);
+            }
+
+            SECTION("Updating an entity that was not added adds it") {
+                auto entity3 = makeEntityNode(skin1Definition, "128 0 0");
+                renderer.updateEntity(entity3.get());
+
+                CHECK(renderer.modelRendererCount() == 2u);
+                CHECK(renderer.modelRenderer(entity3.get()) != nullptr);
+            }
+
+            SECTION("Removing the last entity of a model renderer removes the model renderer") {
+                renderer.removeEntity(entity1.get());
+                CHECK(renderer.modelRendererCount() == 1u);
+                CHECK(renderer.modelRenderer(entity1.get()) == nullptr);
+                CHECK(renderer.entityCount(skin0Renderer) == 1u);
+
+                renderer.removeEntity(entity2.get());
+                CHECK(renderer.modelRendererCount() == 0u);
+                CHECK(renderer.entityCount(skin0Renderer) == 0u);
+            }
+
+            SECTION("Clearing removes all entities") {
+                renderer.clear();
+                CHECK(renderer.modelRendererCount() == 0u);
+                CHECK(renderer.modelRenderer(entity1.get()) == nullptr);
+            }
+        }
+
+        TEST_CASE_METHOD(EntityModelRendererTest, "EntityModelRendererTest.collectInstances", "[EntityModelRendererTest]") {
+            auto entity1 = makeEntityNode(skin0Definition, "0 0 0");
+            auto entity2 = makeEntityNode(skin1Definition, "64 0 0");
+            auto entity3 = makeEntityNode(skin0Definition, "128 0 0");
+
+            auto entityNodes = std::vector<Model::EntityNode*>{entity1.get(), entity2.get(), entity3.get()};
+            renderer.addEntities(std::begin(entityNodes), std::end(entityNodes));
+
+            auto instanceData = std::vector<vm::vec4f>{};
+            const auto batches = renderer.collectInstances(instanceData);
+            REQUIRE(batches.size() == 2u);
+            CHECK(instanceData.size() == 4u * 3u);
+
+            // the entities of each model renderer are adjacent, and the last column of their model transformation holds
+            // their origin
+            auto firstInstance = size_t(0);
+            for (const auto& [modelRenderer, instanceCount] : batches) {
+                CHECK(instanceCount == renderer.entityCount(modelRenderer));
+                for (size_t i = firstInstance; i < firstInstance + instanceCount; ++i) {
+                    const auto& origin = instanceData[4u * i + 3u];
+                    const auto* entityNode = origin.x() == 0.0f ? entity1.get() : origin.x() == 64.0f ? entity2.get() : entity3.get();
+                    CHECK(renderer.modelRenderer(entityNode) == modelRenderer);
+                    CHECK(origin == vm::vec4f(vm::vec3f(entityNode->entity().origin()), 1.0f));
+                }
+                firstInstance += instanceCount;
+            }
+
+            // hidden entities are not collected
+            renderer.setShowHiddenEntities(false);
+            entity2->setVisibilityState(Model::VisibilityState::Hidden);
+
+            instanceData.clear();
+            CHECK(renderer.collectInstances(instanceData).size() == 1u);
+            CHECK(instanceData.size() == 4u * 2u);
+        }
+
+        TEST_CASE("EntityModelRendererTest.instanceBufferCapacity", "[EntityModelRendererTest]") {
+            // a new buffer has room for twice the data
+            CHECK(EntityModelRenderer::instanceBufferCapacity(0u, 64u) == 128u);
+
+            // an existing buffer is kept if the data fits
+            CHECK(EntityModelRenderer::instanceBufferCapacity(128u, 64u) == 128u);
+            CHECK(EntityModelRenderer::instanceBufferCapacity(128u, 128u) == 128u);
+
+            // a buffer that is too small is replaced with one that has room for twice the data
+            CHECK(EntityModelRenderer::instanceBufferCapacity(128u, 192u) == 384u);
+        }
+    }
+}
@@ -0,0 +1,75 @@
+/*
+ Copyright (C) 2021 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+
+#include "View/MapDocumentTest.h"
+#include "TestUtils.h"
+
+#include "Model/BrushNode.h"
+#include "Model/GroupNode.h"
+#include "Renderer/MapRenderer.h"
+#include "View/MapDocument.h"
+
+#include "Catch2.h"
+
+namespace TrenchBroom {
+    namespace Renderer {
+        TEST_CASE_METHOD(View::MapDocumentTest, "MapRendererTest.openAndCloseNestedGroups", "[MapRendererTest]") {
+            MapRenderer renderer(document);
+
+            auto* brushNode = createBrushNode();
+            View::addNode(*document, document->parentForNodes(), brushNode);
+            document->select(brushNode);
+
+            auto* innerGroupNode = document->groupSelection("inner");
+            auto* outerGroupNode = document->groupSelection("outer");
+            document->deselectAll();
+
+            const auto checkRenderers = [&](const Model::Node* node, const bool inDefault, const bool inSelection, const bool inLocked) {
+                CHECK(renderer.isInDefaultRenderer(node) == inDefault);
+                CHECK(renderer.isInSelectionRenderer(node) == inSelection);
+                CHECK(renderer.isInLockedRenderer(node) == inLocked);
+            };
+
+            checkRenderers(outerGroupNode, true, false, false);
+            checkRenderers(innerGroupNode, true, false, false);
+            checkRenderers(brushNode, true, false, false);
+
+            document->openGroup(outerGroupNode);
+            checkRenderers(outerGroupNode, false, true, false);
+            checkRenderers(innerGroupNode, true, false, false);
+            checkRenderers(brushNode, true, false, false);
+
+            // the outer group is no longer open and becomes locked
+            document->openGroup(innerGroupNode);
+            checkRenderers(outerGroupNode, false, false, true);
+            checkRenderers(innerGroupNode, false, true, false);
+            checkRenderers(brushNode, true, false, false);
+
+            // the outer group is reopened
+            document->closeGroup();
+            checkRenderers(outerGroupNode, false, true, false);
+            checkRenderers(innerGroupNode, true, false, false);
+            checkRenderers(brushNode, true, false, false);
+
+            document->closeGroup();
+            checkRenderers(outerGroupNode, true, false, false);
+            checkRenderers(innerGroupNode, true, false, false);
+            checkRenderers(brushNode, true, false, false);
+        }
+    }
+}
@@ -18,10 +18,13 @@
  */
 
 #include "Logger.h"
+#include "IO/DiskIO.h"
 #include "IO/Path.h"
 #include "IO/TestEnvironment.h"
 #include "Model/BrushNode.h"
+#include "Model/Layer.h"
 #include "Model/LayerNode.h"
+#include "Model/WorldNode.h"
 #include "View/Autosaver.h"
 #include "View/MapDocumentTest.h"
 
@@ -61,6 +64,7 @@ namespace TrenchBroom {
             addNode(*document, document->currentLayer(), createBrushNode("some_texture"));
 
             autosaver.triggerAutosave(logger);
+            autosaver.finishPendingAutosave(logger);
 
             CHECK_FALSE(env.fileExists(IO::Path("autosave/test.1.map")));
             CHECK_FALSE(env.directoryExists(IO::Path("autosave")));
@@ -77,6 +81,7 @@ namespace TrenchBroom {
 
             Autosaver autosaver(document, 0s);
             autosaver.triggerAutosave(logger);
+            autosaver.finishPendingAutosave(logger);
 
             CHECK_FALSE(env.fileExists(IO::Path("autosave/test.1.map")));
             CHECK_FALSE(env.directoryExists(IO::Path("autosave")));
@@ -101,6 +106,7 @@ namespace TrenchBroom {
             std::this_thread::sleep_for(100ms);
 
             autosaver.triggerAutosave(logger);
+            autosaver.finishPendingAutosave(logger);
 
             CHECK(env.fileExists(IO::Path("autosave/test.1.map")));
             CHECK(env.directoryExists(IO::Path("autosave")));
@@ -125,6 +131,7 @@ namespace TrenchBroom {
             std::this_thread::sleep_for(100ms);
 
             autosaver.triggerAutosave(logger);
+            autosaver.finishPendingAutosave(logger);
 
             CHECK(env.fileExists(IO::Path("autosave/test.1.map")));
             CHECK(env.directoryExists(IO::Path("autosave")));
@@ -134,12 +141,14 @@ namespace TrenchBroom {
             std::this_thread::sleep_for(100ms);
 
             autosaver.triggerAutosave(logger);
+            autosaver.finishPendingAutosave(logger);
             CHECK_FALSE(env.fileExists(IO::Path("autosave/test.2.map")));
 
             // modify the map
             addNode(*document, document->currentLayer(), createBrushNode("some_texture"));
 
             autosaver.triggerAutosave(logger);
+            autosaver.finishPendingAutosave(logger);
             CHECK(env.fileExists(IO::Path("autosave/test.2.map")));
         }
 
@@ -165,8 +174,77 @@ namespace TrenchBroom {
             addNode(*document, document->currentLayer(), createBrushNode("some_texture"));
 
             autosaver.triggerAutosave(logger);
+            autosaver.finishPendingAutosave(logger);
 
             CHECK(env.fileExists(IO::Path("autosave/test.2.map")));
         }
+
+        TEST_CASE_METHOD(MapDocumentTest, "MapDocumentTest.autosaverWritesBackupLikeDocument") {
+            using namespace std::literals::chrono_literals;
+
+            IO::TestEnvironment env("autosaver_test");
+            NullLogger logger;
+
+            document->saveDocumentAs(env.dir() + IO::Path("test.map"));
+            assert(env.fileExists(IO::Path("test.map")));
+
+            Autosaver autosaver(document, 0s);
+
+            // modify the map, adding persistent IDs for a layer and a group
+            auto* layerNode = new Model::LayerNode(Model::Layer("layer"));
+            addNode(*document, document->world(), layerNode);
+
+            auto* brushNode = createBrushNode("some_texture");
+            addNode(*document, layerNode, brushNode);
+            document->select(brushNode);
+            document->groupSelection("group");
+            document->deselectAll();
+
+            autosaver.triggerAutosave(logger);
+            autosaver.finishPendingAutosave(logger);
+
+            document->saveDocumentTo(env.dir() + IO::Path("expected.map"));
+
+            CHECK(env.fileExists(IO::Path("autosave/test.1.map")));
+            CHECK_FALSE(env.fileExists(IO::Path("autosave/test.1.map.tmp")));
+            CHECK(IO::Disk::readTextFile(env.dir() + IO::Path("autosave/test.1.map")) == IO::Disk::readTextFile(env.dir() + IO::Path("expected.map")));
+        }
+
+        TEST_CASE_METHOD(MapDocumentTest, "MapDocumentTest.autosaverCachesSerializationsOfCopiedBrushes") {
+            using namespace std::literals::chrono_literals;
+
+            IO::TestEnvironment env("autosaver_test");
+            NullLogger logger;
+
+            document->saveDocumentAs(env.dir() + IO::Path("test.map"));
+            assert(env.fileExists(IO::Path("test.map")));
+
+            Autosaver autosaver(document, 0s);
+
+            // modify the map
+            addNode(*document, document->currentLayer(), createBrushNode("some_texture"));
+            const auto [cachedBefore, totalBefore] = document->countCachedSerializations();
+            REQUIRE(cachedBefore + 1u == totalBefore);
+            REQUIRE(document->createWorldSnapshot().copiedNodes.size() == 1u);
+
+            SECTION("Unchanged document") {
+                autosaver.triggerAutosave(logger);
+                autosaver.finishPendingAutosave(logger);
+
+                const auto [cachedAfter, totalAfter] = document->countCachedSerializations();
+                CHECK(cachedAfter == totalAfter);
+                CHECK(document->createWorldSnapshot().copiedNodes.empty());
+            }
+
+            SECTION("Document changed while writing the backup") {
+                autosaver.triggerAutosave(logger);
+                addNode(*document, document->currentLayer(), createBrushNode("some_texture"));
+                autosaver.finishPendingAutosave(logger);
+
+                const auto [cachedAfter, totalAfter] = document->countCachedSerializations();
+                CHECK(cachedAfter == cachedBefore);
+                CHECK(totalAfter == totalBefore + 1u);
+            }
+        }
     }
 }
@@ -25,6 +25,7 @@
 
 #include <chrono>
 #include <memory>
+#include <string>
 #include <thread>
 #include <optional>
 #include <variant>
@@ -106,15 +107,17 @@ namespace TrenchBroom {
         class TestCommand : public UndoableCommand {
         private:
             mutable std::vector<TestCommandCall> m_expectedCalls;
+            size_t m_memorySize;
         public:
             static const CommandType Type;
 
-            static std::unique_ptr<TestCommand> create(const std::string& name) {
-                return std::make_unique<TestCommand>(name);
+            static std::unique_ptr<TestCommand> create(const std::string& name, const size_t memorySize = 0u) {
+                return std::make_unique<TestCommand>(name, memorySize);
             }
 
-            explicit TestCommand(const std::string& name) :
-            UndoableCommand(Type, name, false) {}
+            explicit TestCommand(const std::string& name, const size_t memorySize = 0u) :
+            UndoableCommand(Type, name, false),
+            m_memorySize(memorySize) {}
 
             ~TestCommand() {
                 CHECK(m_expectedCalls.empty());
@@ -146,6 +149,9 @@ namespace TrenchBroom {
                 return expectedCall.returnCanCollate;
             }
 
+            size_t doGetMemorySize() const override {
+                return m_memorySize;
+            }
         public:
             /**
              * Sets an expectation that doPerformDo() should be called.
@@ -582,5 +588,39 @@ namespace TrenchBroom {
             REQUIRE(commandProcessor.undoCommandName() == commandName1);
             REQUIRE(commandProcessor.redoCommandName() == commandName2);
         }
+   
+        TEST_CASE("CommandProcessorTest.undoMemoryBudget", "[CommandProcessorTest]") {
+            /*
+             * Execute four commands while the undo stack has room for two of them, then shrink the budget and undo the
+             * remaining command.
+             */
+
+            CommandProcessor commandProcessor(nullptr);
+            commandProcessor.setUndoMemoryBudget(250u);
+
+            for (size_t i = 0u; i < 4u; ++i) {
+                auto command = TestCommand::create("test command " + std::to_string(i), 100u);
+                command->expectDo(true);
+                if (i == 3u) {
+                    command->expectUndo(true);
+                }
+
+                // commit each command in its own transaction so that the commands are not collated
+                commandProcessor.startTransaction();
+                commandProcessor.executeAndStore(std::move(command));
+                commandProcessor.commitTransaction();
+            }
+
+            CHECK(commandProcessor.undoStackMemorySize() == 200u);
+            REQUIRE(commandProcessor.undoCommandName() == "test command 3");
+
+            // the topmost command is kept even if it exceeds the budget
+            commandProcessor.setUndoMemoryBudget(50u);
+            CHECK(commandProcessor.undoStackMemorySize() == 100u);
+
+            CHECK(commandProcessor.undo()->success());
+            CHECK_FALSE(commandProcessor.canUndo());
+            CHECK(commandProcessor.undoStackMemorySize() == 0u);
+        }
     }
 }
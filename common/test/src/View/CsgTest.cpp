@@ -21,6 +21,8 @@
 #include "MapDocumentTest.h"
 #include "TestUtils.h"
 
+#include "ProgressMonitor.h"
+
 #include "Model/BrushBuilder.h"
 #include "Model/BrushNode.h"
 #include "Model/BrushFace.h"
@@ -221,6 +223,30 @@ namespace TrenchBroom {
             CHECK_THAT(document->selectedNodes().brushes(), Catch::Equals(std::vector<Model::BrushNode*>{ subtrahend1 }));
         }
 
+        class CancelledProgressMonitor : public ProgressMonitor {
+        private:
+            void doProgress(double /* progress */) override {}
+            bool doCancelled() const override { return true; }
+        };
+
+        TEST_CASE_METHOD(MapDocumentTest, "CsgTest.csgSubtractCancelled") {
+            const Model::BrushBuilder builder(document->world()->mapFormat(), document->worldBounds());
+
+            auto* entity = new Model::EntityNode();
+            addNode(*document, document->parentForNodes(), entity);
+
+            Model::BrushNode* minuend = new Model::BrushNode(builder.createCuboid(vm::bbox3(vm::vec3(0, 0, 0), vm::vec3(64, 64, 64)), "texture").value());
+            Model::BrushNode* subtrahend = new Model::BrushNode(builder.createCuboid(vm::bbox3(vm::vec3(0, 0, 0), vm::vec3(32, 32, 64)), "texture").value());
+
+            document->addNodes({{entity, {minuend, subtrahend}}});
+            document->select(subtrahend);
+
+            auto progressMonitor = CancelledProgressMonitor{};
+            CHECK_FALSE(document->csgSubtract(progressMonitor));
+            CHECK_THAT(entity->children(), Catch::Equals(std::vector<Model::Node*>{ minuend, subtrahend }));
+            CHECK_THAT(document->selectedNodes().brushes(), Catch::Equals(std::vector<Model::BrushNode*>{ subtrahend }));
+        }
+
         // Test for https://github.com/TrenchBroom/TrenchBroom/issues/3755
         TEST_CASE("CsgTest.csgSubtractFailure", "[MapDocumentTest]") {
             auto [document, game, gameConfig] = View::loadMapDocument(IO::Path("fixture/test/View/MapDocumentTest/csgSubtractFailure.map"),
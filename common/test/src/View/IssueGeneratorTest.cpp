@@ -32,8 +32,13 @@
 #include "Model/WorldNode.h"
 
 #include <kdl/overload.h>
+#include <kdl/parallel.h>
 #include <kdl/vector_utils.h>
 
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+
 #include "Catch2.h"
 
 namespace TrenchBroom {
@@ -88,5 +93,50 @@ namespace TrenchBroom {
 
             kdl::vec_clear_and_delete(issueGenerators);
         }
+
+        TEST_CASE_METHOD(MapDocumentTest, "IssueGeneratorTest.validateIssuesInParallel") {
+            auto entityNodes = std::vector<Model::Node*>{};
+            for (size_t i = 0u; i < 200u; ++i) {
+                auto* entityNode = document->createPointEntity(m_pointEntityDef, vm::vec3(static_cast<FloatType>(i) * 32.0, 0.0, 0.0));
+                document->deselectAll();
+                document->select(entityNode);
+                if (i % 2u == 0u) {
+                    document->setProperty("", "");
+                } else {
+                    document->setProperty("some_key", "");
+                }
+                entityNodes.push_back(entityNode);
+            }
+            document->deselectAll();
+
+            auto issueGenerators = std::vector<Model::IssueGenerator*>{
+                new Model::EmptyPropertyKeyIssueGenerator(),
+                new Model::EmptyPropertyValueIssueGenerator()
+            };
+
+            for (const auto* entityNode : entityNodes) {
+                REQUIRE_FALSE(entityNode->issuesValid());
+            }
+
+            const auto chunkSize = size_t(16);
+            const auto chunkCount = (entityNodes.size() + chunkSize - 1u) / chunkSize;
+            auto chunkTimes = std::vector<std::vector<std::chrono::nanoseconds>>(chunkCount, std::vector<std::chrono::nanoseconds>(issueGenerators.size()));
+            kdl::parallel_for(chunkCount, [&](const size_t chunk) {
+                const auto first = std::next(std::begin(entityNodes), static_cast<std::ptrdiff_t>(chunk * chunkSize));
+                const auto last = std::next(std::begin(entityNodes), static_cast<std::ptrdiff_t>(std::min((chunk + 1u) * chunkSize, entityNodes.size())));
+                Model::Node::validateIssues(std::vector<Model::Node*>(first, last), issueGenerators, chunkTimes[chunk]);
+            });
+
+            for (size_t i = 0u; i < entityNodes.size(); ++i) {
+                auto* entityNode = entityNodes[i];
+                CHECK(entityNode->issuesValid());
+
+                // the issues are not generated again
+                const auto& issues = entityNode->issues(issueGenerators);
+                CHECK(issues.size() == (i % 2u == 0u ? 2u : 1u));
+            }
+
+            kdl::vec_clear_and_delete(issueGenerators);
+        }
     }
 }
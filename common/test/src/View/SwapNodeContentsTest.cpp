@@ -24,14 +24,18 @@
 #include "IO/Path.h"
 #include "Model/BezierPatch.h"
 #include "Model/Brush.h"
+#include "Model/BrushFace.h"
+#include "Model/BrushFaceAttributes.h"
 #include "Model/BrushNode.h"
 #include "Model/Entity.h"
 #include "Model/EntityNode.h"
 #include "Model/Group.h"
 #include "Model/GroupNode.h"
 #include "Model/NodeContents.h"
+#include "Model/ParallelTexCoordSystem.h"
 #include "Model/PatchNode.h"
 #include "View/MapDocument.h"
+#include "View/MapDocumentCommandFacade.h"
 #include "View/SwapNodeContentsCommand.h"
 #include "View/MapDocumentTest.h"
 
@@ -47,6 +51,7 @@
 #include <vecmath/vec_io.h>
 
 #include <memory>
+#include <string>
 
 #include "TestUtils.h"
 
@@ -72,6 +77,147 @@ namespace TrenchBroom {
             CHECK(brushNode->brush() == originalBrush);
         }
 
+        TEST_CASE_METHOD(MapDocumentTest, "SwapNodeContentsTest.collateBrushFaceChanges") {
+            auto* brushNode = createBrushNode();
+            addNode(*document, document->parentForNodes(), brushNode);
+
+            const auto originalBrush = brushNode->brush();
+
+            auto brushWithOffset = originalBrush;
+            auto attributes = brushWithOffset.face(0u).attributes();
+            attributes.setXOffset(16.0f);
+            brushWithOffset.face(0u).setAttributes(attributes);
+
+            auto brushWithRotation = brushWithOffset;
+            attributes = brushWithRotation.face(1u).attributes();
+            attributes.setRotation(45.0f);
+            brushWithRotation.face(1u).setAttributes(attributes);
+
+            auto* facade = static_cast<MapDocumentCommandFacade*>(document.get());
+
+            auto nodesToSwap = std::vector<std::pair<Model::Node*, Model::NodeContents>>{};
+            nodesToSwap.emplace_back(brushNode, brushWithOffset);
+            auto command1 = std::make_unique<SwapNodeContentsCommand>("Swap Nodes", std::move(nodesToSwap), std::vector<std::pair<const Model::GroupNode*, std::vector<Model::GroupNode*>>>{});
+            REQUIRE(command1->performDo(facade)->success());
+            REQUIRE(brushNode->brush() == brushWithOffset);
+
+            nodesToSwap = std::vector<std::pair<Model::Node*, Model::NodeContents>>{};
+            nodesToSwap.emplace_back(brushNode, brushWithRotation);
+            auto command2 = std::make_unique<SwapNodeContentsCommand>("Swap Nodes", std::move(nodesToSwap), std::vector<std::pair<const Model::GroupNode*, std::vector<Model::GroupNode*>>>{});
+            REQUIRE(command2->performDo(facade)->success());
+            REQUIRE(brushNode->brush() == brushWithRotation);
+
+            REQUIRE(command1->collateWith(command2.get()));
+
+            // only the changed faces are kept for undo
+            CHECK(command1->memorySize() > 0u);
+            CHECK(command1->memorySize() < 3u * (sizeof(Model::BrushFace) + sizeof(Model::ParallelTexCoordSystem)));
+
+            REQUIRE(command1->performUndo(facade)->success());
+            CHECK(brushNode->brush() == originalBrush);
+
+            REQUIRE(command1->performDo(facade)->success());
+            CHECK(brushNode->brush() == brushWithRotation);
+        }
+
+        TEST_CASE_METHOD(MapDocumentTest, "SwapNodeContentsTest.faceSelectionIsNotStored") {
+            auto* brushNode = createBrushNode();
+            addNode(*document, document->parentForNodes(), brushNode);
+
+            const auto originalBrush = brushNode->brush();
+
+            auto brushWithOffset = originalBrush;
+            auto attributes = brushWithOffset.face(0u).attributes();
+            attributes.setXOffset(16.0f);
+            brushWithOffset.face(0u).setAttributes(attributes);
+            brushWithOffset.face(1u).select();
+
+            auto* facade = static_cast<MapDocumentCommandFacade*>(document.get());
+
+            auto nodesToSwap = std::vector<std::pair<Model::Node*, Model::NodeContents>>{};
+            nodesToSwap.emplace_back(brushNode, brushWithOffset);
+            auto command = std::make_unique<SwapNodeContentsCommand>("Swap Nodes", std::move(nodesToSwap), std::vector<std::pair<const Model::GroupNode*, std::vector<Model::GroupNode*>>>{});
+            REQUIRE(command->performDo(facade)->success());
+            CHECK(brushNode->brush().face(0u).attributes().xOffset() == 16.0f);
+
+            // only the face with the changed offset is kept for undo
+            CHECK(command->memorySize() < 2u * (sizeof(Model::BrushFace) + sizeof(Model::ParallelTexCoordSystem)));
+
+            REQUIRE(command->performUndo(facade)->success());
+            CHECK(brushNode->brush().face(0u) == originalBrush.face(0u));
+        }
+
+        TEST_CASE_METHOD(MapDocumentTest, "SwapNodeContentsTest.restoreVertexEditedBrush") {
+            auto* brushNode = createBrushNode();
+            addNode(*document, document->parentForNodes(), brushNode);
+
+            const auto originalBrush = brushNode->brush();
+            const auto originalVertices = originalBrush.vertexPositions();
+
+            auto modifiedBrush = originalBrush;
+            REQUIRE(modifiedBrush.moveVertices(document->worldBounds(), {originalVertices.front()}, vm::vec3(3.0, 5.0, 7.0)).is_success());
+            const auto modifiedVertices = modifiedBrush.vertexPositions();
+
+            auto nodesToSwap = std::vector<std::pair<Model::Node*, Model::NodeContents>>{};
+            nodesToSwap.emplace_back(brushNode, modifiedBrush);
+
+            document->swapNodeContents("Swap Nodes", std::move(nodesToSwap), {});
+            CHECK(brushNode->brush() == modifiedBrush);
+            CHECK(brushNode->brush().vertexPositions() == modifiedVertices);
+
+            document->undoCommand();
+            CHECK(brushNode->brush() == originalBrush);
+            CHECK(brushNode->brush().vertexPositions() == originalVertices);
+
+            document->redoCommand();
+            CHECK(brushNode->brush() == modifiedBrush);
+            CHECK(brushNode->brush().vertexPositions() == modifiedVertices);
+        }
+
+        TEST_CASE_METHOD(MapDocumentTest, "SwapNodeContentsTest.collateEntityPropertyChanges") {
+            auto* entityNode = new Model::EntityNode({
+                {Model::PropertyKeys::Classname, "point_entity"},
+                {"first", std::string(1024u, 'x')},
+                {"second", std::string(1024u, 'y')},
+                {"third", "value"}
+            });
+            addNode(*document, document->parentForNodes(), entityNode);
+
+            const auto originalEntity = entityNode->entity();
+
+            auto entityWithNewValue = originalEntity;
+            entityWithNewValue.addOrUpdateProperty("third", "other value");
+
+            auto entityWithNewProperty = entityWithNewValue;
+            entityWithNewProperty.addOrUpdateProperty("fourth", "value");
+
+            auto* facade = static_cast<MapDocumentCommandFacade*>(document.get());
+
+            auto nodesToSwap = std::vector<std::pair<Model::Node*, Model::NodeContents>>{};
+            nodesToSwap.emplace_back(entityNode, entityWithNewValue);
+            auto command1 = std::make_unique<SwapNodeContentsCommand>("Swap Nodes", std::move(nodesToSwap), std::vector<std::pair<const Model::GroupNode*, std::vector<Model::GroupNode*>>>{});
+            REQUIRE(command1->performDo(facade)->success());
+            REQUIRE(entityNode->entity() == entityWithNewValue);
+
+            nodesToSwap = std::vector<std::pair<Model::Node*, Model::NodeContents>>{};
+            nodesToSwap.emplace_back(entityNode, entityWithNewProperty);
+            auto command2 = std::make_unique<SwapNodeContentsCommand>("Swap Nodes", std::move(nodesToSwap), std::vector<std::pair<const Model::GroupNode*, std::vector<Model::GroupNode*>>>{});
+            REQUIRE(command2->performDo(facade)->success());
+            REQUIRE(entityNode->entity() == entityWithNewProperty);
+
+            REQUIRE(command1->collateWith(command2.get()));
+
+            // the long property values are not kept for undo
+            CHECK(command1->memorySize() > 0u);
+            CHECK(command1->memorySize() < 1024u);
+
+            REQUIRE(command1->performUndo(facade)->success());
+            CHECK(entityNode->entity() == originalEntity);
+
+            REQUIRE(command1->performDo(facade)->success());
+            CHECK(entityNode->entity() == entityWithNewProperty);
+        }
+
         TEST_CASE_METHOD(MapDocumentTest, "SwapNodeContentsTest.swapPatches") {
             auto* patchNode = createPatchNode();
             addNode(*document, document->parentForNodes(), patchNode);
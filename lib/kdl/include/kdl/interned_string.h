@@ -0,0 +1,152 @@
+/*
+ Copyright 2021 Kristian Duske
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+ persons to whom the Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace kdl {
+    /**
+     * An immutable string whose contents are stored only once in a global pool, no matter how many interned strings
+     * with the same contents exist. An interned string is a pointer to its pooled contents, so it can be copied
+     * without allocating memory, and two interned strings are equal if and only if they point to the same contents.
+     *
+     * Interning a string looks up its contents in the pool and adds them if they are not found. The pool can be used
+     * from multiple threads concurrently. Lookups of contents that are already in the pool only take a shared lock.
+     *
+     * The pool never releases any strings, so only strings from a limited vocabulary, such as names and keys, should
+     * be interned.
+     */
+    class interned_string {
+    private:
+        class pool {
+        private:
+            std::shared_mutex m_mutex;
+            // std::deque never moves its elements, so the views and pointers into it remain valid
+            std::deque<std::string> m_strings;
+            std::unordered_map<std::string_view, const std::string*> m_index;
+        public:
+            const std::string* intern(const std::string_view str) {
+                {
+                    const auto lock = std::shared_lock<std::shared_mutex>{m_mutex};
+                    if (const auto it = m_index.find(str); it != std::end(m_index)) {
+                        return it->second;
+                    }
+                }
+
+                const auto lock = std::unique_lock<std::shared_mutex>{m_mutex};
+                if (const auto it = m_index.find(str); it != std::end(m_index)) {
+                    // another thread has added the string in the meantime
+                    return it->second;
+                }
+
+                const auto& result = m_strings.emplace_back(str);
+                m_index.emplace(std::string_view{result}, &result);
+                return &result;
+            }
+
+            std::size_t size() {
+                const auto lock = std::shared_lock<std::shared_mutex>{m_mutex};
+                return m_strings.size();
+            }
+        };
+
+        static pool& pool_instance() {
+            // never destroyed so that interned strings can be used during static destruction
+            static auto* instance = new pool();
+            return *instance;
+        }
+
+        static const std::string* empty_string() {
+            static const auto* result = pool_instance().intern(std::string_view{});
+            return result;
+        }
+
+        const std::string* m_str;
+    public:
+        /**
+         * Creates an empty interned string.
+         */
+        interned_string() :
+        m_str{empty_string()} {}
+
+        /**
+         * Interns the given string.
+         */
+        explicit interned_string(const std::string_view str) :
+        m_str{pool_instance().intern(str)} {}
+
+        /**
+         * Returns the contents of this interned string. The returned reference remains valid until the program exits.
+         */
+        const std::string& str() const {
+            return *m_str;
+        }
+
+        bool empty() const {
+            return m_str->empty();
+        }
+
+        std::size_t size() const {
+            return m_str->size();
+        }
+
+        /**
+         * Returns the number of distinct strings that have been interned so far.
+         */
+        static std::size_t pool_size() {
+            return pool_instance().size();
+        }
+
+        friend bool operator==(const interned_string& lhs, const interned_string& rhs) {
+            return lhs.m_str == rhs.m_str;
+        }
+
+        friend bool operator!=(const interned_string& lhs, const interned_string& rhs) {
+            return lhs.m_str != rhs.m_str;
+        }
+
+        /**
+         * Compares the contents of the given strings lexicographically.
+         */
+        friend bool operator<(const interned_string& lhs, const interned_string& rhs) {
+            return lhs.m_str != rhs.m_str && *lhs.m_str < *rhs.m_str;
+        }
+
+        friend std::ostream& operator<<(std::ostream& str, const interned_string& s) {
+            str << *s.m_str;
+            return str;
+        }
+    };
+}
+
+namespace std {
+    template <>
+    struct hash<kdl::interned_string> {
+        std::size_t operator()(const kdl::interned_string& s) const noexcept {
+            return std::hash<const std::string*>{}(&s.str());
+        }
+    };
+}
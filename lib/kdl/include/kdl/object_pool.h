@@ -0,0 +1,280 @@
+/*
+ Copyright 2021 Kristian Duske
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+ persons to whom the Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace kdl {
+    /**
+     * Provides memory for objects of type T from chunks of `ChunkSize` objects. Use it to implement class specific
+     * `operator new` and `operator delete` for small objects that are created and destroyed in large numbers.
+     *
+     * Allocating and deallocating an object only pushes to or pops from a free list that belongs to the calling thread,
+     * so no locking is required unless the thread's free list is empty or holds more than two chunks' worth of slots.
+     * Objects may be deallocated by a different thread than the one that allocated them. A thread whose free list grows
+     * beyond two chunks' worth of slots hands one chunk's worth over to the other threads, so that memory freed by one
+     * thread can be reused by another. When a thread exits, its free list is handed over to the other threads.
+     *
+     * Chunks are only returned to the system by `release_unused_chunks`, so until it is called, the memory used by the
+     * pool is the peak memory used by the objects.
+     *
+     * The pool is shared by all objects of type T rather than owned by a single container of such objects. Copying a
+     * container therefore still allocates its objects one by one, and destroying it returns them one by one, but each
+     * allocation and deallocation is only a push to or a pop from a free list.
+     */
+    template <typename T, std::size_t ChunkSize = 256u>
+    class object_pool {
+        static_assert(ChunkSize > 0u, "chunk size must not be zero");
+    private:
+        union slot {
+            slot* next;
+            alignas(T) unsigned char storage[sizeof(T)];
+        };
+
+        struct shared_state {
+            std::mutex mutex;
+            std::vector<std::unique_ptr<slot[]>> chunks;
+            slot* free_list = nullptr;
+        };
+
+        struct local_state {
+            slot* free_list = nullptr;
+            std::size_t free_count = 0u;
+        };
+
+        /**
+         * Returns the thread's free list and its length. This is a trivially destructible thread local so that objects
+         * can still be deallocated while the thread's other thread locals are destroyed.
+         */
+        static local_state& local_state_instance() {
+            static thread_local local_state state;
+            return state;
+        }
+
+        /**
+         * Prepends the given list of slots to the shared free list.
+         */
+        static void hand_over(slot* first, slot* last) {
+            auto& shared = shared_state_instance();
+            const auto lock = std::lock_guard<std::mutex>(shared.mutex);
+            last->next = shared.free_list;
+            shared.free_list = first;
+        }
+
+        /**
+         * Hands the given thread's entire free list over to the other threads.
+         */
+        static void flush(local_state& local) {
+            if (local.free_list != nullptr) {
+                slot* last = local.free_list;
+                while (last->next != nullptr) {
+                    last = last->next;
+                }
+
+                hand_over(local.free_list, last);
+                local.free_list = nullptr;
+                local.free_count = 0u;
+            }
+        }
+
+        /**
+         * Hands the thread's free list over to the other threads when the thread exits.
+         */
+        struct local_free_list_flusher {
+            ~local_free_list_flusher() {
+                flush(local_state_instance());
+            }
+        };
+
+        static shared_state& shared_state_instance() {
+            // never destroyed so that objects can be deallocated during static destruction
+            static auto* state = new shared_state();
+            return *state;
+        }
+
+        static void register_local_free_list_flusher() {
+            static thread_local local_free_list_flusher flusher;
+            static_cast<void>(flusher);
+        }
+
+        /**
+         * Takes up to one chunk's worth of slots from the shared free list, or allocates a new chunk if the shared free
+         * list is empty.
+         */
+        static void refill(local_state& local) {
+            register_local_free_list_flusher();
+
+            auto& shared = shared_state_instance();
+            const auto lock = std::lock_guard<std::mutex>(shared.mutex);
+            if (shared.free_list != nullptr) {
+                slot* last = shared.free_list;
+                std::size_t count = 1u;
+                while (count < ChunkSize && last->next != nullptr) {
+                    last = last->next;
+                    ++count;
+                }
+
+                local.free_list = shared.free_list;
+                local.free_count = count;
+                shared.free_list = last->next;
+                last->next = nullptr;
+                return;
+            }
+
+            auto chunk = std::make_unique<slot[]>(ChunkSize);
+            for (std::size_t i = 0u; i < ChunkSize - 1u; ++i) {
+                chunk[i].next = &chunk[i + 1u];
+            }
+            chunk[ChunkSize - 1u].next = nullptr;
+
+            local.free_list = &chunk[0];
+            local.free_count = ChunkSize;
+            shared.chunks.push_back(std::move(chunk));
+        }
+
+        /**
+         * Hands the first chunk's worth of slots of the thread's free list over to the other threads.
+         */
+        static void trim(local_state& local) {
+            slot* first = local.free_list;
+            slot* last = first;
+            for (std::size_t i = 1u; i < ChunkSize; ++i) {
+                last = last->next;
+            }
+
+            local.free_list = last->next;
+            local.free_count -= ChunkSize;
+            hand_over(first, last);
+        }
+    public:
+        /**
+         * Returns uninitialized memory for one object of type T.
+         */
+        static void* allocate() {
+            local_state& local = local_state_instance();
+            if (local.free_list == nullptr) {
+                refill(local);
+            }
+
+            slot* result = local.free_list;
+            local.free_list = result->next;
+            --local.free_count;
+            return result;
+        }
+
+        /**
+         * Returns the given memory to the pool. The memory must have been obtained by calling `allocate` and the object
+         * stored in it must have been destroyed.
+         */
+        static void deallocate(void* ptr) noexcept {
+            if (ptr != nullptr) {
+                local_state& local = local_state_instance();
+                if (local.free_list == nullptr) {
+                    register_local_free_list_flusher();
+                }
+
+                auto* s = static_cast<slot*>(ptr);
+                s->next = local.free_list;
+                local.free_list = s;
+                ++local.free_count;
+
+                // keep one chunk's worth so that alternating allocations and deallocations don't lock every time
+                if (local.free_count > 2u * ChunkSize) {
+                    trim(local);
+                }
+            }
+        }
+
+        /**
+         * Returns the chunks whose slots are all unused to the system and returns the number of bytes released.
+         *
+         * Only slots in the shared free list count as unused, so the calling thread's free list is handed over first.
+         * Slots held in the free lists of other threads keep their chunks alive. Takes time linear in the number of
+         * free slots, so call it after many objects were deallocated rather than after every deallocation.
+         */
+        static std::size_t release_unused_chunks() {
+            flush(local_state_instance());
+
+            auto& shared = shared_state_instance();
+            const auto lock = std::lock_guard<std::mutex>(shared.mutex);
+            if (shared.free_list == nullptr) {
+                return 0u;
+            }
+
+            auto& chunks = shared.chunks;
+            const auto less = std::less<const slot*>{};
+            std::sort(chunks.begin(), chunks.end(), [&](const auto& lhs, const auto& rhs) {
+                return less(lhs.get(), rhs.get());
+            });
+
+            // the index of the chunk containing the given slot, which is the last chunk starting at or before it
+            const auto chunk_index = [&](const slot* s) {
+                const auto it = std::upper_bound(chunks.begin(), chunks.end(), s, [&](const slot* lhs, const auto& rhs) {
+                    return less(lhs, rhs.get());
+                });
+                return static_cast<std::size_t>(it - chunks.begin()) - 1u;
+            };
+
+            auto free_counts = std::vector<std::size_t>(chunks.size(), 0u);
+            for (slot* s = shared.free_list; s != nullptr; s = s->next) {
+                ++free_counts[chunk_index(s)];
+            }
+
+            if (std::find(free_counts.begin(), free_counts.end(), ChunkSize) == free_counts.end()) {
+                return 0u;
+            }
+
+            // unlink the slots of the unused chunks before the chunks are freed
+            slot* free_list = nullptr;
+            for (slot* s = shared.free_list; s != nullptr;) {
+                slot* next = s->next;
+                if (free_counts[chunk_index(s)] < ChunkSize) {
+                    s->next = free_list;
+                    free_list = s;
+                }
+                s = next;
+            }
+            shared.free_list = free_list;
+
+            auto used_chunks = std::vector<std::unique_ptr<slot[]>>{};
+            for (std::size_t i = 0u; i < chunks.size(); ++i) {
+                if (free_counts[i] < ChunkSize) {
+                    used_chunks.push_back(std::move(chunks[i]));
+                }
+            }
+
+            const auto released_chunk_count = chunks.size() - used_chunks.size();
+            chunks = std::move(used_chunks);
+            return released_chunk_count * ChunkSize * sizeof(slot);
+        }
+
+        /**
+         * Returns the number of bytes that the pool has obtained from the system.
+         */
+        static std::size_t allocated_bytes() {
+            auto& shared = shared_state_instance();
+            const auto lock = std::lock_guard<std::mutex>(shared.mutex);
+            return shared.chunks.size() * ChunkSize * sizeof(slot);
+        }
+    };
+}
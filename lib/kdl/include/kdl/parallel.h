@@ -18,9 +18,9 @@
 #ifndef KDL_PARALLEL_H
 #define KDL_PARALLEL_H
 
-#include <atomic>
-#include <future> // for std::async
-#include <thread>
+#include "kdl/thread_pool.h"
+
+#include <cstddef>
 #include <utility> // for std::declval
 #include <vector>
 
@@ -28,52 +28,23 @@ namespace kdl {
     /**
      * Runs the given lambda `count` times, passing it indices `0` through `count - 1`.
      *
-     * Lambda is executed in parallel, using the number of threads returned by std::thread::hardware_concurrency().
-     *
-     * Because the threads are spawned with std::async(std::launch::async, ...) and no thread pool is used,
-     * there is a relatively large overhead and this should only be used on large/slow to process data sets.
+     * Lambda is executed in parallel on the process wide thread pool returned by global_thread_pool(). The calling
+     * thread participates in the work, and this function may be called from within another parallel task.
      *
      * @tparam L type of lambda
      * @param count the maximum value (exclusive) to pass to lambda
      * @param lambda the lambda to run
      */
     template<class L>
-    void parallel_for(const size_t count, L&& lambda) {
-        size_t numThreads = static_cast<size_t>(std::thread::hardware_concurrency());
-        if (numThreads == 0) {
-            numThreads = 1;
-        }
-
-        std::atomic<size_t> nextIndex(0);
-
-        std::vector<std::future<void>> threads;
-        threads.resize(numThreads);
-
-        for (size_t i = 0; i < numThreads; ++i) {
-            threads[i] = std::async(std::launch::async, [&]() {
-                while (true) {
-                    const size_t ourIndex = std::atomic_fetch_add(&nextIndex, static_cast<size_t>(1));
-                    if (ourIndex >= count) {
-                        break;
-                    }
-                    lambda(ourIndex);
-                }
-            });
-        }
-
-        for (size_t i = 0; i < numThreads; ++i) {
-            threads[i].wait();
-        }
+    void parallel_for(const std::size_t count, L&& lambda) {
+        global_thread_pool().parallel_for(count, std::forward<L>(lambda));
     }
 
     /**
      * Applies the given lambda to each element of the input (passing elements as rvalue references),
      * and returns a vector of the resulting values, in their original order.
      * 
-     * The lambda is executed in parallel, using the number of threads returned by std::thread::hardware_concurrency().
-     * 
-     * Because the threads are spawned with std::async(std::launch::async, ...) and no thread pool is used,
-     * there is a relatively large overhead and this should only be used on large/slow to process data sets.
+     * The lambda is executed in parallel on the process wide thread pool returned by global_thread_pool().
      *
      * @tparam T the type of the vector elements
      * @tparam L the type of the lambda to apply
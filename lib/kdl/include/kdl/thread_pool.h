@@ -0,0 +1,450 @@
+/*
+ Copyright 2021 Kristian Duske
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+ persons to whom the Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace kdl {
+    class thread_pool;
+
+    namespace detail {
+        /**
+         * Identifies the pool and queue that the calling thread belongs to, if it is a worker thread.
+         */
+        struct worker_context {
+            const thread_pool* pool = nullptr;
+            std::size_t index = 0u;
+        };
+
+        inline worker_context& current_worker_context() {
+            static thread_local worker_context context;
+            return context;
+        }
+    }
+
+    /**
+     * Tracks a set of tasks that were submitted to a thread pool so that they can be waited for together.
+     *
+     * If any of the tasks throws an exception, the first such exception is stored and rethrown by `wait`.
+     */
+    class task_group {
+    private:
+        friend class thread_pool;
+
+        thread_pool& m_pool;
+        std::atomic<std::size_t> m_pending;
+        std::mutex m_mutex;
+        std::condition_variable m_done;
+        std::exception_ptr m_exception;
+    public:
+        explicit task_group(thread_pool& pool) :
+        m_pool(pool),
+        m_pending(0u) {}
+
+        task_group(const task_group&) = delete;
+        task_group& operator=(const task_group&) = delete;
+
+        ~task_group() {
+            // the tasks reference this group, so we must not go away before they are done
+            wait_no_throw();
+        }
+
+        /**
+         * Submits the given function to the pool as part of this group.
+         */
+        template <typename F>
+        void run(F&& f);
+
+        /**
+         * Waits for all tasks of this group to finish. While waiting, the calling thread executes pending tasks of the
+         * pool, so it is safe to wait from within a task (nested parallelism).
+         *
+         * Rethrows the first exception thrown by any of the group's tasks.
+         */
+        void wait();
+    private:
+        void wait_no_throw();
+
+        void finish_task(std::exception_ptr exception) {
+            // the group may be destroyed as soon as the lock is released after the last task was finished
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (exception && !m_exception) {
+                m_exception = std::move(exception);
+            }
+            if (m_pending.fetch_sub(1u) == 1u) {
+                m_done.notify_all();
+            }
+        }
+    };
+
+    /**
+     * A persistent pool of worker threads with one task queue per worker.
+     *
+     * Workers take tasks from the back of their own queue and steal tasks from the front of other workers' queues when
+     * their own queue is empty. Tasks submitted by threads that don't belong to the pool are distributed among the
+     * workers' queues in a round robin fashion.
+     *
+     * Threads waiting for a task group help execute pending tasks, which allows tasks to spawn and wait for nested
+     * tasks without blocking a worker.
+     */
+    class thread_pool {
+    private:
+        friend class task_group;
+
+        using task = std::function<void()>;
+
+        struct task_queue {
+            std::mutex mutex;
+            std::deque<task> tasks;
+        };
+
+        std::vector<std::unique_ptr<task_queue>> m_queues;
+        std::vector<std::thread> m_threads;
+        std::atomic<std::size_t> m_queued_tasks;
+        std::atomic<std::size_t> m_next_queue;
+
+        std::mutex m_sleep_mutex;
+        std::condition_variable m_wakeup;
+        bool m_stop;
+    public:
+        /**
+         * Creates a thread pool with the given number of worker threads. If the given number is 0, the number of
+         * threads is determined by std::thread::hardware_concurrency().
+         */
+        explicit thread_pool(const std::size_t thread_count = 0u) :
+        m_queued_tasks(0u),
+        m_next_queue(0u),
+        m_stop(false) {
+            start(thread_count == 0u ? default_thread_count() : thread_count);
+        }
+
+        thread_pool(const thread_pool&) = delete;
+        thread_pool& operator=(const thread_pool&) = delete;
+
+        ~thread_pool() {
+            stop();
+        }
+
+        /**
+         * Returns the number of hardware threads, or 1 if it cannot be determined.
+         */
+        static std::size_t default_thread_count() {
+            return std::max(static_cast<std::size_t>(std::thread::hardware_concurrency()), std::size_t(1));
+        }
+
+        /**
+         * Returns the number of worker threads.
+         */
+        std::size_t thread_count() const {
+            return m_threads.size();
+        }
+
+        /**
+         * Stops all worker threads and starts the given number of new worker threads. If the given number is 0, the
+         * number of threads is determined by std::thread::hardware_concurrency().
+         *
+         * Precondition: no tasks are currently submitted to this pool
+         */
+        void resize(const std::size_t thread_count) {
+            stop();
+            start(thread_count == 0u ? default_thread_count() : thread_count);
+        }
+
+        /**
+         * Runs the given lambda `count` times, passing it indices `0` through `count - 1`.
+         *
+         * The index range is split recursively into chunks of at most `grain_size` indices, and the chunks are
+         * executed by the workers of this pool and by the calling thread. If `grain_size` is 0, a grain size is chosen
+         * so that every thread gets several chunks to allow for load balancing.
+         *
+         * This function may be called from within a task of this pool.
+         *
+         * If the lambda throws, the first exception is rethrown once all chunks have finished.
+         *
+         * @tparam L type of lambda
+         * @param count the maximum value (exclusive) to pass to lambda
+         * @param lambda the lambda to run
+         * @param grain_size the maximum number of indices per chunk
+         */
+        template <typename L>
+        void parallel_for(const std::size_t count, L&& lambda, std::size_t grain_size = 0u) {
+            if (count == 0u) {
+                return;
+            }
+
+            if (grain_size == 0u) {
+                grain_size = std::max(count / (8u * (thread_count() + 1u)), std::size_t(1));
+            }
+
+            if (count <= grain_size) {
+                for (std::size_t i = 0u; i < count; ++i) {
+                    lambda(i);
+                }
+                return;
+            }
+
+            task_group group(*this);
+            split_range(group, 0u, count, grain_size, lambda);
+            group.wait();
+        }
+
+        /**
+         * Runs the given functions in parallel and waits for all of them to finish.
+         *
+         * This function may be called from within a task of this pool.
+         */
+        template <typename... F>
+        void parallel_invoke(F&&... f) {
+            task_group group(*this);
+            (group.run(std::forward<F>(f)), ...);
+            group.wait();
+        }
+    private:
+        template <typename L>
+        void split_range(task_group& group, std::size_t begin, std::size_t end, const std::size_t grain_size, L& lambda) {
+            // split off the upper halves as new tasks and process the remaining lower part in this thread
+            while (end - begin > grain_size) {
+                const std::size_t mid = begin + (end - begin) / 2u;
+                group.run([this, &group, mid, end, grain_size, &lambda]() {
+                    split_range(group, mid, end, grain_size, lambda);
+                });
+                end = mid;
+            }
+
+            for (std::size_t i = begin; i < end; ++i) {
+                lambda(i);
+            }
+        }
+
+        void start(const std::size_t thread_count) {
+            assert(m_threads.empty());
+            m_stop = false;
+
+            // one queue per worker plus one queue for tasks submitted by foreign threads if there are no workers
+            m_queues.clear();
+            for (std::size_t i = 0u; i < std::max(thread_count, std::size_t(1)); ++i) {
+                m_queues.push_back(std::make_unique<task_queue>());
+            }
+
+            m_threads.reserve(thread_count);
+            for (std::size_t i = 0u; i < thread_count; ++i) {
+                m_threads.emplace_back([this, i]() { worker_loop(i); });
+            }
+        }
+
+        void stop() {
+            {
+                std::lock_guard<std::mutex> lock(m_sleep_mutex);
+                m_stop = true;
+            }
+            m_wakeup.notify_all();
+
+            for (auto& thread : m_threads) {
+                thread.join();
+            }
+            m_threads.clear();
+
+            assert(m_queued_tasks == 0u);
+        }
+
+        void submit(task t) {
+            const auto& context = detail::current_worker_context();
+            const std::size_t queue_index = context.pool == this
+                ? context.index
+                : m_next_queue.fetch_add(1u) % m_queues.size();
+
+            auto& queue = *m_queues[queue_index];
+            {
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                queue.tasks.push_back(std::move(t));
+            }
+            m_queued_tasks.fetch_add(1u);
+
+            {
+                // lock to avoid losing the wakeup if a worker is just about to go to sleep
+                std::lock_guard<std::mutex> lock(m_sleep_mutex);
+            }
+            m_wakeup.notify_one();
+        }
+
+        /**
+         * Takes a task from the back of the queue with the given index or, if that queue is empty, from the front of
+         * any other queue.
+         */
+        std::optional<task> take_task(const std::size_t own_index) {
+            if (m_queued_tasks == 0u) {
+                return std::nullopt;
+            }
+
+            {
+                auto& queue = *m_queues[own_index];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                if (!queue.tasks.empty()) {
+                    auto result = std::move(queue.tasks.back());
+                    queue.tasks.pop_back();
+                    m_queued_tasks.fetch_sub(1u);
+                    return result;
+                }
+            }
+
+            for (std::size_t i = 1u; i < m_queues.size(); ++i) {
+                auto& queue = *m_queues[(own_index + i) % m_queues.size()];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                if (!queue.tasks.empty()) {
+                    auto result = std::move(queue.tasks.front());
+                    queue.tasks.pop_front();
+                    m_queued_tasks.fetch_sub(1u);
+                    return result;
+                }
+            }
+
+            return std::nullopt;
+        }
+
+        /**
+         * Executes a single pending task, if any. Returns whether a task was executed.
+         */
+        bool run_pending_task() {
+            const auto& context = detail::current_worker_context();
+            const std::size_t own_index = context.pool == this ? context.index : 0u;
+            if (auto t = take_task(own_index)) {
+                (*t)();
+                return true;
+            }
+            return false;
+        }
+
+        void worker_loop(const std::size_t index) {
+            auto& context = detail::current_worker_context();
+            context.pool = this;
+            context.index = index;
+
+            while (true) {
+                if (run_pending_task()) {
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lock(m_sleep_mutex);
+                m_wakeup.wait(lock, [&]() { return m_stop || m_queued_tasks > 0u; });
+                if (m_stop && m_queued_tasks == 0u) {
+                    break;
+                }
+            }
+
+            context.pool = nullptr;
+        }
+    };
+
+    template <typename F>
+    void task_group::run(F&& f) {
+        m_pending.fetch_add(1u);
+        m_pool.submit([this, f = std::forward<F>(f)]() mutable {
+            std::exception_ptr exception;
+            try {
+                f();
+            } catch (...) {
+                exception = std::current_exception();
+            }
+            finish_task(std::move(exception));
+        });
+    }
+
+    inline void task_group::wait() {
+        wait_no_throw();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_exception) {
+            auto exception = std::move(m_exception);
+            m_exception = nullptr;
+            std::rethrow_exception(exception);
+        }
+    }
+
+    inline void task_group::wait_no_throw() {
+        while (m_pending > 0u) {
+            if (!m_pool.run_pending_task()) {
+                // no work to help with, so wait briefly for the remaining tasks to finish
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_done.wait_for(lock, std::chrono::microseconds(100), [&]() { return m_pending == 0u; });
+            }
+        }
+
+        // synchronize with the last call to finish_task
+        std::lock_guard<std::mutex> lock(m_mutex);
+    }
+
+    namespace detail {
+        inline std::size_t& global_thread_pool_size() {
+            static std::size_t size = 0u;
+            return size;
+        }
+
+        inline std::unique_ptr<thread_pool>& global_thread_pool_instance() {
+            static std::unique_ptr<thread_pool> instance;
+            return instance;
+        }
+
+        inline std::mutex& global_thread_pool_mutex() {
+            static std::mutex mutex;
+            return mutex;
+        }
+    }
+
+    /**
+     * Returns the process wide thread pool, creating it on first use.
+     *
+     * The pool creates the number of threads set by `set_global_thread_count`, or the number of hardware threads if
+     * no thread count was set.
+     */
+    inline thread_pool& global_thread_pool() {
+        std::lock_guard<std::mutex> lock(detail::global_thread_pool_mutex());
+        auto& instance = detail::global_thread_pool_instance();
+        if (!instance) {
+            instance = std::make_unique<thread_pool>(detail::global_thread_pool_size());
+        }
+        return *instance;
+    }
+
+    /**
+     * Sets the number of worker threads of the process wide thread pool. A count of 0 uses the number of hardware
+     * threads. If the pool already exists, its threads are restarted.
+     *
+     * Precondition: no tasks are currently running on the global thread pool
+     */
+    inline void set_global_thread_count(const std::size_t thread_count) {
+        std::lock_guard<std::mutex> lock(detail::global_thread_pool_mutex());
+        detail::global_thread_pool_size() = thread_count;
+        if (auto& instance = detail::global_thread_pool_instance()) {
+            instance->resize(thread_count);
+        }
+    }
+}
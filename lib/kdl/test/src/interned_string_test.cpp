@@ -0,0 +1,89 @@
+/*
+ Copyright 2021 Kristian Duske
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+ persons to whom the Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "kdl/interned_string.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace kdl {
+    TEST_CASE("interned_string_test.constructor", "[interned_string_test]") {
+        CHECK(interned_string{}.str() == "");
+        CHECK(interned_string{}.empty());
+        CHECK(interned_string{""} == interned_string{});
+
+        const auto s = interned_string{"some_texture"};
+        CHECK(s.str() == "some_texture");
+        CHECK(s.size() == 12u);
+        CHECK_FALSE(s.empty());
+    }
+
+    TEST_CASE("interned_string_test.shared_contents", "[interned_string_test]") {
+        const auto s1 = interned_string{"shared"};
+        const auto s2 = interned_string{std::string{"shared"}};
+        const auto s3 = interned_string{"other"};
+
+        CHECK(&s1.str() == &s2.str());
+        CHECK(&s1.str() != &s3.str());
+
+        const auto poolSize = interned_string::pool_size();
+        const auto s4 = interned_string{"shared"};
+        CHECK(interned_string::pool_size() == poolSize);
+        CHECK(&s4.str() == &s1.str());
+    }
+
+    TEST_CASE("interned_string_test.compare", "[interned_string_test]") {
+        const auto a = interned_string{"a"};
+        const auto b = interned_string{"b"};
+
+        CHECK(a == interned_string{"a"});
+        CHECK(a != b);
+        CHECK(a < b);
+        CHECK_FALSE(b < a);
+        CHECK_FALSE(a < a);
+
+        CHECK(std::hash<interned_string>{}(a) == std::hash<interned_string>{}(interned_string{"a"}));
+    }
+
+    TEST_CASE("interned_string_test.concurrent_interning", "[interned_string_test]") {
+        constexpr auto threadCount = 8u;
+        constexpr auto stringCount = 1000u;
+
+        auto results = std::vector<std::vector<interned_string>>(threadCount);
+        auto threads = std::vector<std::thread>{};
+        for (std::size_t t = 0u; t < threadCount; ++t) {
+            threads.emplace_back([&, t]() {
+                for (std::size_t i = 0u; i < stringCount; ++i) {
+                    results[t].emplace_back("concurrent_" + std::to_string(i));
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        for (std::size_t t = 1u; t < threadCount; ++t) {
+            CHECK(results[t] == results[0]);
+        }
+        for (std::size_t i = 0u; i < stringCount; ++i) {
+            CHECK(results[0][i].str() == "concurrent_" + std::to_string(i));
+        }
+    }
+}
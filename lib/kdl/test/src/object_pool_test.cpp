@@ -0,0 +1,199 @@
+/*
+ Copyright 2021 Kristian Duske
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+ persons to whom the Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "kdl/object_pool.h"
+
+#include <cassert>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace kdl {
+    struct pooled_object {
+        std::uint64_t value;
+        double other;
+
+        explicit pooled_object(const std::uint64_t i_value) :
+        value(i_value),
+        other(0.0) {}
+
+        static void* operator new(const std::size_t size) {
+            assert(size == sizeof(pooled_object));
+            static_cast<void>(size);
+            return object_pool<pooled_object, 16u>::allocate();
+        }
+
+        static void operator delete(void* ptr) noexcept {
+            object_pool<pooled_object, 16u>::deallocate(ptr);
+        }
+    };
+
+    TEST_CASE("object_pool.allocate", "[object_pool_test]") {
+        auto objects = std::vector<pooled_object*>{};
+        for (std::uint64_t i = 0u; i < 100u; ++i) {
+            objects.push_back(new pooled_object(i));
+        }
+
+        CHECK(std::set<pooled_object*>(objects.begin(), objects.end()).size() == objects.size());
+        for (std::uint64_t i = 0u; i < 100u; ++i) {
+            CHECK(objects[i]->value == i);
+            CHECK(reinterpret_cast<std::uintptr_t>(objects[i]) % alignof(pooled_object) == 0u);
+        }
+
+        for (auto* object : objects) {
+            delete object;
+        }
+    }
+
+    TEST_CASE("object_pool.reuse", "[object_pool_test]") {
+        auto objects = std::vector<pooled_object*>{};
+        for (std::uint64_t i = 0u; i < 16u; ++i) {
+            objects.push_back(new pooled_object(i));
+        }
+        for (auto* object : objects) {
+            delete object;
+        }
+
+        // the freed memory is reused, so no new chunks are needed
+        const auto allocatedBytes = object_pool<pooled_object, 16u>::allocated_bytes();
+        for (std::uint64_t i = 0u; i < 16u; ++i) {
+            objects[i] = new pooled_object(i);
+        }
+        CHECK(object_pool<pooled_object, 16u>::allocated_bytes() == allocatedBytes);
+
+        for (auto* object : objects) {
+            delete object;
+        }
+    }
+
+    TEST_CASE("object_pool.deallocateOnOtherThread", "[object_pool_test]") {
+        auto objects = std::vector<pooled_object*>{};
+        std::thread([&]() {
+            for (std::uint64_t i = 0u; i < 1000u; ++i) {
+                objects.push_back(new pooled_object(i));
+            }
+        }).join();
+
+        std::thread([&]() {
+            for (auto* object : objects) {
+                delete object;
+            }
+        }).join();
+
+        // the exited thread's free list was handed over, so these allocations don't need new chunks
+        const auto allocatedBytes = object_pool<pooled_object, 16u>::allocated_bytes();
+        objects.clear();
+        for (std::uint64_t i = 0u; i < 1000u; ++i) {
+            objects.push_back(new pooled_object(i));
+        }
+        CHECK(object_pool<pooled_object, 16u>::allocated_bytes() == allocatedBytes);
+
+        for (auto* object : objects) {
+            delete object;
+        }
+    }
+
+    TEST_CASE("object_pool.allocateAndDeallocateOnDifferentThreads", "[object_pool_test]") {
+        constexpr std::size_t roundCount = 100u;
+        constexpr std::size_t batchSize = 1000u;
+
+        std::mutex mutex;
+        std::condition_variable condition;
+        auto batch = std::vector<pooled_object*>{};
+        auto batchReady = false;
+
+        const auto allocatedBytes = object_pool<pooled_object, 16u>::allocated_bytes();
+
+        // both threads run for all rounds, so their free lists are only handed over if they grow too long
+        auto consumer = std::thread([&]() {
+            for (std::size_t round = 0u; round < roundCount; ++round) {
+                auto lock = std::unique_lock<std::mutex>(mutex);
+                condition.wait(lock, [&]() { return batchReady; });
+                for (auto* object : batch) {
+                    delete object;
+                }
+                batch.clear();
+                batchReady = false;
+                condition.notify_one();
+            }
+        });
+
+        auto producer = std::thread([&]() {
+            for (std::size_t round = 0u; round < roundCount; ++round) {
+                auto lock = std::unique_lock<std::mutex>(mutex);
+                condition.wait(lock, [&]() { return !batchReady; });
+                for (std::uint64_t i = 0u; i < batchSize; ++i) {
+                    batch.push_back(new pooled_object(i));
+                }
+                batchReady = true;
+                condition.notify_one();
+            }
+        });
+
+        producer.join();
+        consumer.join();
+
+        // the objects freed by the consumer are reused by the producer, so the pool only grows by about one batch
+        CHECK(object_pool<pooled_object, 16u>::allocated_bytes() - allocatedBytes <= 2u * batchSize * sizeof(pooled_object));
+    }
+
+    TEST_CASE("object_pool.releaseUnusedChunks", "[object_pool_test]") {
+        using pool = object_pool<pooled_object, 16u>;
+        constexpr std::size_t chunkBytes = 16u * sizeof(pooled_object);
+
+        // all objects of the other tests were deleted and their threads have exited
+        pool::release_unused_chunks();
+        CHECK(pool::allocated_bytes() == 0u);
+
+        auto objects = std::vector<pooled_object*>{};
+        for (std::uint64_t i = 0u; i < 64u; ++i) {
+            objects.push_back(new pooled_object(i));
+        }
+        REQUIRE(pool::allocated_bytes() == 4u * chunkBytes);
+
+        // the chunk of the remaining object is kept
+        auto* remaining = objects.front();
+        for (auto* object : objects) {
+            if (object != remaining) {
+                delete object;
+            }
+        }
+        CHECK(pool::release_unused_chunks() == 3u * chunkBytes);
+        CHECK(pool::allocated_bytes() == chunkBytes);
+        CHECK(remaining->value == 0u);
+
+        // the free slots of the kept chunk are still available
+        objects.clear();
+        for (std::uint64_t i = 0u; i < 15u; ++i) {
+            objects.push_back(new pooled_object(i));
+        }
+        CHECK(pool::allocated_bytes() == chunkBytes);
+
+        objects.push_back(remaining);
+        for (auto* object : objects) {
+            delete object;
+        }
+        CHECK(pool::release_unused_chunks() == chunkBytes);
+        CHECK(pool::allocated_bytes() == 0u);
+    }
+}
@@ -0,0 +1,111 @@
+/*
+ Copyright 2020 Eric Wasylishen
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+ persons to whom the Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "kdl/thread_pool.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace kdl {
+    TEST_CASE("thread_pool.thread_count", "[thread_pool_test]") {
+        CHECK(thread_pool(3u).thread_count() == 3u);
+        CHECK(thread_pool().thread_count() == thread_pool::default_thread_count());
+
+        thread_pool pool(2u);
+        pool.resize(4u);
+        CHECK(pool.thread_count() == 4u);
+    }
+
+    TEST_CASE("thread_pool.parallel_for", "[thread_pool_test]") {
+        const auto testSize = std::size_t(GENERATE(0u, 1u, 7u, 10'000u));
+        const auto grainSize = std::size_t(GENERATE(0u, 1u, 64u));
+        const auto threadCount = std::size_t(GENERATE(1u, 4u));
+
+        thread_pool pool(threadCount);
+
+        std::vector<std::atomic<std::size_t>> counts(testSize);
+        pool.parallel_for(testSize, [&](const std::size_t i) {
+            counts[i]++;
+        }, grainSize);
+
+        for (std::size_t i = 0u; i < testSize; ++i) {
+            CHECK(counts[i] == 1u);
+        }
+    }
+
+    TEST_CASE("thread_pool.nested_parallel_for", "[thread_pool_test]") {
+        constexpr std::size_t OuterSize = 64u;
+        constexpr std::size_t InnerSize = 256u;
+
+        thread_pool pool(4u);
+
+        std::vector<std::atomic<std::size_t>> counts(OuterSize * InnerSize);
+        pool.parallel_for(OuterSize, [&](const std::size_t i) {
+            pool.parallel_for(InnerSize, [&](const std::size_t j) {
+                counts[i * InnerSize + j]++;
+            }, 1u);
+        }, 1u);
+
+        for (const auto& count : counts) {
+            CHECK(count == 1u);
+        }
+    }
+
+    TEST_CASE("thread_pool.parallel_invoke", "[thread_pool_test]") {
+        thread_pool pool(2u);
+
+        std::atomic<int> a = 0;
+        std::atomic<int> b = 0;
+        std::atomic<int> c = 0;
+        pool.parallel_invoke([&]() { a = 1; }, [&]() { b = 2; }, [&]() { c = 3; });
+
+        CHECK(a == 1);
+        CHECK(b == 2);
+        CHECK(c == 3);
+    }
+
+    TEST_CASE("thread_pool.exception", "[thread_pool_test]") {
+        thread_pool pool(4u);
+
+        CHECK_THROWS_AS(pool.parallel_for(1000u, [&](const std::size_t i) {
+            if (i == 500u) {
+                throw std::runtime_error("error");
+            }
+        }, 10u), std::runtime_error);
+
+        // the pool remains usable
+        std::atomic<std::size_t> count = 0u;
+        pool.parallel_for(1000u, [&](const std::size_t) { count++; }, 10u);
+        CHECK(count == 1000u);
+    }
+
+    TEST_CASE("thread_pool.task_group", "[thread_pool_test]") {
+        thread_pool pool(3u);
+
+        std::atomic<std::size_t> count = 0u;
+        task_group group(pool);
+        for (std::size_t i = 0u; i < 100u; ++i) {
+            group.run([&]() { count++; });
+        }
+        group.wait();
+
+        CHECK(count == 100u);
+    }
+}